@@ -0,0 +1,223 @@
+#!/usr/bin/python3
+#
+# Compiles the D-Bus interface descriptions in dbus-interfaces/ into the
+# binary table GDBusInterfaceInfos are built from by
+# shell_util_lookup_dbus_interface_info() (src/shell-util.c), so that
+# they don't need to be parsed from XML at runtime.
+#
+# Unnamed arguments are named like GDBus does, and elements that aren't
+# part of the D-Bus introspection format (like documentation) are
+# ignored.
+#
+# All integers are little-endian. The file consists of:
+#
+# - Header:
+#   - magic (4 bytes): "DBI1"
+#   - n_interfaces (u32)
+#   - n_methods (u32)
+#   - n_signals (u32)
+#   - n_properties (u32)
+#   - n_args (u32)
+#   - n_annotations (u32)
+#   - strings_offset (u32): file offset of the string pool
+#
+# - Interfaces (n_interfaces entries, sorted by name):
+#   - name_offset (u32), name_length (u32)
+#   - first_method (u32), n_methods (u32)
+#   - first_signal (u32), n_signals (u32)
+#   - first_property (u32), n_properties (u32)
+#   - first_annotation (u32), n_annotations (u32)
+#
+# - Methods (n_methods entries):
+#   - name_offset (u32), name_length (u32)
+#   - first_in_arg (u32), n_in_args (u32)
+#   - first_out_arg (u32), n_out_args (u32)
+#   - first_annotation (u32), n_annotations (u32)
+#
+# - Signals (n_signals entries):
+#   - name_offset (u32), name_length (u32)
+#   - first_arg (u32), n_args (u32)
+#   - first_annotation (u32), n_annotations (u32)
+#
+# - Properties (n_properties entries):
+#   - name_offset (u32), name_length (u32)
+#   - signature_offset (u32), signature_length (u32)
+#   - flags (u32): GDBusPropertyInfoFlags
+#   - first_annotation (u32), n_annotations (u32)
+#
+# - Args (n_args entries):
+#   - name_offset (u32), name_length (u32)
+#   - signature_offset (u32), signature_length (u32)
+#   - first_annotation (u32), n_annotations (u32)
+#
+# - Annotations (n_annotations entries):
+#   - key_offset (u32), key_length (u32)
+#   - value_offset (u32), value_length (u32)
+#   - first_annotation (u32), n_annotations (u32): nested annotations
+#
+# - String pool: UTF-8 strings referenced above by offset and length
+#   (in bytes, relative to strings_offset).
+
+import struct
+import sys
+import xml.etree.ElementTree as ET
+
+PROPERTY_FLAGS = {
+    'read': 1,
+    'write': 2,
+    'readwrite': 3,
+}
+
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, string):
+        encoded = string.encode('utf-8')
+        if encoded not in self.offsets:
+            self.offsets[encoded] = len(self.data)
+            self.data += encoded
+        return self.offsets[encoded], len(encoded)
+
+
+class Table:
+    def __init__(self, fmt):
+        self.fmt = fmt
+        self.records = []
+
+    def reserve(self, n):
+        # Children of an element are stored contiguously, so they are
+        # reserved before their own children get added
+        first = len(self.records)
+        self.records += [None] * n
+        return first
+
+    def pack(self):
+        return b''.join(struct.pack(self.fmt, *r) for r in self.records)
+
+
+def canonicalize(element):
+    return (element.tag, sorted(element.attrib.items()),
+            [canonicalize(child) for child in element])
+
+
+class Compiler:
+    def __init__(self):
+        self.pool = StringPool()
+        self.interfaces = Table('<10I')
+        self.methods = Table('<8I')
+        self.signals = Table('<6I')
+        self.properties = Table('<7I')
+        self.args = Table('<6I')
+        self.annotations = Table('<6I')
+
+    def add_annotations(self, element):
+        children = element.findall('annotation')
+        first = self.annotations.reserve(len(children))
+        for i, annotation in enumerate(children):
+            self.annotations.records[first + i] = (
+                *self.pool.add(annotation.get('name')),
+                *self.pool.add(annotation.get('value')),
+                *self.add_annotations(annotation))
+        return first, len(children)
+
+    @staticmethod
+    def name_args(element):
+        # GDBus numbers unnamed args by their position among all args of
+        # the method or signal, whatever their direction
+        return [(arg.get('name', f'arg_{i}'), arg)
+                for i, arg in enumerate(element.findall('arg'))]
+
+    def add_args(self, args):
+        first = self.args.reserve(len(args))
+        for i, (name, arg) in enumerate(args):
+            self.args.records[first + i] = (
+                *self.pool.add(name),
+                *self.pool.add(arg.get('type')),
+                *self.add_annotations(arg))
+        return first, len(args)
+
+    def add_method(self, method):
+        args = self.name_args(method)
+        in_args = [a for a in args if a[1].get('direction', 'in') == 'in']
+        out_args = [a for a in args if a[1].get('direction', 'in') == 'out']
+        return (*self.pool.add(method.get('name')),
+                *self.add_args(in_args),
+                *self.add_args(out_args),
+                *self.add_annotations(method))
+
+    def add_signal(self, signal):
+        return (*self.pool.add(signal.get('name')),
+                *self.add_args(self.name_args(signal)),
+                *self.add_annotations(signal))
+
+    def add_property(self, prop):
+        return (*self.pool.add(prop.get('name')),
+                *self.pool.add(prop.get('type')),
+                PROPERTY_FLAGS[prop.get('access')],
+                *self.add_annotations(prop))
+
+    def add_members(self, table, elements, add_func):
+        first = table.reserve(len(elements))
+        for i, element in enumerate(elements):
+            table.records[first + i] = add_func(element)
+        return first, len(elements)
+
+    def add_interface(self, interface):
+        return (*self.pool.add(interface.get('name')),
+                *self.add_members(self.methods,
+                                  interface.findall('method'),
+                                  self.add_method),
+                *self.add_members(self.signals,
+                                  interface.findall('signal'),
+                                  self.add_signal),
+                *self.add_members(self.properties,
+                                  interface.findall('property'),
+                                  self.add_property),
+                *self.add_annotations(interface))
+
+    def compile(self, input_paths):
+        interfaces = {}
+        for path in input_paths:
+            for interface in ET.parse(path).getroot().iter('interface'):
+                name = interface.get('name')
+                # Some interfaces are described both in the installed
+                # files and in the ones only used by the shell
+                other = interfaces.setdefault(name, interface)
+                if canonicalize(other) != canonicalize(interface):
+                    sys.exit(f'{path}: Conflicting interface {name}')
+
+        # Sorted by their UTF-8 encoding, to be searched with strcmp()
+        names = sorted(interfaces, key=lambda n: n.encode('utf-8'))
+        self.add_members(self.interfaces,
+                         [interfaces[n] for n in names],
+                         self.add_interface)
+
+    def write(self, output_path):
+        tables = [self.interfaces, self.methods, self.signals,
+                  self.properties, self.args, self.annotations]
+        data = [t.pack() for t in tables]
+        header_size = 32
+        strings_offset = header_size + sum(len(d) for d in data)
+
+        with open(output_path, 'wb') as f:
+            f.write(struct.pack('<4s7I', b'DBI1',
+                                *[len(t.records) for t in tables],
+                                strings_offset))
+            for d in data:
+                f.write(d)
+            f.write(self.pool.data)
+
+
+def main(output_path, input_paths):
+    compiler = Compiler()
+    compiler.compile(input_paths)
+    compiler.write(output_path)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit(f'Usage: {sys.argv[0]} OUTPUT INTERFACE_XML...')
+    main(sys.argv[1], sys.argv[2:])
@@ -0,0 +1,135 @@
+#!/usr/bin/python3
+#
+# Compiles emoji.json into the compact binary table read by the
+# on-screen keyboard's emoji selection (js/ui/keyboard.js).
+#
+# All integers are little-endian. The file consists of:
+#
+# - Header:
+#   - magic (4 bytes): "EMJ1"
+#   - n_sections (u32)
+#   - n_keys (u32)
+#   - n_variants (u32)
+#   - strings_offset (u32): file offset of the string pool
+#
+# - Sections (n_sections entries):
+#   - first_key (u32): index of the first key of the section
+#   - n_keys (u32)
+#
+# - Keys (n_keys entries):
+#   - label_offset (u32), label_length (u32): the key label
+#   - first_variant (u32): index of the first variant of the key
+#   - n_variants (u32)
+#
+# - Variants (n_variants entries):
+#   - offset (u32), length (u32): the variant string
+#
+# - String pool: UTF-8 strings referenced above by offset and length
+#   (in bytes, relative to strings_offset).
+
+import json
+import struct
+import sys
+
+# Name of the first emoji of each section, in the order of the section
+# buttons in the emoji selection
+SECTIONS = [
+    'grinning face',
+    'selfie',
+    'monkey face',
+    'grapes',
+    'globe showing Europe-Africa',
+    'jack-o-lantern',
+    'muted speaker',
+    'ATM sign',
+    'chequered flag',
+]
+
+VARIATION_SELECTOR_16 = '\ufe0f'
+
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, string):
+        encoded = string.encode('utf-8')
+        if encoded not in self.offsets:
+            self.offsets[encoded] = len(self.data)
+            self.data += encoded
+        return self.offsets[encoded], len(encoded)
+
+
+def group_keys(emoji):
+    # Group variants of a same emoji (such as skin tones) so they appear
+    # on the key popover, starting a new section whenever the first emoji
+    # of one is found
+    sections = []
+    variants = []
+    current = 0
+
+    for i, item in enumerate(emoji):
+        if item['name'].startswith(emoji[current]['name']):
+            variants.append(item['char'])
+            if i < len(emoji) - 1:
+                continue
+
+        if emoji[current]['name'] in SECTIONS:
+            sections.append([])
+
+        sections[-1].append({
+            'label': emoji[current]['char'] + VARIATION_SELECTOR_16,
+            'variants': variants,
+        })
+        current = i
+        variants = []
+
+    return sections
+
+
+def main(input_path, output_path):
+    with open(input_path, encoding='utf-8') as f:
+        emoji = json.load(f)
+
+    sections = group_keys(emoji)
+    if len(sections) != len(SECTIONS):
+        sys.exit(f'Expected {len(SECTIONS)} sections, found {len(sections)}')
+
+    pool = StringPool()
+    section_table = bytearray()
+    key_table = bytearray()
+    variant_table = bytearray()
+    n_keys = 0
+    n_variants = 0
+
+    for keys in sections:
+        section_table += struct.pack('<II', n_keys, len(keys))
+
+        for key in keys:
+            key_table += struct.pack('<IIII',
+                                     *pool.add(key['label']),
+                                     n_variants, len(key['variants']))
+            for variant in key['variants']:
+                variant_table += struct.pack('<II', *pool.add(variant))
+            n_keys += 1
+            n_variants += len(key['variants'])
+
+    header_size = 20
+    strings_offset = (header_size + len(section_table) +
+                      len(key_table) + len(variant_table))
+
+    with open(output_path, 'wb') as f:
+        f.write(struct.pack('<4sIIII', b'EMJ1',
+                            len(sections), n_keys, n_variants,
+                            strings_offset))
+        f.write(section_table)
+        f.write(key_table)
+        f.write(variant_table)
+        f.write(pool.data)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit(f'Usage: {sys.argv[0]} EMOJI_JSON OUTPUT')
+    main(sys.argv[1], sys.argv[2])
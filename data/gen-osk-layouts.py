@@ -0,0 +1,181 @@
+#!/usr/bin/python3
+#
+# Compiles the JSON keyboard layouts in osk-layouts/ (as generated by
+# update-osk-layouts.sh) into the compact binary table read by the
+# on-screen keyboard (js/ui/keyboard.js).
+#
+# Layouts share most of their keys and rows, so identical rows and keys
+# are only stored once, and referenced by index.
+#
+# All integers are little-endian. The file consists of:
+#
+# - Header:
+#   - magic (4 bytes): "OSK1"
+#   - n_groups (u32)
+#   - n_levels (u32)
+#   - n_row_refs (u32)
+#   - n_rows (u32)
+#   - n_key_refs (u32)
+#   - n_keys (u32)
+#   - n_strings (u32)
+#   - strings_offset (u32): file offset of the string pool
+#
+# - Groups (n_groups entries, sorted by name):
+#   - name_offset (u32), name_length (u32): the XKB layout name
+#   - first_level (u32): index of the first level of the group
+#   - n_levels (u32)
+#
+# - Levels (n_levels entries):
+#   - mode_offset (u32), mode_length (u32): the level mode
+#   - first_row_ref (u32): index of the first row reference of the level
+#   - n_rows (u32)
+#
+# - Row references (n_row_refs entries):
+#   - row (u32): index of the row
+#
+# - Rows (n_rows entries):
+#   - first_key_ref (u32): index of the first key reference of the row
+#   - n_keys (u32)
+#
+# - Key references (n_key_refs entries):
+#   - key (u32): index of the key
+#
+# - Keys (n_keys entries):
+#   - action_offset (u32), action_length (u32)
+#   - label_offset (u32), label_length (u32)
+#   - icon_name_offset (u32), icon_name_length (u32)
+#   - keyval_offset (u32), keyval_length (u32)
+#   - level (i32): the level switched to, or -1
+#   - width (f32): the key width, or 0 for the default width
+#   - first_string (u32): index of the first string of the key
+#   - n_strings (u32)
+#
+# - Strings (n_strings entries):
+#   - offset (u32), length (u32): a string committed by a key
+#
+# - String pool: UTF-8 strings referenced above by offset and length
+#   (in bytes, relative to strings_offset). Optional fields that are
+#   not set have a length of 0.
+
+import json
+import os
+import struct
+import sys
+
+
+class StringPool:
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, string):
+        if string is None:
+            return 0, 0
+
+        encoded = string.encode('utf-8')
+        if encoded not in self.offsets:
+            self.offsets[encoded] = len(self.data)
+            self.data += encoded
+        return self.offsets[encoded], len(encoded)
+
+
+class Table:
+    def __init__(self):
+        self.data = bytearray()
+        self.length = 0
+        self.indices = {}
+
+    def append(self, record):
+        self.data += record
+        self.length += 1
+        return self.length - 1
+
+    def add(self, record, key=None):
+        # Deduplicates records by key (the record itself by default)
+        if key is None:
+            key = record
+        if key not in self.indices:
+            self.indices[key] = self.append(record)
+        return self.indices[key]
+
+
+def add_key(key, pool, keys, strings):
+    key_strings = key.get('strings', [])
+    packed = struct.pack('<IIIIIIIIif',
+                         *pool.add(key.get('action')),
+                         *pool.add(key.get('label')),
+                         *pool.add(key.get('iconName')),
+                         *pool.add(key.get('keyval')),
+                         key.get('level', -1),
+                         key.get('width', 0))
+    packed_strings = b''.join(struct.pack('<II', *pool.add(string))
+                              for string in key_strings)
+
+    dedup_key = (packed, packed_strings)
+    if dedup_key in keys.indices:
+        return keys.indices[dedup_key]
+
+    first_string = strings.length
+    for string in key_strings:
+        strings.append(struct.pack('<II', *pool.add(string)))
+
+    return keys.add(packed + struct.pack('<II', first_string, len(key_strings)),
+                    dedup_key)
+
+
+def add_row(row, pool, rows, key_refs, keys, strings):
+    indices = tuple(add_key(key, pool, keys, strings) for key in row)
+    if indices in rows.indices:
+        return rows.indices[indices]
+
+    first_key_ref = key_refs.length
+    for index in indices:
+        key_refs.append(struct.pack('<I', index))
+
+    return rows.add(struct.pack('<II', first_key_ref, len(indices)), indices)
+
+
+def main(output_path, input_paths):
+    pool = StringPool()
+    groups = Table()
+    levels = Table()
+    row_refs = Table()
+    rows = Table()
+    key_refs = Table()
+    keys = Table()
+    strings = Table()
+
+    layouts = {os.path.splitext(os.path.basename(path))[0]: path
+               for path in input_paths}
+
+    for name, path in sorted(layouts.items()):
+        with open(path, encoding='utf-8') as f:
+            layout = json.load(f)
+
+        groups.append(struct.pack('<IIII', *pool.add(name),
+                                  levels.length, len(layout['levels'])))
+
+        for level in layout['levels']:
+            levels.append(struct.pack('<IIII', *pool.add(level['mode']),
+                                      row_refs.length, len(level['rows'])))
+
+            for row in level['rows']:
+                index = add_row(row, pool, rows, key_refs, keys, strings)
+                row_refs.append(struct.pack('<I', index))
+
+    tables = [groups, levels, row_refs, rows, key_refs, keys, strings]
+    header_size = 36
+    strings_offset = header_size + sum(len(t.data) for t in tables)
+
+    with open(output_path, 'wb') as f:
+        f.write(struct.pack('<4s8I', b'OSK1',
+                            *[t.length for t in tables], strings_offset))
+        for table in tables:
+            f.write(table.data)
+        f.write(pool.data)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 3:
+        sys.exit(f'Usage: {sys.argv[0]} OUTPUT LAYOUT_JSON...')
+    main(sys.argv[1], sys.argv[2:])
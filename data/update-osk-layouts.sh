@@ -6,8 +6,8 @@ WORKDIR=".osk-layout-workbench"
 CLDR2JSON="cldr2json/cldr2json.py"
 SRCDIR="$WORKDIR/keyboards/android"
 DESTDIR="osk-layouts"
-GRESOURCE_FILE="gnome-shell-osk-layouts.gresource.xml"
-TMP_GRESOURCE_FILE=".$GRESOURCE_FILE.tmp"
+MESON_FILE="$DESTDIR/meson.build"
+TMP_MESON_FILE="$DESTDIR/.meson.build.tmp"
 
 cd `dirname $0`
 
@@ -25,23 +25,19 @@ popd
 # Transform to JSON files
 $CLDR2JSON $SRCDIR $DESTDIR
 
-# Generate new gresources xml file
-cat >$TMP_GRESOURCE_FILE <<EOF
-<?xml version="1.0" encoding="UTF-8"?>
-<gresources>
-  <gresource prefix="/org/gnome/shell/osk-layouts">
+# Generate new list of layouts to compile, see gen-osk-layouts.py
+cat >$TMP_MESON_FILE <<EOF
+osk_layouts = files([
 EOF
 
 for f in $DESTDIR/*.json
 do
-    echo "    <file>$(basename $f)</file>" >>$TMP_GRESOURCE_FILE
+    echo "  '$(basename $f)'," >>$TMP_MESON_FILE
 done
 
-cat >>$TMP_GRESOURCE_FILE <<EOF
-    <file>emoji.json</file>
-  </gresource>
-</gresources>
+cat >>$TMP_MESON_FILE <<EOF
+])
 EOF
 
-# Rewrite old gresources xml
-mv $TMP_GRESOURCE_FILE $GRESOURCE_FILE
+# Rewrite old layouts list
+mv $TMP_MESON_FILE $MESON_FILE
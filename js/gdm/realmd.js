@@ -3,16 +3,16 @@
 import Gio from 'gi://Gio';
 import * as Signals from '../misc/signals.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 
-const ProviderIface = loadInterfaceXML('org.freedesktop.realmd.Provider');
-const Provider = Gio.DBusProxy.makeProxyWrapper(ProviderIface);
+const ProviderIface = lookupInterfaceInfo('org.freedesktop.realmd.Provider');
+const Provider = makeProxyWrapper(ProviderIface);
 
-const ServiceIface = loadInterfaceXML('org.freedesktop.realmd.Service');
-const Service = Gio.DBusProxy.makeProxyWrapper(ServiceIface);
+const ServiceIface = lookupInterfaceInfo('org.freedesktop.realmd.Service');
+const Service = makeProxyWrapper(ServiceIface);
 
-const RealmIface = loadInterfaceXML('org.freedesktop.realmd.Realm');
-const Realm = Gio.DBusProxy.makeProxyWrapper(RealmIface);
+const RealmIface = lookupInterfaceInfo('org.freedesktop.realmd.Realm');
+const Realm = makeProxyWrapper(RealmIface);
 
 export class Manager extends Signals.EventEmitter {
     constructor() {
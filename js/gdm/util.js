@@ -10,14 +10,14 @@ import * as Batch from './batch.js';
 import * as OVirt from './oVirt.js';
 import * as Vmware from './vmware.js';
 import * as Main from '../ui/main.js';
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 import * as Params from '../misc/params.js';
 import * as SmartcardManager from '../misc/smartcardManager.js';
 
-const FprintManagerIface = loadInterfaceXML('net.reactivated.Fprint.Manager');
-const FprintManagerProxy = Gio.DBusProxy.makeProxyWrapper(FprintManagerIface);
-const FprintDeviceIface = loadInterfaceXML('net.reactivated.Fprint.Device');
-const FprintDeviceProxy = Gio.DBusProxy.makeProxyWrapper(FprintDeviceIface);
+const FprintManagerIface = lookupInterfaceInfo('net.reactivated.Fprint.Manager');
+const FprintManagerProxy = makeProxyWrapper(FprintManagerIface);
+const FprintDeviceIface = lookupInterfaceInfo('net.reactivated.Fprint.Device');
+const FprintDeviceProxy = makeProxyWrapper(FprintDeviceIface);
 
 Gio._promisify(Gdm.Client.prototype, 'open_reauthentication_channel');
 Gio._promisify(Gdm.Client.prototype, 'get_user_verifier');
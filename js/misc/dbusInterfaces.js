@@ -0,0 +1,67 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+import Shell from 'gi://Shell';
+
+// The descriptions of the interfaces in data/dbus-interfaces are
+// compiled when gnome-shell is built, so unlike loadInterfaceXML()
+// these don't parse any XML. Services running outside of the shell
+// can't use them and keep using dbusUtils.js.
+
+Gio._promisify(Gio.DBusProxy.prototype, 'init_async');
+
+/**
+ * @param {string} iface the interface name
+ * @returns {Gio.DBusInterfaceInfo} the shared interface info
+ */
+export function lookupInterfaceInfo(iface) {
+    const info = Shell.util_lookup_dbus_interface_info(iface);
+    if (!info)
+        throw new Error(`Unknown D-Bus interface ${iface}`);
+    return info;
+}
+
+/**
+ * Like Gio.DBusProxy.makeProxyWrapper(), but for an interface info
+ * rather than its XML description
+ *
+ * @param {Gio.DBusInterfaceInfo} info the interface info
+ * @returns {Function} the proxy constructor
+ */
+export function makeProxyWrapper(info) {
+    const newProxy = (bus, name, object, flags) => new Gio.DBusProxy({
+        g_connection: bus,
+        g_interface_name: info.name,
+        g_interface_info: info,
+        g_name: name,
+        g_flags: flags,
+        g_object_path: object,
+    });
+
+    // Called with new, like the wrappers of GJS
+    function wrapper(bus, name, object, asyncCallback, cancellable,
+        flags = Gio.DBusProxyFlags.NONE) {
+        const proxy = newProxy(bus, name, object, flags);
+
+        if (asyncCallback) {
+            // Errors thrown by the callback itself are not reported to it
+            proxy.init_async(GLib.PRIORITY_DEFAULT, cancellable ?? null).then(
+                () => asyncCallback(proxy, null),
+                e => asyncCallback(null, e));
+        } else {
+            proxy.init(cancellable ?? null);
+        }
+
+        return proxy;
+    }
+
+    wrapper.newAsync = async (bus, name, object, cancellable,
+        flags = Gio.DBusProxyFlags.NONE) => {
+        const proxy = newProxy(bus, name, object, flags);
+        await proxy.init_async(GLib.PRIORITY_DEFAULT, cancellable ?? null);
+        return proxy;
+    };
+
+    return wrapper;
+}
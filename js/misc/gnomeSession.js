@@ -2,9 +2,9 @@
 
 import Gio from 'gi://Gio';
 
-import {loadInterfaceXML} from './fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from './dbusInterfaces.js';
 
-const PresenceIface = loadInterfaceXML('org.gnome.SessionManager.Presence');
+const PresenceIface = lookupInterfaceInfo('org.gnome.SessionManager.Presence');
 
 /** @enum {number} */
 export const PresenceStatus = {
@@ -14,7 +14,7 @@ export const PresenceStatus = {
     IDLE: 3,
 };
 
-const PresenceProxy = Gio.DBusProxy.makeProxyWrapper(PresenceIface);
+const PresenceProxy = makeProxyWrapper(PresenceIface);
 
 /**
  * @param {Function} initCallback
@@ -31,8 +31,8 @@ export function Presence(initCallback, cancellable) {
 // Note inhibitors are immutable objects, so they don't
 // change at runtime (changes always come in the form
 // of new inhibitors)
-const InhibitorIface = loadInterfaceXML('org.gnome.SessionManager.Inhibitor');
-const InhibitorProxy = Gio.DBusProxy.makeProxyWrapper(InhibitorIface);
+const InhibitorIface = lookupInterfaceInfo('org.gnome.SessionManager.Inhibitor');
+const InhibitorProxy = makeProxyWrapper(InhibitorIface);
 
 /**
  * @param {string} objectPath
@@ -45,8 +45,8 @@ export function Inhibitor(objectPath, initCallback, cancellable) {
 }
 
 // Not the full interface, only the methods we use
-const SessionManagerIface = loadInterfaceXML('org.gnome.SessionManager');
-const SessionManagerProxy = Gio.DBusProxy.makeProxyWrapper(SessionManagerIface);
+const SessionManagerIface = lookupInterfaceInfo('org.gnome.SessionManager');
+const SessionManagerProxy = makeProxyWrapper(SessionManagerIface);
 
 /**
  * @param {Function} initCallback
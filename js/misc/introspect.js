@@ -11,10 +11,10 @@ const APP_ALLOWLIST = [
 
 const INTROSPECT_DBUS_API_VERSION = 3;
 
-import {loadInterfaceXML} from './fileUtils.js';
+import {lookupInterfaceInfo} from './dbusInterfaces.js';
 import {DBusSenderChecker} from './util.js';
 
-const IntrospectDBusIface = loadInterfaceXML('org.gnome.Shell.Introspect');
+const IntrospectDBusIface = lookupInterfaceInfo('org.gnome.Shell.Introspect');
 
 export class IntrospectService {
     constructor() {
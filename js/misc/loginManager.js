@@ -4,15 +4,15 @@ import GLib from 'gi://GLib';
 import Gio from 'gi://Gio';
 import * as Signals from './signals.js';
 
-import {loadInterfaceXML} from './fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from './dbusInterfaces.js';
 
-const SystemdLoginManagerIface = loadInterfaceXML('org.freedesktop.login1.Manager');
-const SystemdLoginSessionIface = loadInterfaceXML('org.freedesktop.login1.Session');
-const SystemdLoginUserIface = loadInterfaceXML('org.freedesktop.login1.User');
+const SystemdLoginManagerIface = lookupInterfaceInfo('org.freedesktop.login1.Manager');
+const SystemdLoginSessionIface = lookupInterfaceInfo('org.freedesktop.login1.Session');
+const SystemdLoginUserIface = lookupInterfaceInfo('org.freedesktop.login1.User');
 
-const SystemdLoginManager = Gio.DBusProxy.makeProxyWrapper(SystemdLoginManagerIface);
-const SystemdLoginSession = Gio.DBusProxy.makeProxyWrapper(SystemdLoginSessionIface);
-const SystemdLoginUser = Gio.DBusProxy.makeProxyWrapper(SystemdLoginUserIface);
+const SystemdLoginManager = makeProxyWrapper(SystemdLoginManagerIface);
+const SystemdLoginSession = makeProxyWrapper(SystemdLoginSessionIface);
+const SystemdLoginUser = makeProxyWrapper(SystemdLoginUserIface);
 
 function haveSystemd() {
     return GLib.access('/run/systemd/seats', 0) >= 0;
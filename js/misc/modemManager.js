@@ -5,7 +5,7 @@ import GObject from 'gi://GObject';
 import NM from 'gi://NM';
 import NMA4 from 'gi://NMA4';
 
-import {loadInterfaceXML} from './fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from './dbusInterfaces.js';
 
 let _mpd;
 
@@ -98,11 +98,11 @@ function _findProviderForSid(sid) {
 // The following are not the complete interfaces, just the methods we need
 // (or may need in the future)
 
-const ModemGsmNetworkInterface = loadInterfaceXML('org.freedesktop.ModemManager.Modem.Gsm.Network');
-const ModemGsmNetworkProxy = Gio.DBusProxy.makeProxyWrapper(ModemGsmNetworkInterface);
+const ModemGsmNetworkInterface = lookupInterfaceInfo('org.freedesktop.ModemManager.Modem.Gsm.Network');
+const ModemGsmNetworkProxy = makeProxyWrapper(ModemGsmNetworkInterface);
 
-const ModemCdmaInterface = loadInterfaceXML('org.freedesktop.ModemManager.Modem.Cdma');
-const ModemCdmaProxy = Gio.DBusProxy.makeProxyWrapper(ModemCdmaInterface);
+const ModemCdmaInterface = lookupInterfaceInfo('org.freedesktop.ModemManager.Modem.Cdma');
+const ModemCdmaProxy = makeProxyWrapper(ModemCdmaInterface);
 
 const ModemBase = GObject.registerClass({
     GTypeFlags: GObject.TypeFlags.ABSTRACT,
@@ -224,14 +224,14 @@ class ModemCdma extends ModemBase {
 // Support for the new ModemManager1 interface (MM >= 0.7) //
 // ------------------------------------------------------- //
 
-const BroadbandModemInterface = loadInterfaceXML('org.freedesktop.ModemManager1.Modem');
-const BroadbandModemProxy = Gio.DBusProxy.makeProxyWrapper(BroadbandModemInterface);
+const BroadbandModemInterface = lookupInterfaceInfo('org.freedesktop.ModemManager1.Modem');
+const BroadbandModemProxy = makeProxyWrapper(BroadbandModemInterface);
 
-const BroadbandModem3gppInterface = loadInterfaceXML('org.freedesktop.ModemManager1.Modem.Modem3gpp');
-const BroadbandModem3gppProxy = Gio.DBusProxy.makeProxyWrapper(BroadbandModem3gppInterface);
+const BroadbandModem3gppInterface = lookupInterfaceInfo('org.freedesktop.ModemManager1.Modem.Modem3gpp');
+const BroadbandModem3gppProxy = makeProxyWrapper(BroadbandModem3gppInterface);
 
-const BroadbandModemCdmaInterface = loadInterfaceXML('org.freedesktop.ModemManager1.Modem.ModemCdma');
-const BroadbandModemCdmaProxy = Gio.DBusProxy.makeProxyWrapper(BroadbandModemCdmaInterface);
+const BroadbandModemCdmaInterface = lookupInterfaceInfo('org.freedesktop.ModemManager1.Modem.ModemCdma');
+const BroadbandModemCdmaProxy = makeProxyWrapper(BroadbandModemCdmaInterface);
 
 export const BroadbandModem = GObject.registerClass({
     Properties: {
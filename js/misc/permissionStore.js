@@ -2,10 +2,10 @@
 
 import Gio from 'gi://Gio';
 
-import {loadInterfaceXML} from './fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from './dbusInterfaces.js';
 
-const PermissionStoreIface = loadInterfaceXML('org.freedesktop.impl.portal.PermissionStore');
-const PermissionStoreProxy = Gio.DBusProxy.makeProxyWrapper(PermissionStoreIface);
+const PermissionStoreIface = lookupInterfaceInfo('org.freedesktop.impl.portal.PermissionStore');
+const PermissionStoreProxy = makeProxyWrapper(PermissionStoreIface);
 
 /**
  * @param {Function} initCallback
@@ -0,0 +1,78 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+// Upper bounds (in ms) of the latency histogram buckets
+const LATENCY_BUCKETS = [25, 50, 100, 250, 500, 1000, 2500, Infinity];
+
+// Number of consecutive searches over budget before a provider is demoted,
+// and within budget before it is promoted again
+const DEMOTE_THRESHOLD = 3;
+const PROMOTE_THRESHOLD = 3;
+
+/**
+ * Per-provider search latency statistics, used to demote providers
+ * that repeatedly fail to answer within the latency budget
+ */
+export class ProviderSearchStats {
+    /**
+     * @param {number} budget - the latency budget of a search, in ms
+     */
+    constructor(budget) {
+        this.budget = budget;
+        this.histogram = LATENCY_BUCKETS.map(() => 0);
+        this.searches = 0;
+        this.overBudget = 0;
+        this.maxLatency = 0;
+        this.demoted = false;
+
+        this._consecutiveOver = 0;
+        this._consecutiveWithin = 0;
+    }
+
+    /**
+     * Records the latency of one search
+     *
+     * @param {number} latency - the time the provider took to answer, in ms
+     * @returns {boolean} - whether the demotion state changed
+     */
+    record(latency) {
+        const bucket = LATENCY_BUCKETS.findIndex(limit => latency <= limit);
+        this.histogram[bucket]++;
+        this.searches++;
+        this.maxLatency = Math.max(this.maxLatency, latency);
+
+        if (latency > this.budget) {
+            this.overBudget++;
+            this._consecutiveOver++;
+            this._consecutiveWithin = 0;
+        } else {
+            this._consecutiveWithin++;
+            this._consecutiveOver = 0;
+        }
+
+        const wasDemoted = this.demoted;
+        if (this._consecutiveOver >= DEMOTE_THRESHOLD)
+            this.demoted = true;
+        else if (this._consecutiveWithin >= PROMOTE_THRESHOLD)
+            this.demoted = false;
+
+        return wasDemoted !== this.demoted;
+    }
+
+    /**
+     * @returns {object} - a plain summary suitable for inspection
+     */
+    toJSON() {
+        const histogram = {};
+        LATENCY_BUCKETS.forEach((limit, i) => {
+            histogram[limit === Infinity ? 'slower' : `<=${limit}ms`] = this.histogram[i];
+        });
+
+        return {
+            searches: this.searches,
+            overBudget: this.overBudget,
+            maxLatency: this.maxLatency,
+            demoted: this.demoted,
+            histogram,
+        };
+    }
+}
@@ -9,33 +9,6 @@ import GnomeDesktop from 'gi://GnomeDesktop';
 import * as Main from '../ui/main.js';
 import {formatTime} from './dateUtils.js';
 
-// http://daringfireball.net/2010/07/improved_regex_for_matching_urls
-const _balancedParens = '\\([^\\s()<>]+\\)';
-const _leadingJunk = '[\\s`(\\[{\'\\"<\u00AB\u201C\u2018]';
-const _notTrailingJunk = '[^\\s`!()\\[\\]{};:\'\\".,<>?\u00AB\u00BB\u200E\u200F\u201C\u201D\u2018\u2019\u202A\u202C]';
-
-const _urlRegexp = new RegExp(
-    `(^|${_leadingJunk})` +
-    '(' +
-        '(?:' +
-            '(?:http|https|ftp)://' +             // scheme://
-            '|' +
-            'www\\d{0,3}[.]' +                    // www.
-            '|' +
-            '[a-z0-9.\\-]+[.][a-z]{2,4}/' +       // foo.xx/
-        ')' +
-        '(?:' +                                   // one or more:
-            '[^\\s()<>]+' +                       // run of non-space non-()
-            '|' +                                 // or
-            `${_balancedParens}` +                // balanced parens
-        ')+' +
-        '(?:' +                                   // end with:
-            `${_balancedParens}` +                // balanced parens
-            '|' +                                 // or
-            `${_notTrailingJunk}` +               // last non-junk char
-        ')' +
-    ')', 'gi');
-
 let _desktopSettings = null;
 
 /**
@@ -50,10 +23,8 @@ let _desktopSettings = null;
  * @returns {{url: string, pos: number}[]} the list of match objects, as described above
  */
 export function findUrls(str) {
-    let res = [], match;
-    while ((match = _urlRegexp.exec(str)))
-        res.push({url: match[2], pos: match.index + match[1].length});
-    return res;
+    const [urls, positions] = Shell.util_find_urls(str);
+    return urls.map((url, i) => ({url, pos: positions[i]}));
 }
 
 /**
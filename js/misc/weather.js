@@ -9,11 +9,11 @@ import * as Signals from './signals.js';
 
 import * as PermissionStore from './permissionStore.js';
 
-import {loadInterfaceXML} from './fileUtils.js';
+import {lookupInterfaceInfo} from './dbusInterfaces.js';
 
 Gio._promisify(Geoclue.Simple, 'new');
 
-const WeatherIntegrationIface = loadInterfaceXML('org.gnome.Shell.WeatherIntegration');
+const WeatherIntegrationIface = lookupInterfaceInfo('org.gnome.Shell.WeatherIntegration');
 
 const WEATHER_BUS_NAME = 'org.gnome.Weather';
 const WEATHER_OBJECT_PATH = '/org/gnome/Weather';
@@ -151,12 +151,11 @@ export class WeatherClient extends Signals.EventEmitter {
     }
 
     async _createWeatherProxy() {
-        const nodeInfo = Gio.DBusNodeInfo.new_for_xml(WeatherIntegrationIface);
         try {
             this._weatherProxy = await Gio.DBusProxy.new(
                 Gio.DBus.session,
                 Gio.DBusProxyFlags.DO_NOT_AUTO_START | Gio.DBusProxyFlags.GET_INVALIDATED_PROPERTIES,
-                nodeInfo.lookup_interface(WEATHER_INTEGRATION_IFACE),
+                WeatherIntegrationIface,
                 WEATHER_BUS_NAME,
                 WEATHER_OBJECT_PATH,
                 WEATHER_INTEGRATION_IFACE,
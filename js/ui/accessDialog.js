@@ -10,10 +10,10 @@ import * as CheckBox from './checkBox.js';
 import * as Dialog from './dialog.js';
 import * as ModalDialog from './modalDialog.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../misc/dbusInterfaces.js';
 
-const RequestIface = loadInterfaceXML('org.freedesktop.impl.portal.Request');
-const AccessIface = loadInterfaceXML('org.freedesktop.impl.portal.Access');
+const RequestIface = lookupInterfaceInfo('org.freedesktop.impl.portal.Request');
+const AccessIface = lookupInterfaceInfo('org.freedesktop.impl.portal.Access');
 
 /** @enum {number} */
 const DialogResponse = {
@@ -617,6 +617,17 @@ var BaseAppView = GObject.registerClass({
         this._appGridLayout = scrollContainer.layoutManager;
         scrollContainer._delegate = this;
 
+        // Drag monitors check whether drags are over the page indicators,
+        // and picks find the arrows above them
+        [
+            scrollContainer,
+            this._grid,
+            this._prevPageIndicator,
+            this._nextPageIndicator,
+            this._prevPageArrow,
+            this._nextPageArrow,
+        ].forEach(actor => DND.addDropTarget(actor));
+
         this._box = new St.BoxLayout({
             vertical: true,
             x_expand: true,
@@ -1897,6 +1908,7 @@ class AppViewItem extends St.Button {
         });
 
         this._delegate = this;
+        DND.addDropTarget(this);
 
         if (isDraggable) {
             this._draggable = DND.makeDraggable(this, {timeoutThreshold: 200});
@@ -2524,6 +2536,7 @@ export const AppFolderDialog = GObject.registerClass({
         this._view = source.view;
         this._appDisplay = appDisplay;
         this._delegate = this;
+        DND.addDropTarget(this);
 
         this._isOpen = false;
 
@@ -10,7 +10,7 @@ import * as Dialog from './dialog.js';
 import * as ModalDialog from './modalDialog.js';
 
 import * as Main from './main.js';
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../misc/dbusInterfaces.js';
 
 const AudioDevice = {
     HEADPHONES: 1 << 0,
@@ -18,7 +18,7 @@ const AudioDevice = {
     MICROPHONE: 1 << 2,
 };
 
-const AudioDeviceSelectionIface = loadInterfaceXML('org.gnome.Shell.AudioDeviceSelection');
+const AudioDeviceSelectionIface = lookupInterfaceInfo('org.gnome.Shell.AudioDeviceSelection');
 
 const AudioDeviceSelectionDialog = GObject.registerClass({
     Signals: {'device-selected': {param_types: [GObject.TYPE_UINT]}},
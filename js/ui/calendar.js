@@ -15,7 +15,7 @@ import * as PopupMenu from './popupMenu.js';
 import {ensureActorVisibleInScrollView} from '../misc/animationUtils.js';
 
 import {formatDateWithCFormatString, formatTimeSpan} from '../misc/dateUtils.js';
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../misc/dbusInterfaces.js';
 
 const SHOW_WEEKDATE_KEY = 'show-weekdate';
 
@@ -165,9 +165,7 @@ class EmptyEventSource extends EventSourceBase {
     }
 });
 
-const CalendarServerIface = loadInterfaceXML('org.gnome.Shell.CalendarServer');
-
-const CalendarServerInfo  = Gio.DBusInterfaceInfo.new_for_xml(CalendarServerIface);
+const CalendarServerInfo = lookupInterfaceInfo('org.gnome.Shell.CalendarServer');
 
 function CalendarServer() {
     return new Gio.DBusProxy({
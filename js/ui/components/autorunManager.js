@@ -11,7 +11,7 @@ import * as MessageTray from '../messageTray.js';
 
 Gio._promisify(Gio.Mount.prototype, 'guess_content_type');
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 // GSettings keys
 const SETTINGS_SCHEMA = 'org.gnome.desktop.media-handling';
@@ -77,8 +77,8 @@ function startAppForMount(app, mount) {
     return retval;
 }
 
-const HotplugSnifferIface = loadInterfaceXML('org.gnome.Shell.HotplugSniffer');
-const HotplugSnifferProxy = Gio.DBusProxy.makeProxyWrapper(HotplugSnifferIface);
+const HotplugSnifferIface = lookupInterfaceInfo('org.gnome.Shell.HotplugSniffer');
+const HotplugSnifferProxy = makeProxyWrapper(HotplugSnifferIface);
 function HotplugSniffer() {
     return new HotplugSnifferProxy(Gio.DBus.session,
         'org.gnome.Shell.HotplugSniffer',
@@ -16,7 +16,7 @@ import * as Calendar from './calendar.js';
 import * as Weather from '../misc/weather.js';
 
 import {formatDateWithCFormatString, formatTime, clearCachedLocalTimeZone} from '../misc/dateUtils.js';
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 
 const NC_ = (context, str) => `${context}\u0004${str}`;
 const T_ = Shell.util_translate_time_string;
@@ -24,8 +24,8 @@ const T_ = Shell.util_translate_time_string;
 const MAX_FORECASTS = 5;
 const EN_CHAR = '\u2013';
 
-const ClocksIntegrationIface = loadInterfaceXML('org.gnome.Shell.ClocksIntegration');
-const ClocksProxy = Gio.DBusProxy.makeProxyWrapper(ClocksIntegrationIface);
+const ClocksIntegrationIface = lookupInterfaceInfo('org.gnome.Shell.ClocksIntegration');
+const ClocksProxy = makeProxyWrapper(ClocksIntegrationIface);
 
 /**
  * @private
@@ -6,6 +6,7 @@ import Meta from 'gi://Meta';
 import Shell from 'gi://Shell';
 import St from 'gi://St';
 import * as Signals from '../misc/signals.js';
+import * as Util from '../misc/util.js';
 
 import * as Main from './main.js';
 import * as Params from '../misc/params.js';
@@ -16,6 +17,35 @@ const SCALE_ANIMATION_TIME = 250;
 const SNAP_BACK_ANIMATION_TIME = 250;
 // Time to animate to original position on success
 const REVERT_ANIMATION_TIME = 750;
+// Size of the stage cells drop targets are indexed by
+const DROP_TARGET_CELL_SIZE = 64;
+
+// Properties affecting where an actor and its descendants are on the stage
+const DROP_TARGET_GEOMETRY_SIGNALS = [
+    'notify::allocation',
+    'notify::mapped',
+    'notify::translation-x',
+    'notify::translation-y',
+    'notify::translation-z',
+    'notify::z-position',
+    'notify::scale-x',
+    'notify::scale-y',
+    'notify::rotation-angle-x',
+    'notify::rotation-angle-y',
+    'notify::rotation-angle-z',
+    'notify::pivot-point',
+    'notify::transform',
+    'notify::child-transform',
+    'notify::clip-to-allocation',
+];
+
+// Changes to where an actor is in the actor tree, and to the children
+// painted with it
+const DROP_TARGET_HIERARCHY_SIGNALS = [
+    'parent-set',
+    'child-added',
+    'child-removed',
+];
 
 /** @enum {number} */
 export const DragMotionResult = {
@@ -47,6 +77,7 @@ export const dragMonitors = [];
 
 let eventHandlerActor = null;
 let currentDraggable = null;
+let dropTargetIndex = null;
 
 function _getEventHandlerActor() {
     if (!eventHandlerActor) {
@@ -94,6 +125,406 @@ export function removeDragMonitor(monitor) {
     }
 }
 
+function _getBoxIntersection(box, other) {
+    return {
+        x1: Math.max(box.x1, other.x1),
+        y1: Math.max(box.y1, other.y1),
+        x2: Math.min(box.x2, other.x2),
+        y2: Math.min(box.y2, other.y2),
+    };
+}
+
+// Whether an actor is painted as the box it is indexed by, rather than
+// rotated or skewed within it
+function _isAxisAligned(actor) {
+    const [topLeft, topRight, bottomLeft] = actor.get_abs_allocation_vertices();
+    return Math.abs(topLeft.y - topRight.y) < 0.5 &&
+        Math.abs(topLeft.x - bottomLeft.x) < 0.5;
+}
+
+function _getTransformedBox(actor) {
+    const {origin, size} = actor.get_transformed_extents();
+    return {
+        x1: origin.x,
+        y1: origin.y,
+        x2: origin.x + size.width,
+        y2: origin.y + size.height,
+    };
+}
+
+/**
+ * Keeps the transformed boxes of registered drop targets in a grid of
+ * stage cells, so that the target under the pointer can be found
+ * during a drag without picking the whole stage.
+ *
+ * A target is hit as a whole by its allocation, clipped by its
+ * ancestors, and targets painted above others are found first. Boxes
+ * are only recomputed once the allocation or the transformation of a
+ * target or of one of its ancestors changed.
+ *
+ * The other children of the ancestors of targets are indexed by their
+ * allocation as well, as picking would hit them. No target is found
+ * where one of them is topmost, so that the stage is picked instead.
+ * Descendants painted outside the allocation of such a child aren't
+ * accounted for. Targets that aren't painted axis-aligned, for example
+ * while rotated, are picked too.
+ */
+class DropTargetIndex {
+    constructor(stage) {
+        this._stage = stage;
+
+        // Entries of targets, indexed by their actor
+        this._targets = new Map();
+        // Entries of unregistered actors painted with targets,
+        // indexed by their actor
+        this._occluders = new Map();
+        // Signal handlers of indexed actors and of their ancestors
+        this._watchedActors = new Map();
+        this._ancestors = new Set();
+
+        // Entries of targets overlapping a cell, in paint order
+        this._cells = new Map();
+        this._nColumns = 0;
+
+        this._layoutChanged = true;
+        this._movedEntries = new Set();
+    }
+
+    add(actor) {
+        if (this._targets.has(actor))
+            return;
+
+        this._targets.set(actor, {
+            ...this._createEntry(actor),
+            destroyId: actor.connect('destroy', () => this.remove(actor)),
+        });
+        this._layoutChanged = true;
+    }
+
+    _createEntry(actor, occluder = false) {
+        return {
+            actor,
+            occluder,
+            exact: true,
+            rank: 0,
+            clip: null,
+            box: null,
+            cells: [],
+        };
+    }
+
+    remove(actor) {
+        const target = this._targets.get(actor);
+        if (!target)
+            return;
+
+        actor.disconnect(target.destroyId);
+        this._targets.delete(actor);
+        this._movedEntries.delete(target);
+        this._layoutChanged = true;
+    }
+
+    /**
+     * @param {number} x - stage X coordinate
+     * @param {number} y - stage Y coordinate
+     * @param {Clutter.Actor=} ignoredActor - actor not to find targets in
+     * @returns {Clutter.Actor} the topmost target at @x, @y, or %null
+     *   if there is none, an unregistered actor is painted above it or
+     *   it isn't painted as its box
+     */
+    lookup(x, y, ignoredActor = null) {
+        this._update();
+
+        const cell = this._cells.get(this._getCellKey(
+            Math.floor(x / DROP_TARGET_CELL_SIZE),
+            Math.floor(y / DROP_TARGET_CELL_SIZE)));
+        if (!cell)
+            return null;
+
+        for (let i = cell.length - 1; i >= 0; i--) {
+            const {actor, occluder, exact, box} = cell[i];
+
+            if (x < box.x1 || x >= box.x2 || y < box.y1 || y >= box.y2)
+                continue;
+
+            if (ignoredActor?.contains(actor))
+                continue;
+
+            return occluder || !exact ? null : actor;
+        }
+
+        return null;
+    }
+
+    _getCellKey(column, row) {
+        if (column < 0 || column >= this._nColumns || row < 0)
+            return -1;
+        return row * this._nColumns + column;
+    }
+
+    _onGeometryChanged(actor) {
+        if (this._ancestors.has(actor))
+            this._layoutChanged = true;
+        else if (this._targets.has(actor))
+            this._movedEntries.add(this._targets.get(actor));
+        else if (this._occluders.has(actor))
+            this._movedEntries.add(this._occluders.get(actor));
+    }
+
+    _onHierarchyChanged(actor, signal) {
+        // Children of indexed actors are hit with their parent
+        if (signal === 'parent-set' || this._ancestors.has(actor))
+            this._layoutChanged = true;
+    }
+
+    _watch(actor) {
+        const ids = [
+            ...DROP_TARGET_GEOMETRY_SIGNALS.map(signal =>
+                actor.connect(signal, () => this._onGeometryChanged(actor))),
+            ...DROP_TARGET_HIERARCHY_SIGNALS.map(signal =>
+                actor.connect(signal, () => this._onHierarchyChanged(actor, signal))),
+        ];
+        ids.push(actor.connect('destroy', () => {
+            this._unwatch(actor, false);
+            this._layoutChanged = true;
+        }));
+
+        // Scrolling moves the children of scrolled actors without
+        // changing their allocation
+        const adjustments = [];
+        if (actor instanceof St.Scrollable &&
+            actor.get_parent() instanceof St.ScrollView) {
+            for (const adjustment of [actor.hadjustment, actor.vadjustment]) {
+                adjustments.push([adjustment, adjustment.connect('notify::value',
+                    () => this._onGeometryChanged(actor))]);
+            }
+        }
+
+        this._watchedActors.set(actor, {ids, adjustments});
+    }
+
+    _unwatch(actor, disconnectActor = true) {
+        const {ids, adjustments} = this._watchedActors.get(actor);
+
+        if (disconnectActor)
+            ids.forEach(id => actor.disconnect(id));
+        adjustments.forEach(([adjustment, id]) => adjustment.disconnect(id));
+        this._watchedActors.delete(actor);
+    }
+
+    _update() {
+        if (this._layoutChanged) {
+            this._rebuild();
+            return;
+        }
+
+        for (const entry of this._movedEntries) {
+            this._unplace(entry);
+            this._place(entry, true);
+        }
+        this._movedEntries.clear();
+    }
+
+    _rebuild() {
+        const childIndices = new Map();
+        const getChildIndex = child => {
+            const parent = child.get_parent();
+            if (!childIndices.has(parent)) {
+                const indices = new Map();
+                let i = 0;
+                for (let c = parent.get_first_child(); c; c = c.get_next_sibling())
+                    indices.set(c, i++);
+                childIndices.set(parent, indices);
+            }
+            return childIndices.get(parent).get(child);
+        };
+
+        const clipBoxes = new Map();
+        const getClipBox = actor => {
+            if (!clipBoxes.has(actor))
+                clipBoxes.set(actor, _getTransformedBox(actor));
+            return clipBoxes.get(actor);
+        };
+
+        const stageBox = {
+            x1: 0,
+            y1: 0,
+            x2: this._stage.width,
+            y2: this._stage.height,
+        };
+
+        this._ancestors.clear();
+        this._occluders.clear();
+
+        const paths = new Map();
+        const onStage = [];
+        const addEntry = entry => {
+            const path = [];
+            let clip = stageBox;
+            let actor = entry.actor;
+
+            entry.clip = null;
+            entry.box = null;
+            entry.cells = [];
+
+            for (; actor.get_parent(); actor = actor.get_parent()) {
+                path.push(getChildIndex(actor));
+
+                const parent = actor.get_parent();
+                this._ancestors.add(parent);
+                if (parent.clip_to_allocation)
+                    clip = _getBoxIntersection(clip, getClipBox(parent));
+            }
+
+            if (actor !== this._stage)
+                return;
+
+            entry.clip = clip;
+            paths.set(entry, path.reverse());
+            onStage.push(entry);
+        };
+
+        this._targets.forEach(addEntry);
+
+        // Any other actor painted with targets may hide them
+        for (const ancestor of [...this._ancestors]) {
+            for (let child = ancestor.get_first_child(); child; child = child.get_next_sibling()) {
+                if (this._targets.has(child) || this._ancestors.has(child))
+                    continue;
+
+                const occluder = this._createEntry(child, true);
+                this._occluders.set(child, occluder);
+                addEntry(occluder);
+            }
+        }
+
+        // Children are painted above their parent, and above their
+        // previous siblings
+        onStage.sort((a, b) => {
+            const pathA = paths.get(a);
+            const pathB = paths.get(b);
+            const length = Math.min(pathA.length, pathB.length);
+
+            for (let i = 0; i < length; i++) {
+                if (pathA[i] !== pathB[i])
+                    return pathA[i] - pathB[i];
+            }
+            return pathA.length - pathB.length;
+        });
+
+        this._cells.clear();
+        this._nColumns = Math.ceil(stageBox.x2 / DROP_TARGET_CELL_SIZE);
+        onStage.forEach((target, i) => {
+            target.rank = i;
+            this._place(target, false);
+        });
+
+        const indexedActors = new Set([
+            ...this._targets.keys(),
+            ...this._occluders.keys(),
+            ...this._ancestors,
+        ]);
+        for (const actor of [...this._watchedActors.keys()]) {
+            if (!indexedActors.has(actor))
+                this._unwatch(actor);
+        }
+        for (const actor of indexedActors) {
+            if (!this._watchedActors.has(actor))
+                this._watch(actor);
+        }
+
+        this._layoutChanged = false;
+        this._movedEntries.clear();
+    }
+
+    _place(entry, sorted) {
+        if (!entry.clip || !entry.actor.mapped)
+            return;
+
+        const box = _getBoxIntersection(
+            _getTransformedBox(entry.actor), entry.clip);
+        if (box.x1 >= box.x2 || box.y1 >= box.y2)
+            return;
+
+        entry.box = box;
+        entry.exact = _isAxisAligned(entry.actor);
+
+        const lastColumn = Math.ceil(box.x2 / DROP_TARGET_CELL_SIZE) - 1;
+        const lastRow = Math.ceil(box.y2 / DROP_TARGET_CELL_SIZE) - 1;
+        for (let row = Math.floor(box.y1 / DROP_TARGET_CELL_SIZE); row <= lastRow; row++) {
+            for (let column = Math.floor(box.x1 / DROP_TARGET_CELL_SIZE); column <= lastColumn; column++) {
+                const key = this._getCellKey(column, row);
+                if (key < 0)
+                    continue;
+
+                let cell = this._cells.get(key);
+                if (!cell) {
+                    cell = [];
+                    this._cells.set(key, cell);
+                }
+
+                // Entries are placed in paint order when rebuilding,
+                // moved ones need to find their position
+                if (sorted)
+                    Util.insertSorted(cell, entry, (a, b) => a.rank - b.rank);
+                else
+                    cell.push(entry);
+
+                entry.cells.push(key);
+            }
+        }
+    }
+
+    _unplace(entry) {
+        for (const key of entry.cells) {
+            const cell = this._cells.get(key);
+            cell.splice(cell.indexOf(entry), 1);
+            if (cell.length === 0)
+                this._cells.delete(key);
+        }
+        entry.cells = [];
+        entry.box = null;
+    }
+}
+
+function _getDropTargetIndex() {
+    if (!dropTargetIndex)
+        dropTargetIndex = new DropTargetIndex(global.stage);
+    return dropTargetIndex;
+}
+
+/**
+ * Registers a drop target, so that drags over it find it without
+ * picking the stage. The target is hit as a whole: drags over its
+ * children resolve to it, so children that need to be the target
+ * actor of drag monitors or have a delegate handling drags must be
+ * registered as well.
+ *
+ * @param {Clutter.Actor} actor
+ */
+export function addDropTarget(actor) {
+    _getDropTargetIndex().add(actor);
+}
+
+/**
+ * @param {Clutter.Actor} actor
+ */
+export function removeDropTarget(actor) {
+    _getDropTargetIndex().remove(actor);
+}
+
+/**
+ * Finds the registered drop target drags at a stage position go to.
+ *
+ * @param {number} x - stage X coordinate
+ * @param {number} y - stage Y coordinate
+ * @param {Clutter.Actor=} ignoredActor - actor not to find targets in
+ * @returns {Clutter.Actor} the topmost drop target, or %null
+ */
+export function findDropTarget(x, y, ignoredActor = null) {
+    return _getDropTargetIndex().lookup(x, y, ignoredActor);
+}
+
 class _Draggable extends Signals.EventEmitter {
     constructor(actor, params) {
         super();
@@ -570,6 +1001,11 @@ class _Draggable extends Signals.EventEmitter {
     }
 
     _pickTargetActor() {
+        // The drag actor is hidden from picks, so targets in it are ignored
+        const target = findDropTarget(this._dragX, this._dragY, this._dragActor);
+        if (target)
+            return target;
+
         return this._dragActor.get_stage().get_actor_at_pos(
             Clutter.PickMode.ALL, this._dragX, this._dragY);
     }
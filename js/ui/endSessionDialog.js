@@ -34,13 +34,13 @@ import * as LoginManager from '../misc/loginManager.js';
 import * as ModalDialog from './modalDialog.js';
 import * as UserWidget from './userWidget.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 
 const _ITEM_ICON_SIZE = 64;
 
 const LOW_BATTERY_THRESHOLD = 30;
 
-const EndSessionDialogIface = loadInterfaceXML('org.gnome.SessionManager.EndSessionDialog');
+const EndSessionDialogIface = lookupInterfaceInfo('org.gnome.SessionManager.EndSessionDialog');
 
 const logoutDialogContent = {
     subjectWithUser: C_('title', 'Log Out %s'),
@@ -160,14 +160,14 @@ const DialogContent = {
 
 const MAX_USERS_IN_SESSION_DIALOG = 5;
 
-const LogindSessionIface = loadInterfaceXML('org.freedesktop.login1.Session');
-const LogindSession = Gio.DBusProxy.makeProxyWrapper(LogindSessionIface);
+const LogindSessionIface = lookupInterfaceInfo('org.freedesktop.login1.Session');
+const LogindSession = makeProxyWrapper(LogindSessionIface);
 
-const PkOfflineIface = loadInterfaceXML('org.freedesktop.PackageKit.Offline');
-const PkOfflineProxy = Gio.DBusProxy.makeProxyWrapper(PkOfflineIface);
+const PkOfflineIface = lookupInterfaceInfo('org.freedesktop.PackageKit.Offline');
+const PkOfflineProxy = makeProxyWrapper(PkOfflineIface);
 
-const UPowerIface = loadInterfaceXML('org.freedesktop.UPower.Device');
-const UPowerProxy = Gio.DBusProxy.makeProxyWrapper(UPowerIface);
+const UPowerIface = lookupInterfaceInfo('org.freedesktop.UPower.Device');
+const UPowerProxy = makeProxyWrapper(UPowerIface);
 
 function findAppFromInhibitor(inhibitor) {
     let desktopFile;
@@ -159,6 +159,15 @@ class KeyContainer extends St.Widget {
         }
     }
 
+    removeAllKeys() {
+        this.remove_all_children();
+
+        this._currentRow = null;
+        this._currentCol = 0;
+        this._maxCols = 0;
+        this._rows = [];
+    }
+
     getRatio() {
         return [this._maxCols, this._rows.length];
     }
@@ -306,6 +315,45 @@ const Key = GObject.registerClass({
         this.cancel();
     }
 
+    /**
+     * Relabels the key, so it can be recycled for a different key
+     * without recreating its actors. The extended keys popup is rebuilt
+     * lazily on the next long press.
+     *
+     * @param {object} params - the new key parameters, as for the constructor
+     * @param {string[]} extendedKeys - the new extended keys
+     */
+    relabel(params, extendedKeys = []) {
+        const {label, iconName, commitString, keyval} = {keyval: 0, ...params};
+
+        this.cancel();
+
+        if (this._boxPointer) {
+            this._boxPointer.destroy();
+            this._boxPointer = null;
+        }
+        this._extendedKeyboard = null;
+        this.keyButton._extendedKeys = null;
+
+        this._keyval = parseInt(keyval, 16);
+        this._extendedKeys = extendedKeys;
+        this.keyButton.commitString = commitString;
+        this.setWidth(1);
+        this.setLatched(false);
+
+        if (iconName) {
+            if (!this._icon) {
+                this._icon = new St.Icon();
+                this.keyButton.set_child(this._icon);
+            }
+            this._icon.icon_name = iconName;
+        } else {
+            this._icon = null;
+            this.keyButton.set_label(label ??
+                GLib.markup_escape_text(commitString ?? '', -1));
+        }
+    }
+
     _ensureExtendedKeysPopup() {
         if (this._extendedKeys.length === 0)
             return;
@@ -439,13 +487,14 @@ const Key = GObject.registerClass({
         }
 
         button.keyWidth = 1;
+        button.commitString = commitString;
         button.connect('button-press-event', () => {
-            this._press(button, commitString);
+            this._press(button, button.commitString);
             button.add_style_pseudo_class('active');
             return Clutter.EVENT_STOP;
         });
         button.connect('button-release-event', () => {
-            this._release(button, commitString);
+            this._release(button, button.commitString);
             button.remove_style_pseudo_class('active');
             return Clutter.EVENT_STOP;
         });
@@ -465,12 +514,12 @@ const Key = GObject.registerClass({
             if (!this._touchPressSlot &&
                 event.type() === Clutter.EventType.TOUCH_BEGIN) {
                 this._touchPressSlot = slot;
-                this._press(button, commitString);
+                this._press(button, button.commitString);
                 button.add_style_pseudo_class('active');
             } else if (event.type() === Clutter.EventType.TOUCH_END) {
                 if (!this._touchPressSlot ||
                     this._touchPressSlot === slot) {
-                    this._release(button, commitString);
+                    this._release(button, button.commitString);
                     button.remove_style_pseudo_class('active');
                 }
 
@@ -496,8 +545,9 @@ const Key = GObject.registerClass({
             this._extendedKeyboard.add(key);
 
             key.set_size(...this.keyButton.allocation.get_size());
-            this.keyButton.connect('notify::allocation',
-                () => key.set_size(...this.keyButton.allocation.get_size()));
+            this.keyButton.connectObject('notify::allocation',
+                () => key.set_size(...this.keyButton.allocation.get_size()),
+                key);
         }
         this._boxPointer.bin.add_actor(this._extendedKeyboard);
     }
@@ -518,37 +568,207 @@ const Key = GObject.registerClass({
     }
 });
 
+/**
+ * Base class for the tables compiled at build time by the data/gen-*.py
+ * scripts.
+ *
+ * Tables are read straight from the (memory-mapped) resource data,
+ * strings are only decoded when needed.
+ */
+class ResourceTable {
+    constructor(path, magic) {
+        const bytes = Gio.resources_lookup_data(path,
+            Gio.ResourceLookupFlags.NONE);
+
+        this._data = bytes.toArray();
+        this._view = new DataView(this._data.buffer,
+            this._data.byteOffset, this._data.byteLength);
+        this._decoder = new TextDecoder();
+        this._stringsOffset = 0;
+
+        const fileMagic = this._decoder.decode(this._data.subarray(0, 4));
+        if (fileMagic !== magic)
+            throw new Error(`Unexpected format of ${path}: ${fileMagic}`);
+    }
+
+    _getUint32(offset) {
+        return this._view.getUint32(offset, true);
+    }
+
+    _getInt32(offset) {
+        return this._view.getInt32(offset, true);
+    }
+
+    _getFloat32(offset) {
+        return this._view.getFloat32(offset, true);
+    }
+
+    _getString(offset) {
+        const start = this._stringsOffset + this._getUint32(offset);
+        const length = this._getUint32(offset + 4);
+        return this._decoder.decode(this._data.subarray(start, start + length));
+    }
+}
+
+/* See data/gen-emoji-table.py */
+class EmojiTable extends ResourceTable {
+    constructor() {
+        super('/org/gnome/shell/osk-layouts/emoji.bin', 'EMJ1');
+
+        this.nSections = this._getUint32(4);
+        const nKeys = this._getUint32(8);
+        this._stringsOffset = this._getUint32(16);
+
+        this._sectionsOffset = 20;
+        this._keysOffset = this._sectionsOffset + this.nSections * 8;
+        this._variantsOffset = this._keysOffset + nKeys * 16;
+    }
+
+    getSection(index) {
+        const offset = this._sectionsOffset + index * 8;
+        return {
+            firstKey: this._getUint32(offset),
+            nKeys: this._getUint32(offset + 4),
+        };
+    }
+
+    getKey(index) {
+        const offset = this._keysOffset + index * 16;
+        const firstVariant = this._getUint32(offset + 8);
+        const nVariants = this._getUint32(offset + 12);
+        const variants = [];
+
+        for (let i = 0; i < nVariants; i++)
+            variants.push(this._getString(this._variantsOffset + (firstVariant + i) * 8));
+
+        return {label: this._getString(offset), variants};
+    }
+}
+
+/* See data/gen-osk-layouts.py */
+class LayoutTable extends ResourceTable {
+    constructor() {
+        super('/org/gnome/shell/osk-layouts/osk-layouts.bin', 'OSK1');
+
+        this._nGroups = this._getUint32(4);
+        const nLevels = this._getUint32(8);
+        const nRowRefs = this._getUint32(12);
+        const nRows = this._getUint32(16);
+        const nKeyRefs = this._getUint32(20);
+        const nKeys = this._getUint32(24);
+        this._stringsOffset = this._getUint32(32);
+
+        this._groupsOffset = 36;
+        this._levelsOffset = this._groupsOffset + this._nGroups * 16;
+        this._rowRefsOffset = this._levelsOffset + nLevels * 16;
+        this._rowsOffset = this._rowRefsOffset + nRowRefs * 4;
+        this._keyRefsOffset = this._rowsOffset + nRows * 8;
+        this._keysOffset = this._keyRefsOffset + nKeyRefs * 4;
+        this._keyStringsOffset = this._keysOffset + nKeys * 48;
+    }
+
+    _getOptionalString(offset) {
+        return this._getUint32(offset + 4) > 0 ? this._getString(offset) : null;
+    }
+
+    lookupGroup(name) {
+        /* Groups are sorted by name */
+        let low = 0;
+        let high = this._nGroups - 1;
+
+        while (low <= high) {
+            const mid = Math.floor((low + high) / 2);
+            const midName = this._getString(this._groupsOffset + mid * 16);
+
+            if (midName === name)
+                return mid;
+            else if (midName < name)
+                low = mid + 1;
+            else
+                high = mid - 1;
+        }
+
+        return -1;
+    }
+
+    _getKey(index) {
+        const offset = this._keysOffset + index * 48;
+        const level = this._getInt32(offset + 32);
+        const width = this._getFloat32(offset + 36);
+        const firstString = this._getUint32(offset + 40);
+        const nStrings = this._getUint32(offset + 44);
+        const strings = [];
+
+        for (let i = 0; i < nStrings; i++)
+            strings.push(this._getString(this._keyStringsOffset + (firstString + i) * 8));
+
+        return {
+            action: this._getOptionalString(offset),
+            label: this._getOptionalString(offset + 8),
+            iconName: this._getOptionalString(offset + 16),
+            keyval: this._getOptionalString(offset + 24),
+            level: level >= 0 ? level : null,
+            width: width > 0 ? width : null,
+            strings,
+        };
+    }
+
+    _getRow(index) {
+        const offset = this._rowsOffset + index * 8;
+        const firstKeyRef = this._getUint32(offset);
+        const nKeys = this._getUint32(offset + 4);
+        const keys = [];
+
+        for (let i = 0; i < nKeys; i++)
+            keys.push(this._getKey(this._getUint32(this._keyRefsOffset + (firstKeyRef + i) * 4)));
+
+        return keys;
+    }
+
+    getLevels(group) {
+        const groupOffset = this._groupsOffset + group * 16;
+        const firstLevel = this._getUint32(groupOffset + 8);
+        const nLevels = this._getUint32(groupOffset + 12);
+        const levels = [];
+
+        for (let i = 0; i < nLevels; i++) {
+            const offset = this._levelsOffset + (firstLevel + i) * 16;
+            const firstRowRef = this._getUint32(offset + 8);
+            const nRows = this._getUint32(offset + 12);
+            const rows = [];
+
+            for (let j = 0; j < nRows; j++)
+                rows.push(this._getRow(this._getUint32(this._rowRefsOffset + (firstRowRef + j) * 4)));
+
+            levels.push({mode: this._getString(offset), rows});
+        }
+
+        return levels;
+    }
+}
+
+let layoutTable = null;
+
 class KeyboardModel {
     constructor(groupName) {
+        layoutTable ??= new LayoutTable();
+
         let names = [groupName];
         if (groupName.includes('+'))
             names.push(groupName.replace(/\+.*/, ''));
         names.push('us');
 
         for (let i = 0; i < names.length; i++) {
-            try {
-                this._model = this._loadModel(names[i]);
+            const group = layoutTable.lookupGroup(names[i]);
+            if (group >= 0) {
+                this._levels = layoutTable.getLevels(group);
                 break;
-            } catch (e) {
             }
         }
     }
 
-    _loadModel(groupName) {
-        const file = Gio.File.new_for_uri(
-            `resource:///org/gnome/shell/osk-layouts/${groupName}.json`);
-        let [success_, contents] = file.load_contents(null);
-
-        const decoder = new TextDecoder();
-        return JSON.parse(decoder.decode(contents));
-    }
-
     getLevels() {
-        return this._model.levels;
-    }
-
-    getKeysForLevel(levelName) {
-        return this._model.levels.find(level => level === levelName);
+        return this._levels;
     }
 }
 
@@ -665,7 +885,7 @@ const EmojiPager = GObject.registerClass({
         },
     },
 }, class EmojiPager extends St.Widget {
-    _init(sections) {
+    _init(sections, table) {
         super._init({
             layout_manager: new Clutter.BinLayout(),
             reactive: true,
@@ -673,6 +893,8 @@ const EmojiPager = GObject.registerClass({
             y_expand: true,
         });
         this._sections = sections;
+        this._table = table;
+        this._keyPool = [];
 
         this._pages = [];
         this._panel = null;
@@ -704,6 +926,9 @@ const EmojiPager = GObject.registerClass({
             this._swipeTracker.destroy();
             delete this._swipeTracker;
         }
+
+        this._keyPool.forEach(key => key.destroy());
+        this._keyPool = [];
     }
 
     get delta() {
@@ -721,7 +946,7 @@ const EmojiPager = GObject.registerClass({
 
         if (this._followingPage !== followingPage) {
             if (this._followingPanel) {
-                this._followingPanel.destroy();
+                this._releasePanel(this._followingPanel);
                 this._followingPanel = null;
             }
 
@@ -805,18 +1030,18 @@ const EmojiPager = GObject.registerClass({
         for (let i = 0; i < this._sections.length; i++) {
             let section = this._sections[i];
             let itemsPerPage = this._nCols * this._nRows;
-            let nPages = Math.ceil(section.keys.length / itemsPerPage);
-            let page = -1;
-            let pageKeys;
-
-            for (let j = 0; j < section.keys.length; j++) {
-                if (j % itemsPerPage === 0) {
-                    page++;
-                    pageKeys = [];
-                    this._pages.push({pageKeys, nPages, page, section: this._sections[i]});
-                }
+            let nPages = Math.ceil(section.nKeys / itemsPerPage);
+
+            for (let page = 0; page < nPages; page++) {
+                const first = page * itemsPerPage;
 
-                pageKeys.push(section.keys[j]);
+                this._pages.push({
+                    firstKey: section.firstKey + first,
+                    nKeys: Math.min(itemsPerPage, section.nKeys - first),
+                    nPages,
+                    page,
+                    section,
+                });
             }
         }
     }
@@ -855,21 +1080,9 @@ const EmojiPager = GObject.registerClass({
         let col = 0;
         let row = 0;
 
-        for (let i = 0; i < page.pageKeys.length; i++) {
-            let modelKey = page.pageKeys[i];
-            let key = new Key({commitString: modelKey.label}, modelKey.variants);
-
-            key.keyButton.set_button_mask(0);
-
-            key.connect('pressed', () => {
-                this._currentKey = key;
-            });
-            key.connect('commit', (actor, keyval, str) => {
-                if (this._currentKey !== key)
-                    return;
-                this._currentKey = null;
-                this.emit('emoji', str);
-            });
+        for (let i = 0; i < page.nKeys; i++) {
+            const {label, variants} = this._table.getKey(page.firstKey + i);
+            const key = this._getKey(label, variants);
 
             gridLayout.attach(key, col, row, 1, 1);
 
@@ -883,6 +1096,46 @@ const EmojiPager = GObject.registerClass({
         return panel;
     }
 
+    _getKey(label, variants) {
+        let key = this._keyPool.pop();
+        if (key) {
+            key.relabel({commitString: label}, variants);
+            return key;
+        }
+
+        key = new Key({commitString: label}, variants);
+        key.keyButton.set_button_mask(0);
+
+        key.connect('pressed', () => {
+            this._currentKey = key;
+        });
+        key.connect('commit', (actor, keyval, str) => {
+            if (this._currentKey !== key)
+                return;
+            this._currentKey = null;
+            this.emit('emoji', str);
+        });
+
+        return key;
+    }
+
+    _releasePanel(panel) {
+        /* Keep the keys around, so they can be relabeled for other pages */
+        for (const child of panel.get_children()) {
+            if (!(child instanceof Key))
+                continue;
+
+            if (this._currentKey === child)
+                this._currentKey = null;
+
+            child.cancel();
+            panel.remove_child(child);
+            this._keyPool.push(child);
+        }
+
+        panel.destroy();
+    }
+
     setCurrentPage(nPage) {
         if (this._curPage === nPage)
             return;
@@ -890,7 +1143,7 @@ const EmojiPager = GObject.registerClass({
         this._curPage = nPage;
 
         if (this._panel) {
-            this._panel.destroy();
+            this._releasePanel(this._panel);
             this._panel = null;
         }
 
@@ -901,7 +1154,7 @@ const EmojiPager = GObject.registerClass({
         }
 
         if (this._followingPanel)
-            this._followingPanel.destroy();
+            this._releasePanel(this._followingPanel);
 
         this._followingPanel = null;
         this._followingPage = null;
@@ -955,16 +1208,17 @@ const EmojiSelection = GObject.registerClass({
             text_direction: global.stage.text_direction,
         });
 
+        /* Must match the order of sections in data/gen-emoji-table.py */
         this._sections = [
-            {first: 'grinning face', label: '🙂️'},
-            {first: 'selfie', label: '👍️'},
-            {first: 'monkey face', label: '🌷️'},
-            {first: 'grapes', label: '🍴️'},
-            {first: 'globe showing Europe-Africa', label: '✈️'},
-            {first: 'jack-o-lantern', label: '🏃️'},
-            {first: 'muted speaker', label: '🔔️'},
-            {first: 'ATM sign', label: '❤️'},
-            {first: 'chequered flag', label: '🚩️'},
+            {label: '🙂️'},
+            {label: '👍️'},
+            {label: '🌷️'},
+            {label: '🍴️'},
+            {label: '✈️'},
+            {label: '🏃️'},
+            {label: '🔔️'},
+            {label: '❤️'},
+            {label: '🚩️'},
         ];
 
         this._gridLayout = gridLayout;
@@ -976,7 +1230,7 @@ const EmojiSelection = GObject.registerClass({
             }),
         });
 
-        this._emojiPager = new EmojiPager(this._sections);
+        this._emojiPager = new EmojiPager(this._sections, this._table);
         this._emojiPager.connect('page-changed', (pager, sectionLabel, page, nPages) => {
             this._onPageChanged(sectionLabel, page, nPages);
         });
@@ -1022,45 +1276,13 @@ const EmojiSelection = GObject.registerClass({
             this._emojiPager.delta / this._emojiPager.width);
     }
 
-    _findSection(emoji) {
-        for (let i = 0; i < this._sections.length; i++) {
-            if (this._sections[i].first === emoji)
-                return this._sections[i];
-        }
-
-        return null;
-    }
-
     _populateSections() {
-        let file = Gio.File.new_for_uri('resource:///org/gnome/shell/osk-layouts/emoji.json');
-        let [success_, contents] = file.load_contents(null);
-
-        let emoji = JSON.parse(new TextDecoder().decode(contents));
-
-        let variants = [];
-        let currentKey = 0;
-        let currentSection = null;
-
-        for (let i = 0; i < emoji.length; i++) {
-            /* Group variants of a same emoji so they appear on the key popover */
-            if (emoji[i].name.startsWith(emoji[currentKey].name)) {
-                variants.push(emoji[i].char);
-                if (i < emoji.length - 1)
-                    continue;
-            }
-
-            let newSection = this._findSection(emoji[currentKey].name);
-            if (newSection != null) {
-                currentSection = newSection;
-                currentSection.keys = [];
-            }
+        this._table = new EmojiTable();
+        console.assert(this._table.nSections === this._sections.length,
+            'Emoji table does not match the emoji sections');
 
-            /* Create the key */
-            let label = emoji[currentKey].char + String.fromCharCode(0xFE0F);
-            currentSection.keys.push({label, variants});
-            currentKey = i;
-            variants = [];
-        }
+        for (let i = 0; i < this._sections.length; i++)
+            Object.assign(this._sections[i], this._table.getSection(i));
     }
 
     _createBottomRow() {
@@ -1395,6 +1617,10 @@ export const Keyboard = GObject.registerClass({
             this._languagePopup = null;
         }
 
+        /* Keys not used by the current layer are not parented */
+        this._keys.filter(key => !key.get_parent()).forEach(key => key.destroy());
+        this._keys = [];
+
         IBusManager.getIBusManager().setCompletionEnabled(false, () => Main.inputMethod.update());
     }
 
@@ -1405,7 +1631,9 @@ export const Keyboard = GObject.registerClass({
         this._keyboardController = new KeyboardController();
 
         this._groups = {};
-        this._currentPage = null;
+        this._currentLayer = null;
+        this._keys = [];
+        this._nextKey = 0;
 
         this._suggestions = new Suggestions();
         this.add_child(this._suggestions);
@@ -1416,6 +1644,13 @@ export const Keyboard = GObject.registerClass({
         });
         this.add_child(this._aspectContainer);
 
+        /* Keys are shared by all groups and levels, and relabeled when
+         * switching between them */
+        this._currentPage = new KeyContainer();
+        this._currentPage.shiftKeys = [];
+        this._currentPage.mode = null;
+        this._aspectContainer.add_child(this._currentPage);
+
         this._emojiSelection = new EmojiSelection();
         this._emojiSelection.connect('toggle', this._toggleEmoji.bind(this));
         this._emojiSelection.connect('close-request', () => this.close());
@@ -1435,7 +1670,7 @@ export const Keyboard = GObject.registerClass({
         this._keypad.hide();
         this._keypadVisible = false;
 
-        this._ensureKeysForGroup(this._keyboardController.getCurrentGroup());
+        this._ensureLayersForGroup(this._keyboardController.getCurrentGroup());
         this._setActiveLayer(0);
 
         Main.inputMethod.connectObject(
@@ -1489,98 +1724,111 @@ export const Keyboard = GObject.registerClass({
         let layers = {};
         let levels = keyboardModel.getLevels();
         for (let i = 0; i < levels.length; i++) {
-            let currentLevel = levels[i];
             /* There are keyboard maps which consist of 3 levels (no uppercase,
              * basically). We however make things consistent by skipping that
              * second level.
              */
             let level = i >= 1 && levels.length === 3 ? i + 1 : i;
 
-            let layout = new KeyContainer();
-            layout.shiftKeys = [];
-            layout.mode = currentLevel.mode;
-
-            this._loadRows(currentLevel, level, levels.length, layout);
-            layers[level] = layout;
-            this._aspectContainer.add_child(layout);
-            layout.layoutButtons();
-
-            layout.hide();
+            layers[level] = levels[i];
         }
 
         return layers;
     }
 
-    _ensureKeysForGroup(group) {
+    _ensureLayersForGroup(group) {
         if (!this._groups[group])
             this._groups[group] = this._createLayersForGroup(group);
     }
 
+    _createKey() {
+        const button = new Key({});
+
+        button.connect('commit', (_actor, keyval, str) => {
+            if (button.model.action === 'modifier')
+                return;
+
+            const {mode} = this._currentPage;
+            this._commitAction(keyval, str).then(() => {
+                if (mode === 'latched' && !this._latched)
+                    this._setActiveLayer(0);
+            });
+        });
+
+        button.connect('released', () => {
+            const key = button.model;
+
+            if (key.action === 'hide') {
+                this.close();
+            } else if (key.action === 'languageMenu') {
+                this._popupLanguageMenu(button);
+            } else if (key.action === 'emoji') {
+                this._toggleEmoji();
+            } else if (key.action === 'modifier') {
+                this._toggleModifier(key.keyval);
+            } else if (key.action === 'delete') {
+                this._toggleDelete(true);
+                this._toggleDelete(false);
+            } else if (!this._longPressed && key.action === 'levelSwitch') {
+                this._setActiveLayer(key.level);
+                this._setLatched(
+                    key.level === 1 &&
+                        key.iconName === 'keyboard-caps-lock-symbolic');
+            }
+
+            this._longPressed = false;
+        });
+
+        button.connect('long-press', () => {
+            const key = button.model;
+
+            if (key.action === 'levelSwitch' &&
+                key.iconName === 'keyboard-shift-symbolic' &&
+                key.level === 1) {
+                this._setActiveLayer(key.level);
+                this._setLatched(true);
+                this._longPressed = true;
+            } else if (key.action === 'delete') {
+                this._toggleDelete(true);
+            }
+        });
+
+        return button;
+    }
+
+    _getKey() {
+        /* Hand out keys in the same order on every layer, so keys
+         * keep their position as much as possible */
+        let button = this._keys[this._nextKey];
+        if (!button) {
+            button = this._createKey();
+            this._keys.push(button);
+        }
+
+        this._nextKey++;
+        return button;
+    }
+
     _addRowKeys(keys, layout) {
         for (let i = 0; i < keys.length; ++i) {
             const key = keys[i];
-            const {strings} = key;
-            const commitString = strings?.shift();
+            const [commitString, ...extendedKeys] = key.strings;
 
-            let button = new Key({
+            const button = this._getKey();
+            button.model = key;
+            button.relabel({
                 commitString,
                 label: key.label,
                 iconName: key.iconName,
                 keyval: key.keyval,
-            }, strings);
+            }, extendedKeys);
 
             if (key.width !== null)
                 button.setWidth(key.width);
 
-            if (key.action !== 'modifier') {
-                button.connect('commit', (_actor, keyval, str) => {
-                    this._commitAction(keyval, str).then(() => {
-                        if (layout.mode === 'latched' && !this._latched)
-                            this._setActiveLayer(0);
-                    });
-                });
-            }
-
-            if (key.action !== null) {
-                button.connect('released', () => {
-                    if (key.action === 'hide') {
-                        this.close();
-                    } else if (key.action === 'languageMenu') {
-                        this._popupLanguageMenu(button);
-                    } else if (key.action === 'emoji') {
-                        this._toggleEmoji();
-                    } else if (key.action === 'modifier') {
-                        this._toggleModifier(key.keyval);
-                    } else if (key.action === 'delete') {
-                        this._toggleDelete(true);
-                        this._toggleDelete(false);
-                    } else if (!this._longPressed && key.action === 'levelSwitch') {
-                        this._setActiveLayer(key.level);
-                        this._setLatched(
-                            key.level === 1 &&
-                                key.iconName === 'keyboard-caps-lock-symbolic');
-                    }
-
-                    this._longPressed = false;
-                });
-            }
-
             if (key.action === 'levelSwitch' &&
-                key.iconName === 'keyboard-shift-symbolic') {
+                key.iconName === 'keyboard-shift-symbolic')
                 layout.shiftKeys.push(button);
-                if (key.level === 1) {
-                    button.connect('long-press', () => {
-                        this._setActiveLayer(key.level);
-                        this._setLatched(true);
-                        this._longPressed = true;
-                    });
-                }
-            }
-
-            if (key.action === 'delete') {
-                button.connect('long-press',
-                    () => this._toggleDelete(true));
-            }
 
             if (key.action === 'modifier') {
                 let modifierKeys = this._modifierKeys[key.keyval] || [];
@@ -1590,6 +1838,8 @@ export const Keyboard = GObject.registerClass({
 
             if (key.action || key.keyval)
                 button.keyButton.add_style_class_name('default-key');
+            else
+                button.keyButton.remove_style_class_name('default-key');
 
             layout.appendKey(button, button.keyButton.keyWidth);
         }
@@ -1721,7 +1971,7 @@ export const Keyboard = GObject.registerClass({
         else
             this._modifiers.delete(keyval);
 
-        for (const key of this._modifierKeys[keyval])
+        for (const key of this._modifierKeys[keyval] ?? [])
             key.setLatched(enabled);
     }
 
@@ -1777,7 +2027,7 @@ export const Keyboard = GObject.registerClass({
         }
     }
 
-    _loadRows(model, level, numLevels, layout) {
+    _loadRows(model, layout) {
         let rows = model.rows;
         for (let i = 0; i < rows.length; ++i) {
             layout.appendRow();
@@ -1785,6 +2035,19 @@ export const Keyboard = GObject.registerClass({
         }
     }
 
+    _loadLayer(layer) {
+        const layout = this._currentPage;
+
+        layout.removeAllKeys();
+        layout.shiftKeys = [];
+        layout.mode = layer.mode;
+        this._modifierKeys = new Map();
+        this._nextKey = 0;
+
+        this._loadRows(layer, layout);
+        layout.layoutButtons();
+    }
+
     _getGridSlots() {
         let numOfHorizSlots = 0, numOfVertSlots;
         let rows = this._currentPage.get_children();
@@ -1815,7 +2078,7 @@ export const Keyboard = GObject.registerClass({
     }
 
     _updateKeys() {
-        this._ensureKeysForGroup(this._keyboardController.getCurrentGroup());
+        this._ensureLayersForGroup(this._keyboardController.getCurrentGroup());
         this._setActiveLayer(0);
     }
 
@@ -1828,12 +2091,8 @@ export const Keyboard = GObject.registerClass({
     }
 
     _onKeyboardGroupsChanged() {
-        let nonGroupActors = [this._emojiSelection, this._keypad];
-        this._aspectContainer.get_children().filter(c => !nonGroupActors.includes(c)).forEach(c => {
-            c.destroy();
-        });
-
         this._groups = {};
+        this._currentLayer = null;
         this._onGroupChanged();
     }
 
@@ -1875,25 +2134,18 @@ export const Keyboard = GObject.registerClass({
     _setActiveLayer(activeLevel) {
         let activeGroupName = this._keyboardController.getCurrentGroup();
         let layers = this._groups[activeGroupName];
-        let currentPage = layers[activeLevel];
+        let currentLayer = layers[activeLevel];
 
-        if (this._currentPage === currentPage) {
+        if (this._currentLayer === currentLayer) {
             this._updateCurrentPageVisible();
             return;
         }
 
-        if (this._currentPage != null) {
-            this._setCurrentLevelLatched(this._currentPage, false);
-            this._currentPage.disconnect(this._currentPage._destroyID);
-            this._currentPage.hide();
-            delete this._currentPage._destroyID;
-        }
-
+        this._setCurrentLevelLatched(this._currentPage, false);
         this._disableAllModifiers();
-        this._currentPage = currentPage;
-        this._currentPage._destroyID = this._currentPage.connect('destroy', () => {
-            this._currentPage = null;
-        });
+
+        this._currentLayer = currentLayer;
+        this._loadLayer(currentLayer);
         this._updateCurrentPageVisible();
         this._aspectContainer.setRatio(...this._currentPage.getRatio());
         this._emojiSelection.setRatio(...this._currentPage.getRatio());
@@ -35,6 +35,7 @@ const commandHeader = `
     const inspect = Main.lookingGlass.inspect.bind(Main.lookingGlass);
     const it = Main.lookingGlass.getIt();
     const r = Main.lookingGlass.getResult.bind(Main.lookingGlass);
+    const searchStats = () => Main.overview.searchController.getProviderStats();
     `;
 const AsyncFunction = async function () {}.constructor;
 
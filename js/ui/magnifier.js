@@ -94,6 +94,137 @@ const MouseSpriteContent = GObject.registerClass({
     }
 });
 
+// Properties that place an actor within its parent, which the stand-ins
+// for the actor in a CulledGroupClone mirror
+const MIRRORED_PROPERTIES = [
+    'x', 'y', 'z-position', 'width', 'height', 'visible', 'opacity',
+    'pivot-point', 'translation-x', 'translation-y', 'translation-z',
+    'scale-x', 'scale-y',
+    'rotation-angle-x', 'rotation-angle-y', 'rotation-angle-z',
+];
+
+/**
+ * A clone of a group that only paints the children that intersect the
+ * region of interest.
+ *
+ * A Clutter.Clone always paints all of its source, since culling is
+ * disabled while painting clones. This clones every child of the group
+ * separately instead, and skips those whose paint box lies outside the
+ * region of interest. Children of the groups in @expandedGroups, such as
+ * the window group, are cloned one by one the same way.
+ */
+const CulledGroupClone = GObject.registerClass(
+class CulledGroupClone extends Clutter.Actor {
+    _init(source, expandedGroups, root = null) {
+        super._init();
+
+        this._source = source;
+        this._expandedGroups = expandedGroups;
+        this._root = root ?? this;
+        this._units = new Map();
+
+        // The region of interest, in the coordinates of the root source
+        this._roi = null;
+
+        // The number of cloned actors painted and skipped by the last paint
+        this.paintedCount = 0;
+        this.culledCount = 0;
+
+        for (const child of source)
+            this._addUnit(child);
+
+        source.connectObject(
+            'child-added', (s, child) => this._addUnit(child),
+            'child-removed', (s, child) => this._removeUnit(child),
+            this);
+
+        this.connect('destroy', () => {
+            for (const child of [...this._units.keys()])
+                this._removeUnit(child);
+        });
+    }
+
+    _addUnit(child) {
+        let unit;
+        if (this._expandedGroups.includes(child)) {
+            unit = new CulledGroupClone(child,
+                this._expandedGroups, this._root);
+        } else {
+            unit = new Clutter.Clone({source: child});
+        }
+
+        unit._bindings = MIRRORED_PROPERTIES.map(prop =>
+            child.bind_property(prop, unit, prop, GObject.BindingFlags.SYNC_CREATE));
+
+        this._units.set(child, unit);
+        this.add_child(unit);
+    }
+
+    _removeUnit(child) {
+        const unit = this._units.get(child);
+        if (!unit)
+            return;
+
+        this._units.delete(child);
+        unit._bindings.forEach(binding => binding.unbind());
+        unit.destroy();
+    }
+
+    /**
+     * @param {number[]} roi - the region of interest, [x, y, width, height]
+     */
+    setROI(roi) {
+        this._roi = roi;
+        this.queue_redraw();
+    }
+
+    _isInROI(child) {
+        const root = this._root;
+        if (!root._roi)
+            return true;
+
+        // Paint boxes are in stage coordinates, which only match those of
+        // the root source while it isn't moved or transformed
+        const {x, y, translationX, translationY} = root._source;
+        if (x !== 0 || y !== 0 || translationX !== 0 || translationY !== 0 ||
+            root._source.is_scaled() || root._source.is_rotated())
+            return true;
+
+        const [hasPaintBox, box] = child.get_paint_box();
+        if (!hasPaintBox)
+            return true;
+
+        const [roiX, roiY, roiWidth, roiHeight] = root._roi;
+        return box.x1 < roiX + roiWidth && box.x2 > roiX &&
+            box.y1 < roiY + roiHeight && box.y2 > roiY;
+    }
+
+    vfunc_paint(paintContext) {
+        const root = this._root;
+        if (root === this) {
+            this.paintedCount = 0;
+            this.culledCount = 0;
+        }
+
+        // Follow the stacking order of the source, which may change
+        // without notice
+        for (const child of this._source) {
+            const unit = this._units.get(child);
+            if (!unit?.visible)
+                continue;
+
+            if (!this._isInROI(child)) {
+                root.culledCount++;
+                continue;
+            }
+
+            if (unit instanceof Clutter.Clone)
+                root.paintedCount++;
+            unit.paint(paintContext);
+        }
+    }
+});
+
 export class Magnifier extends Signals.EventEmitter {
     constructor() {
         super();
@@ -772,6 +903,7 @@ class ZoomRegion {
         this._magView = null;
         this._background = null;
         this._uiGroupClone = null;
+        this._cloneBindings = null;
         this._mouseSourceActor = mouseSourceActor;
         this._mouseActor  = null;
         this._crossHairs = null;
@@ -1486,11 +1618,15 @@ class ZoomRegion {
         mainGroup.add_actor(this._background);
 
         // Clone the group that contains all of UI on the screen.  This is the
-        // chrome, the windows, etc.
-        this._uiGroupClone = new Clutter.Clone({
-            source: Main.uiGroup,
-            clip_to_allocation: true,
-        });
+        // chrome, the windows, etc. Only the windows and chrome that intersect
+        // the region of interest set in _updateCloneGeometry() get painted.
+        this._uiGroupClone = new CulledGroupClone(Main.uiGroup,
+            [global.window_group, global.top_window_group]);
+        this._uiGroupClone.clip_to_allocation = true;
+        this._cloneBindings = ['width', 'height'].map(prop =>
+            Main.uiGroup.bind_property(prop, this._uiGroupClone, prop,
+                GObject.BindingFlags.SYNC_CREATE));
+        this._cloneROI = null;
         mainGroup.add_actor(this._uiGroupClone);
 
         // Add either the given mouseSourceActor to the ZoomRegion, or a clone of
@@ -1522,14 +1658,35 @@ class ZoomRegion {
 
         this._magShaderEffects.destroyEffects();
         this._magShaderEffects = null;
+        this._cloneBindings.forEach(binding => binding.unbind());
+        this._cloneBindings = null;
         this._magView.destroy();
         this._magView = null;
         this._background = null;
         this._uiGroupClone = null;
+        this._cloneROI = null;
         this._mouseActor = null;
         this._crossHairsActor = null;
     }
 
+    _getCloneROI() {
+        // The region of interest in the coordinates of the cloned uiGroup,
+        // padded by a pixel so that actors touching its edges are kept
+        const [roiX, roiY, roiWidth, roiHeight] = this.getROI();
+        const x = Math.floor(roiX) - 1;
+        const y = Math.floor(roiY) - 1;
+        return [
+            x, y,
+            Math.ceil(roiX + roiWidth) + 1 - x,
+            Math.ceil(roiY + roiHeight) + 1 - y,
+        ];
+    }
+
+    _setCloneROI(roi) {
+        this._cloneROI = roi;
+        this._uiGroupClone.setROI(roi);
+    }
+
     _setViewPort(viewPort, fromROIUpdate) {
         // Sets the position of the zoom region on the screen
 
@@ -1755,6 +1912,21 @@ class ZoomRegion {
         if (!this.isActive())
             return;
 
+        // While animating, the view shows parts of both the old and the new
+        // region of interest, so paint their union until it is done
+        const roi = this._getCloneROI();
+        if (animate && this._cloneROI) {
+            const [oldX, oldY, oldWidth, oldHeight] = this._cloneROI;
+            const [newX, newY, newWidth, newHeight] = roi;
+            const x1 = Math.min(oldX, newX);
+            const y1 = Math.min(oldY, newY);
+            const x2 = Math.max(oldX + oldWidth, newX + newWidth);
+            const y2 = Math.max(oldY + oldHeight, newY + newHeight);
+            this._setCloneROI([x1, y1, x2 - x1, y2 - y1]);
+        } else {
+            this._setCloneROI(roi);
+        }
+
         let [x, y] = this._screenToViewPort(0, 0);
         this._uiGroupClone.ease({
             x: Math.round(x),
@@ -1763,6 +1935,10 @@ class ZoomRegion {
             scale_y: this._yMagFactor,
             mode: Clutter.AnimationMode.EASE_OUT_QUAD,
             duration: animate ? 100 : 0,
+            onComplete: () => {
+                if (this._uiGroupClone)
+                    this._setCloneROI(this._getCloneROI());
+            },
         });
 
         let [mouseX, mouseY] = this._getMousePosition();
@@ -28,6 +28,12 @@ const MAX_NOTIFICATIONS_IN_QUEUE = 3;
 const MAX_NOTIFICATIONS_PER_SOURCE = 3;
 const MAX_NOTIFICATION_BUTTONS = 3;
 
+// Number of new notifications a source can show in a burst, and the number
+// it regains per second; notifications beyond that are coalesced into a
+// single summary notification
+const RATE_LIMIT_BURST = 10;
+const RATE_LIMIT_PER_SECOND = 2;
+
 // We delay hiding of the tray if the mouse is within MOUSE_LEFT_ACTOR_THRESHOLD
 // range from the point where it left the tray.
 const MOUSE_LEFT_ACTOR_THRESHOLD = 20;
@@ -80,6 +86,32 @@ export const PrivacyScope = {
     SYSTEM: 1,
 };
 
+class TokenBucket {
+    constructor(capacity, refillRate) {
+        this._capacity = capacity;
+        this._refillRate = refillRate;
+        this._tokens = capacity;
+        this._lastRefill = GLib.get_monotonic_time();
+    }
+
+    _refill() {
+        const now = GLib.get_monotonic_time();
+        const elapsed = (now - this._lastRefill) / GLib.USEC_PER_SEC;
+        this._tokens = Math.min(this._capacity,
+            this._tokens + elapsed * this._refillRate);
+        this._lastRefill = now;
+    }
+
+    consume() {
+        this._refill();
+        if (this._tokens < 1)
+            return false;
+
+        this._tokens--;
+        return true;
+    }
+}
+
 class FocusGrabber {
     constructor(actor) {
         this._actor = actor;
@@ -379,6 +411,9 @@ export const Notification = GObject.registerClass({
         this._soundName = null;
         this._soundFile = null;
         this._soundPlayed = false;
+        this._updatedLaterId = 0;
+        this._updatePending = false;
+        this._pendingUpdateClear = false;
         this.actions = [];
         this.setResident(false);
 
@@ -434,7 +469,33 @@ export const Notification = GObject.registerClass({
             this._soundPlayed = false;
         }
 
-        this.emit('updated', params.clear);
+        this._queueUpdated(params.clear);
+    }
+
+    // Coalesce repeated updates within a frame, so that a notification
+    // that is replaced repeatedly only rebuilds its UI once per frame;
+    // the first update of a frame is still emitted right away
+    _queueUpdated(clear) {
+        if (this._updatedLaterId) {
+            this._updatePending = true;
+            this._pendingUpdateClear ||= clear;
+            return;
+        }
+
+        this.emit('updated', clear);
+
+        const laters = global.compositor.get_laters();
+        this._updatedLaterId = laters.add(Meta.LaterType.BEFORE_REDRAW, () => {
+            this._updatedLaterId = 0;
+
+            if (this._updatePending) {
+                const pendingClear = this._pendingUpdateClear;
+                this._updatePending = false;
+                this._pendingUpdateClear = false;
+                this.emit('updated', pendingClear);
+            }
+            return GLib.SOURCE_REMOVE;
+        });
     }
 
     // addAction:
@@ -497,6 +558,11 @@ export const Notification = GObject.registerClass({
     }
 
     destroy(reason = NotificationDestroyedReason.DISMISSED) {
+        if (this._updatedLaterId) {
+            global.compositor.get_laters().remove(this._updatedLaterId);
+            this._updatedLaterId = 0;
+        }
+
         this.emit('destroy', reason);
         this.run_dispose();
     }
@@ -673,6 +739,16 @@ export const Source = GObject.registerClass({
 
         this.notifications = [];
 
+        this._rateLimiter = new TokenBucket(
+            RATE_LIMIT_BURST, RATE_LIMIT_PER_SECOND);
+        this._coalescedNotifications = new Set();
+        this._coalesceTimeoutId = 0;
+        this._summaryNotification = null;
+        this._summaryCount = 0;
+
+        this._pendingShows = new Set();
+        this._showLaterId = 0;
+
         this._policy = this._createPolicy();
     }
 
@@ -767,16 +843,121 @@ export const Source = GObject.registerClass({
 
     showNotification(notification) {
         notification.acknowledged = false;
+
+        const isUpdate = this.notifications.includes(notification);
+        if (!isUpdate &&
+            notification !== this._summaryNotification &&
+            notification.urgency !== Urgency.CRITICAL &&
+            !this._rateLimiter.consume()) {
+            this._coalesceNotification(notification);
+            return;
+        }
+
+        this._coalescedNotifications.delete(notification);
+
         this.pushNotification(notification);
 
         if (notification.urgency === Urgency.LOW)
             return;
 
-        if (this.policy.showBanners || notification.urgency === Urgency.CRITICAL)
+        if (!this.policy.showBanners && notification.urgency !== Urgency.CRITICAL)
+            return;
+
+        if (isUpdate)
+            this._queueNotificationShow(notification);
+        else
             this.emit('notification-show', notification);
     }
 
+    _queueNotificationShow(notification) {
+        this._pendingShows.add(notification);
+
+        if (this._showLaterId)
+            return;
+
+        const laters = global.compositor.get_laters();
+        this._showLaterId = laters.add(Meta.LaterType.BEFORE_REDRAW, () => {
+            this._showLaterId = 0;
+
+            const pendingShows = [...this._pendingShows];
+            this._pendingShows.clear();
+            pendingShows
+                .filter(n => this.notifications.includes(n))
+                .forEach(n => this.emit('notification-show', n));
+            return GLib.SOURCE_REMOVE;
+        });
+    }
+
+    _coalesceNotification(notification) {
+        // The app is sending notifications faster than they can be
+        // read; expire this one once the caller is done with it, and
+        // let a summary mention it instead
+        if (this._coalescedNotifications.has(notification))
+            return;
+
+        this._coalescedNotifications.add(notification);
+        notification.connect('destroy',
+            () => this._coalescedNotifications.delete(notification));
+
+        if (this._coalesceTimeoutId)
+            return;
+
+        this._coalesceTimeoutId = GLib.timeout_add(GLib.PRIORITY_DEFAULT,
+            1000 / RATE_LIMIT_PER_SECOND, () => {
+                this._coalesceTimeoutId = 0;
+                this._showCoalescedSummary();
+                return GLib.SOURCE_REMOVE;
+            });
+        GLib.Source.set_name_by_id(this._coalesceTimeoutId,
+            '[gnome-shell] this._showCoalescedSummary');
+    }
+
+    _dropCoalescedNotifications(reason) {
+        const notifications = [...this._coalescedNotifications];
+        this._coalescedNotifications.clear();
+        notifications.forEach(n => n.destroy(reason));
+
+        return notifications.length;
+    }
+
+    _showCoalescedSummary() {
+        const count = this._dropCoalescedNotifications(
+            NotificationDestroyedReason.EXPIRED);
+        if (count === 0)
+            return;
+
+        this._summaryCount += count;
+
+        if (!this._summaryNotification) {
+            this._summaryNotification = new Notification(this);
+            this._summaryNotification.connect('destroy', () => {
+                this._summaryNotification = null;
+                this._summaryCount = 0;
+            });
+        }
+
+        this._summaryNotification.update(this.title,
+            ngettext(
+                '%d more notification',
+                '%d more notifications',
+                this._summaryCount).format(this._summaryCount));
+        this.showNotification(this._summaryNotification);
+    }
+
     destroy(reason) {
+        if (this._coalesceTimeoutId) {
+            GLib.source_remove(this._coalesceTimeoutId);
+            this._coalesceTimeoutId = 0;
+        }
+
+        if (this._showLaterId) {
+            global.compositor.get_laters().remove(this._showLaterId);
+            this._showLaterId = 0;
+        }
+        this._pendingShows.clear();
+
+        this._dropCoalescedNotifications(reason);
+
         let notifications = this.notifications;
         this.notifications = [];
 
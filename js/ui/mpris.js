@@ -7,16 +7,16 @@ import * as Signals from '../misc/signals.js';
 import * as Main from './main.js';
 import * as MessageList from './messageList.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 
-const DBusIface = loadInterfaceXML('org.freedesktop.DBus');
-const DBusProxy = Gio.DBusProxy.makeProxyWrapper(DBusIface);
+const DBusIface = lookupInterfaceInfo('org.freedesktop.DBus');
+const DBusProxy = makeProxyWrapper(DBusIface);
 
-const MprisIface = loadInterfaceXML('org.mpris.MediaPlayer2');
-const MprisProxy = Gio.DBusProxy.makeProxyWrapper(MprisIface);
+const MprisIface = lookupInterfaceInfo('org.mpris.MediaPlayer2');
+const MprisProxy = makeProxyWrapper(MprisIface);
 
-const MprisPlayerIface = loadInterfaceXML('org.mpris.MediaPlayer2.Player');
-const MprisPlayerProxy = Gio.DBusProxy.makeProxyWrapper(MprisPlayerIface);
+const MprisPlayerIface = lookupInterfaceInfo('org.mpris.MediaPlayer2.Player');
+const MprisPlayerProxy = makeProxyWrapper(MprisPlayerIface);
 
 const MPRIS_PLAYER_PREFIX = 'org.mpris.MediaPlayer2.';
 
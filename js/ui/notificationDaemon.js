@@ -1,6 +1,5 @@
 // -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
 
-import GdkPixbuf from 'gi://GdkPixbuf';
 import Gio from 'gi://Gio';
 import GLib from 'gi://GLib';
 import GObject from 'gi://GObject';
@@ -12,9 +11,15 @@ import * as Main from './main.js';
 import * as MessageTray from './messageTray.js';
 import * as Params from '../misc/params.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 
-const FdoNotificationsIface = loadInterfaceXML('org.freedesktop.Notifications');
+const FdoNotificationsIface = lookupInterfaceInfo('org.freedesktop.Notifications');
+
+// The largest size at which notification images are displayed
+const NOTIFICATION_IMAGE_SIZE = 48;
+
+// Hints carrying raw image data, which are kept packed as variants
+const IMAGE_DATA_HINTS = ['image-data', 'image_data', 'icon_data'];
 
 /** @enum {number} */
 const NotificationClosedReason = {
@@ -42,19 +47,22 @@ class FdoNotificationDaemon {
         this._nextNotificationId = 1;
     }
 
+    _getMaxResourceScale() {
+        // Unless monitor framebuffers are scaled, the theme scale factor
+        // already is the monitor scale, so the two must not be multiplied
+        const {scaleFactor} = St.ThemeContext.get_for_stage(global.stage);
+        let maxScale = scaleFactor;
+        for (let i = 0; i < global.display.get_n_monitors(); i++)
+            maxScale = Math.max(maxScale, global.display.get_monitor_scale(i));
+        return maxScale;
+    }
+
     _imageForNotificationData(hints) {
         if (hints['image-data']) {
-            const [
-                width, height, rowStride, hasAlpha,
-                bitsPerSample, nChannels_, data,
-            ] = hints['image-data'];
-            return Shell.util_create_pixbuf_from_data(data,
-                GdkPixbuf.Colorspace.RGB,
-                hasAlpha,
-                bitsPerSample,
-                width,
-                height,
-                rowStride);
+            const maxSize = Math.ceil(
+                NOTIFICATION_IMAGE_SIZE * this._getMaxResourceScale());
+            return Shell.util_get_image_from_image_data(
+                hints['image-data'], maxSize);
         } else if (hints['image-path']) {
             return this._iconForNotificationData(hints['image-path']);
         }
@@ -140,8 +148,10 @@ class FdoNotificationDaemon {
         let id;
 
         for (let hint in hints) {
-            // unpack the variants
-            hints[hint] = hints[hint].deepUnpack();
+            // unpack the variants, except for image data which is
+            // decoded natively
+            if (!IMAGE_DATA_HINTS.includes(hint))
+                hints[hint] = hints[hint].deepUnpack();
         }
 
         hints = Params.parse(hints, {urgency: Urgency.NORMAL}, true);
@@ -543,8 +553,8 @@ class GtkNotificationDaemonNotification extends MessageTray.Notification {
     }
 });
 
-const FdoApplicationIface = loadInterfaceXML('org.freedesktop.Application');
-const FdoApplicationProxy = Gio.DBusProxy.makeProxyWrapper(FdoApplicationIface);
+const FdoApplicationIface = lookupInterfaceInfo('org.freedesktop.Application');
+const FdoApplicationProxy = makeProxyWrapper(FdoApplicationIface);
 
 function objectPathFromAppId(appId) {
     return `/${appId.replace(/\./g, '/').replace(/-/g, '_')}`;
@@ -669,7 +679,7 @@ class GtkNotificationDaemonAppSource extends MessageTray.Source {
     }
 });
 
-const GtkNotificationsIface = loadInterfaceXML('org.gtk.Notifications');
+const GtkNotificationsIface = lookupInterfaceInfo('org.gtk.Notifications');
 
 class GtkNotificationDaemon {
     constructor() {
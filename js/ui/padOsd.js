@@ -17,7 +17,7 @@ import * as Main from './main.js';
 import * as PopupMenu from './popupMenu.js';
 import * as Layout from './layout.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../misc/dbusInterfaces.js';
 
 const ACTIVE_COLOR = '#729fcf';
 
@@ -938,7 +938,7 @@ export const PadOsd = GObject.registerClass({
     }
 });
 
-const PadOsdIface = loadInterfaceXML('org.gnome.Shell.Wacom.PadOsd');
+const PadOsdIface = lookupInterfaceInfo('org.gnome.Shell.Wacom.PadOsd');
 
 export class PadOsdService extends Signals.EventEmitter {
     constructor() {
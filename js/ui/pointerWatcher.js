@@ -1,13 +1,12 @@
 // -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
 
 import GLib from 'gi://GLib';
-
-// We stop polling if the user is idle for more than this amount of time
-const IDLE_TIME = 1000;
+import Meta from 'gi://Meta';
 
 // This file implements a reasonably efficient system for tracking the position
-// of the mouse pointer. We simply query the pointer from the X server in a loop,
-// but we turn off the polling when the user is idle.
+// of the mouse pointer. We listen to position changes from the cursor tracker
+// and dispatch them to watches at most once per frame, so nothing happens at
+// all while the pointer is not moving.
 
 let _pointerWatcher = null;
 
@@ -38,18 +37,24 @@ class PointerWatch {
 
 class PointerWatcher {
     constructor() {
-        this._idleMonitor = global.backend.get_core_idle_monitor();
-        this._idleMonitor.add_idle_watch(IDLE_TIME, this._onIdleMonitorBecameIdle.bind(this));
-        this._idle = this._idleMonitor.get_idletime() > IDLE_TIME;
+        this._cursorTracker = Meta.CursorTracker.get_for_display(global.display);
+        this._positionChangedId = 0;
+        this._laterId = 0;
+        this._timeoutId = 0;
+        this._lastDispatchTime = 0;
         this._watches = [];
         this.pointerX = null;
         this.pointerY = null;
+
+        // Number of times the watcher woke up to check the pointer
+        // position; this stays constant while the pointer is still
+        this.wakeups = 0;
     }
 
     // addWatch:
-    // @interval: hint as to the time resolution needed. When the user is
-    //   not idle, the position of the pointer will be queried at least
-    //   once every this many milliseconds.
+    // @interval: hint as to the time resolution needed. When the pointer
+    //   moves, watches are called at most once per frame, and not more
+    //   often than once every this many milliseconds.
     // @callback to call when the pointer position changes - takes
     //   two arguments, X and Y.
     //
@@ -61,7 +66,7 @@ class PointerWatcher {
 
         let watch = new PointerWatch(this, interval, callback);
         this._watches.push(watch);
-        this._updateTimeout();
+        this._updateTracking();
         return watch;
     }
 
@@ -69,45 +74,70 @@ class PointerWatcher {
         for (let i = 0; i < this._watches.length; i++) {
             if (this._watches[i] === watch) {
                 this._watches.splice(i, 1);
-                this._updateTimeout();
+                this._updateTracking();
                 return;
             }
         }
     }
 
-    _onIdleMonitorBecameActive() {
-        this._idle = false;
-        this._updatePointer();
-        this._updateTimeout();
+    _updateTracking() {
+        if (this._watches.length > 0 && !this._positionChangedId) {
+            this._cursorTracker.track_position();
+            this._positionChangedId = this._cursorTracker.connect(
+                'position-invalidated', this._onPositionInvalidated.bind(this));
+        } else if (this._watches.length === 0 && this._positionChangedId) {
+            this._cursorTracker.disconnect(this._positionChangedId);
+            this._cursorTracker.untrack_position();
+            this._positionChangedId = 0;
+
+            this._clearPendingDispatch();
+        }
     }
 
-    _onIdleMonitorBecameIdle() {
-        this._idle = true;
-        this._idleMonitor.add_user_active_watch(this._onIdleMonitorBecameActive.bind(this));
-        this._updateTimeout();
-    }
+    _clearPendingDispatch() {
+        if (this._laterId) {
+            global.compositor.get_laters().remove(this._laterId);
+            this._laterId = 0;
+        }
 
-    _updateTimeout() {
         if (this._timeoutId) {
             GLib.source_remove(this._timeoutId);
             this._timeoutId = 0;
         }
+    }
 
-        if (this._idle || this._watches.length === 0)
-            return;
+    _getMinInterval() {
+        return Math.min(...this._watches.map(w => w.interval));
+    }
 
-        let minInterval = this._watches[0].interval;
-        for (let i = 1; i < this._watches.length; i++)
-            minInterval = Math.min(this._watches[i].interval, minInterval);
+    _onPositionInvalidated() {
+        if (this._laterId || this._timeoutId)
+            return;
 
-        this._timeoutId = GLib.timeout_add(GLib.PRIORITY_DEFAULT, minInterval,
-            this._onTimeout.bind(this));
-        GLib.Source.set_name_by_id(this._timeoutId, '[gnome-shell] this._onTimeout');
+        const elapsed = (GLib.get_monotonic_time() - this._lastDispatchTime) / 1000;
+        const delay = this._getMinInterval() - elapsed;
+
+        if (delay > 0) {
+            this._timeoutId = GLib.timeout_add(GLib.PRIORITY_DEFAULT, Math.ceil(delay), () => {
+                this._timeoutId = 0;
+                this._dispatch();
+                return GLib.SOURCE_REMOVE;
+            });
+            GLib.Source.set_name_by_id(this._timeoutId, '[gnome-shell] this._dispatch');
+        } else {
+            const laters = global.compositor.get_laters();
+            this._laterId = laters.add(Meta.LaterType.BEFORE_REDRAW, () => {
+                this._laterId = 0;
+                this._dispatch();
+                return GLib.SOURCE_REMOVE;
+            });
+        }
     }
 
-    _onTimeout() {
+    _dispatch() {
+        this.wakeups++;
+        this._lastDispatchTime = GLib.get_monotonic_time();
         this._updatePointer();
-        return GLib.SOURCE_CONTINUE;
     }
 
     _updatePointer() {
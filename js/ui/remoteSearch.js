@@ -10,6 +10,13 @@ import * as FileUtils from '../misc/fileUtils.js';
 
 const KEY_FILE_GROUP = 'Shell Search Provider';
 
+// Number of term lists whose result ids are remembered per provider
+const MAX_CACHED_RESULT_SETS = 32;
+// Number of result metas remembered per provider
+const MAX_CACHED_RESULT_METAS = 256;
+// Seconds after which cached results are considered stale
+const CACHE_TTL = 300;
+
 const SearchProviderIface = `
 <node>
 <interface name="org.gnome.Shell.SearchProvider">
@@ -192,18 +199,110 @@ export function loadRemoteSearchProviders(searchSettings) {
     return loadedProviders;
 }
 
-class RemoteSearchProvider {
+/**
+ * @param {string[]} terms - the search terms
+ * @returns {string[]} - the terms with empty and surrounding whitespace removed
+ */
+function normalizeTerms(terms) {
+    return terms.map(t => t.trim()).filter(t => t.length > 0);
+}
+
+/**
+ * A bounded least-recently-used map whose entries expire after a
+ * fixed time-to-live.
+ */
+export class SearchCache {
+    /**
+     * @param {number} maxEntries - maximum number of entries to keep
+     * @param {number} ttl - time-to-live of an entry, in seconds
+     */
+    constructor(maxEntries, ttl) {
+        this._maxEntries = maxEntries;
+        this._ttl = ttl * GLib.USEC_PER_SEC;
+        this._entries = new Map();
+
+        this.hits = 0;
+        this.misses = 0;
+    }
+
+    get size() {
+        return this._entries.size;
+    }
+
+    _isExpired(entry) {
+        return GLib.get_monotonic_time() - entry.time > this._ttl;
+    }
+
+    lookup(key) {
+        const entry = this._entries.get(key);
+        if (!entry || this._isExpired(entry)) {
+            this._entries.delete(key);
+            this.misses++;
+            return undefined;
+        }
+
+        // Move to the most-recently-used end
+        this._entries.delete(key);
+        this._entries.set(key, entry);
+        this.hits++;
+        return entry.value;
+    }
+
+    insert(key, value) {
+        this._entries.delete(key);
+        this._entries.set(key, {value, time: GLib.get_monotonic_time()});
+
+        while (this._entries.size > this._maxEntries) {
+            const [oldest] = this._entries.keys();
+            this._entries.delete(oldest);
+        }
+    }
+
+    /**
+     * Iterates over the live entries, most recently used first
+     *
+     * @yields {Array} - [key, value] pairs
+     */
+    *entries() {
+        for (const [key, entry] of [...this._entries].reverse()) {
+            if (!this._isExpired(entry))
+                yield [key, entry.value];
+        }
+    }
+
+    clear() {
+        this._entries.clear();
+    }
+}
+
+export class RemoteSearchProvider {
     constructor(appInfo, dbusName, dbusPath, autoStart, proxyInfo) {
         if (!proxyInfo)
             proxyInfo = SearchProviderProxyInfo;
 
+        this.proxy = this._createProxy(dbusName, dbusPath, autoStart, proxyInfo);
+
+        // Results only stay valid for as long as the same provider
+        // instance is running, so forget them when the owner changes
+        this.proxy.connect('notify::g-name-owner', () => this.clearCache());
+
+        this._resultCache = new SearchCache(MAX_CACHED_RESULT_SETS, CACHE_TTL);
+        this._metaCache = new SearchCache(MAX_CACHED_RESULT_METAS, CACHE_TTL);
+
+        this.appInfo = appInfo;
+        this.id = appInfo.get_id();
+        this.isRemoteProvider = true;
+        this.canLaunchSearch = false;
+    }
+
+    _createProxy(dbusName, dbusPath, autoStart, proxyInfo) {
         let gFlags = Gio.DBusProxyFlags.DO_NOT_LOAD_PROPERTIES;
         if (autoStart)
             gFlags |= Gio.DBusProxyFlags.DO_NOT_AUTO_START_AT_CONSTRUCTION;
         else
             gFlags |= Gio.DBusProxyFlags.DO_NOT_AUTO_START;
 
-        this.proxy = new Gio.DBusProxy({
+        const proxy = new Gio.DBusProxy({
             g_bus_type: Gio.BusType.SESSION,
             g_name: dbusName,
             g_object_path: dbusPath,
@@ -211,12 +310,28 @@ class RemoteSearchProvider {
             g_interface_name: proxyInfo.name,
             gFlags,
         });
-        this.proxy.init_async(GLib.PRIORITY_DEFAULT, null);
+        proxy.init_async(GLib.PRIORITY_DEFAULT, null);
+        return proxy;
+    }
 
-        this.appInfo = appInfo;
-        this.id = appInfo.get_id();
-        this.isRemoteProvider = true;
-        this.canLaunchSearch = false;
+    clearCache() {
+        this._resultCache.clear();
+        this._metaCache.clear();
+    }
+
+    _findCachedSuperset(terms) {
+        // A result set for terms that are each a prefix of the new terms
+        // is a superset of the new results, so the provider only needs
+        // to filter it rather than run a full search
+        for (const [key, results] of this._resultCache.entries()) {
+            const cachedTerms = key.split('\n');
+            if (cachedTerms.length > terms.length)
+                continue;
+
+            if (cachedTerms.every((t, i) => terms[i].startsWith(t)))
+                return results;
+        }
+        return null;
     }
 
     createIcon(size, meta) {
@@ -257,8 +372,20 @@ class RemoteSearchProvider {
     }
 
     async getInitialResultSet(terms, cancellable) {
+        terms = normalizeTerms(terms);
+
+        const key = terms.join('\n');
+        const cachedResults = this._resultCache.lookup(key);
+        if (cachedResults)
+            return cachedResults;
+
+        const superset = this._findCachedSuperset(terms);
+        if (superset)
+            return this.getSubsearchResultSet(superset, terms, cancellable);
+
         try {
             const [results] = await this.proxy.GetInitialResultSetAsync(terms, cancellable);
+            this._resultCache.insert(key, results);
             return results;
         } catch (error) {
             if (!error.matches(Gio.IOErrorEnum, Gio.IOErrorEnum.CANCELLED))
@@ -268,8 +395,16 @@ class RemoteSearchProvider {
     }
 
     async getSubsearchResultSet(previousResults, newTerms, cancellable) {
+        newTerms = normalizeTerms(newTerms);
+
+        const key = newTerms.join('\n');
+        const cachedResults = this._resultCache.lookup(key);
+        if (cachedResults)
+            return cachedResults;
+
         try {
             const [results] = await this.proxy.GetSubsearchResultSetAsync(previousResults, newTerms, cancellable);
+            this._resultCache.insert(key, results);
             return results;
         } catch (error) {
             if (!error.matches(Gio.IOErrorEnum, Gio.IOErrorEnum.CANCELLED))
@@ -279,29 +414,55 @@ class RemoteSearchProvider {
     }
 
     async getResultMetas(ids, cancellable) {
-        let metas;
-        try {
-            [metas] = await this.proxy.GetResultMetasAsync(ids, cancellable);
-        } catch (error) {
-            if (!error.matches(Gio.IOErrorEnum, Gio.IOErrorEnum.CANCELLED))
-                log(`Received error from D-Bus search provider ${this.id} during GetResultMetas: ${error}`);
-            return [];
+        const metasById = new Map();
+        for (const id of ids) {
+            const meta = this._metaCache.lookup(id);
+            if (meta)
+                metasById.set(id, meta);
         }
 
-        let resultMetas = [];
-        for (let i = 0; i < metas.length; i++) {
-            for (let prop in metas[i]) {
-                // we can use the serialized icon variant directly
-                if (prop !== 'icon')
-                    metas[i][prop] = metas[i][prop].deepUnpack();
+        const missingIds = ids.filter(id => !metasById.has(id));
+        if (missingIds.length > 0) {
+            let metas;
+            try {
+                [metas] = await this.proxy.GetResultMetasAsync(missingIds, cancellable);
+            } catch (error) {
+                if (!error.matches(Gio.IOErrorEnum, Gio.IOErrorEnum.CANCELLED))
+                    log(`Received error from D-Bus search provider ${this.id} during GetResultMetas: ${error}`);
+                return [];
+            }
+
+            // Providers may drop or reorder metas, so match them to the
+            // requested ids by their own id; ids without a meta are skipped
+            const requestedIds = new Set(missingIds);
+            for (const meta of metas) {
+                for (let prop in meta) {
+                    // we can use the serialized icon variant directly
+                    if (prop !== 'icon')
+                        meta[prop] = meta[prop].deepUnpack();
+                }
+
+                const {id} = meta;
+                if (!requestedIds.has(id) || metasById.has(id))
+                    continue;
+
+                metasById.set(id, meta);
+                this._metaCache.insert(id, meta);
             }
+        }
+
+        let resultMetas = [];
+        for (const id of ids) {
+            const meta = metasById.get(id);
+            if (!meta)
+                continue;
 
             resultMetas.push({
-                id: metas[i]['id'],
-                name: metas[i]['name'],
-                description: metas[i]['description'],
-                createIcon: size => this.createIcon(size, metas[i]),
-                clipboardText: metas[i]['clipboardText'],
+                id: meta['id'],
+                name: meta['name'],
+                description: meta['description'],
+                createIcon: size => this.createIcon(size, meta),
+                clipboardText: meta['clipboardText'],
             });
         }
         return resultMetas;
@@ -319,7 +480,7 @@ class RemoteSearchProvider {
     }
 }
 
-class RemoteSearchProvider2 extends RemoteSearchProvider {
+export class RemoteSearchProvider2 extends RemoteSearchProvider {
     constructor(appInfo, dbusName, dbusPath, autoStart) {
         super(appInfo, dbusName, dbusPath, autoStart, SearchProvider2ProxyInfo);
 
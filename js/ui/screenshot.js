@@ -25,13 +25,13 @@ Gio._promisify(Shell.Screenshot.prototype, 'screenshot_area');
 Gio._promisify(Shell.Screenshot.prototype, 'screenshot_stage_to_content');
 Gio._promisify(Shell.Screenshot, 'composite_to_stream');
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 import {DBusSenderChecker} from '../misc/util.js';
 
-const ScreenshotIface = loadInterfaceXML('org.gnome.Shell.Screenshot');
+const ScreenshotIface = lookupInterfaceInfo('org.gnome.Shell.Screenshot');
 
-const ScreencastIface = loadInterfaceXML('org.gnome.Shell.Screencast');
-const ScreencastProxy = Gio.DBusProxy.makeProxyWrapper(ScreencastIface);
+const ScreencastIface = lookupInterfaceInfo('org.gnome.Shell.Screencast');
+const ScreencastProxy = makeProxyWrapper(ScreencastIface);
 
 const IconLabelButton = GObject.registerClass(
 class IconLabelButton extends St.Button {
@@ -10,7 +10,7 @@ import * as Main from './main.js';
 import * as Params from '../misc/params.js';
 import * as Util from '../misc/util.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 
 // This module provides functionality for driving the shell user interface
 // in an automated fashion. The primary current use case for this is
@@ -60,8 +60,32 @@ export function waitLeisure() {
     });
 }
 
-const PerfHelperIface = loadInterfaceXML('org.gnome.Shell.PerfHelper');
-export const PerfHelperProxy = Gio.DBusProxy.makeProxyWrapper(PerfHelperIface);
+/**
+ * Used within an automation script to measure the time it takes to paint
+ * the stage. Use as 'const time = await Scripting.measureFrame();'
+ *
+ * @returns {Promise<number>} that resolves with the time it took to
+ *   paint the next frame, in microseconds
+ */
+export function measureFrame() {
+    return new Promise(resolve => {
+        const {stage} = global;
+        let startTime = 0;
+
+        const beforeId = stage.connect('before-paint', () => {
+            startTime = GLib.get_monotonic_time();
+        });
+        const afterId = stage.connect('after-paint', () => {
+            stage.disconnect(beforeId);
+            stage.disconnect(afterId);
+            resolve(GLib.get_monotonic_time() - startTime);
+        });
+        stage.queue_redraw();
+    });
+}
+
+const PerfHelperIface = lookupInterfaceInfo('org.gnome.Shell.PerfHelper');
+export const PerfHelperProxy = makeProxyWrapper(PerfHelperIface);
 
 let _perfHelper = null;
 
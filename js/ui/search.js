@@ -14,6 +14,7 @@ import * as Main from './main.js';
 import * as ParentalControlsManager from '../misc/parentalControlsManager.js';
 import * as RemoteSearch from './remoteSearch.js';
 import {ensureActorVisibleInScrollView} from '../misc/animationUtils.js';
+import {ProviderSearchStats} from '../misc/searchStats.js';
 
 import {Highlighter} from '../misc/util.js';
 
@@ -21,6 +22,10 @@ const SEARCH_PROVIDERS_SCHEMA = 'org.gnome.desktop.search-providers';
 
 const MAX_LIST_SEARCH_RESULTS_ROWS = 5;
 
+// Time (in ms) providers get to answer a search before they stop holding
+// up the search progress indicator and count as slow
+const SEARCH_LATENCY_BUDGET = 250;
+
 const MaxWidthBox = GObject.registerClass(
 class MaxWidthBox extends St.BoxLayout {
     vfunc_allocate(box) {
@@ -591,6 +596,8 @@ export const SearchResultsView = GObject.registerClass({
         this._results = {};
 
         this._providers = [];
+        this._providerStats = new Map();
+        this._nextProviderIndex = 0;
 
         this._highlighter = new Highlighter();
 
@@ -601,6 +608,8 @@ export const SearchResultsView = GObject.registerClass({
         this._searchSettings.connect('changed::sort-order', this._reloadRemoteProviders.bind(this));
 
         this._searchTimeoutId = 0;
+        this._budgetTimeoutId = 0;
+        this._searchSerial = 0;
         this._cancellable = new Gio.Cancellable();
 
         this._registerProvider(new AppDisplay.AppSearchProvider());
@@ -626,13 +635,24 @@ export const SearchResultsView = GObject.registerClass({
 
     _registerProvider(provider) {
         provider.searchInProgress = false;
+        provider.searchLate = false;
 
         // Filter out unwanted providers.
         if (provider.appInfo && !this._parentalControlsManager.shouldShowApp(provider.appInfo))
             return;
 
+        // Keep statistics across provider reloads
+        let stats = this._providerStats.get(provider.id);
+        if (!stats) {
+            stats = new ProviderSearchStats(SEARCH_LATENCY_BUDGET);
+            this._providerStats.set(provider.id, stats);
+        }
+        provider.searchStats = stats;
+        provider.searchIndex = this._nextProviderIndex++;
+
         this._providers.push(provider);
         this._ensureProviderDisplay(provider);
+        this._sortProviders();
     }
 
     _unregisterProvider(provider) {
@@ -650,19 +670,50 @@ export const SearchResultsView = GObject.registerClass({
         }
     }
 
+    _clearBudgetTimeout() {
+        if (this._budgetTimeoutId > 0) {
+            GLib.source_remove(this._budgetTimeoutId);
+            this._budgetTimeoutId = 0;
+        }
+    }
+
     _reset() {
         this._terms = [];
         this._results = {};
         this._clearDisplay();
         this._clearSearchTimeout();
+        this._clearBudgetTimeout();
         this._defaultResult = null;
         this._startingSearch = false;
 
+        this._providers.forEach(provider => {
+            provider.searchInProgress = false;
+            provider.searchLate = false;
+        });
+
         this._updateSearchProgress();
     }
 
+    _sortProviders() {
+        // Demoted providers keep their relative order, but go after
+        // all providers that answer within the latency budget
+        this._providers.sort((a, b) => {
+            if (a.searchStats.demoted !== b.searchStats.demoted)
+                return a.searchStats.demoted ? 1 : -1;
+            return a.searchIndex - b.searchIndex;
+        });
+
+        this._providers.forEach(provider => {
+            this._content.set_child_above_sibling(provider.display, null);
+        });
+    }
+
     async _doProviderSearch(provider, previousResults) {
+        const serial = this._searchSerial;
+        const startTime = GLib.get_monotonic_time();
+
         provider.searchInProgress = true;
+        provider.searchLate = false;
 
         let results;
         if (this._isSubSearch && previousResults) {
@@ -676,10 +727,35 @@ export const SearchResultsView = GObject.registerClass({
                 this._cancellable);
         }
 
+        const latency = (GLib.get_monotonic_time() - startTime) / 1000;
+        const superseded = serial !== this._searchSerial;
+
+        // A superseded search still tells us the provider was too slow
+        // if it ran past the budget before being cancelled
+        if (!superseded || latency > SEARCH_LATENCY_BUDGET) {
+            if (provider.searchStats.record(latency))
+                this._sortProviders();
+        }
+
+        if (superseded)
+            return;
+
         this._results[provider.id] = results;
         this._updateResults(provider, results);
     }
 
+    _onBudgetTimeout() {
+        this._budgetTimeoutId = 0;
+
+        this._providers.forEach(provider => {
+            if (provider.searchInProgress)
+                provider.searchLate = true;
+        });
+        this._updateSearchProgress();
+
+        return GLib.SOURCE_REMOVE;
+    }
+
     _doSearch() {
         this._startingSearch = false;
 
@@ -691,6 +767,12 @@ export const SearchResultsView = GObject.registerClass({
             this._doProviderSearch(provider, previousProviderResults);
         });
 
+        this._clearBudgetTimeout();
+        this._budgetTimeoutId = GLib.timeout_add(GLib.PRIORITY_DEFAULT,
+            SEARCH_LATENCY_BUDGET, this._onBudgetTimeout.bind(this));
+        GLib.Source.set_name_by_id(this._budgetTimeoutId,
+            '[gnome-shell] this._onBudgetTimeout');
+
         this._updateSearchProgress();
 
         this._clearSearchTimeout();
@@ -714,6 +796,7 @@ export const SearchResultsView = GObject.registerClass({
 
         this._startingSearch = true;
 
+        this._searchSerial++;
         this._cancellable.cancel();
         this._cancellable.reset();
 
@@ -801,7 +884,17 @@ export const SearchResultsView = GObject.registerClass({
         if (this._startingSearch)
             return true;
 
-        return this._providers.some(p => p.searchInProgress);
+        // Providers that missed the latency budget no longer hold up
+        // the progress indicator; their results show up when they arrive
+        return this._providers.some(p => p.searchInProgress && !p.searchLate);
+    }
+
+    /**
+     * @returns {object} - search latency statistics, keyed by provider id
+     */
+    getProviderStats() {
+        return Object.fromEntries(
+            [...this._providerStats].map(([id, stats]) => [id, stats.toJSON()]));
     }
 
     _updateSearchProgress() {
@@ -827,6 +920,7 @@ export const SearchResultsView = GObject.registerClass({
 
         display.updateSearch(results, terms, () => {
             provider.searchInProgress = false;
+            provider.searchLate = false;
 
             this._maybeSetInitialSelection();
             this._updateSearchProgress();
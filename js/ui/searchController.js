@@ -343,6 +343,17 @@ export const SearchController = GObject.registerClass({
         this._searchResults._unregisterProvider(provider);
     }
 
+    /**
+     * getProviderStats:
+     *
+     * Get the per-provider search latency statistics.
+     *
+     * @returns {object} - statistics keyed by provider id
+     */
+    getProviderStats() {
+        return this._searchResults.getProviderStats();
+    }
+
     get searchActive() {
         return this._searchActive;
     }
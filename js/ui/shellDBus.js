@@ -11,12 +11,12 @@ import * as ExtensionUtils from '../misc/extensionUtils.js';
 import * as Main from './main.js';
 import * as Screenshot from './screenshot.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../misc/dbusInterfaces.js';
 import {DBusSenderChecker} from '../misc/util.js';
 import {ControlsState} from './overviewControls.js';
 
-const GnomeShellIface = loadInterfaceXML('org.gnome.Shell');
-const ScreenSaverIface = loadInterfaceXML('org.gnome.ScreenSaver');
+const GnomeShellIface = lookupInterfaceInfo('org.gnome.Shell');
+const ScreenSaverIface = lookupInterfaceInfo('org.gnome.ScreenSaver');
 
 export class GnomeShell {
     constructor() {
@@ -389,7 +389,7 @@ export class GnomeShell {
     }
 }
 
-const GnomeShellExtensionsIface = loadInterfaceXML('org.gnome.Shell.Extensions');
+const GnomeShellExtensionsIface = lookupInterfaceInfo('org.gnome.Shell.Extensions');
 
 class GnomeShellExtensions {
     constructor() {
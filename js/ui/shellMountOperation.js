@@ -17,7 +17,7 @@ import * as ModalDialog from './modalDialog.js';
 import * as Params from '../misc/params.js';
 import * as ShellEntry from './shellEntry.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../misc/dbusInterfaces.js';
 import {wiggle} from '../misc/animationUtils.js';
 
 const LIST_ITEM_ICON_SIZE = 48;
@@ -529,7 +529,7 @@ const ShellProcessesDialog = GObject.registerClass({
     }
 });
 
-const GnomeShellMountOpIface = loadInterfaceXML('org.Gtk.MountOperationHandler');
+const GnomeShellMountOpIface = lookupInterfaceInfo('org.Gtk.MountOperationHandler');
 
 /** @enum {number} */
 const ShellMountOperationType = {
@@ -11,15 +11,15 @@ import * as Util from '../../misc/util.js';
 
 import {Spinner} from '../animation.js';
 import {QuickToggle, SystemIndicator} from '../quickSettings.js';
-import {loadInterfaceXML} from '../../misc/dbusUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 const DBUS_NAME = 'org.freedesktop.background.Monitor';
 const DBUS_OBJECT_PATH = '/org/freedesktop/background/monitor';
 
 const SPINNER_TIMEOUT = 5; // seconds
 
-const BackgroundMonitorIface = loadInterfaceXML('org.freedesktop.background.Monitor');
-const BackgroundMonitorProxy = Gio.DBusProxy.makeProxyWrapper(BackgroundMonitorIface);
+const BackgroundMonitorIface = lookupInterfaceInfo('org.freedesktop.background.Monitor');
+const BackgroundMonitorProxy = makeProxyWrapper(BackgroundMonitorIface);
 
 Gio._promisify(Gio.DBusConnection.prototype, 'call');
 
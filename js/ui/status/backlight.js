@@ -11,13 +11,13 @@ import {QuickMenuToggle, SystemIndicator} from '../quickSettings.js';
 import * as PopupMenu from '../popupMenu.js';
 import {Slider} from '../slider.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 const BUS_NAME = 'org.gnome.SettingsDaemon.Power';
 const OBJECT_PATH = '/org/gnome/SettingsDaemon/Power';
 
-const BrightnessInterface = loadInterfaceXML('org.gnome.SettingsDaemon.Power.Keyboard');
-const BrightnessProxy = Gio.DBusProxy.makeProxyWrapper(BrightnessInterface);
+const BrightnessInterface = lookupInterfaceInfo('org.gnome.SettingsDaemon.Power.Keyboard');
+const BrightnessProxy = makeProxyWrapper(BrightnessInterface);
 
 const SliderItem = GObject.registerClass({
     Properties: {
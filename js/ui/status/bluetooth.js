@@ -12,15 +12,14 @@ import {Spinner} from '../animation.js';
 import * as PopupMenu from '../popupMenu.js';
 import {QuickMenuToggle, SystemIndicator} from '../quickSettings.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../../misc/dbusInterfaces.js';
 
 const {AdapterState} = GnomeBluetooth;
 
 const BUS_NAME = 'org.gnome.SettingsDaemon.Rfkill';
 const OBJECT_PATH = '/org/gnome/SettingsDaemon/Rfkill';
 
-const RfkillManagerInterface = loadInterfaceXML('org.gnome.SettingsDaemon.Rfkill');
-const rfkillManagerInfo = Gio.DBusInterfaceInfo.new_for_xml(RfkillManagerInterface);
+const rfkillManagerInfo = lookupInterfaceInfo('org.gnome.SettingsDaemon.Rfkill');
 
 Gio._promisify(GnomeBluetooth.Client.prototype, 'connect_service');
 
@@ -5,13 +5,13 @@ import GObject from 'gi://GObject';
 
 import {QuickSlider, SystemIndicator} from '../quickSettings.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 const BUS_NAME = 'org.gnome.SettingsDaemon.Power';
 const OBJECT_PATH = '/org/gnome/SettingsDaemon/Power';
 
-const BrightnessInterface = loadInterfaceXML('org.gnome.SettingsDaemon.Power.Screen');
-const BrightnessProxy = Gio.DBusProxy.makeProxyWrapper(BrightnessInterface);
+const BrightnessInterface = lookupInterfaceInfo('org.gnome.SettingsDaemon.Power.Screen');
+const BrightnessProxy = makeProxyWrapper(BrightnessInterface);
 
 const BrightnessItem = GObject.registerClass(
 class BrightnessItem extends QuickSlider {
@@ -12,7 +12,7 @@ import * as ModalDialog from '../modalDialog.js';
 import * as PermissionStore from '../../misc/permissionStore.js';
 import {SystemIndicator} from '../quickSettings.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 const LOCATION_SCHEMA = 'org.gnome.system.location';
 const MAX_ACCURACY_LEVEL = 'max-accuracy-level';
@@ -40,10 +40,10 @@ function accuracyLevelToString(accuracyLevel) {
     return 'NONE';
 }
 
-const GeoclueIface = loadInterfaceXML('org.freedesktop.GeoClue2.Manager');
-const GeoclueManager = Gio.DBusProxy.makeProxyWrapper(GeoclueIface);
+const GeoclueIface = lookupInterfaceInfo('org.freedesktop.GeoClue2.Manager');
+const GeoclueManager = makeProxyWrapper(GeoclueIface);
 
-const AgentIface = loadInterfaceXML('org.freedesktop.GeoClue2.Agent');
+const AgentIface = lookupInterfaceInfo('org.freedesktop.GeoClue2.Agent');
 
 let _geoclueAgent = null;
 
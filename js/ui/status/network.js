@@ -5,6 +5,7 @@ import Clutter from 'gi://Clutter';
 import Gio from 'gi://Gio';
 import GLib from 'gi://GLib';
 import GObject from 'gi://GObject';
+import Meta from 'gi://Meta';
 import NM from 'gi://NM';
 import Polkit from 'gi://Polkit';
 import St from 'gi://St';
@@ -18,7 +19,7 @@ import * as Util from '../../misc/util.js';
 import {Spinner} from '../animation.js';
 import {QuickMenuToggle, SystemIndicator} from '../quickSettings.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo} from '../../misc/dbusInterfaces.js';
 import {registerDestroyableType} from '../../misc/signalTracker.js';
 
 Gio._promisify(Gio.DBusConnection.prototype, 'call');
@@ -29,6 +30,9 @@ Gio._promisify(NM.DeviceWifi.prototype, 'request_scan_async');
 const WIFI_SCAN_FREQUENCY = 15;
 const MAX_VISIBLE_NETWORKS = 8;
 
+// Changes in signal strength smaller than this don't reorder networks
+const STRENGTH_HYSTERESIS = 10;
+
 // small optimization, to avoid using [] all the time
 const NM80211Mode = NM['80211Mode'];
 
@@ -39,8 +43,7 @@ const PortalHelperResult = {
     RECHECK: 2,
 };
 
-const PortalHelperIface = loadInterfaceXML('org.gnome.Shell.PortalHelper');
-const PortalHelperInfo = Gio.DBusInterfaceInfo.new_for_xml(PortalHelperIface);
+const PortalHelperInfo = lookupInterfaceInfo('org.gnome.Shell.PortalHelper');
 
 function signalToIcon(value) {
     if (value < 20)
@@ -168,6 +171,28 @@ class ItemSorter {
     }
 }
 
+/**
+ * Merges two sorted arrays into a new sorted array
+ *
+ * @param {Array} one - a sorted array
+ * @param {Array} two - another array, sorted by the same function
+ * @param {Function} sortFunc - the sort function
+ * @returns {Array} - the merged array
+ */
+function mergeSorted(one, two, sortFunc) {
+    const merged = [];
+    let i = 0, j = 0;
+
+    while (i < one.length && j < two.length) {
+        if (sortFunc(two[j], one[i]) < 0)
+            merged.push(two[j++]);
+        else
+            merged.push(one[i++]);
+    }
+
+    return merged.concat(one.slice(i), two.slice(j));
+}
+
 const NMMenuItem = GObject.registerClass({
     Properties: {
         'radio-mode': GObject.ParamSpec.boolean('radio-mode', '', '',
@@ -765,6 +790,10 @@ const WirelessNetwork = GObject.registerClass({
             'signal-strength', '', '',
             GObject.ParamFlags.READABLE,
             0),
+        'sort-strength': GObject.ParamSpec.uint(
+            'sort-strength', '', '',
+            GObject.ParamFlags.READABLE,
+            0),
     },
     Signals: {
         'destroy': {},
@@ -773,6 +802,34 @@ const WirelessNetwork = GObject.registerClass({
     static _securityTypes =
         Object.values(NM.UtilsSecurityType).sort((a, b) => b - a);
 
+    /**
+     * @param {NM.DeviceWifi} device - the device seeing the access point
+     * @param {NM.AccessPoint} ap - an access point
+     * @returns {string} - the key of the network @ap belongs to, or
+     *   null if it can't belong to any network
+     */
+    static getKey(device, ap) {
+        const ssid = ap.get_ssid();
+        if (!ssid)
+            return null;
+
+        const secType = WirelessNetwork._getSecurityType(device, ap);
+        if (secType === NM.UtilsSecurityType.INVALID)
+            return null;
+
+        return `${ap.mode}:${secType}:${ssid.get_data().join(',')}`;
+    }
+
+    static _getSecurityType(device, ap) {
+        const {wirelessCapabilities: caps} = device;
+        const {flags, wpaFlags, rsnFlags} = ap;
+        const haveAp = true;
+        const adHoc = ap.mode === NM80211Mode.ADHOC;
+        const bestType = WirelessNetwork._securityTypes
+            .find(t => NM.utils_security_valid(t, caps, haveAp, adHoc, flags, wpaFlags, rsnFlags));
+        return bestType ?? NM.UtilsSecurityType.INVALID;
+    }
+
     _init(device) {
         super._init();
 
@@ -788,6 +845,8 @@ const WirelessNetwork = GObject.registerClass({
         this._name = '';
         this._ssid = null;
         this._bestAp = null;
+        this._sortStrength = 0;
+        this._key = null;
         this._mode = 0;
         this._securityType = NM.UtilsSecurityType.NONE;
     }
@@ -796,6 +855,15 @@ const WirelessNetwork = GObject.registerClass({
         return this._bestAp?.strength ?? 0;
     }
 
+    // The signal strength used for sorting, which ignores small changes
+    get sort_strength() {
+        return this._sortStrength;
+    }
+
+    get key() {
+        return this._key;
+    }
+
     get name() {
         return this._name;
     }
@@ -865,6 +933,7 @@ const WirelessNetwork = GObject.registerClass({
             this._mode = ap.mode;
             this._securityType = this._getApSecurityType(ap);
             this._name = NM.utils_ssid_to_utf8(this._ssid.get_data()) || '<unknown>';
+            this._key = WirelessNetwork.getKey(this._device, ap);
 
             this.notify('name');
             this.notify('secure');
@@ -873,13 +942,11 @@ const WirelessNetwork = GObject.registerClass({
         const wasActive = this.is_active;
         this._accessPoints.add(ap);
 
-        ap.connectObject(
-            'notify::strength', () => {
-                this.notify('icon-name');
-                this.notify('signal-strength');
-                this._updateBestAp();
-            }, this);
-        this._updateBestAp();
+        ap.connectObject('notify::strength',
+            () => this._accessPointStrengthChanged(ap), this);
+
+        if (!this._bestAp || ap.strength > this._bestAp.strength)
+            this._setBestAp(ap);
 
         if (wasActive !== this.is_active)
             this.notify('is-active');
@@ -897,7 +964,9 @@ const WirelessNetwork = GObject.registerClass({
             return false;
 
         ap.disconnectObject(this);
-        this._updateBestAp();
+
+        if (ap === this._bestAp)
+            this._setBestAp(this._findBestAp());
 
         if (wasActive !== this.is_active)
             this.notify('is-active');
@@ -920,7 +989,7 @@ const WirelessNetwork = GObject.registerClass({
             return cmpAps;
 
         // place stronger connections first
-        const cmpStrength = other.signal_strength - this.signal_strength;
+        const cmpStrength = other.sort_strength - this.sort_strength;
         if (cmpStrength !== 0)
             return cmpStrength;
 
@@ -975,24 +1044,39 @@ const WirelessNetwork = GObject.registerClass({
     }
 
     _getApSecurityType(ap) {
-        const {wirelessCapabilities: caps} = this._device;
-        const {flags, wpaFlags, rsnFlags} = ap;
-        const haveAp = true;
-        const adHoc = ap.mode === NM80211Mode.ADHOC;
-        const bestType = WirelessNetwork._securityTypes
-            .find(t => NM.utils_security_valid(t, caps, haveAp, adHoc, flags, wpaFlags, rsnFlags));
-        return bestType ?? NM.UtilsSecurityType.INVALID;
+        return WirelessNetwork._getSecurityType(this._device, ap);
     }
 
-    _updateBestAp() {
-        const [bestAp] =
-            [...this._accessPoints].sort((a, b) => b.strength - a.strength);
+    _findBestAp() {
+        let bestAp = null;
+        for (const ap of this._accessPoints) {
+            if (!bestAp || ap.strength > bestAp.strength)
+                bestAp = ap;
+        }
+        return bestAp;
+    }
 
-        if (this._bestAp === bestAp)
-            return;
+    _accessPointStrengthChanged(ap) {
+        // Only fluctuations of existing access points are dampened
+        const useHysteresis = true;
+        if (ap === this._bestAp)
+            this._setBestAp(this._findBestAp(), useHysteresis);
+        else if (ap.strength > this._bestAp.strength)
+            this._setBestAp(ap, useHysteresis);
+    }
 
+    _setBestAp(bestAp, useHysteresis = false) {
         this._bestAp = bestAp;
         this.notify('icon-name');
+        this.notify('signal-strength');
+
+        const strength = this.signal_strength;
+        if (useHysteresis &&
+            Math.abs(strength - this._sortStrength) < STRENGTH_HYSTERESIS)
+            return;
+
+        this._sortStrength = strength;
+        this.notify('sort-strength');
     }
 });
 registerDestroyableType(WirelessNetwork);
@@ -1083,10 +1167,14 @@ const NMWirelessDeviceItem = GObject.registerClass({
 
         this._deviceName = '';
 
+        // Networks are kept sorted, but only the first ones are
+        // materialized as menu items; changes are batched per frame
+        this._networks = new Map();
+        this._apNetworks = new Map();
+        this._sortedNetworks = [];
+        this._dirtyNetworks = new Set();
         this._networkItems = new Map();
-        this._itemSorter = new ItemSorter({
-            sortFunc: (one, two) => one.network.compare(two.network),
-        });
+        this._updateLaterId = 0;
 
         this._client.connectObject(
             'notify::wireless-enabled', () => this.notify('icon-name'),
@@ -1099,21 +1187,16 @@ const NMWirelessDeviceItem = GObject.registerClass({
             'notify::active-connection', () => this._activeConnectionChanged(),
             'notify::available-connections', () => this._availableConnectionsChanged(),
             'state-changed', () => this.notify('is-hotspot'),
-            'access-point-added', (d, ap) => {
-                this._addAccessPoint(ap);
-                this._updateItemsVisibility();
-            },
-            'access-point-removed', (d, ap) => {
-                this._removeAccessPoint(ap);
-                this._updateItemsVisibility();
-            }, this);
+            'access-point-added', (d, ap) => this._addAccessPoint(ap),
+            'access-point-removed', (d, ap) => this._removeAccessPoint(ap),
+            this);
 
         this.bind_property('single-device-mode',
             this, 'use-submenu',
             GObject.BindingFlags.INVERT_BOOLEAN);
 
         Main.sessionMode.connectObject('updated',
-            () => this._updateItemsVisibility(),
+            () => this._queueUpdateNetworks(),
             this);
 
         for (const ap of this._device.get_access_points())
@@ -1122,10 +1205,14 @@ const NMWirelessDeviceItem = GObject.registerClass({
         this._activeApChanged();
         this._activeConnectionChanged();
         this._availableConnectionsChanged();
-        this._updateItemsVisibility();
+        this._updateNetworks();
 
         this.connect('destroy', () => {
-            for (const net of this._networkItems.keys())
+            if (this._updateLaterId)
+                global.compositor.get_laters().remove(this._updateLaterId);
+            this._updateLaterId = 0;
+
+            for (const net of this._networks.values())
                 net.destroy();
         });
     }
@@ -1218,8 +1305,11 @@ const NMWirelessDeviceItem = GObject.registerClass({
 
     _availableConnectionsChanged() {
         const connections = this._device.get_available_connections();
-        for (const net of this._networkItems.keys())
+        for (const net of this._networks.values()) {
             net.checkConnections(connections);
+            this._dirtyNetworks.add(net);
+        }
+        this._queueUpdateNetworks();
     }
 
     _addAccessPoint(ap) {
@@ -1235,62 +1325,114 @@ const NMWirelessDeviceItem = GObject.registerClass({
             return;
         }
 
-        let network = [...this._networkItems.keys()]
-            .find(n => n.checkAccessPoint(ap));
+        const key = WirelessNetwork.getKey(this._device, ap);
+        if (!key)
+            return;
 
+        let network = this._networks.get(key);
         if (!network) {
             network = new WirelessNetwork(this._device);
+            network.connectObject('notify::sort-strength',
+                () => this._networkChanged(network), this);
+            this._networks.set(key, network);
+        }
 
-            const item = new NMWirelessNetworkItem(network);
-            item.connect('activate', () => network.activate());
+        if (!network.addAccessPoint(ap))
+            return;
 
-            network.connectObject(
-                'notify::icon-name', () => this._resortItem(item),
-                'notify::is-active', () => this._resortItem(item),
-                this);
+        this._apNetworks.set(ap, network);
+        this._networkChanged(network);
+    }
 
-            const pos = this._itemSorter.upsert(item);
-            this.section.addMenuItem(item, pos);
-            this._networkItems.set(network, item);
-        }
+    _removeAccessPoint(ap) {
+        const network = this._apNetworks.get(ap);
+        if (!network)
+            return;
 
-        network.addAccessPoint(ap);
+        this._apNetworks.delete(ap);
+        network.removeAccessPoint(ap);
+        this._networkChanged(network);
     }
 
-    _removeAccessPoint(ap) {
-        const network = [...this._networkItems.keys()]
-            .find(n => n.removeAccessPoint(ap));
+    _networkChanged(network) {
+        this._dirtyNetworks.add(network);
+        this._queueUpdateNetworks();
+    }
 
-        if (!network || network.hasAccessPoints())
+    _queueUpdateNetworks() {
+        if (this._updateLaterId)
             return;
 
-        const item = this._networkItems.get(network);
-        this._itemSorter.delete(item);
-        this._networkItems.delete(network);
-
-        item?.destroy();
-        network.destroy();
+        const laters = global.compositor.get_laters();
+        this._updateLaterId = laters.add(Meta.LaterType.BEFORE_REDRAW, () => {
+            this._updateLaterId = 0;
+            this._updateNetworks();
+            return GLib.SOURCE_REMOVE;
+        });
     }
 
-    _resortItem(item) {
-        const pos = this._itemSorter.upsert(item);
-        this.section.moveMenuItem(item, pos);
+    _updateNetworks() {
+        if (this._updateLaterId)
+            global.compositor.get_laters().remove(this._updateLaterId);
+        this._updateLaterId = 0;
 
-        this._updateItemsVisibility();
+        // Take changed networks out, and merge them back in order
+        const sortFunc = (one, two) => one.compare(two);
+        const unchanged =
+            this._sortedNetworks.filter(n => !this._dirtyNetworks.has(n));
+        const changed = [];
+        const removed = [];
+
+        for (const net of this._dirtyNetworks) {
+            if (net.hasAccessPoints())
+                changed.push(net);
+            else
+                removed.push(net);
+        }
+        this._dirtyNetworks.clear();
+
+        this._sortedNetworks =
+            mergeSorted(unchanged, changed.sort(sortFunc), sortFunc);
+
+        this._updateItems();
+
+        for (const net of removed) {
+            this._networks.delete(net.key);
+            net.destroy();
+        }
     }
 
-    _updateItemsVisibility() {
+    _updateItems() {
         const {hasWindows} = Main.sessionMode;
 
-        let nVisible = 0;
-        for (const item of this._itemSorter) {
-            const {network: net} = item;
-            item.visible =
-                (hasWindows || net.hasConnections() || net.canAutoconnect()) &&
-                nVisible < MAX_VISIBLE_NETWORKS;
-            if (item.visible)
-                nVisible++;
+        const visibleNetworks = [];
+        for (const net of this._sortedNetworks) {
+            if (visibleNetworks.length === MAX_VISIBLE_NETWORKS)
+                break;
+
+            if (hasWindows || net.hasConnections() || net.canAutoconnect())
+                visibleNetworks.push(net);
         }
+
+        for (const [net, item] of this._networkItems) {
+            if (visibleNetworks.includes(net))
+                continue;
+
+            this._networkItems.delete(net);
+            item.destroy();
+        }
+
+        visibleNetworks.forEach((net, pos) => {
+            let item = this._networkItems.get(net);
+            if (!item) {
+                item = new NMWirelessNetworkItem(net);
+                item.connect('activate', () => net.activate());
+                this._networkItems.set(net, item);
+                this.section.addMenuItem(item, pos);
+            } else if (this.section.box.get_child_at_index(pos) !== item) {
+                this.section.moveMenuItem(item, pos);
+            }
+        });
     }
 
     setDeviceName(name) {
@@ -8,13 +8,13 @@ import {QuickMenuToggle, SystemIndicator} from '../quickSettings.js';
 
 import * as PopupMenu from '../popupMenu.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 const BUS_NAME = 'net.hadess.PowerProfiles';
 const OBJECT_PATH = '/net/hadess/PowerProfiles';
 
-const PowerProfilesIface = loadInterfaceXML('net.hadess.PowerProfiles');
-const PowerProfilesProxy = Gio.DBusProxy.makeProxyWrapper(PowerProfilesIface);
+const PowerProfilesIface = lookupInterfaceInfo('net.hadess.PowerProfiles');
+const PowerProfilesProxy = makeProxyWrapper(PowerProfilesIface);
 
 const PROFILE_PARAMS = {
     'performance': {
@@ -13,14 +13,14 @@ import * as Main from '../main.js';
 import * as MessageTray from '../messageTray.js';
 import {SystemIndicator} from '../quickSettings.js';
 
-import {loadInterfaceXML} from '../../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../../misc/dbusInterfaces.js';
 
 /* Keep in sync with data/org.freedesktop.bolt.xml */
 
-const BoltClientInterface = loadInterfaceXML('org.freedesktop.bolt1.Manager');
-const BoltDeviceInterface = loadInterfaceXML('org.freedesktop.bolt1.Device');
+const BoltClientInterface = lookupInterfaceInfo('org.freedesktop.bolt1.Manager');
+const BoltDeviceInterface = lookupInterfaceInfo('org.freedesktop.bolt1.Device');
 
-const BoltDeviceProxy = Gio.DBusProxy.makeProxyWrapper(BoltDeviceInterface);
+const BoltDeviceProxy = makeProxyWrapper(BoltDeviceInterface);
 
 /** @enum {string} */
 const Status = {
@@ -64,12 +64,11 @@ class Client extends Signals.EventEmitter {
     }
 
     async _getProxy() {
-        let nodeInfo = Gio.DBusNodeInfo.new_for_xml(BoltClientInterface);
         try {
             this._proxy = await Gio.DBusProxy.new(
                 Gio.DBus.system,
                 Gio.DBusProxyFlags.DO_NOT_AUTO_START,
-                nodeInfo.lookup_interface(BOLT_DBUS_CLIENT_IFACE),
+                BoltClientInterface,
                 BOLT_DBUS_NAME,
                 BOLT_DBUS_PATH,
                 BOLT_DBUS_CLIENT_IFACE,
@@ -23,7 +23,7 @@ import * as SwitchMonitor from './switchMonitor.js';
 import * as IBusManager from '../misc/ibusManager.js';
 import * as WorkspaceAnimation from './workspaceAnimation.js';
 
-import {loadInterfaceXML} from '../misc/fileUtils.js';
+import {lookupInterfaceInfo, makeProxyWrapper} from '../misc/dbusInterfaces.js';
 import * as Main from './main.js';
 
 export const SHELL_KEYBINDINGS_SCHEMA = 'org.gnome.shell.keybindings';
@@ -47,8 +47,8 @@ const MIN_NUM_WORKSPACES = 2;
 const GSD_WACOM_BUS_NAME = 'org.gnome.SettingsDaemon.Wacom';
 const GSD_WACOM_OBJECT_PATH = '/org/gnome/SettingsDaemon/Wacom';
 
-const GsdWacomIface = loadInterfaceXML('org.gnome.SettingsDaemon.Wacom');
-const GsdWacomProxy = Gio.DBusProxy.makeProxyWrapper(GsdWacomIface);
+const GsdWacomIface = lookupInterfaceInfo('org.gnome.SettingsDaemon.Wacom');
+const GsdWacomProxy = makeProxyWrapper(GsdWacomIface);
 
 const WINDOW_DIMMER_EFFECT_NAME = 'gnome-shell-window-dimmer';
 
@@ -598,6 +598,7 @@ export const ThumbnailsBox = GObject.registerClass({
         });
 
         this._delegate = this;
+        DND.addDropTarget(this);
 
         let indicator = new St.Bin({style_class: 'workspace-thumbnail-indicator'});
 
@@ -0,0 +1,40 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+#ifndef __SHELL_APP_ORDER_PRIVATE_H__
+#define __SHELL_APP_ORDER_PRIVATE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* What shell_app_compare() sorts running apps by */
+typedef struct _ShellAppOrderKey ShellAppOrderKey;
+
+struct _ShellAppOrderKey
+{
+  gboolean minimized;
+  gboolean has_windows;
+  /* Server timestamps, which wrap around */
+  guint32 last_user_time;
+};
+
+typedef struct _ShellAppOrder ShellAppOrder;
+
+ShellAppOrder  *shell_app_order_new         (void);
+void            shell_app_order_free        (ShellAppOrder          *order);
+
+void            shell_app_order_update      (ShellAppOrder          *order,
+                                             gpointer                app,
+                                             const ShellAppOrderKey *key);
+void            shell_app_order_remove      (ShellAppOrder          *order,
+                                             gpointer                app);
+
+gpointer       *shell_app_order_peek        (ShellAppOrder          *order,
+                                             guint                  *n_apps);
+guint           shell_app_order_get_serial  (ShellAppOrder          *order);
+
+int             shell_app_order_key_compare (const ShellAppOrderKey *key,
+                                             const ShellAppOrderKey *other);
+
+G_END_DECLS
+
+#endif /* __SHELL_APP_ORDER_PRIVATE_H__ */
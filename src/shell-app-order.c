@@ -0,0 +1,209 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+#include "config.h"
+
+#include "shell-app-order-private.h"
+
+/*
+ * ShellAppOrder:
+ *
+ * Keeps running apps sorted the way shell_app_compare() sorts them, so
+ * that they don't need to be sorted again whenever they are listed.
+ *
+ * Apps are repositioned as the keys they are sorted by change, which
+ * makes an update linear in the number of apps at worst. Apps with
+ * equal keys keep their relative order, and an app whose key changed
+ * is moved after the apps whose key is equal to its new one.
+ */
+struct _ShellAppOrder
+{
+  GPtrArray *apps;
+  GArray *keys; /* ShellAppOrderKey, in the same order as apps */
+
+  /* Bumped whenever apps are added, removed or reordered */
+  guint serial;
+};
+
+ShellAppOrder *
+shell_app_order_new (void)
+{
+  ShellAppOrder *order = g_new0 (ShellAppOrder, 1);
+
+  order->apps = g_ptr_array_new ();
+  order->keys = g_array_new (FALSE, FALSE, sizeof (ShellAppOrderKey));
+
+  return order;
+}
+
+void
+shell_app_order_free (ShellAppOrder *order)
+{
+  g_ptr_array_unref (order->apps);
+  g_array_unref (order->keys);
+  g_free (order);
+}
+
+/**
+ * shell_app_order_key_compare:
+ * @key: a #ShellAppOrderKey
+ * @other: another #ShellAppOrderKey
+ *
+ * Compares the keys of two running apps like shell_app_compare() compares
+ * the apps: apps with visible windows first, then apps with windows, then
+ * the app the user interacted with most recently.
+ *
+ * Returns: a negative value if @key sorts first, a positive value if
+ *   @other does, 0 if they are equal
+ */
+int
+shell_app_order_key_compare (const ShellAppOrderKey *key,
+                             const ShellAppOrderKey *other)
+{
+  if (key->minimized != other->minimized)
+    return key->minimized ? 1 : -1;
+
+  if (key->has_windows != other->has_windows)
+    return key->has_windows ? -1 : 1;
+
+  /* Like XSERVER_TIME_IS_BEFORE() in mutter */
+  if (key->last_user_time != other->last_user_time)
+    return (gint32) (key->last_user_time - other->last_user_time) > 0 ? -1 : 1;
+
+  return 0;
+}
+
+static inline ShellAppOrderKey *
+get_key (ShellAppOrder *order,
+         guint          index)
+{
+  return &g_array_index (order->keys, ShellAppOrderKey, index);
+}
+
+/* Whether the app at @index would still be sorted with @key */
+static gboolean
+is_sorted_at (ShellAppOrder          *order,
+              guint                   index,
+              const ShellAppOrderKey *key)
+{
+  if (index > 0 &&
+      shell_app_order_key_compare (get_key (order, index - 1), key) > 0)
+    return FALSE;
+
+  if (index + 1 < order->keys->len &&
+      shell_app_order_key_compare (key, get_key (order, index + 1)) > 0)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* Finds the index after the last app whose key is not after @key */
+static guint
+find_insert_index (ShellAppOrder          *order,
+                   const ShellAppOrderKey *key)
+{
+  guint low = 0, high = order->keys->len;
+
+  while (low < high)
+    {
+      guint mid = low + (high - low) / 2;
+
+      if (shell_app_order_key_compare (get_key (order, mid), key) <= 0)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+/**
+ * shell_app_order_update:
+ * @order: a #ShellAppOrder
+ * @app: an app
+ * @key: the key to sort @app by
+ *
+ * Adds @app, or repositions it if its key changed.
+ */
+void
+shell_app_order_update (ShellAppOrder          *order,
+                        gpointer                app,
+                        const ShellAppOrderKey *key)
+{
+  guint old_index, new_index;
+  gboolean found;
+
+  found = g_ptr_array_find (order->apps, app, &old_index);
+
+  if (found)
+    {
+      if (is_sorted_at (order, old_index, key))
+        {
+          *get_key (order, old_index) = *key;
+          return;
+        }
+
+      g_ptr_array_remove_index (order->apps, old_index);
+      g_array_remove_index (order->keys, old_index);
+    }
+
+  new_index = find_insert_index (order, key);
+  g_ptr_array_insert (order->apps, new_index, app);
+  g_array_insert_val (order->keys, new_index, *key);
+
+  order->serial++;
+}
+
+/**
+ * shell_app_order_remove:
+ * @order: a #ShellAppOrder
+ * @app: an app
+ *
+ * Removes @app, if it was added.
+ */
+void
+shell_app_order_remove (ShellAppOrder *order,
+                        gpointer       app)
+{
+  guint index;
+
+  if (!g_ptr_array_find (order->apps, app, &index))
+    return;
+
+  g_ptr_array_remove_index (order->apps, index);
+  g_array_remove_index (order->keys, index);
+
+  order->serial++;
+}
+
+/**
+ * shell_app_order_peek:
+ * @order: a #ShellAppOrder
+ * @n_apps: (out): return location for the number of apps
+ *
+ * Gets the sorted apps without copying them. The array is only valid
+ * until @order is next changed.
+ *
+ * Returns: the sorted apps
+ */
+gpointer *
+shell_app_order_peek (ShellAppOrder *order,
+                      guint         *n_apps)
+{
+  *n_apps = order->apps->len;
+  return order->apps->pdata;
+}
+
+/**
+ * shell_app_order_get_serial:
+ * @order: a #ShellAppOrder
+ *
+ * Gets a number that changes whenever the sorted apps change, so that
+ * lists built from them can be kept until then.
+ *
+ * Returns: the current serial
+ */
+guint
+shell_app_order_get_serial (ShellAppOrder *order)
+{
+  return order->serial;
+}
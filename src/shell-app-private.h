@@ -4,6 +4,7 @@
 
 #include "shell-app.h"
 #include "shell-app-system.h"
+#include "shell-app-order-private.h"
 
 G_BEGIN_DECLS
 
@@ -19,6 +20,8 @@ void _shell_app_add_window (ShellApp *app, MetaWindow *window);
 
 void _shell_app_remove_window (ShellApp *app, MetaWindow *window);
 
+void _shell_app_get_order_key (ShellApp *app, ShellAppOrderKey *key);
+
 G_END_DECLS
 
 #endif /* __SHELL_APP_PRIVATE_H__ */
@@ -6,4 +6,8 @@
 
 void _shell_app_system_notify_app_state_changed (ShellAppSystem *self, ShellApp *app);
 
+void _shell_app_system_notify_app_order_changed (ShellAppSystem *self, ShellApp *app);
+
+guint _shell_app_system_get_installed_serial (ShellAppSystem *self);
+
 #endif
@@ -57,10 +57,14 @@ struct _ShellAppSystem
 
 struct _ShellAppSystemPrivate {
   GHashTable *running_apps;
+  ShellAppOrder *running_order;
   GHashTable *id_to_app;
   GHashTable *startup_wm_class_to_id;
   GList *installed_apps;
 
+  /* Bumped whenever installed apps change */
+  guint installed_serial;
+
   guint rescan_icons_timeout_id;
   guint n_rescan_retries;
 };
@@ -288,6 +292,8 @@ installed_changed (ShellAppCache  *cache,
 {
   GPtrArray *windows = g_ptr_array_new ();
 
+  self->priv->installed_serial++;
+
   rescan_icon_theme (self);
   scan_startup_wm_class_to_id (self);
 
@@ -309,6 +315,7 @@ shell_app_system_init (ShellAppSystem *self)
   self->priv = priv = shell_app_system_get_instance_private (self);
 
   priv->running_apps = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) g_object_unref, NULL);
+  priv->running_order = shell_app_order_new ();
   priv->id_to_app = g_hash_table_new_full (g_str_hash, g_str_equal,
                                            NULL,
                                            (GDestroyNotify)g_object_unref);
@@ -326,6 +333,7 @@ shell_app_system_finalize (GObject *object)
   ShellAppSystem *self = SHELL_APP_SYSTEM (object);
   ShellAppSystemPrivate *priv = self->priv;
 
+  shell_app_order_free (priv->running_order);
   g_hash_table_destroy (priv->running_apps);
   g_hash_table_destroy (priv->id_to_app);
   g_hash_table_destroy (priv->startup_wm_class_to_id);
@@ -459,6 +467,169 @@ shell_app_system_lookup_desktop_wmclass (ShellAppSystem *system,
   return app;
 }
 
+static gboolean
+check_sandboxed_app_id (ShellApp   *app,
+                        const char *sandboxed_app_id)
+{
+  const char *id;
+  size_t len;
+
+  if (sandboxed_app_id == NULL)
+    return TRUE;
+
+  /* Same as checking for a "<sandboxed_app_id>." prefix */
+  id = shell_app_get_id (app);
+  len = strlen (sandboxed_app_id);
+
+  return strncmp (id, sandboxed_app_id, len) == 0 && id[len] == '.';
+}
+
+/*
+ * get_app_from_wmclass:
+ * @appsys: the #ShellAppSystem
+ * @wm_class: (nullable): the class part of WM_CLASS
+ * @wm_instance: (nullable): the instance part of WM_CLASS
+ * @sandboxed_app_id: (nullable): the Flatpak or Snap ID of the window
+ *
+ * Attempts to determine an application based on WM_CLASS.  If one
+ * can't be determined, return %NULL.
+ *
+ * Return value: (transfer none): A #ShellApp, or %NULL
+ */
+static ShellApp *
+get_app_from_wmclass (ShellAppSystem *appsys,
+                      const char     *wm_class,
+                      const char     *wm_instance,
+                      const char     *sandboxed_app_id)
+{
+  ShellApp *app;
+
+  /* Notes on the heuristics used here:
+     much of the complexity here comes from the desire to support
+     Chrome apps.
+
+     From https://bugzilla.gnome.org/show_bug.cgi?id=673657#c13
+
+     Currently chrome sets WM_CLASS as follows (the first string is the 'instance',
+     the second one is the 'class':
+
+     For the normal browser:
+     WM_CLASS(STRING) = "chromium", "Chromium"
+
+     For a bookmarked page (through 'Tools -> Create application shortcuts')
+     WM_CLASS(STRING) = "wiki.gnome.org__GnomeShell_ApplicationBased", "Chromium"
+
+     For an application from the chrome store (with a .desktop file created through
+     right click, "Create shortcuts" from Chrome's apps overview)
+     WM_CLASS(STRING) = "crx_blpcfgokakmgnkcojhhkbfbldkacnbeo", "Chromium"
+
+     The .desktop file has a matching StartupWMClass, but the name differs, e.g. for
+     the store app (youtube) there is
+
+     .local/share/applications/chrome-blpcfgokakmgnkcojhhkbfbldkacnbeo-Default.desktop
+
+     with
+
+     StartupWMClass=crx_blpcfgokakmgnkcojhhkbfbldkacnbeo
+
+     Note that chromium (but not google-chrome!) includes a StartupWMClass=chromium
+     in their .desktop file, so we must match the instance first.
+
+     Also note that in the good case (regular gtk+ app without hacks), instance and
+     class are the same except for case and there is no StartupWMClass at all.
+  */
+
+  /* first try a match from WM_CLASS (instance part) to StartupWMClass */
+  app = shell_app_system_lookup_startup_wmclass (appsys, wm_instance);
+  if (app != NULL && check_sandboxed_app_id (app, sandboxed_app_id))
+    return app;
+
+  /* then try a match from WM_CLASS to StartupWMClass */
+  app = shell_app_system_lookup_startup_wmclass (appsys, wm_class);
+  if (app != NULL && check_sandboxed_app_id (app, sandboxed_app_id))
+    return app;
+
+  /* then try a match from WM_CLASS (instance part) to .desktop */
+  app = shell_app_system_lookup_desktop_wmclass (appsys, wm_instance);
+  if (app != NULL && check_sandboxed_app_id (app, sandboxed_app_id))
+    return app;
+
+  /* finally, try a match from WM_CLASS to .desktop */
+  app = shell_app_system_lookup_desktop_wmclass (appsys, wm_class);
+  if (app != NULL && check_sandboxed_app_id (app, sandboxed_app_id))
+    return app;
+
+  return NULL;
+}
+
+/*
+ * get_app_from_id:
+ * @appsys: the #ShellAppSystem
+ * @id: (nullable): an application ID
+ *
+ * Attempts to determine an application based on @id.  If one can't
+ * be determined, return %NULL.
+ *
+ * Return value: (transfer none): A #ShellApp, or %NULL
+ */
+static ShellApp *
+get_app_from_id (ShellAppSystem *appsys,
+                 const char     *id)
+{
+  g_autofree char *desktop_file = NULL;
+
+  if (id == NULL)
+    return NULL;
+
+  desktop_file = g_strconcat (id, ".desktop", NULL);
+  return shell_app_system_lookup_app (appsys, desktop_file);
+}
+
+/**
+ * shell_app_system_resolve_window_app:
+ * @system: a #ShellAppSystem
+ * @wm_class: (nullable): the class part of WM_CLASS
+ * @wm_instance: (nullable): the instance part of WM_CLASS
+ * @gtk_application_id: (nullable): the GApplication ID
+ * @sandboxed_app_id: (nullable): the Flatpak or Snap ID
+ *
+ * Attempts to determine the application of a window based only on
+ * those of its properties that only change along with installed apps.
+ * This goes through the heuristics every time, #ShellWindowTracker
+ * remembers the results, see shell_window_tracker_lookup_app().
+ *
+ * Returns: (transfer none) (nullable): A #ShellApp, or %NULL if none
+ */
+ShellApp *
+shell_app_system_resolve_window_app (ShellAppSystem *system,
+                                     const char     *wm_class,
+                                     const char     *wm_instance,
+                                     const char     *gtk_application_id,
+                                     const char     *sandboxed_app_id)
+{
+  ShellApp *app;
+
+  /* Check if the app's WM_CLASS specifies an app; this is
+   * canonical if it does.
+   */
+  app = get_app_from_wmclass (system, wm_class, wm_instance,
+                              sandboxed_app_id);
+  if (app != NULL)
+    return app;
+
+  /* Check if the window was opened from within a sandbox; if this
+   * is the case, a corresponding .desktop file is guaranteed to match;
+   */
+  app = get_app_from_id (system, sandboxed_app_id);
+  if (app != NULL)
+    return app;
+
+  /* Check if the window has a GApplication ID attached; this is
+   * canonical if it does
+   */
+  return get_app_from_id (system, gtk_application_id);
+}
+
 /**
  * shell_app_system_lookup_startup_wmclass:
  * @system: a #ShellAppSystem
@@ -485,6 +656,22 @@ shell_app_system_lookup_startup_wmclass (ShellAppSystem *system,
   return shell_app_system_lookup_app (system, id);
 }
 
+/*
+ * _shell_app_system_get_installed_serial:
+ * @self: a #ShellAppSystem
+ *
+ * Gets a number that changes whenever installed apps change. Unlike
+ * #ShellAppSystem::installed-changed, it already changed when windows of
+ * stale apps are retracked.
+ *
+ * Returns: the current serial
+ */
+guint
+_shell_app_system_get_installed_serial (ShellAppSystem *self)
+{
+  return self->priv->installed_serial;
+}
+
 void
 _shell_app_system_notify_app_state_changed (ShellAppSystem *self,
                                             ShellApp       *app)
@@ -495,10 +682,12 @@ _shell_app_system_notify_app_state_changed (ShellAppSystem *self,
     {
     case SHELL_APP_STATE_RUNNING:
       g_hash_table_insert (self->priv->running_apps, g_object_ref (app), NULL);
+      _shell_app_system_notify_app_order_changed (self, app);
       break;
     case SHELL_APP_STATE_STARTING:
       break;
     case SHELL_APP_STATE_STOPPED:
+      shell_app_order_remove (self->priv->running_order, app);
       g_hash_table_remove (self->priv->running_apps, app);
       break;
     default:
@@ -508,6 +697,27 @@ _shell_app_system_notify_app_state_changed (ShellAppSystem *self,
   g_signal_emit (self, signals[APP_STATE_CHANGED], 0, app);
 }
 
+/*
+ * _shell_app_system_notify_app_order_changed:
+ * @self: a #ShellAppSystem
+ * @app: a #ShellApp
+ *
+ * Called when what @app is sorted by may have changed, to reposition it
+ * among the running apps.
+ */
+void
+_shell_app_system_notify_app_order_changed (ShellAppSystem *self,
+                                            ShellApp       *app)
+{
+  ShellAppOrderKey key;
+
+  if (!g_hash_table_contains (self->priv->running_apps, app))
+    return;
+
+  _shell_app_get_order_key (app, &key);
+  shell_app_order_update (self->priv->running_order, app, &key);
+}
+
 /**
  * shell_app_system_get_running:
  * @self: A #ShellAppSystem
@@ -520,23 +730,53 @@ _shell_app_system_notify_app_state_changed (ShellAppSystem *self,
 GSList *
 shell_app_system_get_running (ShellAppSystem *self)
 {
-  gpointer key, value;
+  ShellApp **apps;
   GSList *ret;
-  GHashTableIter iter;
+  guint n_apps;
 
-  g_hash_table_iter_init (&iter, self->priv->running_apps);
+  apps = shell_app_system_peek_running (self, &n_apps);
 
   ret = NULL;
-  while (g_hash_table_iter_next (&iter, &key, &value))
-    {
-      ShellApp *app = key;
+  while (n_apps > 0)
+    ret = g_slist_prepend (ret, apps[--n_apps]);
 
-      ret = g_slist_prepend (ret, app);
-    }
+  return ret;
+}
 
-  ret = g_slist_sort (ret, (GCompareFunc)shell_app_compare);
+/**
+ * shell_app_system_peek_running:
+ * @self: A #ShellAppSystem
+ * @n_apps: (out): return location for the number of running applications
+ *
+ * Like shell_app_system_get_running(), but without copying the
+ * applications. The array is owned by @self and only valid until
+ * running applications change, which is whenever the number returned
+ * by shell_app_system_get_running_serial() changes.
+ *
+ * Returns: (array length=n_apps) (transfer none): Active applications,
+ *   sorted by shell_app_compare()
+ */
+ShellApp **
+shell_app_system_peek_running (ShellAppSystem *self,
+                               guint          *n_apps)
+{
+  return (ShellApp **) shell_app_order_peek (self->priv->running_order, n_apps);
+}
 
-  return ret;
+/**
+ * shell_app_system_get_running_serial:
+ * @self: A #ShellAppSystem
+ *
+ * Gets a number that changes whenever applications start or stop
+ * running, or are reordered. Lists of running applications can be
+ * kept until then.
+ *
+ * Returns: the current serial
+ */
+guint
+shell_app_system_get_running_serial (ShellAppSystem *self)
+{
+  return shell_app_order_get_serial (self->priv->running_order);
 }
 
 /**
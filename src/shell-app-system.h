@@ -23,8 +23,16 @@ ShellApp       *shell_app_system_lookup_startup_wmclass       (ShellAppSystem *s
                                                                const char     *wmclass);
 ShellApp       *shell_app_system_lookup_desktop_wmclass       (ShellAppSystem *system,
                                                                const char     *wmclass);
+ShellApp       *shell_app_system_resolve_window_app           (ShellAppSystem *system,
+                                                               const char     *wm_class,
+                                                               const char     *wm_instance,
+                                                               const char     *gtk_application_id,
+                                                               const char     *sandboxed_app_id);
 
 GSList         *shell_app_system_get_running               (ShellAppSystem  *self);
+ShellApp      **shell_app_system_peek_running              (ShellAppSystem  *self,
+                                                            guint           *n_apps);
+guint           shell_app_system_get_running_serial        (ShellAppSystem  *self);
 char         ***shell_app_system_search                    (const char *search_string);
 
 GList          *shell_app_system_get_installed             (ShellAppSystem  *self);
@@ -39,6 +39,10 @@ typedef struct {
   /* Signal connection to dirty window sort list on workspace changes */
   gulong workspace_switch_id;
 
+  /* Signal connection to reposition the app when its windows are
+   * hidden or shown with the desktop */
+  gulong showing_desktop_id;
+
   GSList *windows;
 
   guint interesting_windows;
@@ -831,7 +835,7 @@ shell_app_is_on_workspace (ShellApp *app,
   return FALSE;
 }
 
-static int
+static guint32
 shell_app_get_last_user_time (ShellApp *app)
 {
   GSList *iter;
@@ -842,12 +846,22 @@ shell_app_get_last_user_time (ShellApp *app)
   if (app->running_state != NULL)
     {
       for (iter = app->running_state->windows; iter; iter = iter->next)
-        last_user_time = MAX (last_user_time, meta_window_get_user_time (iter->data));
+        {
+          guint32 user_time = meta_window_get_user_time (iter->data);
+
+          if (last_user_time == 0 ||
+              (gint32) (user_time - last_user_time) > 0)
+            last_user_time = user_time;
+        }
     }
 
-  return (int)last_user_time;
+  return last_user_time;
 }
 
+/* Besides a window being minimized, whether it is showing depends on
+ * its workspace showing the desktop and on its transient parents being
+ * minimized; the window tracker watches the latter.
+ */
 static gboolean
 shell_app_is_minimized (ShellApp *app)
 {
@@ -890,6 +904,16 @@ shell_app_compare (ShellApp *app,
       return 1;
     }
 
+  if (app->state == SHELL_APP_STATE_RUNNING)
+    {
+      ShellAppOrderKey app_key, other_key;
+
+      _shell_app_get_order_key (app, &app_key);
+      _shell_app_get_order_key (other, &other_key);
+
+      return shell_app_order_key_compare (&app_key, &other_key);
+    }
+
   min_app = shell_app_is_minimized (app);
   min_other = shell_app_is_minimized (other);
 
@@ -900,17 +924,30 @@ shell_app_compare (ShellApp *app,
       return 1;
     }
 
-  if (app->state == SHELL_APP_STATE_RUNNING)
-    {
-      if (app->running_state->windows && !other->running_state->windows)
-        return -1;
-      else if (!app->running_state->windows && other->running_state->windows)
-        return 1;
+  return 0;
+}
 
-      return shell_app_get_last_user_time (other) - shell_app_get_last_user_time (app);
-    }
+/*
+ * _shell_app_get_order_key:
+ * @app: a #ShellApp
+ * @key: (out): return location for the key
+ *
+ * Gets what running apps are sorted by. #ShellAppSystem is notified
+ * whenever it may have changed.
+ */
+void
+_shell_app_get_order_key (ShellApp         *app,
+                          ShellAppOrderKey *key)
+{
+  key->minimized = shell_app_is_minimized (app);
+  key->has_windows = app->running_state && app->running_state->windows != NULL;
+  key->last_user_time = shell_app_get_last_user_time (app);
+}
 
-  return 0;
+static void
+shell_app_order_changed (ShellApp *app)
+{
+  _shell_app_system_notify_app_order_changed (shell_app_system_get_default (), app);
 }
 
 ShellApp *
@@ -972,6 +1009,8 @@ shell_app_on_user_time_changed (MetaWindow *window,
 {
   g_assert (app->running_state != NULL);
 
+  shell_app_order_changed (app);
+
   /* Ideally we don't want to emit windows-changed if the sort order
    * isn't actually changing. This check catches most of those.
    */
@@ -982,6 +1021,28 @@ shell_app_on_user_time_changed (MetaWindow *window,
     }
 }
 
+static void
+shell_app_on_minimized_changed (MetaWindow *window,
+                                GParamSpec *pspec,
+                                ShellApp   *app)
+{
+  shell_app_order_changed (app);
+}
+
+static void
+shell_app_on_window_workspace_changed (MetaWindow *window,
+                                       ShellApp   *app)
+{
+  shell_app_order_changed (app);
+}
+
+static void
+shell_app_on_showing_desktop_changed (MetaWorkspaceManager *workspace_manager,
+                                      ShellApp             *app)
+{
+  shell_app_order_changed (app);
+}
+
 static void
 shell_app_sync_running_state (ShellApp *app)
 {
@@ -1133,6 +1194,9 @@ _shell_app_add_window (ShellApp        *app,
   app->running_state->windows = g_slist_prepend (app->running_state->windows, g_object_ref (window));
   g_signal_connect_object (window, "notify::user-time", G_CALLBACK(shell_app_on_user_time_changed), app, 0);
   g_signal_connect_object (window, "notify::skip-taskbar", G_CALLBACK(shell_app_on_skip_taskbar_changed), app, 0);
+  g_signal_connect_object (window, "notify::minimized", G_CALLBACK(shell_app_on_minimized_changed), app, 0);
+  g_signal_connect_object (window, "notify::transient-for", G_CALLBACK(shell_app_on_minimized_changed), app, 0);
+  g_signal_connect_object (window, "workspace-changed", G_CALLBACK(shell_app_on_window_workspace_changed), app, 0);
 
   shell_app_update_app_actions (app, window);
   shell_app_ensure_busy_watch (app);
@@ -1147,6 +1211,8 @@ _shell_app_add_window (ShellApp        *app,
 
   g_object_thaw_notify (G_OBJECT (app));
 
+  shell_app_order_changed (app);
+
   g_signal_emit (app, shell_app_signals[WINDOWS_CHANGED], 0);
 }
 
@@ -1170,6 +1236,8 @@ _shell_app_remove_window (ShellApp   *app,
 
   g_signal_handlers_disconnect_by_func (window, G_CALLBACK(shell_app_on_user_time_changed), app);
   g_signal_handlers_disconnect_by_func (window, G_CALLBACK(shell_app_on_skip_taskbar_changed), app);
+  g_signal_handlers_disconnect_by_func (window, G_CALLBACK(shell_app_on_minimized_changed), app);
+  g_signal_handlers_disconnect_by_func (window, G_CALLBACK(shell_app_on_window_workspace_changed), app);
   if (window == app->fallback_icon_window)
     {
       g_signal_handlers_disconnect_by_func (window, G_CALLBACK(on_window_icon_changed), app);
@@ -1182,6 +1250,8 @@ _shell_app_remove_window (ShellApp   *app,
 
   g_object_unref (window);
 
+  shell_app_order_changed (app);
+
   g_signal_emit (app, shell_app_signals[WINDOWS_CHANGED], 0);
 }
 
@@ -1534,6 +1604,9 @@ create_running_state (ShellApp *app)
   app->running_state->workspace_switch_id =
     g_signal_connect (workspace_manager, "workspace-switched",
                       G_CALLBACK (shell_app_on_ws_switch), app);
+  app->running_state->showing_desktop_id =
+    g_signal_connect (workspace_manager, "showing-desktop-changed",
+                      G_CALLBACK (shell_app_on_showing_desktop_changed), app);
 
   app->running_state->session = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, NULL);
   g_assert (app->running_state->session != NULL);
@@ -1590,6 +1663,7 @@ unref_running_state (ShellAppRunningState *state)
     return;
 
   g_clear_signal_handler (&state->workspace_switch_id, workspace_manager);
+  g_clear_signal_handler (&state->showing_desktop_id, workspace_manager);
 
   g_clear_object (&state->application_proxy);
 
@@ -18,6 +18,7 @@
 
 #include "shell-app-cache-private.h"
 #include "shell-util.h"
+#include "st.h"
 #include <glib/gi18n-lib.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 #include <meta/display.h>
@@ -184,6 +185,878 @@ shell_util_regex_escape (const char *str)
   return g_regex_escape_string (str, -1);
 }
 
+/* URL scanning
+ *
+ * This matches the same URLs as the regular expression from
+ * http://daringfireball.net/2010/07/improved_regex_for_matching_urls
+ * that was previously used by findUrls(), but in a single forward pass:
+ *
+ *   (^|<leading junk>)
+ *   ((?:(?:http|https|ftp)://|www\d{0,3}[.]|[a-z0-9.\-]+[.][a-z]{2,4}/)
+ *    (?:[^\s()<>]+|\([^\s()<>]+\))+
+ *    (?:\([^\s()<>]+\)|<not trailing junk>))
+ *
+ * The regular expression backtracks to the longest body that ends in
+ * balanced parentheses or in a character that isn't trailing junk, so
+ * the scanner walks the body once, remembering the last place it
+ * could have ended.
+ */
+
+typedef struct
+{
+  const char *p;
+  int utf16_pos;
+} UrlCursor;
+
+static gunichar
+url_cursor_peek (const UrlCursor *cursor,
+                 const char      *end,
+                 int             *len)
+{
+  gunichar c;
+
+  c = g_utf8_get_char_validated (cursor->p, end - cursor->p);
+  if (c == (gunichar) -1 || c == (gunichar) -2)
+    {
+      *len = 1;
+      return 0xFFFD;
+    }
+
+  *len = g_utf8_next_char (cursor->p) - cursor->p;
+  return c;
+}
+
+static gunichar
+url_cursor_next (UrlCursor  *cursor,
+                 const char *end)
+{
+  gunichar c;
+  int len;
+
+  c = url_cursor_peek (cursor, end, &len);
+  cursor->p += len;
+  cursor->utf16_pos += c > 0xFFFF ? 2 : 1;
+
+  return c;
+}
+
+/* Characters matched by \s in JavaScript regular expressions */
+static gboolean
+url_is_space (gunichar c)
+{
+  switch (c)
+    {
+    case '\t': case '\n': case '\v': case '\f': case '\r': case ' ':
+    case 0x00A0: case 0x1680: case 0x2028: case 0x2029: case 0x202F:
+    case 0x205F: case 0x3000: case 0xFEFF:
+      return TRUE;
+    default:
+      return c >= 0x2000 && c <= 0x200A;
+    }
+}
+
+/* Characters that may precede a URL */
+static gboolean
+url_is_leading_junk (gunichar c)
+{
+  switch (c)
+    {
+    case '`': case '(': case '[': case '{': case '\'': case '"': case '<':
+    case 0x00AB: case 0x201C: case 0x2018:
+      return TRUE;
+    default:
+      return url_is_space (c);
+    }
+}
+
+/* Characters allowed in the body of a URL, outside of parentheses */
+static gboolean
+url_is_body (gunichar c)
+{
+  return c != '(' && c != ')' && c != '<' && c != '>' && !url_is_space (c);
+}
+
+/* Characters a URL may end with */
+static gboolean
+url_is_not_trailing_junk (gunichar c)
+{
+  switch (c)
+    {
+    case '`': case '!': case '[': case ']': case '{': case '}': case ';':
+    case ':': case '\'': case '"': case '.': case ',': case '?':
+    case 0x00AB: case 0x00BB: case 0x200E: case 0x200F: case 0x201C:
+    case 0x201D: case 0x2018: case 0x2019: case 0x202A: case 0x202C:
+      return FALSE;
+    default:
+      return url_is_body (c);
+    }
+}
+
+static gboolean
+url_is_host (gunichar c)
+{
+  return g_ascii_isalnum (c) || c == '.' || c == '-';
+}
+
+static gboolean
+url_match_ascii (UrlCursor  *cursor,
+                 const char *end,
+                 const char *str)
+{
+  gsize len = strlen (str);
+
+  if ((gsize) (end - cursor->p) < len ||
+      g_ascii_strncasecmp (cursor->p, str, len) != 0)
+    return FALSE;
+
+  cursor->p += len;
+  cursor->utf16_pos += len;
+  return TRUE;
+}
+
+/* (?:http|https|ftp):// */
+static gboolean
+url_match_scheme (UrlCursor  *cursor,
+                  const char *end)
+{
+  UrlCursor c = *cursor;
+
+  if (!url_match_ascii (&c, end, "http://") &&
+      !url_match_ascii (&c, end, "https://") &&
+      !url_match_ascii (&c, end, "ftp://"))
+    return FALSE;
+
+  *cursor = c;
+  return TRUE;
+}
+
+/* www\d{0,3}[.] */
+static gboolean
+url_match_www (UrlCursor  *cursor,
+               const char *end)
+{
+  UrlCursor c = *cursor;
+  int i;
+
+  if (!url_match_ascii (&c, end, "www"))
+    return FALSE;
+
+  for (i = 0; i < 3 && c.p < end && g_ascii_isdigit (*c.p); i++)
+    {
+      c.p++;
+      c.utf16_pos++;
+    }
+
+  if (!url_match_ascii (&c, end, "."))
+    return FALSE;
+
+  *cursor = c;
+  return TRUE;
+}
+
+/* [a-z0-9.\-]+[.][a-z]{2,4}/
+ *
+ * The run of host characters can only end right before the slash, and
+ * the top level domain is whatever follows its last dot.
+ */
+static gboolean
+url_match_host (UrlCursor  *cursor,
+                const char *end)
+{
+  const char *p = cursor->p;
+  const char *last_dot = NULL;
+  gboolean tld_is_alpha = FALSE;
+
+  while (p < end && url_is_host (*p))
+    {
+      if (*p == '.')
+        {
+          last_dot = p;
+          tld_is_alpha = TRUE;
+        }
+      else if (!g_ascii_isalpha (*p))
+        {
+          tld_is_alpha = FALSE;
+        }
+      p++;
+    }
+
+  if (p == end || *p != '/' ||
+      last_dot == NULL || last_dot == cursor->p || !tld_is_alpha ||
+      p - last_dot - 1 < 2 || p - last_dot - 1 > 4)
+    return FALSE;
+
+  p++;
+  cursor->utf16_pos += p - cursor->p;
+  cursor->p = p;
+  return TRUE;
+}
+
+/* \([^\s()<>]+\) */
+static gboolean
+url_match_parens (UrlCursor  *cursor,
+                  const char *end)
+{
+  UrlCursor c = *cursor;
+  gunichar ch;
+  int n_chars = 0;
+  int len;
+
+  if (url_cursor_next (&c, end) != '(')
+    return FALSE;
+
+  while (c.p < end)
+    {
+      ch = url_cursor_peek (&c, end, &len);
+      if (!url_is_body (ch))
+        break;
+
+      url_cursor_next (&c, end);
+      n_chars++;
+    }
+
+  if (n_chars == 0 || c.p == end || *c.p != ')')
+    return FALSE;
+
+  url_cursor_next (&c, end);
+  *cursor = c;
+  return TRUE;
+}
+
+/* (?:[^\s()<>]+|\([^\s()<>]+\))+(?:\([^\s()<>]+\)|<not trailing junk>)
+ *
+ * Returns the end of the longest match; it must be preceded by at least
+ * one body character or balanced parentheses.
+ */
+static gboolean
+url_match_body (UrlCursor  *cursor,
+                const char *end)
+{
+  UrlCursor c = *cursor;
+  UrlCursor match_end = { NULL, 0 };
+  gboolean first = TRUE;
+  gunichar ch;
+  int len;
+
+  while (c.p < end)
+    {
+      ch = url_cursor_peek (&c, end, &len);
+
+      if (ch == '(')
+        {
+          if (!url_match_parens (&c, end))
+            break;
+
+          if (!first)
+            match_end = c;
+        }
+      else if (url_is_body (ch))
+        {
+          url_cursor_next (&c, end);
+
+          /* Characters outside the BMP are two UTF-16 code units, and
+           * the regular expression could match them separately */
+          if ((!first || ch > 0xFFFF) && url_is_not_trailing_junk (ch))
+            match_end = c;
+        }
+      else
+        {
+          break;
+        }
+
+      first = FALSE;
+    }
+
+  if (match_end.p == NULL)
+    return FALSE;
+
+  *cursor = match_end;
+  return TRUE;
+}
+
+static gboolean
+url_match (UrlCursor  *cursor,
+           const char *end)
+{
+  UrlCursor c;
+
+  c = *cursor;
+  if (url_match_scheme (&c, end) && url_match_body (&c, end))
+    goto found;
+
+  c = *cursor;
+  if (url_match_www (&c, end) && url_match_body (&c, end))
+    goto found;
+
+  c = *cursor;
+  if (url_match_host (&c, end) && url_match_body (&c, end))
+    goto found;
+
+  return FALSE;
+
+found:
+  *cursor = c;
+  return TRUE;
+}
+
+/**
+ * shell_util_find_urls:
+ * @text: a UTF-8 string to find URLs in
+ * @positions: (out) (array length=n_positions) (transfer full): return
+ *   location for the position of each URL in @text
+ * @n_positions: (out): return location for the number of URLs
+ *
+ * Finds the URLs in @text, in linear time. Positions are counted in
+ * UTF-16 code units, like the indices of JavaScript strings.
+ *
+ * Returns: (array zero-terminated=1) (transfer full): the URLs in @text
+ */
+char **
+shell_util_find_urls (const char  *text,
+                      int        **positions,
+                      int         *n_positions)
+{
+  g_autoptr (GPtrArray) urls = NULL;
+  g_autoptr (GArray) starts = NULL;
+  const char *end;
+  UrlCursor cursor = { text, 0 };
+  gboolean at_candidate = TRUE;
+
+  g_return_val_if_fail (text != NULL, NULL);
+
+  urls = g_ptr_array_new_with_free_func (g_free);
+  starts = g_array_new (FALSE, FALSE, sizeof (int));
+  end = text + strlen (text);
+
+  while (cursor.p < end)
+    {
+      UrlCursor url_end = cursor;
+
+      if (at_candidate && url_match (&url_end, end))
+        {
+          g_ptr_array_add (urls, g_strndup (cursor.p, url_end.p - cursor.p));
+          g_array_append_val (starts, cursor.utf16_pos);
+
+          /* The next URL needs leading junk of its own */
+          cursor = url_end;
+          at_candidate = FALSE;
+          continue;
+        }
+
+      at_candidate = url_is_leading_junk (url_cursor_next (&cursor, end));
+    }
+
+  g_ptr_array_set_free_func (urls, NULL);
+  g_ptr_array_add (urls, NULL);
+
+  *n_positions = starts->len;
+  *positions = (int *) g_array_free (g_steal_pointer (&starts), FALSE);
+
+  return (char **) g_ptr_array_free (g_steal_pointer (&urls), FALSE);
+}
+
+/* Compiled D-Bus interfaces
+ *
+ * The interface descriptions in data/dbus-interfaces are compiled at
+ * build time by data/gen-dbus-interfaces.py into a table of records
+ * that is bundled with them; see there for the format. Interface infos
+ * are built from it when they are first looked up, and then shared for
+ * the lifetime of the process.
+ */
+
+#define DBUS_INTERFACES_RESOURCE "gnome-shell-dbus-interfaces.gresource"
+#define DBUS_INTERFACES_TABLE "/org/gnome/shell/dbus-interfaces/dbus-interfaces.bin"
+#define DBUS_INTERFACES_MAGIC "DBI1"
+
+typedef struct
+{
+  guint32 offset;
+  guint32 length;
+} DBusTableString;
+
+typedef struct
+{
+  guint32 first;
+  guint32 n;
+} DBusTableRange;
+
+typedef struct
+{
+  char magic[4];
+  guint32 n_interfaces;
+  guint32 n_methods;
+  guint32 n_signals;
+  guint32 n_properties;
+  guint32 n_args;
+  guint32 n_annotations;
+  guint32 strings_offset;
+} DBusTableHeader;
+
+typedef struct
+{
+  DBusTableString name;
+  DBusTableRange methods;
+  DBusTableRange signals;
+  DBusTableRange properties;
+  DBusTableRange annotations;
+} DBusTableInterface;
+
+typedef struct
+{
+  DBusTableString name;
+  DBusTableRange in_args;
+  DBusTableRange out_args;
+  DBusTableRange annotations;
+} DBusTableMethod;
+
+typedef struct
+{
+  DBusTableString name;
+  DBusTableRange args;
+  DBusTableRange annotations;
+} DBusTableSignal;
+
+typedef struct
+{
+  DBusTableString name;
+  DBusTableString signature;
+  guint32 flags;
+  DBusTableRange annotations;
+} DBusTableProperty;
+
+typedef struct
+{
+  DBusTableString name;
+  DBusTableString signature;
+  DBusTableRange annotations;
+} DBusTableArg;
+
+typedef struct
+{
+  DBusTableString key;
+  DBusTableString value;
+  DBusTableRange annotations;
+} DBusTableAnnotation;
+
+typedef struct
+{
+  GBytes *bytes;
+
+  const DBusTableInterface *interfaces;
+  const DBusTableMethod *methods;
+  const DBusTableSignal *signals;
+  const DBusTableProperty *properties;
+  const DBusTableArg *args;
+  const DBusTableAnnotation *annotations;
+  const char *strings;
+
+  guint32 n_interfaces;
+  guint32 n_methods;
+  guint32 n_signals;
+  guint32 n_properties;
+  guint32 n_args;
+  guint32 n_annotations;
+  gsize strings_len;
+} DBusTable;
+
+/* Interface infos that were looked up, keyed by their name */
+static GHashTable *dbus_interface_infos = NULL;
+
+static GBytes *
+load_dbus_interfaces_table_bytes (void)
+{
+  g_autoptr (GResource) resource = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *path = NULL;
+  const char *datadir;
+  GBytes *bytes;
+
+  /* The resource is usually registered already, unless the JS code
+   * didn't need any interface XML yet */
+  bytes = g_resources_lookup_data (DBUS_INTERFACES_TABLE,
+                                   G_RESOURCE_LOOKUP_FLAGS_NONE, NULL);
+  if (bytes != NULL)
+    return bytes;
+
+  datadir = g_getenv ("GNOME_SHELL_DATADIR");
+  if (datadir == NULL)
+    datadir = GNOME_SHELL_DATADIR;
+
+  path = g_build_filename (datadir, DBUS_INTERFACES_RESOURCE, NULL);
+  resource = g_resource_load (path, &error);
+  if (resource != NULL)
+    bytes = g_resource_lookup_data (resource, DBUS_INTERFACES_TABLE,
+                                    G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+
+  if (bytes == NULL)
+    g_warning ("Failed to load compiled D-Bus interfaces: %s", error->message);
+
+  return bytes;
+}
+
+static gboolean
+dbus_table_init (DBusTable *table,
+                 GBytes    *bytes)
+{
+  const DBusTableHeader *header;
+  const guint8 *data;
+  gsize size, offset;
+
+  data = g_bytes_get_data (bytes, &size);
+  if (size < sizeof (DBusTableHeader) ||
+      memcmp (data, DBUS_INTERFACES_MAGIC, 4) != 0)
+    return FALSE;
+
+  /* Records are read in place */
+  if (GPOINTER_TO_SIZE (data) % sizeof (guint32) != 0)
+    {
+      table->bytes = g_bytes_new (data, size);
+      data = g_bytes_get_data (table->bytes, NULL);
+    }
+  else
+    {
+      table->bytes = g_bytes_ref (bytes);
+    }
+
+  header = (const DBusTableHeader *) data;
+  table->n_interfaces = GUINT32_FROM_LE (header->n_interfaces);
+  table->n_methods = GUINT32_FROM_LE (header->n_methods);
+  table->n_signals = GUINT32_FROM_LE (header->n_signals);
+  table->n_properties = GUINT32_FROM_LE (header->n_properties);
+  table->n_args = GUINT32_FROM_LE (header->n_args);
+  table->n_annotations = GUINT32_FROM_LE (header->n_annotations);
+
+  offset = sizeof (DBusTableHeader);
+  table->interfaces = (const DBusTableInterface *) (data + offset);
+  offset += (gsize) table->n_interfaces * sizeof (DBusTableInterface);
+  table->methods = (const DBusTableMethod *) (data + offset);
+  offset += (gsize) table->n_methods * sizeof (DBusTableMethod);
+  table->signals = (const DBusTableSignal *) (data + offset);
+  offset += (gsize) table->n_signals * sizeof (DBusTableSignal);
+  table->properties = (const DBusTableProperty *) (data + offset);
+  offset += (gsize) table->n_properties * sizeof (DBusTableProperty);
+  table->args = (const DBusTableArg *) (data + offset);
+  offset += (gsize) table->n_args * sizeof (DBusTableArg);
+  table->annotations = (const DBusTableAnnotation *) (data + offset);
+  offset += (gsize) table->n_annotations * sizeof (DBusTableAnnotation);
+
+  if (offset != GUINT32_FROM_LE (header->strings_offset) || offset > size)
+    {
+      g_clear_pointer (&table->bytes, g_bytes_unref);
+      return FALSE;
+    }
+
+  table->strings = (const char *) data + offset;
+  table->strings_len = size - offset;
+
+  return TRUE;
+}
+
+static DBusTable *
+ensure_dbus_table (void)
+{
+  static DBusTable table;
+  static gboolean loaded = FALSE;
+  g_autoptr (GBytes) bytes = NULL;
+
+  if (loaded)
+    return table.bytes != NULL ? &table : NULL;
+
+  loaded = TRUE;
+
+  bytes = load_dbus_interfaces_table_bytes ();
+  if (bytes != NULL && !dbus_table_init (&table, bytes))
+    g_warning ("Unexpected format of " DBUS_INTERFACES_TABLE);
+
+  return table.bytes != NULL ? &table : NULL;
+}
+
+static const char *
+dbus_table_get_string (DBusTable             *table,
+                       const DBusTableString *string,
+                       gsize                 *length)
+{
+  guint32 offset = GUINT32_FROM_LE (string->offset);
+
+  *length = GUINT32_FROM_LE (string->length);
+  g_return_val_if_fail (offset <= table->strings_len &&
+                        *length <= table->strings_len - offset, "");
+
+  return table->strings + offset;
+}
+
+static char *
+dbus_table_dup_string (DBusTable             *table,
+                       const DBusTableString *string)
+{
+  const char *str;
+  gsize length;
+
+  str = dbus_table_get_string (table, string, &length);
+  return g_strndup (str, length);
+}
+
+static int
+dbus_table_compare_string (DBusTable             *table,
+                           const DBusTableString *string,
+                           const char            *str)
+{
+  const char *table_str;
+  gsize length;
+  int cmp;
+
+  table_str = dbus_table_get_string (table, string, &length);
+
+  cmp = strncmp (table_str, str, length);
+  if (cmp != 0)
+    return cmp;
+
+  return str[length] == '\0' ? 0 : -1;
+}
+
+/* Returns the number of records in @range, and their first index in
+ * @first, or 0 if @range doesn't fit in @n_records */
+static guint32
+dbus_table_get_range (const DBusTableRange *range,
+                      guint32               n_records,
+                      guint32              *first)
+{
+  guint32 n = GUINT32_FROM_LE (range->n);
+
+  *first = GUINT32_FROM_LE (range->first);
+  g_return_val_if_fail (*first <= n_records && n <= n_records - *first, 0);
+
+  return n;
+}
+
+static GDBusAnnotationInfo **
+build_annotation_infos (DBusTable            *table,
+                        const DBusTableRange *range)
+{
+  GDBusAnnotationInfo **infos;
+  guint32 i, first, n;
+
+  n = dbus_table_get_range (range, table->n_annotations, &first);
+  infos = g_new0 (GDBusAnnotationInfo *, n + 1);
+
+  for (i = 0; i < n; i++)
+    {
+      const DBusTableAnnotation *record = &table->annotations[first + i];
+      GDBusAnnotationInfo *info = g_new0 (GDBusAnnotationInfo, 1);
+
+      info->ref_count = 1;
+      info->key = dbus_table_dup_string (table, &record->key);
+      info->value = dbus_table_dup_string (table, &record->value);
+      info->annotations = build_annotation_infos (table, &record->annotations);
+      infos[i] = info;
+    }
+
+  return infos;
+}
+
+static GDBusArgInfo **
+build_arg_infos (DBusTable            *table,
+                 const DBusTableRange *range)
+{
+  GDBusArgInfo **infos;
+  guint32 i, first, n;
+
+  n = dbus_table_get_range (range, table->n_args, &first);
+  infos = g_new0 (GDBusArgInfo *, n + 1);
+
+  for (i = 0; i < n; i++)
+    {
+      const DBusTableArg *record = &table->args[first + i];
+      GDBusArgInfo *info = g_new0 (GDBusArgInfo, 1);
+
+      info->ref_count = 1;
+      info->name = dbus_table_dup_string (table, &record->name);
+      info->signature = dbus_table_dup_string (table, &record->signature);
+      info->annotations = build_annotation_infos (table, &record->annotations);
+      infos[i] = info;
+    }
+
+  return infos;
+}
+
+static GDBusMethodInfo **
+build_method_infos (DBusTable            *table,
+                    const DBusTableRange *range)
+{
+  GDBusMethodInfo **infos;
+  guint32 i, first, n;
+
+  n = dbus_table_get_range (range, table->n_methods, &first);
+  infos = g_new0 (GDBusMethodInfo *, n + 1);
+
+  for (i = 0; i < n; i++)
+    {
+      const DBusTableMethod *record = &table->methods[first + i];
+      GDBusMethodInfo *info = g_new0 (GDBusMethodInfo, 1);
+
+      info->ref_count = 1;
+      info->name = dbus_table_dup_string (table, &record->name);
+      info->in_args = build_arg_infos (table, &record->in_args);
+      info->out_args = build_arg_infos (table, &record->out_args);
+      info->annotations = build_annotation_infos (table, &record->annotations);
+      infos[i] = info;
+    }
+
+  return infos;
+}
+
+static GDBusSignalInfo **
+build_signal_infos (DBusTable            *table,
+                    const DBusTableRange *range)
+{
+  GDBusSignalInfo **infos;
+  guint32 i, first, n;
+
+  n = dbus_table_get_range (range, table->n_signals, &first);
+  infos = g_new0 (GDBusSignalInfo *, n + 1);
+
+  for (i = 0; i < n; i++)
+    {
+      const DBusTableSignal *record = &table->signals[first + i];
+      GDBusSignalInfo *info = g_new0 (GDBusSignalInfo, 1);
+
+      info->ref_count = 1;
+      info->name = dbus_table_dup_string (table, &record->name);
+      info->args = build_arg_infos (table, &record->args);
+      info->annotations = build_annotation_infos (table, &record->annotations);
+      infos[i] = info;
+    }
+
+  return infos;
+}
+
+static GDBusPropertyInfo **
+build_property_infos (DBusTable            *table,
+                      const DBusTableRange *range)
+{
+  GDBusPropertyInfo **infos;
+  guint32 i, first, n;
+
+  n = dbus_table_get_range (range, table->n_properties, &first);
+  infos = g_new0 (GDBusPropertyInfo *, n + 1);
+
+  for (i = 0; i < n; i++)
+    {
+      const DBusTableProperty *record = &table->properties[first + i];
+      GDBusPropertyInfo *info = g_new0 (GDBusPropertyInfo, 1);
+
+      info->ref_count = 1;
+      info->name = dbus_table_dup_string (table, &record->name);
+      info->signature = dbus_table_dup_string (table, &record->signature);
+      info->flags = GUINT32_FROM_LE (record->flags);
+      info->annotations = build_annotation_infos (table, &record->annotations);
+      infos[i] = info;
+    }
+
+  return infos;
+}
+
+static GDBusInterfaceInfo *
+build_interface_info (DBusTable                *table,
+                      const DBusTableInterface *record)
+{
+  GDBusInterfaceInfo *info = g_new0 (GDBusInterfaceInfo, 1);
+
+  info->ref_count = 1;
+  info->name = dbus_table_dup_string (table, &record->name);
+  info->methods = build_method_infos (table, &record->methods);
+  info->signals = build_signal_infos (table, &record->signals);
+  info->properties = build_property_infos (table, &record->properties);
+  info->annotations = build_annotation_infos (table, &record->annotations);
+
+  return info;
+}
+
+static GDBusInterfaceInfo *
+build_dbus_interface_info (const char *interface_name)
+{
+  DBusTable *table;
+  guint32 lower, upper;
+
+  table = ensure_dbus_table ();
+  if (table == NULL)
+    return NULL;
+
+  /* Interfaces are sorted by name */
+  lower = 0;
+  upper = table->n_interfaces;
+  while (lower < upper)
+    {
+      guint32 middle = lower + (upper - lower) / 2;
+      const DBusTableInterface *record = &table->interfaces[middle];
+      int cmp;
+
+      cmp = dbus_table_compare_string (table, &record->name, interface_name);
+      if (cmp < 0)
+        lower = middle + 1;
+      else if (cmp > 0)
+        upper = middle;
+      else
+        return build_interface_info (table, record);
+    }
+
+  return NULL;
+}
+
+/**
+ * shell_util_lookup_dbus_interface_info:
+ * @interface_name: the name of a D-Bus interface
+ *
+ * Looks up the description of one of the D-Bus interfaces in
+ * gnome-shell's dbus-interfaces resource. Interfaces are compiled
+ * when gnome-shell is built, so this doesn't parse any XML, and the
+ * returned info is shared by all lookups of @interface_name.
+ *
+ * Returns: (transfer none) (nullable): the #GDBusInterfaceInfo of
+ *   @interface_name, or %NULL if it isn't known
+ */
+GDBusInterfaceInfo *
+shell_util_lookup_dbus_interface_info (const char *interface_name)
+{
+  GDBusInterfaceInfo *info;
+
+  g_return_val_if_fail (interface_name != NULL, NULL);
+
+  if (dbus_interface_infos == NULL)
+    dbus_interface_infos =
+      g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                             (GDestroyNotify) g_dbus_interface_info_unref);
+
+  info = g_hash_table_lookup (dbus_interface_infos, interface_name);
+  if (info != NULL)
+    return info;
+
+  info = build_dbus_interface_info (interface_name);
+  if (info != NULL)
+    g_hash_table_insert (dbus_interface_infos, info->name, info);
+
+  return info;
+}
+
+/**
+ * shell_util_build_dbus_interface_info:
+ * @interface_name: the name of a D-Bus interface
+ *
+ * Like shell_util_lookup_dbus_interface_info(), but builds a new info
+ * every time rather than sharing the one of earlier lookups, so that
+ * building it can be measured.
+ *
+ * Returns: (transfer full) (nullable): a new #GDBusInterfaceInfo of
+ *   @interface_name, or %NULL if it isn't known
+ */
+GDBusInterfaceInfo *
+shell_util_build_dbus_interface_info (const char *interface_name)
+{
+  g_return_val_if_fail (interface_name != NULL, NULL);
+
+  return build_dbus_interface_info (interface_name);
+}
+
 /**
  * shell_write_string_to_stream:
  * @stream: a #GOutputStream
@@ -351,6 +1224,140 @@ shell_util_create_pixbuf_from_data (const guchar      *data,
                                    (GdkPixbufDestroyNotify) g_free, NULL);
 }
 
+/* Images currently in use by notifications, keyed by a checksum of their
+ * content and target size; values are weak references. */
+static GHashTable *image_data_cache = NULL;
+
+static void
+image_data_cache_remove (gpointer  key,
+                         GObject  *where_the_object_was)
+{
+  g_hash_table_remove (image_data_cache, key);
+}
+
+static char *
+compute_image_data_key (GBytes *bytes,
+                        int     width,
+                        int     height,
+                        int     rowstride,
+                        int     has_alpha,
+                        int     max_size)
+{
+  g_autoptr (GChecksum) checksum = NULL;
+  const guchar *data;
+  gsize len;
+
+  data = g_bytes_get_data (bytes, &len);
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, data, len);
+
+  return g_strdup_printf ("%s,%dx%d,%d,%d,%d",
+                          g_checksum_get_string (checksum),
+                          width, height, rowstride, has_alpha, max_size);
+}
+
+/**
+ * shell_util_get_image_from_image_data:
+ * @image_data: a #GVariant of type `(iiibiiay)`, as sent in the
+ *   `image-data` hint of a notification
+ * @max_size: the maximum width and height of the image, in pixels
+ *
+ * Creates an image from notification image data, downscaled to fit
+ * within @max_size. The pixel data is read directly from @image_data
+ * rather than unpacked, and images with identical content share a
+ * single texture for as long as they are in use.
+ *
+ * Returns: (transfer full) (nullable): a #GIcon for the image, or %NULL
+ *   if @image_data is invalid
+ */
+GIcon *
+shell_util_get_image_from_image_data (GVariant *image_data,
+                                      int       max_size)
+{
+  g_autoptr (GVariant) data_variant = NULL;
+  g_autoptr (GBytes) bytes = NULL;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *key = NULL;
+  ClutterContent *image;
+  int width, height, rowstride, bits_per_sample, n_channels;
+  gboolean has_alpha;
+  gsize len;
+
+  g_return_val_if_fail (image_data != NULL, NULL);
+  g_return_val_if_fail (max_size > 0, NULL);
+
+  if (!g_variant_is_of_type (image_data, G_VARIANT_TYPE ("(iiibiiay)")))
+    return NULL;
+
+  g_variant_get (image_data, "(iiibii@ay)",
+                 &width, &height, &rowstride, &has_alpha,
+                 &bits_per_sample, &n_channels, &data_variant);
+
+  if (width <= 0 || height <= 0 || bits_per_sample != 8 ||
+      n_channels != (has_alpha ? 4 : 3) ||
+      rowstride < width * n_channels)
+    return NULL;
+
+  /* This references the message data rather than copying it */
+  bytes = g_variant_get_data_as_bytes (data_variant);
+  len = g_bytes_get_size (bytes);
+
+  if (len < (gsize) rowstride * (height - 1) + width * n_channels)
+    return NULL;
+
+  if (!image_data_cache)
+    image_data_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free, NULL);
+
+  key = compute_image_data_key (bytes, width, height, rowstride,
+                                has_alpha, max_size);
+
+  image = g_hash_table_lookup (image_data_cache, key);
+  if (image)
+    return G_ICON (g_object_ref (image));
+
+  pixbuf = gdk_pixbuf_new_from_bytes (bytes, GDK_COLORSPACE_RGB, has_alpha,
+                                      bits_per_sample, width, height,
+                                      rowstride);
+
+  if (width > max_size || height > max_size)
+    {
+      GdkPixbuf *scaled;
+      double scale;
+
+      scale = MIN ((double) max_size / width, (double) max_size / height);
+      width = MAX (1, (int) round (width * scale));
+      height = MAX (1, (int) round (height * scale));
+
+      scaled = gdk_pixbuf_scale_simple (pixbuf, width, height,
+                                        GDK_INTERP_BILINEAR);
+      g_set_object (&pixbuf, scaled);
+      g_object_unref (scaled);
+    }
+
+  image = st_image_content_new_with_preferred_size (width, height);
+  if (!clutter_image_set_data (CLUTTER_IMAGE (image),
+                               gdk_pixbuf_get_pixels (pixbuf),
+                               has_alpha ? COGL_PIXEL_FORMAT_RGBA_8888
+                                         : COGL_PIXEL_FORMAT_RGB_888,
+                               width, height,
+                               gdk_pixbuf_get_rowstride (pixbuf),
+                               &error))
+    {
+      g_warning ("Failed to allocate notification image: %s", error->message);
+      g_object_unref (image);
+      return NULL;
+    }
+
+  g_hash_table_insert (image_data_cache, key, image);
+  g_object_weak_ref (G_OBJECT (image), image_data_cache_remove,
+                     g_steal_pointer (&key));
+
+  return G_ICON (image);
+}
+
 typedef const gchar *(*ShellGLGetString) (GLenum);
 
 cairo_surface_t *
@@ -20,6 +20,13 @@ const char *shell_util_translate_time_string   (const char *str);
 
 char    *shell_util_regex_escape               (const char *str);
 
+char   **shell_util_find_urls                  (const char  *text,
+                                                int        **positions,
+                                                int         *n_positions);
+
+GDBusInterfaceInfo *shell_util_lookup_dbus_interface_info (const char *interface_name);
+GDBusInterfaceInfo *shell_util_build_dbus_interface_info (const char *interface_name);
+
 gboolean shell_write_string_to_stream          (GOutputStream    *stream,
                                                 const char       *str,
                                                 GError          **error);
@@ -46,6 +53,9 @@ GdkPixbuf *shell_util_create_pixbuf_from_data (const guchar      *data,
                                                int                height,
                                                int                rowstride);
 
+GIcon     *shell_util_get_image_from_image_data (GVariant *image_data,
+                                                 int       max_size);
+
 cairo_surface_t * shell_util_composite_capture_images (ClutterCapture  *captures,
                                                        int              n_captures,
                                                        int              x,
@@ -14,6 +14,7 @@
 
 #include "shell-window-tracker-private.h"
 #include "shell-app-private.h"
+#include "shell-app-system-private.h"
 #include "shell-global.h"
 #include "st.h"
 
@@ -42,8 +43,26 @@ struct _ShellWindowTracker
 
   /* <MetaWindow * window, ShellApp *app> */
   GHashTable *window_to_app;
+
+  /* <AppResolutionKey *key, ShellApp *app>, app may be %NULL */
+  GHashTable *app_resolutions;
+  guint app_resolutions_serial;
 };
 
+/* The window properties apps are resolved from, see
+ * shell_app_system_resolve_window_app() */
+typedef struct
+{
+  char *wm_class;
+  char *wm_instance;
+  char *gtk_application_id;
+  char *sandboxed_app_id;
+} AppResolutionKey;
+
+/* Resolutions are forgotten past this, in case windows keep making up
+ * new WM_CLASSes */
+#define MAX_APP_RESOLUTIONS 1024
+
 G_DEFINE_TYPE (ShellWindowTracker, shell_window_tracker, G_TYPE_OBJECT);
 
 enum {
@@ -125,173 +144,102 @@ shell_window_tracker_class_init (ShellWindowTrackerClass *klass)
                                                    G_TYPE_NONE, 0);
 }
 
-static gboolean
-check_app_id_prefix (ShellApp   *app,
-                     const char *prefix)
+static guint
+app_resolution_key_hash (gconstpointer data)
 {
-  if (prefix == NULL)
-    return TRUE;
+  const AppResolutionKey *key = data;
+  guint hash = 0;
+
+  hash = hash * 31 + (key->wm_class ? g_str_hash (key->wm_class) : 0);
+  hash = hash * 31 + (key->wm_instance ? g_str_hash (key->wm_instance) : 0);
+  hash = hash * 31 + (key->gtk_application_id ? g_str_hash (key->gtk_application_id) : 0);
+  hash = hash * 31 + (key->sandboxed_app_id ? g_str_hash (key->sandboxed_app_id) : 0);
 
-  return g_str_has_prefix (shell_app_get_id (app), prefix);
+  return hash;
 }
 
-/*
- * get_app_from_window_wmclass:
- *
- * Looks only at the given window, and attempts to determine
- * an application based on WM_CLASS.  If one can't be determined,
- * return %NULL.
- *
- * Return value: (transfer full): A newly-referenced #ShellApp, or %NULL
- */
-static ShellApp *
-get_app_from_window_wmclass (MetaWindow  *window)
+static gboolean
+app_resolution_key_equal (gconstpointer a,
+                          gconstpointer b)
 {
-  ShellApp *app;
-  ShellAppSystem *appsys;
-  const char *wm_class;
-  const char *wm_instance;
-  const char *sandbox_id;
-  g_autofree char *app_prefix = NULL;
-
-  appsys = shell_app_system_get_default ();
-
-  sandbox_id = meta_window_get_sandboxed_app_id (window);
-  if (sandbox_id)
-    app_prefix = g_strdup_printf ("%s.", sandbox_id);
-
-  /* Notes on the heuristics used here:
-     much of the complexity here comes from the desire to support
-     Chrome apps.
-
-     From https://bugzilla.gnome.org/show_bug.cgi?id=673657#c13
-
-     Currently chrome sets WM_CLASS as follows (the first string is the 'instance',
-     the second one is the 'class':
-
-     For the normal browser:
-     WM_CLASS(STRING) = "chromium", "Chromium"
-
-     For a bookmarked page (through 'Tools -> Create application shortcuts')
-     WM_CLASS(STRING) = "wiki.gnome.org__GnomeShell_ApplicationBased", "Chromium"
-
-     For an application from the chrome store (with a .desktop file created through
-     right click, "Create shortcuts" from Chrome's apps overview)
-     WM_CLASS(STRING) = "crx_blpcfgokakmgnkcojhhkbfbldkacnbeo", "Chromium"
-
-     The .desktop file has a matching StartupWMClass, but the name differs, e.g. for
-     the store app (youtube) there is
-
-     .local/share/applications/chrome-blpcfgokakmgnkcojhhkbfbldkacnbeo-Default.desktop
+  const AppResolutionKey *key_a = a;
+  const AppResolutionKey *key_b = b;
 
-     with
-
-     StartupWMClass=crx_blpcfgokakmgnkcojhhkbfbldkacnbeo
-
-     Note that chromium (but not google-chrome!) includes a StartupWMClass=chromium
-     in their .desktop file, so we must match the instance first.
-
-     Also note that in the good case (regular gtk+ app without hacks), instance and
-     class are the same except for case and there is no StartupWMClass at all.
-  */
-
-  /* first try a match from WM_CLASS (instance part) to StartupWMClass */
-  wm_instance = meta_window_get_wm_class_instance (window);
-  app = shell_app_system_lookup_startup_wmclass (appsys, wm_instance);
-  if (app != NULL && check_app_id_prefix (app, app_prefix))
-    return g_object_ref (app);
-
-  /* then try a match from WM_CLASS to StartupWMClass */
-  wm_class = meta_window_get_wm_class (window);
-  app = shell_app_system_lookup_startup_wmclass (appsys, wm_class);
-  if (app != NULL && check_app_id_prefix (app, app_prefix))
-    return g_object_ref (app);
-
-  /* then try a match from WM_CLASS (instance part) to .desktop */
-  app = shell_app_system_lookup_desktop_wmclass (appsys, wm_instance);
-  if (app != NULL && check_app_id_prefix (app, app_prefix))
-    return g_object_ref (app);
-
-  /* finally, try a match from WM_CLASS to .desktop */
-  app = shell_app_system_lookup_desktop_wmclass (appsys, wm_class);
-  if (app != NULL && check_app_id_prefix (app, app_prefix))
-    return g_object_ref (app);
-
-  return NULL;
+  return g_strcmp0 (key_a->wm_class, key_b->wm_class) == 0 &&
+         g_strcmp0 (key_a->wm_instance, key_b->wm_instance) == 0 &&
+         g_strcmp0 (key_a->gtk_application_id, key_b->gtk_application_id) == 0 &&
+         g_strcmp0 (key_a->sandboxed_app_id, key_b->sandboxed_app_id) == 0;
 }
 
-/*
- * get_app_from_id:
- * @window: a #MetaWindow
- *
- * Looks only at the given window, and attempts to determine
- * an application based on %id.  If one can't be determined,
- * return %NULL.
- *
- * Return value: (transfer full): A newly-referenced #ShellApp, or %NULL
- */
-static ShellApp *
-get_app_from_id (MetaWindow  *window,
-                 const char  *id)
+static AppResolutionKey *
+app_resolution_key_copy (const AppResolutionKey *key)
 {
-  ShellApp *app;
-  ShellAppSystem *appsys;
-  g_autofree char *desktop_file = NULL;
+  AppResolutionKey *copy = g_new0 (AppResolutionKey, 1);
 
-  g_return_val_if_fail (id != NULL, NULL);
+  copy->wm_class = g_strdup (key->wm_class);
+  copy->wm_instance = g_strdup (key->wm_instance);
+  copy->gtk_application_id = g_strdup (key->gtk_application_id);
+  copy->sandboxed_app_id = g_strdup (key->sandboxed_app_id);
 
-  appsys = shell_app_system_get_default ();
-
-  desktop_file = g_strconcat (id, ".desktop", NULL);
-  app = shell_app_system_lookup_app (appsys, desktop_file);
-  if (app)
-    return g_object_ref (app);
-
-  return NULL;
+  return copy;
 }
 
-/*
- * get_app_from_gapplication_id:
- * @window: a #MetaWindow
- *
- * Looks only at the given window, and attempts to determine
- * an application based on _GTK_APPLICATION_ID.  If one can't be determined,
- * return %NULL.
- *
- * Return value: (transfer full): A newly-referenced #ShellApp, or %NULL
- */
-static ShellApp *
-get_app_from_gapplication_id (MetaWindow  *window)
+static void
+app_resolution_key_free (AppResolutionKey *key)
 {
-  const char *id;
-
-  id = meta_window_get_gtk_application_id (window);
-  if (!id)
-    return NULL;
+  g_free (key->wm_class);
+  g_free (key->wm_instance);
+  g_free (key->gtk_application_id);
+  g_free (key->sandboxed_app_id);
+  g_free (key);
+}
 
-  return get_app_from_id (window, id);
+static void
+app_resolution_value_free (ShellApp *app)
+{
+  g_clear_object (&app);
 }
 
 /*
- * get_app_from_sandboxed_app_id:
- * @window: a #MetaWindow
+ * lookup_app_from_window_properties:
+ * @tracker: a #ShellWindowTracker
+ * @key: the properties of a window
  *
- * Looks only at the given window, and attempts to determine
- * an application based on its Flatpak or Snap ID.  If one can't be determined,
- * return %NULL.
+ * Like shell_app_system_resolve_window_app(), but remembers results
+ * (including failures to find an app) until installed apps change.
  *
- * Return value: (transfer full): A newly-referenced #ShellApp, or %NULL
+ * Return value: (transfer none): A #ShellApp, or %NULL
  */
 static ShellApp *
-get_app_from_sandboxed_app_id (MetaWindow  *window)
+lookup_app_from_window_properties (ShellWindowTracker     *tracker,
+                                   const AppResolutionKey *key)
 {
-  const char *id;
+  ShellAppSystem *appsys = shell_app_system_get_default ();
+  ShellApp *app;
+  guint serial;
 
-  id = meta_window_get_sandboxed_app_id (window);
-  if (!id)
-    return NULL;
+  serial = _shell_app_system_get_installed_serial (appsys);
+  if (serial != tracker->app_resolutions_serial ||
+      g_hash_table_size (tracker->app_resolutions) >= MAX_APP_RESOLUTIONS)
+    {
+      g_hash_table_remove_all (tracker->app_resolutions);
+      tracker->app_resolutions_serial = serial;
+    }
+
+  if (g_hash_table_lookup_extended (tracker->app_resolutions, key,
+                                    NULL, (gpointer *) &app))
+    return app;
+
+  app = shell_app_system_resolve_window_app (appsys,
+                                             key->wm_class,
+                                             key->wm_instance,
+                                             key->gtk_application_id,
+                                             key->sandboxed_app_id);
+  g_hash_table_insert (tracker->app_resolutions,
+                       app_resolution_key_copy (key),
+                       app ? g_object_ref (app) : NULL);
 
-  return get_app_from_id (window, id);
+  return app;
 }
 
 /*
@@ -390,6 +338,7 @@ get_app_for_window (ShellWindowTracker    *tracker,
   ShellApp *result = NULL;
   MetaWindow *transient_for;
   const char *startup_id;
+  AppResolutionKey key;
 
   transient_for = meta_window_get_transient_for (window);
   if (transient_for != NULL)
@@ -419,26 +368,14 @@ get_app_for_window (ShellWindowTracker    *tracker,
       g_strcmp0 (meta_window_get_title (window), "OpenGL Renderer") == 0)
     return NULL;
 
-  /* Check if the app's WM_CLASS specifies an app; this is
-   * canonical if it does.
-   */
-  result = get_app_from_window_wmclass (window);
-  if (result != NULL)
-    return result;
+  key.wm_class = (char *) meta_window_get_wm_class (window);
+  key.wm_instance = (char *) meta_window_get_wm_class_instance (window);
+  key.gtk_application_id = (char *) meta_window_get_gtk_application_id (window);
+  key.sandboxed_app_id = (char *) meta_window_get_sandboxed_app_id (window);
 
-  /* Check if the window was opened from within a sandbox; if this
-   * is the case, a corresponding .desktop file is guaranteed to match;
-   */
-  result = get_app_from_sandboxed_app_id (window);
+  result = lookup_app_from_window_properties (tracker, &key);
   if (result != NULL)
-    return result;
-
-  /* Check if the window has a GApplication ID attached; this is
-   * canonical if it does
-   */
-  result = get_app_from_gapplication_id (window);
-  if (result != NULL)
-    return result;
+    return g_object_ref (result);
 
   result = get_app_from_window_pid (tracker, window);
   if (result != NULL)
@@ -549,6 +486,30 @@ on_gtk_application_id_changed (MetaWindow  *window,
   tracked_window_changed (self, window);
 }
 
+static gboolean
+notify_transient_app_order (MetaWindow *transient,
+                            gpointer    user_data)
+{
+  ShellWindowTracker *self = SHELL_WINDOW_TRACKER (user_data);
+  ShellApp *app;
+
+  app = g_hash_table_lookup (self->window_to_app, transient);
+  if (app)
+    _shell_app_system_notify_app_order_changed (shell_app_system_get_default (), app);
+
+  return TRUE;
+}
+
+static void
+on_minimized_changed (MetaWindow  *window,
+                      GParamSpec  *pspec,
+                      gpointer     user_data)
+{
+  /* Transients of a minimized window aren't showing either, whichever
+   * app they belong to */
+  meta_window_foreach_transient (window, notify_transient_app_order, user_data);
+}
+
 static void
 on_window_unmanaged (MetaWindow *window,
                      gpointer    user_data)
@@ -572,6 +533,7 @@ track_window (ShellWindowTracker *self,
   g_signal_connect (window, "notify::wm-class", G_CALLBACK (on_wm_class_changed), self);
   g_signal_connect (window, "notify::title", G_CALLBACK (on_title_changed), self);
   g_signal_connect (window, "notify::gtk-application-id", G_CALLBACK (on_gtk_application_id_changed), self);
+  g_signal_connect (window, "notify::minimized", G_CALLBACK (on_minimized_changed), self);
   g_signal_connect (window, "unmanaged", G_CALLBACK (on_window_unmanaged), self);
 
   _shell_app_add_window (app, window);
@@ -605,6 +567,7 @@ disassociate_window (ShellWindowTracker   *self,
   g_signal_handlers_disconnect_by_func (window, G_CALLBACK (on_wm_class_changed), self);
   g_signal_handlers_disconnect_by_func (window, G_CALLBACK (on_title_changed), self);
   g_signal_handlers_disconnect_by_func (window, G_CALLBACK (on_gtk_application_id_changed), self);
+  g_signal_handlers_disconnect_by_func (window, G_CALLBACK (on_minimized_changed), self);
   g_signal_handlers_disconnect_by_func (window, G_CALLBACK (on_window_unmanaged), self);
 
   g_signal_emit (self, signals[TRACKED_WINDOWS_CHANGED], 0);
@@ -676,6 +639,10 @@ shell_window_tracker_init (ShellWindowTracker *self)
 
   self->window_to_app = g_hash_table_new_full (g_direct_hash, g_direct_equal,
                                                NULL, (GDestroyNotify) g_object_unref);
+  self->app_resolutions =
+    g_hash_table_new_full (app_resolution_key_hash, app_resolution_key_equal,
+                           (GDestroyNotify) app_resolution_key_free,
+                           (GDestroyNotify) app_resolution_value_free);
 
 
   g_signal_connect (sn, "changed",
@@ -694,6 +661,7 @@ shell_window_tracker_finalize (GObject *object)
   ShellWindowTracker *self = SHELL_WINDOW_TRACKER (object);
 
   g_hash_table_destroy (self->window_to_app);
+  g_hash_table_destroy (self->app_resolutions);
 
   G_OBJECT_CLASS (shell_window_tracker_parent_class)->finalize(object);
 }
@@ -732,13 +700,16 @@ ShellApp *
 shell_window_tracker_get_app_from_pid (ShellWindowTracker *tracker,
                                        int                 pid)
 {
-  GSList *running = shell_app_system_get_running (shell_app_system_get_default());
-  GSList *iter;
+  ShellApp **running;
   ShellApp *result = NULL;
+  guint n_running, i;
+
+  running = shell_app_system_peek_running (shell_app_system_get_default (),
+                                           &n_running);
 
-  for (iter = running; iter; iter = iter->next)
+  for (i = 0; i < n_running; i++)
     {
-      ShellApp *app = iter->data;
+      ShellApp *app = running[i];
       GSList *pids = shell_app_get_pids (app);
       GSList *pids_iter;
 
@@ -757,8 +728,6 @@ shell_window_tracker_get_app_from_pid (ShellWindowTracker *tracker,
         break;
     }
 
-  g_slist_free (running);
-
   return result;
 }
 
@@ -823,6 +792,39 @@ shell_startup_sequence_get_app (MetaStartupSequence *sequence)
   return app;
 }
 
+/**
+ * shell_window_tracker_lookup_app:
+ * @tracker: a #ShellWindowTracker
+ * @wm_class: (nullable): the class part of WM_CLASS
+ * @wm_instance: (nullable): the instance part of WM_CLASS
+ * @gtk_application_id: (nullable): the GApplication ID
+ * @sandboxed_app_id: (nullable): the Flatpak or Snap ID
+ *
+ * Looks up the application a window with the given properties belongs
+ * to, like for the windows the tracker associates with applications,
+ * but without looking at other windows or running processes.
+ *
+ * Returns: (transfer none) (nullable): A #ShellApp, or %NULL if none
+ */
+ShellApp *
+shell_window_tracker_lookup_app (ShellWindowTracker *tracker,
+                                 const char         *wm_class,
+                                 const char         *wm_instance,
+                                 const char         *gtk_application_id,
+                                 const char         *sandboxed_app_id)
+{
+  AppResolutionKey key = {
+    .wm_class = (char *) wm_class,
+    .wm_instance = (char *) wm_instance,
+    .gtk_application_id = (char *) gtk_application_id,
+    .sandboxed_app_id = (char *) sandboxed_app_id,
+  };
+
+  g_return_val_if_fail (SHELL_IS_WINDOW_TRACKER (tracker), NULL);
+
+  return lookup_app_from_window_properties (tracker, &key);
+}
+
 /**
  * shell_window_tracker_get_default:
  *
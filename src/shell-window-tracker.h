@@ -24,6 +24,12 @@ ShellApp *shell_window_tracker_get_app_from_pid (ShellWindowTracker *tracker, in
 
 GSList *shell_window_tracker_get_startup_sequences (ShellWindowTracker *tracker);
 
+ShellApp *shell_window_tracker_lookup_app (ShellWindowTracker *tracker,
+                                           const char         *wm_class,
+                                           const char         *wm_instance,
+                                           const char         *gtk_application_id,
+                                           const char         *sandboxed_app_id);
+
 G_END_DECLS
 
 #endif /* __SHELL_WINDOW_TRACKER_H__ */
@@ -24,6 +24,10 @@
  * #StCliboard is a very simple object representation of the clipboard
  * available to applications. Text is always assumed to be UTF-8 and non-text
  * items are not handled.
+ *
+ * Clipboard contents are provided by other clients, and may be arbitrarily
+ * large. The asynchronous transfer functions take a maximum size, so that
+ * only as much data as will be used is read into memory.
  */
 
 #include "config.h"
@@ -39,12 +43,36 @@ G_DEFINE_TYPE (StClipboard, st_clipboard, G_TYPE_OBJECT)
 typedef struct _TransferData TransferData;
 struct _TransferData
 {
-  StClipboard            *clipboard;
+  GOutputStream          *stream;
+  StClipboardTransferFlags flags;
+  gboolean                truncated;
+};
+
+typedef struct _CallbackData CallbackData;
+struct _CallbackData
+{
   GCallback               callback;
   gpointer                user_data;
-  GOutputStream          *stream;
 };
 
+/* Output stream passing at most a given number of bytes through to
+ * its base stream, and recording whether more were written to it. */
+#define ST_TYPE_LIMIT_OUTPUT_STREAM (st_limit_output_stream_get_type ())
+G_DECLARE_FINAL_TYPE (StLimitOutputStream, st_limit_output_stream,
+                      ST, LIMIT_OUTPUT_STREAM, GFilterOutputStream)
+
+struct _StLimitOutputStream
+{
+  GFilterOutputStream parent;
+
+  gsize limit;
+  gsize written;
+  gboolean overflow;
+};
+
+G_DEFINE_TYPE (StLimitOutputStream, st_limit_output_stream,
+               G_TYPE_FILTER_OUTPUT_STREAM)
+
 const char *supported_mimetypes[] = {
   "text/plain;charset=utf-8",
   "UTF8_STRING",
@@ -54,6 +82,61 @@ const char *supported_mimetypes[] = {
 
 static MetaSelection *meta_selection = NULL;
 
+static gssize
+st_limit_output_stream_write (GOutputStream  *stream,
+                              const void     *buffer,
+                              gsize           count,
+                              GCancellable   *cancellable,
+                              GError        **error)
+{
+  StLimitOutputStream *self = ST_LIMIT_OUTPUT_STREAM (stream);
+  GOutputStream *base_stream;
+  gsize to_write;
+
+  to_write = MIN (count, self->limit - self->written);
+  if (to_write < count)
+    self->overflow = TRUE;
+
+  base_stream = g_filter_output_stream_get_base_stream (G_FILTER_OUTPUT_STREAM (self));
+  if (to_write > 0 &&
+      !g_output_stream_write_all (base_stream, buffer, to_write,
+                                  NULL, cancellable, error))
+    return -1;
+
+  self->written += to_write;
+
+  /* Swallow what goes over the limit, the transfer is stopped shortly
+   * after anyway (see st_clipboard_transfer_async()) */
+  return count;
+}
+
+static void
+st_limit_output_stream_class_init (StLimitOutputStreamClass *klass)
+{
+  GOutputStreamClass *stream_class = G_OUTPUT_STREAM_CLASS (klass);
+
+  stream_class->write_fn = st_limit_output_stream_write;
+}
+
+static void
+st_limit_output_stream_init (StLimitOutputStream *self)
+{
+}
+
+static GOutputStream *
+st_limit_output_stream_new (GOutputStream *base_stream,
+                            gsize          limit)
+{
+  StLimitOutputStream *self;
+
+  self = g_object_new (ST_TYPE_LIMIT_OUTPUT_STREAM,
+                       "base-stream", base_stream,
+                       NULL);
+  self->limit = limit;
+
+  return G_OUTPUT_STREAM (self);
+}
+
 static void
 st_clipboard_class_init (StClipboardClass *klass)
 {
@@ -123,44 +206,360 @@ pick_mimetype (MetaSelection     *meta_selection,
   return selected_mimetype;
 }
 
+static void
+transfer_data_free (TransferData *data)
+{
+  g_clear_object (&data->stream);
+  g_free (data);
+}
+
 static void
 transfer_cb (MetaSelection *selection,
              GAsyncResult  *res,
-             TransferData  *data)
+             GTask         *task)
 {
-  gchar *text = NULL;
+  TransferData *data = g_task_get_task_data (task);
+  GError *error = NULL;
 
-  if (meta_selection_transfer_finish (selection, res, NULL))
+  if (!meta_selection_transfer_finish (selection, res, &error))
     {
-      gsize data_size;
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  if (ST_IS_LIMIT_OUTPUT_STREAM (data->stream))
+    data->truncated = ST_LIMIT_OUTPUT_STREAM (data->stream)->overflow;
+
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+/**
+ * st_clipboard_transfer_async:
+ * @clipboard: A #StClipboard
+ * @type: The type of clipboard data you want
+ * @mimetype: The mimetype to get content for
+ * @max_size: The maximum number of bytes to transfer, or -1 for no limit
+ * @flags: #StClipboardTransferFlags for the transfer
+ * @output: The stream to write the content to
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): function to call when the transfer is done
+ * @user_data: the data to pass to @callback
+ *
+ * Writes the clipboard content of type @mimetype to @output, as it is
+ * received from the clipboard owner.
+ *
+ * If the content is larger than @max_size, the transfer is stopped after
+ * @max_size bytes have been written to @output. It then fails with
+ * %G_IO_ERROR_MESSAGE_TOO_LARGE, unless %ST_CLIPBOARD_TRANSFER_TRUNCATE
+ * is in @flags.
+ */
+void
+st_clipboard_transfer_async (StClipboard              *clipboard,
+                             StClipboardType           type,
+                             const char               *mimetype,
+                             gssize                    max_size,
+                             StClipboardTransferFlags  flags,
+                             GOutputStream            *output,
+                             GCancellable             *cancellable,
+                             GAsyncReadyCallback       callback,
+                             gpointer                  user_data)
+{
+  MetaSelectionType selection_type;
+  TransferData *data;
+  GTask *task;
+  gssize transfer_size = -1;
 
-      data_size =
-        g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (data->stream));
-      text = g_new0 (char, data_size + 1);
-      memcpy (text, g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (data->stream)), data_size);
+  g_return_if_fail (ST_IS_CLIPBOARD (clipboard));
+  g_return_if_fail (meta_selection != NULL);
+  g_return_if_fail (mimetype != NULL);
+  g_return_if_fail (G_IS_OUTPUT_STREAM (output));
+
+  task = g_task_new (clipboard, cancellable, callback, user_data);
+  g_task_set_source_tag (task, st_clipboard_transfer_async);
+
+  if (!convert_type (type, &selection_type))
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                               "Invalid clipboard type %d", type);
+      g_object_unref (task);
+      return;
     }
 
-  ((StClipboardCallbackFunc) data->callback) (data->clipboard, text,
-                                              data->user_data);
-  g_object_unref (data->stream);
-  g_free (data);
-  g_free (text);
+  data = g_new0 (TransferData, 1);
+  data->flags = flags;
+  g_task_set_task_data (task, data, (GDestroyNotify) transfer_data_free);
+
+  if (max_size >= 0)
+    {
+      /* Ask for one more byte than allowed, to tell whether the
+       * content was cut short */
+      data->stream = st_limit_output_stream_new (output, max_size);
+      transfer_size = max_size + 1;
+    }
+  else
+    {
+      data->stream = g_object_ref (output);
+    }
+
+  meta_selection_transfer_async (meta_selection,
+                                 selection_type,
+                                 mimetype, transfer_size,
+                                 data->stream, cancellable,
+                                 (GAsyncReadyCallback) transfer_cb,
+                                 task);
+}
+
+/**
+ * st_clipboard_transfer_finish:
+ * @clipboard: A #StClipboard
+ * @result: the #GAsyncResult that was provided to the callback
+ * @truncated: (out) (optional): return location for whether the content
+ *   was truncated to the maximum size
+ * @error: #GError for error reporting
+ *
+ * Finishes a transfer started with st_clipboard_transfer_async().
+ *
+ * Returns: whether the transfer succeeded
+ */
+gboolean
+st_clipboard_transfer_finish (StClipboard   *clipboard,
+                              GAsyncResult  *result,
+                              gboolean      *truncated,
+                              GError       **error)
+{
+  TransferData *data;
+
+  g_return_val_if_fail (ST_IS_CLIPBOARD (clipboard), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, clipboard), FALSE);
+  g_return_val_if_fail (g_async_result_is_tagged (result,
+                                                  st_clipboard_transfer_async),
+                        FALSE);
+
+  if (truncated)
+    *truncated = FALSE;
+
+  if (!g_task_propagate_boolean (G_TASK (result), error))
+    return FALSE;
+
+  data = g_task_get_task_data (G_TASK (result));
+
+  if (data->truncated && (data->flags & ST_CLIPBOARD_TRANSFER_TRUNCATE) == 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_MESSAGE_TOO_LARGE,
+                   "Clipboard content exceeds %" G_GSIZE_FORMAT " bytes",
+                   ST_LIMIT_OUTPUT_STREAM (data->stream)->limit);
+      return FALSE;
+    }
+
+  if (truncated)
+    *truncated = data->truncated;
+
+  return TRUE;
 }
 
 static void
-transfer_bytes_cb (MetaSelection *selection,
-                   GAsyncResult  *res,
-                   TransferData  *data)
+get_text_cb (StClipboard  *clipboard,
+             GAsyncResult *res,
+             GTask        *task)
 {
-  GBytes *bytes = NULL;
+  GMemoryOutputStream *stream = g_task_get_task_data (task);
+  gboolean truncated;
+  GError *error = NULL;
+  gsize size;
+  char *text;
 
-  if (meta_selection_transfer_finish (selection, res, NULL))
-    bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (data->stream));
+  if (!st_clipboard_transfer_finish (clipboard, res, &truncated, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
 
-  ((StClipboardContentCallbackFunc) data->callback) (data->clipboard, bytes,
-                                                     data->user_data);
-  g_object_unref (data->stream);
-  g_clear_pointer (&bytes, g_bytes_unref);
+  /* Take over the stream buffer rather than copying it */
+  g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, NULL);
+  size = g_memory_output_stream_get_data_size (stream);
+  text = g_realloc (g_memory_output_stream_steal_data (stream), size + 1);
+  text[size] = '\0';
+
+  if (truncated && size > 0)
+    {
+      char *last = g_utf8_find_prev_char (text, text + size);
+
+      /* Don't leave a partial character at the end */
+      if (last &&
+          g_utf8_get_char_validated (last, text + size - last) == (gunichar) -2)
+        *last = '\0';
+    }
+
+  g_task_return_pointer (task, text, g_free);
+  g_object_unref (task);
+}
+
+/**
+ * st_clipboard_get_text_async:
+ * @clipboard: A #StClipboard
+ * @type: The type of clipboard data you want
+ * @max_size: The maximum size of the text in bytes, or -1 for no limit
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): function to call when the text is retrieved
+ * @user_data: the data to pass to @callback
+ *
+ * Request the data from the clipboard in text form. Text larger than
+ * @max_size is truncated, without reading the rest of it.
+ */
+void
+st_clipboard_get_text_async (StClipboard         *clipboard,
+                             StClipboardType      type,
+                             gssize               max_size,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+  MetaSelectionType selection_type;
+  const char *mimetype = NULL;
+  GOutputStream *stream;
+  GTask *task;
+
+  g_return_if_fail (ST_IS_CLIPBOARD (clipboard));
+  g_return_if_fail (meta_selection != NULL);
+
+  task = g_task_new (clipboard, cancellable, callback, user_data);
+  g_task_set_source_tag (task, st_clipboard_get_text_async);
+
+  if (convert_type (type, &selection_type))
+    mimetype = pick_mimetype (meta_selection, selection_type);
+
+  if (!mimetype)
+    {
+      g_task_return_pointer (task, NULL, NULL);
+      g_object_unref (task);
+      return;
+    }
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_task_set_task_data (task, stream, g_object_unref);
+
+  st_clipboard_transfer_async (clipboard, type, mimetype, max_size,
+                               ST_CLIPBOARD_TRANSFER_TRUNCATE,
+                               stream, cancellable,
+                               (GAsyncReadyCallback) get_text_cb,
+                               task);
+}
+
+/**
+ * st_clipboard_get_text_finish:
+ * @clipboard: A #StClipboard
+ * @result: the #GAsyncResult that was provided to the callback
+ * @error: #GError for error reporting
+ *
+ * Finishes a request started with st_clipboard_get_text_async().
+ *
+ * Returns: (transfer full) (nullable): the clipboard text, or %NULL if
+ *   there is no text on the clipboard or on error
+ */
+char *
+st_clipboard_get_text_finish (StClipboard   *clipboard,
+                              GAsyncResult  *result,
+                              GError       **error)
+{
+  g_return_val_if_fail (ST_IS_CLIPBOARD (clipboard), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, clipboard), NULL);
+  g_return_val_if_fail (g_async_result_is_tagged (result,
+                                                  st_clipboard_get_text_async),
+                        NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+get_content_cb (StClipboard  *clipboard,
+                GAsyncResult *res,
+                GTask        *task)
+{
+  GMemoryOutputStream *stream = g_task_get_task_data (task);
+  GError *error = NULL;
+
+  if (!st_clipboard_transfer_finish (clipboard, res, NULL, &error))
+    {
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, NULL);
+  g_task_return_pointer (task,
+                         g_memory_output_stream_steal_as_bytes (stream),
+                         (GDestroyNotify) g_bytes_unref);
+  g_object_unref (task);
+}
+
+/**
+ * st_clipboard_get_content_async:
+ * @clipboard: A #StClipboard
+ * @type: The type of clipboard data you want
+ * @mimetype: The mimetype to get content for
+ * @max_size: The maximum size of the content in bytes, or -1 for no limit
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): function to call when the content is retrieved
+ * @user_data: the data to pass to @callback
+ *
+ * Request the data from the clipboard in #GBytes form. The request fails
+ * with %G_IO_ERROR_MESSAGE_TOO_LARGE if the content is larger than
+ * @max_size.
+ */
+void
+st_clipboard_get_content_async (StClipboard         *clipboard,
+                                StClipboardType      type,
+                                const char          *mimetype,
+                                gssize               max_size,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  GOutputStream *stream;
+  GTask *task;
+
+  g_return_if_fail (ST_IS_CLIPBOARD (clipboard));
+  g_return_if_fail (meta_selection != NULL);
+  g_return_if_fail (mimetype != NULL);
+
+  task = g_task_new (clipboard, cancellable, callback, user_data);
+  g_task_set_source_tag (task, st_clipboard_get_content_async);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_task_set_task_data (task, stream, g_object_unref);
+
+  st_clipboard_transfer_async (clipboard, type, mimetype, max_size,
+                               ST_CLIPBOARD_TRANSFER_NONE,
+                               stream, cancellable,
+                               (GAsyncReadyCallback) get_content_cb,
+                               task);
+}
+
+/**
+ * st_clipboard_get_content_finish:
+ * @clipboard: A #StClipboard
+ * @result: the #GAsyncResult that was provided to the callback
+ * @error: #GError for error reporting
+ *
+ * Finishes a request started with st_clipboard_get_content_async().
+ *
+ * Returns: (transfer full): the clipboard content, or %NULL on error
+ */
+GBytes *
+st_clipboard_get_content_finish (StClipboard   *clipboard,
+                                 GAsyncResult  *result,
+                                 GError       **error)
+{
+  g_return_val_if_fail (ST_IS_CLIPBOARD (clipboard), NULL);
+  g_return_val_if_fail (g_task_is_valid (result, clipboard), NULL);
+  g_return_val_if_fail (g_async_result_is_tagged (result,
+                                                  st_clipboard_get_content_async),
+                        NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
 }
 
 /**
@@ -186,6 +585,20 @@ st_clipboard_get_mimetypes (StClipboard     *clipboard,
   return meta_selection_get_mimetypes (meta_selection, selection_type);
 }
 
+static void
+get_text_callback_cb (StClipboard  *clipboard,
+                      GAsyncResult *res,
+                      CallbackData *data)
+{
+  char *text;
+
+  text = st_clipboard_get_text_finish (clipboard, res, NULL);
+  ((StClipboardCallbackFunc) data->callback) (clipboard, text,
+                                              data->user_data);
+  g_free (text);
+  g_free (data);
+}
+
 /**
  * st_clipboard_get_text:
  * @clipboard: A #StCliboard
@@ -195,6 +608,8 @@ st_clipboard_get_mimetypes (StClipboard     *clipboard,
  *
  * Request the data from the clipboard in text form. @callback is executed
  * when the data is retrieved.
+ *
+ * See st_clipboard_get_text_async() to limit the size of the text.
  */
 void
 st_clipboard_get_text (StClipboard            *clipboard,
@@ -202,35 +617,33 @@ st_clipboard_get_text (StClipboard            *clipboard,
                        StClipboardCallbackFunc callback,
                        gpointer                user_data)
 {
-  MetaSelectionType selection_type;
-  TransferData *data;
-  const char *mimetype = NULL;
+  CallbackData *data;
 
   g_return_if_fail (ST_IS_CLIPBOARD (clipboard));
   g_return_if_fail (meta_selection != NULL);
   g_return_if_fail (callback != NULL);
 
-  if (convert_type (type, &selection_type))
-    mimetype = pick_mimetype (meta_selection, selection_type);
-
-  if (!mimetype)
-    {
-      callback (clipboard, NULL, user_data);
-      return;
-    }
-
-  data = g_new0 (TransferData, 1);
-  data->clipboard = clipboard;
+  data = g_new0 (CallbackData, 1);
   data->callback = G_CALLBACK (callback);
   data->user_data = user_data;
-  data->stream = g_memory_output_stream_new_resizable ();
 
-  meta_selection_transfer_async (meta_selection,
-                                 selection_type,
-                                 mimetype, -1,
-                                 data->stream, NULL,
-                                 (GAsyncReadyCallback) transfer_cb,
-                                 data);
+  st_clipboard_get_text_async (clipboard, type, -1, NULL,
+                               (GAsyncReadyCallback) get_text_callback_cb,
+                               data);
+}
+
+static void
+get_content_callback_cb (StClipboard  *clipboard,
+                         GAsyncResult *res,
+                         CallbackData *data)
+{
+  GBytes *bytes;
+
+  bytes = st_clipboard_get_content_finish (clipboard, res, NULL);
+  ((StClipboardContentCallbackFunc) data->callback) (clipboard, bytes,
+                                                     data->user_data);
+  g_clear_pointer (&bytes, g_bytes_unref);
+  g_free (data);
 }
 
 /**
@@ -243,6 +656,8 @@ st_clipboard_get_text (StClipboard            *clipboard,
  *
  * Request the data from the clipboard in #GBytes form. @callback is executed
  * when the data is retrieved.
+ *
+ * See st_clipboard_get_content_async() to limit the size of the content.
  */
 void
 st_clipboard_get_content (StClipboard                    *clipboard,
@@ -251,31 +666,25 @@ st_clipboard_get_content (StClipboard                    *clipboard,
                           StClipboardContentCallbackFunc  callback,
                           gpointer                        user_data)
 {
-  MetaSelectionType selection_type;
-  TransferData *data;
+  CallbackData *data;
 
   g_return_if_fail (ST_IS_CLIPBOARD (clipboard));
   g_return_if_fail (meta_selection != NULL);
   g_return_if_fail (callback != NULL);
 
-  if (!mimetype || !convert_type (type, &selection_type))
+  if (!mimetype)
     {
       callback (clipboard, NULL, user_data);
       return;
     }
 
-  data = g_new0 (TransferData, 1);
-  data->clipboard = clipboard;
+  data = g_new0 (CallbackData, 1);
   data->callback = G_CALLBACK (callback);
   data->user_data = user_data;
-  data->stream = g_memory_output_stream_new_resizable ();
 
-  meta_selection_transfer_async (meta_selection,
-                                 selection_type,
-                                 mimetype, -1,
-                                 data->stream, NULL,
-                                 (GAsyncReadyCallback) transfer_bytes_cb,
-                                 data);
+  st_clipboard_get_content_async (clipboard, type, mimetype, -1, NULL,
+                                  (GAsyncReadyCallback) get_content_callback_cb,
+                                  data);
 }
 
 /**
@@ -24,7 +24,7 @@
 #ifndef _ST_CLIPBOARD_H
 #define _ST_CLIPBOARD_H
 
-#include <glib-object.h>
+#include <gio/gio.h>
 #include <meta/meta-selection.h>
 
 G_BEGIN_DECLS
@@ -51,6 +51,19 @@ typedef enum {
   ST_CLIPBOARD_TYPE_CLIPBOARD
 } StClipboardType;
 
+/**
+ * StClipboardTransferFlags:
+ * @ST_CLIPBOARD_TRANSFER_NONE: No flags
+ * @ST_CLIPBOARD_TRANSFER_TRUNCATE: Truncate content over the maximum size,
+ *   instead of failing
+ *
+ * Flags for st_clipboard_transfer_async().
+ */
+typedef enum {
+  ST_CLIPBOARD_TRANSFER_NONE = 0,
+  ST_CLIPBOARD_TRANSFER_TRUNCATE = 1 << 0,
+} StClipboardTransferFlags;
+
 /**
  * StClipboardCallbackFunc:
  * @clipboard: A #StClipboard
@@ -98,6 +111,41 @@ void st_clipboard_get_content (StClipboard                    *clipboard,
                                StClipboardContentCallbackFunc  callback,
                                gpointer                        user_data);
 
+void     st_clipboard_transfer_async  (StClipboard              *clipboard,
+                                       StClipboardType           type,
+                                       const char               *mimetype,
+                                       gssize                    max_size,
+                                       StClipboardTransferFlags  flags,
+                                       GOutputStream            *output,
+                                       GCancellable             *cancellable,
+                                       GAsyncReadyCallback       callback,
+                                       gpointer                  user_data);
+gboolean st_clipboard_transfer_finish (StClipboard              *clipboard,
+                                       GAsyncResult             *result,
+                                       gboolean                 *truncated,
+                                       GError                  **error);
+
+void  st_clipboard_get_text_async  (StClipboard          *clipboard,
+                                    StClipboardType       type,
+                                    gssize                max_size,
+                                    GCancellable         *cancellable,
+                                    GAsyncReadyCallback   callback,
+                                    gpointer              user_data);
+char *st_clipboard_get_text_finish (StClipboard          *clipboard,
+                                    GAsyncResult         *result,
+                                    GError              **error);
+
+void    st_clipboard_get_content_async  (StClipboard          *clipboard,
+                                         StClipboardType       type,
+                                         const char           *mimetype,
+                                         gssize                max_size,
+                                         GCancellable         *cancellable,
+                                         GAsyncReadyCallback   callback,
+                                         gpointer              user_data);
+GBytes *st_clipboard_get_content_finish (StClipboard          *clipboard,
+                                         GAsyncResult         *result,
+                                         GError              **error);
+
 void st_clipboard_set_selection (MetaSelection *selection);
 
 G_END_DECLS
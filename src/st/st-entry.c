@@ -90,6 +90,10 @@ enum
 
 #define ST_ENTRY_PRIV(x) st_entry_get_instance_private ((StEntry *) x)
 
+/* Pasting more text than this into an entry is almost certainly a
+ * mistake, and not worth reading from the clipboard */
+#define MAX_PASTE_SIZE (1024 * 1024)
+
 
 typedef struct _StEntryPrivate StEntryPrivate;
 struct _StEntryPrivate
@@ -110,6 +114,8 @@ struct _StEntryPrivate
   CoglPipeline *text_shadow_material;
   gfloat        shadow_width;
   gfloat        shadow_height;
+
+  GCancellable *paste_cancellable;
 };
 
 static guint entry_signals[LAST_SIGNAL] = { 0, };
@@ -218,6 +224,9 @@ st_entry_dispose (GObject *object)
 
   cogl_clear_object (&priv->text_shadow_material);
 
+  g_cancellable_cancel (priv->paste_cancellable);
+  g_clear_object (&priv->paste_cancellable);
+
   G_OBJECT_CLASS (st_entry_parent_class)->dispose (object);
 }
 
@@ -585,17 +594,23 @@ invalidate_shadow_pipeline (GObject    *object,
 }
 
 static void
-st_entry_clipboard_callback (StClipboard *clipboard,
-                             const gchar *text,
-                             gpointer     data)
+st_entry_clipboard_callback (GObject      *source,
+                             GAsyncResult *result,
+                             gpointer      data)
 {
-  StEntryPrivate *priv = ST_ENTRY_PRIV (data);
-  ClutterText *ctext = (ClutterText*)priv->entry;
+  StEntryPrivate *priv;
+  ClutterText *ctext;
   gint cursor_pos;
+  g_autofree char *text = NULL;
 
+  /* The entry is gone if the request was cancelled */
+  text = st_clipboard_get_text_finish (ST_CLIPBOARD (source), result, NULL);
   if (!text)
     return;
 
+  priv = ST_ENTRY_PRIV (data);
+  ctext = (ClutterText*)priv->entry;
+
   /* delete the current selection before pasting */
   clutter_text_delete_selection (ctext);
 
@@ -604,6 +619,29 @@ st_entry_clipboard_callback (StClipboard *clipboard,
   clutter_text_insert_text (ctext, text, cursor_pos);
 }
 
+static void
+st_entry_paste (StEntry         *entry,
+                StClipboardType  type)
+{
+  StEntryPrivate *priv = ST_ENTRY_PRIV (entry);
+  gssize max_size = MAX_PASTE_SIZE;
+  int max_length;
+
+  /* No need to read more than fits in the entry, characters take
+   * at most 4 bytes in UTF-8 */
+  max_length = clutter_text_get_max_length (CLUTTER_TEXT (priv->entry));
+  if (max_length > 0)
+    max_size = MIN (max_size, (gssize) max_length * 4);
+
+  if (!priv->paste_cancellable)
+    priv->paste_cancellable = g_cancellable_new ();
+
+  st_clipboard_get_text_async (st_clipboard_get_default (),
+                               type, max_size, priv->paste_cancellable,
+                               st_entry_clipboard_callback,
+                               entry);
+}
+
 static gboolean
 clutter_text_button_press_event (ClutterActor *actor,
                                  ClutterEvent *event,
@@ -620,22 +658,13 @@ clutter_text_button_press_event (ClutterActor *actor,
       settings = st_settings_get ();
       g_object_get (settings, "primary-paste", &primary_paste_enabled, NULL);
 
+      /* By the time the clipboard callback is called,
+       * the rest of the signal handlers will have
+       * run, making the text cursor to be in the correct
+       * place.
+       */
       if (primary_paste_enabled)
-        {
-          StClipboard *clipboard;
-
-          clipboard = st_clipboard_get_default ();
-
-          /* By the time the clipboard callback is called,
-           * the rest of the signal handlers will have
-           * run, making the text cursor to be in the correct
-           * place.
-           */
-          st_clipboard_get_text (clipboard,
-                                 ST_CLIPBOARD_TYPE_PRIMARY,
-                                 st_entry_clipboard_callback,
-                                 user_data);
-        }
+        st_entry_paste (ST_ENTRY (user_data), ST_CLIPBOARD_TYPE_PRIMARY);
     }
 
   return FALSE;
@@ -664,15 +693,7 @@ st_entry_key_press_event (ClutterActor *actor,
       ((state & CLUTTER_SHIFT_MASK)
        && keyval == CLUTTER_KEY_Insert))
     {
-      StClipboard *clipboard;
-
-      clipboard = st_clipboard_get_default ();
-
-      st_clipboard_get_text (clipboard,
-                             ST_CLIPBOARD_TYPE_CLIPBOARD,
-                             st_entry_clipboard_callback,
-                             actor);
-
+      st_entry_paste (ST_ENTRY (actor), ST_CLIPBOARD_TYPE_CLIPBOARD);
       return TRUE;
     }
 
@@ -27,7 +27,10 @@
 #include <cairo.h>
 #include "st-widget.h"
 #include "st-bin.h"
+#include "st-scroll-view-fade.h"
 #include "st-shadow.h"
+#include "st-texture-cache.h"
+#include "st-viewport.h"
 
 G_BEGIN_DECLS
 
@@ -72,4 +75,30 @@ void _st_paint_shadow_with_opacity (StShadow        *shadow_spec,
                                     ClutterActorBox *box,
                                     guint8           paint_opacity);
 
+/* Helper for scroll views to paint their content with the fade applied;
+ * the paint function only needs to paint what shows in @region, in the
+ * coordinates of @actor
+ */
+typedef void (* StScrollViewPaintFunc) (ClutterActor          *actor,
+                                        ClutterPaintContext   *paint_context,
+                                        const ClutterActorBox *region);
+
+gboolean _st_scroll_view_fade_paint_masked (StScrollViewFade      *self,
+                                            ClutterPaintContext   *paint_context,
+                                            StScrollViewPaintFunc  paint_func);
+
+/* Restricts the children a viewport paints to those showing in @region,
+ * in the coordinates of @viewport, or lifts the restriction when %NULL
+ */
+void _st_viewport_set_paint_region (StViewport            *viewport,
+                                    const ClutterActorBox *region);
+
+/* Number of decoded sliced images kept by @cache, for tests */
+int _st_texture_cache_get_n_sliced_images (StTextureCache *cache);
+
+/* Memory taken by icons @cache prewarms, and whether it is busy
+ * prewarming, for tests */
+gsize _st_texture_cache_get_prewarm_size (StTextureCache *cache);
+gboolean _st_texture_cache_is_prewarming (StTextureCache *cache);
+
 #endif /* __ST_PRIVATE_H__ */
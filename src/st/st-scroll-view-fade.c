@@ -29,11 +29,29 @@
 
 #include <clutter/clutter.h>
 #include <cogl/cogl.h>
+#include <math.h>
 
 #define DEFAULT_FADE_OFFSET 68.0f
 
 #include "st-scroll-view-fade-generated.h"
 
+typedef enum
+{
+  FADE_EDGE_TOP,
+  FADE_EDGE_BOTTOM,
+  FADE_EDGE_LEFT,
+  FADE_EDGE_RIGHT,
+
+  N_FADE_EDGES
+} FadeEdge;
+
+typedef struct
+{
+  CoglTexture *texture;
+  CoglFramebuffer *framebuffer;
+  CoglPipeline *pipeline;
+} FadeStrip;
+
 struct _StScrollViewFade
 {
   ClutterShaderEffect parent_instance;
@@ -48,6 +66,11 @@ struct _StScrollViewFade
   guint extend_fade_area: 1;
 
   ClutterMargin fade_margins;
+
+  /* Offscreen buffers for the leading and trailing faded strips, when
+   * fading without rendering the whole actor offscreen
+   */
+  FadeStrip strips[2];
 };
 
 G_DEFINE_TYPE (StScrollViewFade,
@@ -84,41 +107,19 @@ st_scroll_view_fade_get_static_shader_source (ClutterShaderEffect *effect)
 }
 
 
+/* The area of the actor that is faded, in actor coordinates */
 static void
-st_scroll_view_fade_paint_target (ClutterOffscreenEffect *effect,
-                                  ClutterPaintNode       *node,
-                                  ClutterPaintContext    *paint_context)
+get_fade_area (StScrollViewFade *self,
+               ClutterActorBox  *fade_area)
 {
-  StScrollViewFade *self = ST_SCROLL_VIEW_FADE (effect);
-  ClutterShaderEffect *shader = CLUTTER_SHADER_EFFECT (effect);
-  ClutterOffscreenEffectClass *parent;
-
-  gdouble value, lower, upper, page_size;
   ClutterActor *vscroll = st_scroll_view_get_vscroll_bar (ST_SCROLL_VIEW (self->actor));
   ClutterActor *hscroll = st_scroll_view_get_hscroll_bar (ST_SCROLL_VIEW (self->actor));
-  gboolean h_scroll_visible, v_scroll_visible, rtl;
-
-  ClutterActorBox allocation, content_box, paint_box;
-
-  float fade_area_topleft[2];
-  float fade_area_bottomright[2];
-  graphene_point3d_t verts[4];
-
-  clutter_actor_get_paint_box (self->actor, &paint_box);
-  clutter_actor_get_abs_allocation_vertices (self->actor, verts);
+  gboolean h_scroll_visible, v_scroll_visible;
+  ClutterActorBox allocation;
 
   clutter_actor_get_allocation_box (self->actor, &allocation);
   st_theme_node_get_content_box (st_widget_get_theme_node (ST_WIDGET (self->actor)),
-                                (const ClutterActorBox *)&allocation, &content_box);
-
-  /*
-   * The FBO is based on the paint_volume's size which can be larger then the actual
-   * allocation, so we have to account for that when passing the positions
-   */
-  fade_area_topleft[0] = content_box.x1 + (verts[0].x - paint_box.x1);
-  fade_area_topleft[1] = content_box.y1 + (verts[0].y - paint_box.y1);
-  fade_area_bottomright[0] = content_box.x2 + (verts[3].x - paint_box.x2) + 1;
-  fade_area_bottomright[1] = content_box.y2 + (verts[3].y - paint_box.y2) + 1;
+                                (const ClutterActorBox *)&allocation, fade_area);
 
   g_object_get (ST_SCROLL_VIEW (self->actor),
                 "hscrollbar-visible", &h_scroll_visible,
@@ -128,39 +129,83 @@ st_scroll_view_fade_paint_target (ClutterOffscreenEffect *effect,
   if (v_scroll_visible)
     {
       if (clutter_actor_get_text_direction (self->actor) == CLUTTER_TEXT_DIRECTION_RTL)
-          fade_area_topleft[0] += clutter_actor_get_width (vscroll);
+          fade_area->x1 += clutter_actor_get_width (vscroll);
 
-      fade_area_bottomright[0] -= clutter_actor_get_width (vscroll);
+      fade_area->x2 -= clutter_actor_get_width (vscroll);
     }
 
   if (h_scroll_visible)
-      fade_area_bottomright[1] -= clutter_actor_get_height (hscroll);
+      fade_area->y2 -= clutter_actor_get_height (hscroll);
 
   if (self->fade_margins.left < 0)
-    fade_area_topleft[0] -= ABS (self->fade_margins.left);
+    fade_area->x1 -= ABS (self->fade_margins.left);
   if (self->fade_margins.right < 0)
-    fade_area_bottomright[0] += ABS (self->fade_margins.right);
+    fade_area->x2 += ABS (self->fade_margins.right);
   if (self->fade_margins.top < 0)
-    fade_area_topleft[1] -= ABS (self->fade_margins.top);
+    fade_area->y1 -= ABS (self->fade_margins.top);
   if (self->fade_margins.bottom < 0)
-    fade_area_bottomright[1] += ABS (self->fade_margins.bottom);
+    fade_area->y2 += ABS (self->fade_margins.bottom);
+}
+
+/* Which edges are faded, depending on the scroll position */
+static void
+get_fade_edges (StScrollViewFade *self,
+                gboolean          edges[N_FADE_EDGES])
+{
+  gdouble value, lower, upper, page_size;
+  gboolean rtl;
 
   st_adjustment_get_values (self->vadjustment, &value, &lower, &upper, NULL, NULL, &page_size);
   value = (value - lower) / (upper - page_size - lower);
-  clutter_shader_effect_set_uniform (shader, "fade_edges_top", G_TYPE_INT, 1, self->fade_edges ? value >= 0.0 : value > 0.0);
-  clutter_shader_effect_set_uniform (shader, "fade_edges_bottom", G_TYPE_INT, 1, self->fade_edges ? value <= 1.0 : value < 1.0);
+  edges[FADE_EDGE_TOP] = self->fade_edges ? value >= 0.0 : value > 0.0;
+  edges[FADE_EDGE_BOTTOM] = self->fade_edges ? value <= 1.0 : value < 1.0;
 
   st_adjustment_get_values (self->hadjustment, &value, &lower, &upper, NULL, NULL, &page_size);
   value = (value - lower) / (upper - page_size - lower);
   rtl = clutter_actor_get_text_direction (self->actor) == CLUTTER_TEXT_DIRECTION_RTL;
-  clutter_shader_effect_set_uniform (shader, "fade_edges_left", G_TYPE_INT, 1,
-                                     self->fade_edges ?
-                                     value >= 0.0 :
-                                     (rtl ? value < 1.0 : value > 0.0));
-  clutter_shader_effect_set_uniform (shader, "fade_edges_right", G_TYPE_INT, 1,
-                                     self->fade_edges ?
-                                     value <= 1.0 :
-                                     (rtl ? value > 0.0 : value < 1.0));
+  edges[FADE_EDGE_LEFT] = self->fade_edges ?
+                          value >= 0.0 :
+                          (rtl ? value < 1.0 : value > 0.0);
+  edges[FADE_EDGE_RIGHT] = self->fade_edges ?
+                           value <= 1.0 :
+                           (rtl ? value > 0.0 : value < 1.0);
+}
+
+static void
+st_scroll_view_fade_paint_target (ClutterOffscreenEffect *effect,
+                                  ClutterPaintNode       *node,
+                                  ClutterPaintContext    *paint_context)
+{
+  StScrollViewFade *self = ST_SCROLL_VIEW_FADE (effect);
+  ClutterShaderEffect *shader = CLUTTER_SHADER_EFFECT (effect);
+  ClutterOffscreenEffectClass *parent;
+
+  ClutterActorBox fade_area, paint_box;
+  gboolean edges[N_FADE_EDGES];
+
+  float fade_area_topleft[2];
+  float fade_area_bottomright[2];
+  graphene_point3d_t verts[4];
+
+  clutter_actor_get_paint_box (self->actor, &paint_box);
+  clutter_actor_get_abs_allocation_vertices (self->actor, verts);
+
+  get_fade_area (self, &fade_area);
+
+  /*
+   * The FBO is based on the paint_volume's size which can be larger then the actual
+   * allocation, so we have to account for that when passing the positions
+   */
+  fade_area_topleft[0] = fade_area.x1 + (verts[0].x - paint_box.x1);
+  fade_area_topleft[1] = fade_area.y1 + (verts[0].y - paint_box.y1);
+  fade_area_bottomright[0] = fade_area.x2 + (verts[3].x - paint_box.x2) + 1;
+  fade_area_bottomright[1] = fade_area.y2 + (verts[3].y - paint_box.y2) + 1;
+
+  get_fade_edges (self, edges);
+  clutter_shader_effect_set_uniform (shader, "fade_edges_top", G_TYPE_INT, 1, edges[FADE_EDGE_TOP]);
+  clutter_shader_effect_set_uniform (shader, "fade_edges_bottom", G_TYPE_INT, 1, edges[FADE_EDGE_BOTTOM]);
+  clutter_shader_effect_set_uniform (shader, "fade_edges_left", G_TYPE_INT, 1, edges[FADE_EDGE_LEFT]);
+  clutter_shader_effect_set_uniform (shader, "fade_edges_right", G_TYPE_INT, 1, edges[FADE_EDGE_RIGHT]);
 
   clutter_shader_effect_set_uniform (shader, "extend_fade_area", G_TYPE_INT, 1, self->extend_fade_area);
   clutter_shader_effect_set_uniform (shader, "fade_offset_top", G_TYPE_FLOAT, 1, ABS (self->fade_margins.top));
@@ -177,6 +222,461 @@ st_scroll_view_fade_paint_target (ClutterOffscreenEffect *effect,
   parent->paint_target (effect, node, paint_context);
 }
 
+static float
+get_fade_offset (StScrollViewFade *self,
+                 FadeEdge          edge)
+{
+  switch (edge)
+    {
+    case FADE_EDGE_TOP:
+      return ABS (self->fade_margins.top);
+    case FADE_EDGE_BOTTOM:
+      return ABS (self->fade_margins.bottom);
+    case FADE_EDGE_LEFT:
+      return ABS (self->fade_margins.left);
+    case FADE_EDGE_RIGHT:
+      return ABS (self->fade_margins.right);
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* Gets the part of the actor that needs to be rendered offscreen to fade
+ * @edge, and the part of it where the fade applies; outside of @gradient,
+ * the strip is painted as is, like the shader does outside the fade area.
+ */
+static void
+get_fade_strip (StScrollViewFade      *self,
+                FadeEdge               edge,
+                const ClutterActorBox *fade_area,
+                ClutterActorBox       *strip,
+                ClutterActorBox       *gradient)
+{
+  float offset = get_fade_offset (self, edge);
+  float width, height;
+
+  clutter_actor_get_size (self->actor, &width, &height);
+
+  *gradient = *fade_area;
+
+  switch (edge)
+    {
+    case FADE_EDGE_TOP:
+      gradient->y2 = fade_area->y1 + offset;
+      *strip = (ClutterActorBox) { 0, 0, width, gradient->y2 };
+      break;
+    case FADE_EDGE_BOTTOM:
+      gradient->y1 = fade_area->y2 - offset;
+      *strip = (ClutterActorBox) { 0, gradient->y1, width, height };
+      break;
+    case FADE_EDGE_LEFT:
+      gradient->x2 = fade_area->x1 + offset;
+      *strip = (ClutterActorBox) { 0, 0, gradient->x2, height };
+      break;
+    case FADE_EDGE_RIGHT:
+      gradient->x1 = fade_area->x2 - offset;
+      *strip = (ClutterActorBox) { gradient->x1, 0, width, height };
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  strip->x1 = CLAMP (strip->x1, 0, width);
+  strip->x2 = CLAMP (strip->x2, 0, width);
+  strip->y1 = CLAMP (strip->y1, 0, height);
+  strip->y2 = CLAMP (strip->y2, 0, height);
+
+  gradient->x1 = CLAMP (gradient->x1, strip->x1, strip->x2);
+  gradient->x2 = CLAMP (gradient->x2, gradient->x1, strip->x2);
+  gradient->y1 = CLAMP (gradient->y1, strip->y1, strip->y2);
+  gradient->y2 = CLAMP (gradient->y2, gradient->y1, strip->y2);
+}
+
+/* The fade factor of @edge at the given position, as in the shader */
+static float
+get_fade_ratio (StScrollViewFade      *self,
+                FadeEdge               edge,
+                const ClutterActorBox *fade_area,
+                float                  x,
+                float                  y)
+{
+  float offset = get_fade_offset (self, edge);
+  float distance;
+
+  switch (edge)
+    {
+    case FADE_EDGE_TOP:
+      distance = y - fade_area->y1;
+      break;
+    case FADE_EDGE_BOTTOM:
+      distance = fade_area->y2 - y;
+      break;
+    case FADE_EDGE_LEFT:
+      distance = x - fade_area->x1;
+      break;
+    case FADE_EDGE_RIGHT:
+      distance = fade_area->x2 - x;
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  return CLAMP (distance / offset, 0.0, 1.0);
+}
+
+/* Whether the fade can be applied by only rendering the faded strips
+ * offscreen, rather than the whole actor. Returns the edges to fade.
+ */
+static gboolean
+can_paint_masked (StScrollViewFade *self,
+                  gboolean          faded[N_FADE_EDGES])
+{
+  ClutterActorBox fade_area, leading, trailing, gradient;
+  gboolean edges[N_FADE_EDGES];
+  gboolean has_other_effects;
+  ClutterActor *child;
+  GList *effects;
+  int i;
+
+  if (!clutter_actor_meta_get_enabled (CLUTTER_ACTOR_META (self)))
+    return FALSE;
+
+  /* Outside of the fade area, the shader fades everything or nothing */
+  if (self->extend_fade_area)
+    return FALSE;
+
+  get_fade_edges (self, edges);
+  for (i = 0; i < N_FADE_EDGES; i++)
+    faded[i] = edges[i] && get_fade_offset (self, i) > 0;
+
+  /* Where fades along both axes meet, their ratios are multiplied, which
+   * strips along a single axis can't do
+   */
+  if ((faded[FADE_EDGE_TOP] || faded[FADE_EDGE_BOTTOM]) &&
+      (faded[FADE_EDGE_LEFT] || faded[FADE_EDGE_RIGHT]))
+    return FALSE;
+
+  get_fade_area (self, &fade_area);
+
+  if (faded[FADE_EDGE_TOP] && faded[FADE_EDGE_BOTTOM])
+    {
+      get_fade_strip (self, FADE_EDGE_TOP, &fade_area, &leading, &gradient);
+      get_fade_strip (self, FADE_EDGE_BOTTOM, &fade_area, &trailing, &gradient);
+      if (leading.y2 > trailing.y1)
+        return FALSE;
+    }
+
+  if (faded[FADE_EDGE_LEFT] && faded[FADE_EDGE_RIGHT])
+    {
+      get_fade_strip (self, FADE_EDGE_LEFT, &fade_area, &leading, &gradient);
+      get_fade_strip (self, FADE_EDGE_RIGHT, &fade_area, &trailing, &gradient);
+      if (leading.x2 > trailing.x1)
+        return FALSE;
+    }
+
+  /* Strips paint the content again, which would run its effects again */
+  effects = clutter_actor_get_effects (self->actor);
+  has_other_effects = effects != NULL && effects->next != NULL;
+  g_list_free (effects);
+
+  if (has_other_effects)
+    return FALSE;
+
+  for (child = clutter_actor_get_first_child (self->actor);
+       child != NULL;
+       child = clutter_actor_get_next_sibling (child))
+    {
+      if (clutter_actor_has_effects (child))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+fade_strip_clear (FadeStrip *strip)
+{
+  cogl_clear_object (&strip->pipeline);
+  g_clear_object (&strip->framebuffer);
+  cogl_clear_object (&strip->texture);
+}
+
+static gboolean
+fade_strip_ensure_size (FadeStrip *strip,
+                        int        width,
+                        int        height)
+{
+  CoglContext *ctx;
+  CoglOffscreen *offscreen;
+  GError *catch_error = NULL;
+
+  if (strip->texture != NULL &&
+      cogl_texture_get_width (strip->texture) == width &&
+      cogl_texture_get_height (strip->texture) == height)
+    return TRUE;
+
+  fade_strip_clear (strip);
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  strip->texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, width, height));
+  if (strip->texture == NULL)
+    return FALSE;
+
+  offscreen = cogl_offscreen_new_with_texture (strip->texture);
+  strip->framebuffer = COGL_FRAMEBUFFER (offscreen);
+
+  if (!cogl_framebuffer_allocate (strip->framebuffer, &catch_error))
+    {
+      g_error_free (catch_error);
+      fade_strip_clear (strip);
+      return FALSE;
+    }
+
+  strip->pipeline = _st_create_texture_pipeline (strip->texture);
+
+  return TRUE;
+}
+
+static void
+add_strip_quad (CoglVertexP2T2C4      *verts,
+                int                   *n_verts,
+                StScrollViewFade      *self,
+                FadeEdge               edge,
+                const ClutterActorBox *fade_area,
+                const ClutterActorBox *strip,
+                float                  tex_width,
+                float                  tex_height,
+                const ClutterActorBox *quad,
+                gboolean               faded)
+{
+  const float corners[6][2] = {
+    { quad->x1, quad->y1 }, { quad->x2, quad->y1 }, { quad->x1, quad->y2 },
+    { quad->x1, quad->y2 }, { quad->x2, quad->y1 }, { quad->x2, quad->y2 },
+  };
+  int i;
+
+  if (quad->x2 <= quad->x1 || quad->y2 <= quad->y1)
+    return;
+
+  for (i = 0; i < G_N_ELEMENTS (corners); i++)
+    {
+      CoglVertexP2T2C4 *v = &verts[(*n_verts)++];
+      float x = corners[i][0];
+      float y = corners[i][1];
+      float ratio = 1.0;
+      guint8 alpha;
+
+      if (faded)
+        ratio = get_fade_ratio (self, edge, fade_area, x, y);
+
+      /* The texture is premultiplied, so fade all of its components */
+      alpha = (guint8) (ratio * 255 + 0.5);
+
+      v->x = x;
+      v->y = y;
+      v->s = (x - strip->x1) / tex_width;
+      v->t = (y - strip->y1) / tex_height;
+      v->r = v->g = v->b = v->a = alpha;
+    }
+}
+
+static void
+paint_strip (StScrollViewFade     *self,
+             FadeEdge              edge,
+             ClutterPaintContext  *paint_context,
+             StScrollViewPaintFunc paint_func)
+{
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+  FadeStrip *fade_strip;
+  ClutterActorBox fade_area, strip, gradient;
+  ClutterPaintContext *strip_context;
+  CoglVertexP2T2C4 verts[5 * 6];
+  CoglPrimitive *primitive;
+  CoglColor clear_color;
+  CoglContext *ctx;
+  float resource_scale;
+  float tex_width, tex_height;
+  int n_verts = 0;
+
+  get_fade_area (self, &fade_area);
+  get_fade_strip (self, edge, &fade_area, &strip, &gradient);
+
+  if (strip.x2 <= strip.x1 || strip.y2 <= strip.y1)
+    return;
+
+  resource_scale = clutter_actor_get_resource_scale (self->actor);
+  fade_strip = &self->strips[edge == FADE_EDGE_TOP || edge == FADE_EDGE_LEFT ? 0 : 1];
+
+  if (!fade_strip_ensure_size (fade_strip,
+                               ceilf ((strip.x2 - strip.x1) * resource_scale),
+                               ceilf ((strip.y2 - strip.y1) * resource_scale)))
+    {
+      /* Better unfaded than missing */
+      cogl_framebuffer_push_rectangle_clip (framebuffer,
+                                            strip.x1, strip.y1,
+                                            strip.x2, strip.y2);
+      paint_func (self->actor, paint_context, &strip);
+      cogl_framebuffer_pop_clip (framebuffer);
+      return;
+    }
+
+  tex_width = cogl_texture_get_width (fade_strip->texture) / resource_scale;
+  tex_height = cogl_texture_get_height (fade_strip->texture) / resource_scale;
+
+  cogl_color_init_from_4ub (&clear_color, 0, 0, 0, 0);
+  cogl_framebuffer_clear (fade_strip->framebuffer, COGL_BUFFER_BIT_COLOR, &clear_color);
+  cogl_framebuffer_orthographic (fade_strip->framebuffer,
+                                 0, 0,
+                                 cogl_texture_get_width (fade_strip->texture),
+                                 cogl_texture_get_height (fade_strip->texture),
+                                 0, 1.0);
+  cogl_framebuffer_identity_matrix (fade_strip->framebuffer);
+  cogl_framebuffer_scale (fade_strip->framebuffer, resource_scale, resource_scale, 1);
+  cogl_framebuffer_translate (fade_strip->framebuffer, -strip.x1, -strip.y1, 0);
+
+  strip_context =
+    clutter_paint_context_new_for_framebuffer (fade_strip->framebuffer, NULL,
+                                               CLUTTER_PAINT_FLAG_NONE);
+  paint_func (self->actor, strip_context, &strip);
+  clutter_paint_context_destroy (strip_context);
+
+  /* Composite the strip with the fade applied through vertex colors:
+   * the gradient itself, and the parts of the strip around it as is.
+   */
+  add_strip_quad (verts, &n_verts, self, edge, &fade_area, &strip,
+                  tex_width, tex_height, &gradient, TRUE);
+  add_strip_quad (verts, &n_verts, self, edge, &fade_area, &strip,
+                  tex_width, tex_height,
+                  &(ClutterActorBox) { strip.x1, strip.y1, strip.x2, gradient.y1 },
+                  FALSE);
+  add_strip_quad (verts, &n_verts, self, edge, &fade_area, &strip,
+                  tex_width, tex_height,
+                  &(ClutterActorBox) { strip.x1, gradient.y2, strip.x2, strip.y2 },
+                  FALSE);
+  add_strip_quad (verts, &n_verts, self, edge, &fade_area, &strip,
+                  tex_width, tex_height,
+                  &(ClutterActorBox) { strip.x1, gradient.y1, gradient.x1, gradient.y2 },
+                  FALSE);
+  add_strip_quad (verts, &n_verts, self, edge, &fade_area, &strip,
+                  tex_width, tex_height,
+                  &(ClutterActorBox) { gradient.x2, gradient.y1, strip.x2, gradient.y2 },
+                  FALSE);
+
+  if (n_verts == 0)
+    return;
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  primitive = cogl_primitive_new_p2t2c4 (ctx, COGL_VERTICES_MODE_TRIANGLES,
+                                         n_verts, verts);
+  cogl_primitive_draw (primitive, framebuffer, fade_strip->pipeline);
+  cogl_object_unref (primitive);
+}
+
+/**
+ * _st_scroll_view_fade_paint_masked:
+ * @self: a #StScrollViewFade
+ * @paint_context: the #ClutterPaintContext of the scroll view paint
+ * @paint_func: the function painting the scroll view content
+ *
+ * When the fade can be applied without rendering the whole scroll view
+ * offscreen, the effect lets the scroll view paint as usual, and the
+ * scroll view calls this function to paint its content: the unfaded
+ * part is painted directly, and only the faded strips along the edges
+ * are rendered offscreen, then composited with the fade applied.
+ *
+ * @paint_func is called once for each of these regions, and only needs
+ * to paint what shows in it; the offscreen strips aren't culled by
+ * Clutter, so it is up to @paint_func to skip the rest.
+ *
+ * Returns: %TRUE if the content was painted, %FALSE if the scroll view
+ *   needs to paint it itself
+ */
+gboolean
+_st_scroll_view_fade_paint_masked (StScrollViewFade      *self,
+                                   ClutterPaintContext   *paint_context,
+                                   StScrollViewPaintFunc  paint_func)
+{
+  CoglFramebuffer *framebuffer;
+  ClutterActorBox fade_area, strip, gradient, direct;
+  gboolean faded[N_FADE_EDGES];
+  int i;
+
+  /* The scroll view is painted from within st_scroll_view_fade_paint(),
+   * so this comes to the same conclusion it did
+   */
+  if (!can_paint_masked (self, faded))
+    return FALSE;
+
+  get_fade_area (self, &fade_area);
+  clutter_actor_get_allocation_box (self->actor, &direct);
+  clutter_actor_box_set_origin (&direct, 0, 0);
+
+  for (i = 0; i < N_FADE_EDGES; i++)
+    {
+      if (!faded[i])
+        continue;
+
+      get_fade_strip (self, i, &fade_area, &strip, &gradient);
+
+      switch ((FadeEdge) i)
+        {
+        case FADE_EDGE_TOP:
+          direct.y1 = strip.y2;
+          break;
+        case FADE_EDGE_BOTTOM:
+          direct.y2 = strip.y1;
+          break;
+        case FADE_EDGE_LEFT:
+          direct.x1 = strip.x2;
+          break;
+        case FADE_EDGE_RIGHT:
+          direct.x2 = strip.x1;
+          break;
+        default:
+          g_assert_not_reached ();
+        }
+
+      paint_strip (self, i, paint_context, paint_func);
+    }
+
+  framebuffer = clutter_paint_context_get_framebuffer (paint_context);
+  cogl_framebuffer_push_rectangle_clip (framebuffer,
+                                        direct.x1, direct.y1,
+                                        direct.x2, direct.y2);
+  paint_func (self->actor, paint_context, &direct);
+  cogl_framebuffer_pop_clip (framebuffer);
+
+  return TRUE;
+}
+
+static void
+st_scroll_view_fade_paint (ClutterEffect           *effect,
+                           ClutterPaintNode        *node,
+                           ClutterPaintContext     *paint_context,
+                           ClutterEffectPaintFlags  flags)
+{
+  StScrollViewFade *self = ST_SCROLL_VIEW_FADE (effect);
+  ClutterEffectClass *parent;
+  gboolean faded[N_FADE_EDGES];
+
+  if (can_paint_masked (self, faded))
+    {
+      ClutterPaintNode *actor_node;
+
+      /* Paint the actor as if there was no effect, the scroll view
+       * masks its content with _st_scroll_view_fade_paint_masked()
+       */
+      actor_node = clutter_actor_node_new (self->actor, -1);
+      clutter_paint_node_add_child (node, actor_node);
+      clutter_paint_node_unref (actor_node);
+      return;
+    }
+
+  parent = CLUTTER_EFFECT_CLASS (st_scroll_view_fade_parent_class);
+  parent->paint (effect, node, paint_context, flags);
+}
+
 static void
 on_adjustment_changed (StAdjustment *adjustment,
                        ClutterEffect *effect)
@@ -242,6 +742,9 @@ st_scroll_view_fade_set_actor (ClutterActorMeta *meta,
         on_adjustment_changed (NULL, CLUTTER_EFFECT (self));
     }
 
+  fade_strip_clear (&self->strips[0]);
+  fade_strip_clear (&self->strips[1]);
+
   parent = CLUTTER_ACTOR_META_CLASS (st_scroll_view_fade_parent_class);
   parent->set_actor (meta, actor);
 
@@ -272,6 +775,9 @@ st_scroll_view_fade_dispose (GObject *gobject)
 
   self->actor = NULL;
 
+  fade_strip_clear (&self->strips[0]);
+  fade_strip_clear (&self->strips[1]);
+
   G_OBJECT_CLASS (st_scroll_view_fade_parent_class)->dispose (gobject);
 }
 
@@ -380,6 +886,7 @@ static void
 st_scroll_view_fade_class_init (StScrollViewFadeClass *klass)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterEffectClass *effect_class = CLUTTER_EFFECT_CLASS (klass);
   ClutterShaderEffectClass *shader_class;
   ClutterOffscreenEffectClass *offscreen_class;
   ClutterActorMetaClass *meta_class = CLUTTER_ACTOR_META_CLASS (klass);
@@ -390,6 +897,8 @@ st_scroll_view_fade_class_init (StScrollViewFadeClass *klass)
 
   meta_class->set_actor = st_scroll_view_fade_set_actor;
 
+  effect_class->paint = st_scroll_view_fade_paint;
+
   shader_class = CLUTTER_SHADER_EFFECT_CLASS (klass);
   shader_class->get_static_shader_source = st_scroll_view_fade_get_static_shader_source;
 
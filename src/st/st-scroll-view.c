@@ -272,16 +272,58 @@ st_scroll_view_dispose (GObject *object)
   G_OBJECT_CLASS (st_scroll_view_parent_class)->dispose (object);
 }
 
+static void
+st_scroll_view_paint_content (ClutterActor          *actor,
+                              ClutterPaintContext   *paint_context,
+                              const ClutterActorBox *region)
+{
+  StScrollViewPrivate *priv = ST_SCROLL_VIEW (actor)->priv;
+  ClutterActorBox child_region, allocation;
+  float translation_x, translation_y;
+
+  st_widget_paint_background (ST_WIDGET (actor), paint_context);
+
+  if (priv->child == NULL)
+    return;
+
+  if (region == NULL ||
+      !ST_IS_VIEWPORT (priv->child) ||
+      clutter_actor_is_scaled (priv->child) ||
+      clutter_actor_is_rotated (priv->child))
+    {
+      clutter_actor_paint (priv->child, paint_context);
+      return;
+    }
+
+  /* Only paint the scrolled children that show in @region */
+  clutter_actor_get_allocation_box (priv->child, &allocation);
+  clutter_actor_get_translation (priv->child, &translation_x, &translation_y, NULL);
+
+  child_region = *region;
+  child_region.x1 -= allocation.x1 + translation_x;
+  child_region.y1 -= allocation.y1 + translation_y;
+  child_region.x2 -= allocation.x1 + translation_x;
+  child_region.y2 -= allocation.y1 + translation_y;
+
+  _st_viewport_set_paint_region (ST_VIEWPORT (priv->child), &child_region);
+  clutter_actor_paint (priv->child, paint_context);
+  _st_viewport_set_paint_region (ST_VIEWPORT (priv->child), NULL);
+}
+
 static void
 st_scroll_view_paint (ClutterActor        *actor,
                       ClutterPaintContext *paint_context)
 {
   StScrollViewPrivate *priv = ST_SCROLL_VIEW (actor)->priv;
 
-  st_widget_paint_background (ST_WIDGET (actor), paint_context);
+  if (priv->fade_effect == NULL ||
+      !_st_scroll_view_fade_paint_masked (priv->fade_effect, paint_context,
+                                          st_scroll_view_paint_content))
+    st_scroll_view_paint_content (actor, paint_context, NULL);
 
-  if (priv->child)
-    clutter_actor_paint (priv->child, paint_context);
+  /* The scroll bars are never faded, so they are painted over the
+   * content rather than with it
+   */
   if (priv->hscrollbar_visible)
     clutter_actor_paint (priv->hscroll, paint_context);
   if (priv->vscrollbar_visible)
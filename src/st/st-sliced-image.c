@@ -0,0 +1,390 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * st-sliced-image.c: Frames of an image sliced in a grid
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* A sliced image holds the decoded pixels of an image made of a grid
+ * of frames, like the sprite sheets of animated spinners. All frames
+ * share a single texture, but each frame is only uploaded to it the
+ * first time it is painted; once every frame is uploaded the decoded
+ * pixels are released.
+ *
+ * Frames are laid out in the texture with a 1 pixel border repeating
+ * their edges, so that filtering doesn't pick up their neighbours.
+ *
+ * Frames are drawn by StSlicedImageFrame, a content that can be set on
+ * any number of actors.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "st-sliced-image.h"
+
+#define FRAME_BORDER 1
+
+struct _StSlicedImage
+{
+  GObject parent_instance;
+
+  /* Released once every frame is uploaded */
+  GdkPixbuf *pixbuf;
+
+  CoglTexture *texture;
+  CoglTexture **frames;
+
+  int frame_width;
+  int frame_height;
+  int preferred_width;
+  int preferred_height;
+
+  int n_columns;
+  int n_frames;
+  int n_uploaded;
+
+  guint failed : 1;
+};
+
+G_DEFINE_TYPE (StSlicedImage, st_sliced_image, G_TYPE_OBJECT)
+
+#define ST_TYPE_SLICED_IMAGE_FRAME (st_sliced_image_frame_get_type ())
+G_DECLARE_FINAL_TYPE (StSlicedImageFrame, st_sliced_image_frame,
+                      ST, SLICED_IMAGE_FRAME, GObject)
+
+struct _StSlicedImageFrame
+{
+  GObject parent_instance;
+
+  StSlicedImage *image;
+  int frame;
+};
+
+static void clutter_content_interface_init (ClutterContentInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (StSlicedImageFrame, st_sliced_image_frame, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                clutter_content_interface_init))
+
+static void
+st_sliced_image_finalize (GObject *object)
+{
+  StSlicedImage *image = ST_SLICED_IMAGE (object);
+  int i;
+
+  for (i = 0; i < image->n_frames; i++)
+    cogl_clear_object (&image->frames[i]);
+
+  g_free (image->frames);
+  cogl_clear_object (&image->texture);
+  g_clear_object (&image->pixbuf);
+
+  G_OBJECT_CLASS (st_sliced_image_parent_class)->finalize (object);
+}
+
+static void
+st_sliced_image_class_init (StSlicedImageClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = st_sliced_image_finalize;
+}
+
+static void
+st_sliced_image_init (StSlicedImage *image)
+{
+}
+
+/*
+ * st_sliced_image_new:
+ * @pixbuf: the decoded image
+ * @frame_width: width of a frame, in pixels
+ * @frame_height: height of a frame, in pixels
+ * @resource_scale: the resource scale @pixbuf was decoded for
+ *
+ * Slices @pixbuf into frames of @frame_width by @frame_height pixels,
+ * row by row. Partial frames on the right and bottom edges are ignored.
+ *
+ * Returns: (transfer full): a new #StSlicedImage
+ */
+StSlicedImage *
+st_sliced_image_new (GdkPixbuf *pixbuf,
+                     int        frame_width,
+                     int        frame_height,
+                     float      resource_scale)
+{
+  StSlicedImage *image;
+  int n_rows;
+
+  g_return_val_if_fail (GDK_IS_PIXBUF (pixbuf), NULL);
+  g_return_val_if_fail (frame_width > 0 && frame_height > 0, NULL);
+  g_return_val_if_fail (resource_scale > 0, NULL);
+
+  image = g_object_new (ST_TYPE_SLICED_IMAGE, NULL);
+  image->frame_width = frame_width;
+  image->frame_height = frame_height;
+  image->preferred_width = ceilf (frame_width / resource_scale);
+  image->preferred_height = ceilf (frame_height / resource_scale);
+
+  image->n_columns = gdk_pixbuf_get_width (pixbuf) / frame_width;
+  n_rows = gdk_pixbuf_get_height (pixbuf) / frame_height;
+  image->n_frames = image->n_columns * n_rows;
+
+  if (image->n_frames > 0)
+    {
+      image->pixbuf = g_object_ref (pixbuf);
+      image->frames = g_new0 (CoglTexture *, image->n_frames);
+    }
+
+  return image;
+}
+
+/*
+ * st_sliced_image_get_n_frames:
+ * @image: a #StSlicedImage
+ *
+ * Returns: the number of frames of @image
+ */
+int
+st_sliced_image_get_n_frames (StSlicedImage *image)
+{
+  g_return_val_if_fail (ST_IS_SLICED_IMAGE (image), 0);
+
+  return image->n_frames;
+}
+
+static gboolean
+ensure_texture (StSlicedImage *image)
+{
+  CoglContext *ctx;
+  g_autoptr (GError) error = NULL;
+
+  if (image->texture != NULL)
+    return TRUE;
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  image->texture =
+    COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
+                                                 image->n_columns *
+                                                 (image->frame_width + 2 * FRAME_BORDER),
+                                                 (image->n_frames / image->n_columns) *
+                                                 (image->frame_height + 2 * FRAME_BORDER)));
+
+  if (!cogl_texture_allocate (image->texture, &error))
+    {
+      g_warning ("Failed to allocate sliced image texture: %s", error->message);
+      cogl_clear_object (&image->texture);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* Copies the pixels of @frame with a border repeating its edges */
+static guint8 *
+copy_frame_with_border (StSlicedImage *image,
+                        int            frame,
+                        int           *rowstride_out)
+{
+  const guint8 *pixels;
+  guint8 *data;
+  int src_rowstride, rowstride, bpp;
+  int x, y, width, height, i;
+
+  src_rowstride = gdk_pixbuf_get_rowstride (image->pixbuf);
+  bpp = gdk_pixbuf_get_n_channels (image->pixbuf);
+  pixels = gdk_pixbuf_read_pixels (image->pixbuf);
+
+  x = (frame % image->n_columns) * image->frame_width;
+  y = (frame / image->n_columns) * image->frame_height;
+  width = image->frame_width + 2 * FRAME_BORDER;
+  height = image->frame_height + 2 * FRAME_BORDER;
+
+  rowstride = width * bpp;
+  data = g_malloc (height * rowstride);
+
+  for (i = 0; i < image->frame_height; i++)
+    {
+      const guint8 *src = pixels + (y + i) * src_rowstride + x * bpp;
+      guint8 *row = data + (i + FRAME_BORDER) * rowstride;
+
+      memcpy (row + FRAME_BORDER * bpp, src, image->frame_width * bpp);
+      memcpy (row, src, bpp);
+      memcpy (row + (width - 1) * bpp, src + (image->frame_width - 1) * bpp, bpp);
+    }
+
+  memcpy (data, data + FRAME_BORDER * rowstride, rowstride);
+  memcpy (data + (height - 1) * rowstride, data + (height - 2) * rowstride, rowstride);
+
+  *rowstride_out = rowstride;
+  return data;
+}
+
+/*
+ * st_sliced_image_get_frame_texture:
+ * @image: a #StSlicedImage
+ * @frame: index of the frame
+ *
+ * Gets the texture of @frame, uploading it to the shared texture if
+ * it isn't already.
+ *
+ * Returns: (transfer none) (nullable): the texture of @frame, or %NULL
+ *   if it couldn't be uploaded
+ */
+CoglTexture *
+st_sliced_image_get_frame_texture (StSlicedImage *image,
+                                   int            frame)
+{
+  CoglContext *ctx;
+  g_autofree guint8 *data = NULL;
+  int x, y, rowstride;
+
+  g_return_val_if_fail (ST_IS_SLICED_IMAGE (image), NULL);
+  g_return_val_if_fail (frame >= 0 && frame < image->n_frames, NULL);
+
+  if (image->frames[frame] != NULL || image->failed)
+    return image->frames[frame];
+
+  if (!ensure_texture (image))
+    {
+      image->failed = TRUE;
+      return NULL;
+    }
+
+  x = (frame % image->n_columns) * (image->frame_width + 2 * FRAME_BORDER);
+  y = (frame / image->n_columns) * (image->frame_height + 2 * FRAME_BORDER);
+
+  data = copy_frame_with_border (image, frame, &rowstride);
+
+  if (!cogl_texture_set_region (image->texture,
+                                0, 0, x, y,
+                                image->frame_width + 2 * FRAME_BORDER,
+                                image->frame_height + 2 * FRAME_BORDER,
+                                image->frame_width + 2 * FRAME_BORDER,
+                                image->frame_height + 2 * FRAME_BORDER,
+                                gdk_pixbuf_get_has_alpha (image->pixbuf) ?
+                                  COGL_PIXEL_FORMAT_RGBA_8888 : COGL_PIXEL_FORMAT_RGB_888,
+                                rowstride,
+                                data))
+    {
+      g_warning ("Failed to upload frame %d of sliced image", frame);
+      image->failed = TRUE;
+      return NULL;
+    }
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  image->frames[frame] =
+    COGL_TEXTURE (cogl_sub_texture_new (ctx, image->texture,
+                                        x + FRAME_BORDER, y + FRAME_BORDER,
+                                        image->frame_width,
+                                        image->frame_height));
+
+  if (++image->n_uploaded == image->n_frames)
+    g_clear_object (&image->pixbuf);
+
+  return image->frames[frame];
+}
+
+/*
+ * st_sliced_image_create_frame_content:
+ * @image: a #StSlicedImage
+ * @frame: index of the frame
+ *
+ * Creates a content drawing @frame of @image. The frame is uploaded
+ * when the content is first painted.
+ *
+ * Returns: (transfer full): a new #ClutterContent
+ */
+ClutterContent *
+st_sliced_image_create_frame_content (StSlicedImage *image,
+                                      int            frame)
+{
+  StSlicedImageFrame *content;
+
+  g_return_val_if_fail (ST_IS_SLICED_IMAGE (image), NULL);
+  g_return_val_if_fail (frame >= 0 && frame < image->n_frames, NULL);
+
+  content = g_object_new (ST_TYPE_SLICED_IMAGE_FRAME, NULL);
+  content->image = g_object_ref (image);
+  content->frame = frame;
+
+  return CLUTTER_CONTENT (content);
+}
+
+static void
+st_sliced_image_frame_finalize (GObject *object)
+{
+  StSlicedImageFrame *content = ST_SLICED_IMAGE_FRAME (object);
+
+  g_clear_object (&content->image);
+
+  G_OBJECT_CLASS (st_sliced_image_frame_parent_class)->finalize (object);
+}
+
+static void
+st_sliced_image_frame_class_init (StSlicedImageFrameClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = st_sliced_image_frame_finalize;
+}
+
+static void
+st_sliced_image_frame_init (StSlicedImageFrame *content)
+{
+}
+
+static void
+st_sliced_image_frame_paint_content (ClutterContent      *content,
+                                     ClutterActor        *actor,
+                                     ClutterPaintNode    *root,
+                                     ClutterPaintContext *paint_context)
+{
+  StSlicedImageFrame *self = ST_SLICED_IMAGE_FRAME (content);
+  ClutterPaintNode *node;
+  CoglTexture *texture;
+
+  texture = st_sliced_image_get_frame_texture (self->image, self->frame);
+  if (texture == NULL)
+    return;
+
+  node = clutter_actor_create_texture_paint_node (actor, texture);
+  clutter_paint_node_set_static_name (node, "Sliced Image Frame");
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static gboolean
+st_sliced_image_frame_get_preferred_size (ClutterContent *content,
+                                          float          *width,
+                                          float          *height)
+{
+  StSlicedImageFrame *self = ST_SLICED_IMAGE_FRAME (content);
+
+  if (width != NULL)
+    *width = self->image->preferred_width;
+
+  if (height != NULL)
+    *height = self->image->preferred_height;
+
+  return TRUE;
+}
+
+static void
+clutter_content_interface_init (ClutterContentInterface *iface)
+{
+  iface->paint_content = st_sliced_image_frame_paint_content;
+  iface->get_preferred_size = st_sliced_image_frame_get_preferred_size;
+}
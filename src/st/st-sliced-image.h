@@ -0,0 +1,46 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * st-sliced-image.h: Frames of an image sliced in a grid
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __ST_SLICED_IMAGE_H__
+#define __ST_SLICED_IMAGE_H__
+
+#include <clutter/clutter.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+G_BEGIN_DECLS
+
+#define ST_TYPE_SLICED_IMAGE (st_sliced_image_get_type ())
+G_DECLARE_FINAL_TYPE (StSlicedImage, st_sliced_image,
+                      ST, SLICED_IMAGE, GObject)
+
+StSlicedImage  *st_sliced_image_new                  (GdkPixbuf     *pixbuf,
+                                                      int            frame_width,
+                                                      int            frame_height,
+                                                      float          resource_scale);
+
+int             st_sliced_image_get_n_frames         (StSlicedImage *image);
+
+CoglTexture    *st_sliced_image_get_frame_texture    (StSlicedImage *image,
+                                                      int            frame);
+
+ClutterContent *st_sliced_image_create_frame_content (StSlicedImage *image,
+                                                      int            frame);
+
+G_END_DECLS
+
+#endif /* __ST_SLICED_IMAGE_H__ */
@@ -25,6 +25,7 @@
 #include "st-texture-cache.h"
 #include "st-private.h"
 #include "st-settings.h"
+#include "st-sliced-image.h"
 #include "st-icon-theme.h"
 #include <math.h>
 #include <string.h>
@@ -33,6 +34,8 @@
 #define CACHE_PREFIX_ICON "icon:"
 #define CACHE_PREFIX_FILE "file:"
 #define CACHE_PREFIX_FILE_FOR_CAIRO "file-for-cairo:"
+#define CACHE_PREFIX_FILE_FOR_COGL "file-for-cogl:"
+#define CACHE_PREFIX_SLICED "sliced:"
 
 struct _StTextureCachePrivate
 {
@@ -41,11 +44,29 @@ struct _StTextureCachePrivate
   /* Things that were loaded with a cache policy != NONE */
   GHashTable *keyed_cache; /* char * -> ClutterImage* */
   GHashTable *keyed_surface_cache; /* char * -> cairo_surface_t* */
+  GHashTable *sliced_images; /* char * -> StSlicedImage* */
+  GQueue sliced_images_lru; /* char *, owned by sliced_images */
 
   GHashTable *used_scales; /* Set: double */
 
+  /* Icons to load ahead of time for other scales, see prewarm_icon() */
+  GQueue recent_icons; /* IconSpec * */
+  GHashTable *recent_icon_links; /* char * -> GList * */
+  GQueue prewarm_queue; /* PrewarmJob * */
+  GHashTable *prewarm_keys; /* Set: char * */
+  /* Prewarmed icons nothing loaded since, oldest first */
+  GHashTable *prewarmed_icons; /* char * -> gsize */
+  GQueue prewarmed_icons_lru; /* char *, owned by prewarmed_icons */
+  /* Queued, loading and prewarmed icons, see PREWARM_BUDGET */
+  gsize prewarm_size;
+  guint prewarm_idle_id;
+
   /* Presently this is used to de-duplicate requests for GIcons and async URIs. */
   GHashTable *outstanding_requests; /* char * -> AsyncTextureLoadData * */
+  GHashTable *outstanding_sliced_requests; /* char * -> SlicedImageRequest * */
+
+  /* File loads that failed, not retried until the file changes */
+  GHashTable *failed_file_loads; /* Set: char * */
 
   /* File monitors to evict cache data on changes */
   GHashTable *file_monitors; /* char * -> GFileMonitor * */
@@ -53,6 +74,29 @@ struct _StTextureCachePrivate
   GCancellable *cancellable;
 };
 
+/* An icon as loaded by st_texture_cache_load_gicon(), minus the scale */
+typedef struct {
+  GIcon *icon;
+  char *gicon_string;
+  char *id;
+  int size;
+  int paint_scale;
+  StIconStyle icon_style;
+  StIconLookupFlags lookup_flags;
+  StIconColors *colors;
+} IconSpec;
+
+typedef struct {
+  IconSpec *spec;
+  char *key;
+  int scale;
+  double resource_scale;
+  gsize n_bytes;
+} PrewarmJob;
+
+static void icon_spec_unref (gpointer data);
+static void prewarm_job_free (gpointer data);
+
 static void st_texture_cache_dispose (GObject *object);
 static void st_texture_cache_finalize (GObject *object);
 
@@ -60,6 +104,7 @@ enum
 {
   ICON_THEME_CHANGED,
   TEXTURE_FILE_CHANGED,
+  TEXTURE_FILE_LOADED,
 
   LAST_SIGNAL
 };
@@ -127,6 +172,24 @@ st_texture_cache_class_init (StTextureCacheClass *klass)
                   0, /* no default handler slot */
                   NULL, NULL, NULL,
                   G_TYPE_NONE, 1, G_TYPE_FILE);
+
+  /**
+   * StTextureCache::texture-file-loaded:
+   * @self: a #StTextureCache
+   * @file: a #GFile
+   *
+   * Emitted when a texture requested with
+   * st_texture_cache_load_file_to_cogl_texture() or
+   * st_texture_cache_load_file_to_cairo_surface() finished loading,
+   * and can now be looked up with the same arguments.
+   */
+  signals[TEXTURE_FILE_LOADED] =
+    g_signal_new ("texture-file-loaded",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0, /* no default handler slot */
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 1, G_TYPE_FILE);
 }
 
 /* Evicts all cached textures for named icons */
@@ -149,6 +212,23 @@ st_texture_cache_evict_icons (StTextureCache *cache)
       if (g_str_has_prefix (cache_key, CACHE_PREFIX_ICON))
         g_hash_table_iter_remove (&iter);
     }
+
+  /* Icons will be prewarmed again as they are reloaded, the ones
+   * loading still count until they are done */
+  while (cache->priv->prewarm_queue.head != NULL)
+    {
+      PrewarmJob *job = g_queue_pop_head (&cache->priv->prewarm_queue);
+
+      cache->priv->prewarm_size -= job->n_bytes;
+      prewarm_job_free (job);
+    }
+  g_hash_table_remove_all (cache->priv->prewarm_keys);
+
+  g_hash_table_iter_init (&iter, cache->priv->prewarmed_icons);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    cache->priv->prewarm_size -= GPOINTER_TO_SIZE (value);
+  g_queue_clear (&cache->priv->prewarmed_icons_lru);
+  g_hash_table_remove_all (cache->priv->prewarmed_icons);
 }
 
 static void
@@ -176,10 +256,23 @@ st_texture_cache_init (StTextureCache *self)
                                                            g_str_equal,
                                                            g_free,
                                                            (GDestroyNotify) cairo_surface_destroy);
+  self->priv->sliced_images = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                     g_free, g_object_unref);
+  g_queue_init (&self->priv->sliced_images_lru);
   self->priv->used_scales = g_hash_table_new_full (g_double_hash, g_double_equal,
                                                    g_free, NULL);
+  g_queue_init (&self->priv->recent_icons);
+  self->priv->recent_icon_links = g_hash_table_new (g_str_hash, g_str_equal);
+  g_queue_init (&self->priv->prewarm_queue);
+  self->priv->prewarm_keys = g_hash_table_new (g_str_hash, g_str_equal);
+  self->priv->prewarmed_icons = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                       g_free, NULL);
+  g_queue_init (&self->priv->prewarmed_icons_lru);
   self->priv->outstanding_requests = g_hash_table_new_full (g_str_hash, g_str_equal,
                                                             g_free, NULL);
+  self->priv->outstanding_sliced_requests = g_hash_table_new (g_str_hash, g_str_equal);
+  self->priv->failed_file_loads = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                         g_free, NULL);
   self->priv->file_monitors = g_hash_table_new_full (g_file_hash, (GEqualFunc) g_file_equal,
                                                      g_object_unref, g_object_unref);
 
@@ -198,8 +291,19 @@ st_texture_cache_dispose (GObject *object)
 
   g_clear_pointer (&self->priv->keyed_cache, g_hash_table_destroy);
   g_clear_pointer (&self->priv->keyed_surface_cache, g_hash_table_destroy);
+  g_queue_clear (&self->priv->sliced_images_lru);
+  g_clear_pointer (&self->priv->sliced_images, g_hash_table_destroy);
   g_clear_pointer (&self->priv->used_scales, g_hash_table_destroy);
+  g_clear_handle_id (&self->priv->prewarm_idle_id, g_source_remove);
+  g_clear_pointer (&self->priv->prewarm_keys, g_hash_table_destroy);
+  g_queue_clear_full (&self->priv->prewarm_queue, prewarm_job_free);
+  g_queue_clear (&self->priv->prewarmed_icons_lru);
+  g_clear_pointer (&self->priv->prewarmed_icons, g_hash_table_destroy);
+  g_clear_pointer (&self->priv->recent_icon_links, g_hash_table_destroy);
+  g_queue_clear_full (&self->priv->recent_icons, icon_spec_unref);
   g_clear_pointer (&self->priv->outstanding_requests, g_hash_table_destroy);
+  g_clear_pointer (&self->priv->outstanding_sliced_requests, g_hash_table_destroy);
+  g_clear_pointer (&self->priv->failed_file_loads, g_hash_table_destroy);
   g_clear_pointer (&self->priv->file_monitors, g_hash_table_destroy);
 
   G_OBJECT_CLASS (st_texture_cache_parent_class)->dispose (object);
@@ -269,11 +373,54 @@ compute_pixbuf_scale (gint      width,
     }
 }
 
+/* Like compute_pixbuf_scale(), but the image only needs to cover the
+ * available dimensions, so the least limiting one determines the scale.
+ */
+static void
+compute_pixbuf_cover_scale (gint      width,
+                            gint      height,
+                            gint      available_width,
+                            gint      available_height,
+                            gint     *new_width,
+                            gint     *new_height)
+{
+  double scale;
+
+  if (width == 0 || height == 0)
+    {
+      *new_width = *new_height = 0;
+      return;
+    }
+
+  if (available_width >= 0 && available_height >= 0)
+    scale = MAX ((double) available_width / width,
+                 (double) available_height / height);
+  else if (available_width >= 0)
+    scale = (double) available_width / width;
+  else if (available_height >= 0)
+    scale = (double) available_height / height;
+  else
+    scale = 1.0;
+
+  /* Scale the image only if that will not increase its original dimensions. */
+  if (scale > 0 && scale < 1.0)
+    {
+      *new_width = MAX (1, ceil (width * scale));
+      *new_height = MAX (1, ceil (height * scale));
+    }
+  else
+    {
+      *new_width = width;
+      *new_height = height;
+    }
+}
+
 /* A private structure for keeping width, height and scale. */
 typedef struct {
   int width;
   int height;
   int scale;
+  gboolean cover;
 } Dimensions;
 
 /* This struct corresponds to a request for an texture.
@@ -290,9 +437,16 @@ typedef struct {
   gfloat resource_scale;
   GSList *actors;
 
+  /* For loads without actors, see load_file_in_background() */
+  gboolean cover;
+  gboolean for_cairo;
+
   StIconInfo *icon_info;
   StIconColors *colors;
   GFile *file;
+
+  /* For prewarmed icons, see prewarm_icons_idle() */
+  gsize prewarm_size;
 } AsyncTextureLoadData;
 
 static void
@@ -329,7 +483,7 @@ texture_load_data_free (gpointer p)
  * Private function.
  *
  * Sets the size of the image being loaded to fit the available width and height dimensions,
- * but never scales up the image beyond its actual size.
+ * or to cover them if requested, but never scales up the image beyond its actual size.
  * Intended to be used as a callback for #GdkPixbufLoader "size-prepared" signal.
  */
 static void
@@ -345,8 +499,12 @@ on_image_size_prepared (GdkPixbufLoader *pixbuf_loader,
   int scaled_width;
   int scaled_height;
 
-  compute_pixbuf_scale (width, height, available_width, available_height,
-                        &scaled_width, &scaled_height);
+  if (available_dimensions->cover)
+    compute_pixbuf_cover_scale (width, height, available_width, available_height,
+                                &scaled_width, &scaled_height);
+  else
+    compute_pixbuf_scale (width, height, available_width, available_height,
+                          &scaled_width, &scaled_height);
 
   gdk_pixbuf_loader_set_size (pixbuf_loader,
                               scaled_width * scale_factor,
@@ -359,6 +517,7 @@ impl_load_pixbuf_data (const guchar   *data,
                        int             available_width,
                        int             available_height,
                        int             scale,
+                       gboolean        cover,
                        GError        **error)
 {
   GdkPixbufLoader *pixbuf_loader = NULL;
@@ -373,6 +532,7 @@ impl_load_pixbuf_data (const guchar   *data,
   available_dimensions.width = available_width;
   available_dimensions.height = available_height;
   available_dimensions.scale = scale;
+  available_dimensions.cover = cover;
   g_signal_connect (pixbuf_loader, "size-prepared",
                     G_CALLBACK (on_image_size_prepared), &available_dimensions);
 
@@ -407,6 +567,7 @@ impl_load_pixbuf_data (const guchar   *data,
       available_dimensions.width = available_height;
       available_dimensions.height = available_width;
       available_dimensions.scale = scale;
+      available_dimensions.cover = cover;
       g_signal_connect (pixbuf_loader, "size-prepared",
                         G_CALLBACK (on_image_size_prepared), &available_dimensions);
 
@@ -435,6 +596,7 @@ impl_load_pixbuf_file (GFile          *file,
                        int             available_height,
                        int             paint_scale,
                        float           resource_scale,
+                       gboolean        cover,
                        GError        **error)
 {
   GdkPixbuf *pixbuf = NULL;
@@ -446,7 +608,7 @@ impl_load_pixbuf_file (GFile          *file,
       int scale = ceilf (paint_scale * resource_scale);
       pixbuf = impl_load_pixbuf_data ((const guchar *) contents, size,
                                       available_width, available_height,
-                                      scale,
+                                      scale, cover,
                                       error);
     }
 
@@ -470,7 +632,7 @@ load_pixbuf_thread (GTask        *result,
 
   pixbuf = impl_load_pixbuf_file (data->file, data->width, data->height,
                                   data->paint_scale, data->resource_scale,
-                                  &error);
+                                  data->cover, &error);
 
   if (error != NULL)
     g_task_return_error (result, error);
@@ -730,7 +892,20 @@ finish_texture_load (AsyncTextureLoadData *data,
       set_content_from_image (actor, image);
     }
 
+  /* Counted against the budget until the icon is used */
+  if (data->prewarm_size > 0 && data->actors == NULL)
+    {
+      StTextureCachePrivate *priv = cache->priv;
+      char *key = g_strdup (data->key);
+
+      g_hash_table_insert (priv->prewarmed_icons, key,
+                           GSIZE_TO_POINTER (data->prewarm_size));
+      g_queue_push_tail (&priv->prewarmed_icons_lru, key);
+      data->prewarm_size = 0;
+    }
+
 out:
+  cache->priv->prewarm_size -= data->prewarm_size;
   texture_load_data_free (data);
 }
 
@@ -1036,6 +1211,291 @@ ensure_request (StTextureCache        *cache,
   return had_pending;
 }
 
+static gboolean
+hash_table_insert_scale (GHashTable *hash,
+                         double      scale)
+{
+  double *saved_scale;
+
+  if (g_hash_table_contains (hash, &scale))
+    return FALSE;
+
+  saved_scale = g_new (double, 1);
+  *saved_scale = scale;
+
+  g_hash_table_add (hash, saved_scale);
+  return TRUE;
+}
+
+static char *
+icon_cache_key (const char   *gicon_string,
+                int           size,
+                int           scale,
+                StIconStyle   icon_style,
+                StIconColors *colors)
+{
+  if (colors)
+    {
+      /* This raises some doubts about the practice of using string keys */
+      return g_strdup_printf (CACHE_PREFIX_ICON "%s,size=%d,scale=%d,style=%d,colors=%2x%2x%2x%2x,%2x%2x%2x%2x,%2x%2x%2x%2x,%2x%2x%2x%2x",
+                              gicon_string, size, scale, icon_style,
+                              colors->foreground.red, colors->foreground.blue, colors->foreground.green, colors->foreground.alpha,
+                              colors->warning.red, colors->warning.blue, colors->warning.green, colors->warning.alpha,
+                              colors->error.red, colors->error.blue, colors->error.green, colors->error.alpha,
+                              colors->success.red, colors->success.blue, colors->success.green, colors->success.alpha);
+    }
+  else
+    {
+      return g_strdup_printf (CACHE_PREFIX_ICON "%s,size=%d,scale=%d,style=%d",
+                              gicon_string, size, scale, icon_style);
+    }
+}
+
+/* Icons are loaded ahead of time for the other scales in used_scales,
+ * so that moving them to a monitor with another scale finds them in
+ * the cache. This applies to the icons loaded most recently, which are
+ * the ones on screen, within a memory budget.
+ */
+#define MAX_PREWARM_ICONS 256
+#define PREWARM_BUDGET (16 * 1024 * 1024)
+
+static void
+icon_spec_clear (gpointer data)
+{
+  IconSpec *spec = data;
+
+  g_object_unref (spec->icon);
+  g_free (spec->gicon_string);
+  g_free (spec->id);
+  g_clear_pointer (&spec->colors, st_icon_colors_unref);
+}
+
+static void
+icon_spec_unref (gpointer data)
+{
+  g_rc_box_release_full (data, icon_spec_clear);
+}
+
+static void
+prewarm_job_free (gpointer data)
+{
+  PrewarmJob *job = data;
+
+  icon_spec_unref (job->spec);
+  g_free (job->key);
+  g_free (job);
+}
+
+/* Stops counting a prewarmed icon against the budget, as it is used
+ * now or is evicted */
+static void
+forget_prewarmed_icon (StTextureCache *cache,
+                       const char     *key,
+                       gboolean        evict)
+{
+  StTextureCachePrivate *priv = cache->priv;
+  gpointer orig_key, n_bytes;
+
+  if (!g_hash_table_lookup_extended (priv->prewarmed_icons, key,
+                                     &orig_key, &n_bytes))
+    return;
+
+  priv->prewarm_size -= GPOINTER_TO_SIZE (n_bytes);
+  g_queue_remove (&priv->prewarmed_icons_lru, orig_key);
+
+  if (evict)
+    g_hash_table_remove (priv->keyed_cache, orig_key);
+
+  g_hash_table_remove (priv->prewarmed_icons, orig_key);
+}
+
+static gboolean
+prewarm_icons_idle (gpointer user_data)
+{
+  StTextureCache *cache = user_data;
+  StTextureCachePrivate *priv = cache->priv;
+  AsyncTextureLoadData *request;
+  PrewarmJob *job;
+  StIconInfo *info;
+
+  job = g_queue_pop_head (&priv->prewarm_queue);
+  if (job == NULL)
+    {
+      priv->prewarm_idle_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  g_hash_table_remove (priv->prewarm_keys, job->key);
+
+  if (g_hash_table_contains (priv->keyed_cache, job->key) ||
+      g_hash_table_contains (priv->outstanding_requests, job->key))
+    {
+      priv->prewarm_size -= job->n_bytes;
+      goto out;
+    }
+
+  info = st_icon_theme_lookup_by_gicon_for_scale (priv->icon_theme,
+                                                  job->spec->icon,
+                                                  job->spec->size,
+                                                  job->scale,
+                                                  job->spec->lookup_flags);
+  if (info == NULL)
+    {
+      priv->prewarm_size -= job->n_bytes;
+      goto out;
+    }
+
+  /* A request without actors, loads for the same icon and scale
+   * that come in meanwhile are added to it. */
+  request = g_new0 (AsyncTextureLoadData, 1);
+  request->cache = cache;
+  request->key = g_strdup (job->key);
+  request->policy = ST_TEXTURE_CACHE_POLICY_FOREVER;
+  request->colors = job->spec->colors ? st_icon_colors_ref (job->spec->colors) : NULL;
+  request->icon_info = info;
+  request->width = request->height = job->spec->size;
+  request->paint_scale = job->spec->paint_scale;
+  request->resource_scale = job->resource_scale;
+  request->prewarm_size = job->n_bytes;
+
+  g_hash_table_insert (priv->outstanding_requests, g_strdup (job->key), request);
+  load_texture_async (cache, request);
+
+ out:
+  prewarm_job_free (job);
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+prewarm_icon (StTextureCache *cache,
+              IconSpec       *spec,
+              double          resource_scale)
+{
+  StTextureCachePrivate *priv = cache->priv;
+  PrewarmJob *job;
+  g_autofree char *key = NULL;
+  gsize n_bytes;
+  int scale;
+
+  scale = ceilf (spec->paint_scale * resource_scale);
+  key = icon_cache_key (spec->gicon_string, spec->size, scale,
+                        spec->icon_style, spec->colors);
+
+  if (g_hash_table_contains (priv->keyed_cache, key) ||
+      g_hash_table_contains (priv->outstanding_requests, key) ||
+      g_hash_table_contains (priv->prewarm_keys, key))
+    return;
+
+  n_bytes = (gsize) spec->size * scale * spec->size * scale * 4;
+  if (n_bytes > PREWARM_BUDGET)
+    return;
+
+  /* Make room by dropping the icons prewarmed longest ago that weren't
+   * used since, queued and loading ones can't be dropped */
+  while (priv->prewarm_size + n_bytes > PREWARM_BUDGET &&
+         priv->prewarmed_icons_lru.head != NULL)
+    forget_prewarmed_icon (cache, priv->prewarmed_icons_lru.head->data, TRUE);
+
+  if (priv->prewarm_size + n_bytes > PREWARM_BUDGET)
+    return;
+
+  priv->prewarm_size += n_bytes;
+
+  job = g_new0 (PrewarmJob, 1);
+  job->spec = g_rc_box_acquire (spec);
+  job->key = g_steal_pointer (&key);
+  job->scale = scale;
+  job->resource_scale = resource_scale;
+  job->n_bytes = n_bytes;
+
+  g_hash_table_add (priv->prewarm_keys, job->key);
+  g_queue_push_tail (&priv->prewarm_queue, job);
+
+  if (priv->prewarm_idle_id == 0)
+    {
+      priv->prewarm_idle_id = g_idle_add_full (G_PRIORITY_LOW,
+                                               prewarm_icons_idle,
+                                               cache, NULL);
+      g_source_set_name_by_id (priv->prewarm_idle_id,
+                               "[st] prewarm_icons_idle");
+    }
+}
+
+/* Records the resource scale something was loaded for, and loads
+ * the recent icons for it if it wasn't known yet */
+static void
+st_texture_cache_add_used_scale (StTextureCache *cache,
+                                 double          resource_scale)
+{
+  GList *l;
+
+  if (!hash_table_insert_scale (cache->priv->used_scales, resource_scale))
+    return;
+
+  for (l = cache->priv->recent_icons.head; l; l = l->next)
+    prewarm_icon (cache, l->data, resource_scale);
+}
+
+static void
+remember_icon (StTextureCache    *cache,
+               GIcon             *icon,
+               const char        *gicon_string,
+               int                size,
+               int                paint_scale,
+               StIconStyle        icon_style,
+               StIconLookupFlags  lookup_flags,
+               StIconColors      *colors,
+               double             resource_scale)
+{
+  StTextureCachePrivate *priv = cache->priv;
+  GHashTableIter iter;
+  IconSpec *spec;
+  GList *link;
+  gpointer scale;
+  char *id;
+
+  id = icon_cache_key (gicon_string, size, 0, icon_style, colors);
+
+  link = g_hash_table_lookup (priv->recent_icon_links, id);
+  if (link != NULL)
+    {
+      /* Already prewarmed when it was first loaded */
+      g_queue_unlink (&priv->recent_icons, link);
+      g_queue_push_head_link (&priv->recent_icons, link);
+      g_free (id);
+      return;
+    }
+
+  spec = g_rc_box_new0 (IconSpec);
+  spec->icon = g_object_ref (icon);
+  spec->gicon_string = g_strdup (gicon_string);
+  spec->id = id;
+  spec->size = size;
+  spec->paint_scale = paint_scale;
+  spec->icon_style = icon_style;
+  spec->lookup_flags = lookup_flags;
+  spec->colors = colors ? st_icon_colors_ref (colors) : NULL;
+
+  g_queue_push_head (&priv->recent_icons, spec);
+  g_hash_table_insert (priv->recent_icon_links, spec->id,
+                       priv->recent_icons.head);
+
+  if (priv->recent_icons.length > MAX_PREWARM_ICONS)
+    {
+      IconSpec *oldest = g_queue_pop_tail (&priv->recent_icons);
+
+      g_hash_table_remove (priv->recent_icon_links, oldest->id);
+      icon_spec_unref (oldest);
+    }
+
+  g_hash_table_iter_init (&iter, priv->used_scales);
+  while (g_hash_table_iter_next (&iter, &scale, NULL))
+    {
+      if (*(double *) scale != resource_scale)
+        prewarm_icon (cache, spec, *(double *) scale);
+    }
+}
+
 /**
  * st_texture_cache_load_gicon:
  * @cache: A #StTextureCache
@@ -1123,22 +1583,8 @@ st_texture_cache_load_gicon (StTextureCache    *cache,
    * now; we should actually blow this away on icon theme changes probably */
   policy = gicon_string != NULL ? ST_TEXTURE_CACHE_POLICY_FOREVER
                                 : ST_TEXTURE_CACHE_POLICY_NONE;
-  if (colors)
-    {
-      /* This raises some doubts about the practice of using string keys */
-      key = g_strdup_printf (CACHE_PREFIX_ICON "%s,size=%d,scale=%d,style=%d,colors=%2x%2x%2x%2x,%2x%2x%2x%2x,%2x%2x%2x%2x,%2x%2x%2x%2x",
-                             gicon_string, size, scale, icon_style,
-                             colors->foreground.red, colors->foreground.blue, colors->foreground.green, colors->foreground.alpha,
-                             colors->warning.red, colors->warning.blue, colors->warning.green, colors->warning.alpha,
-                             colors->error.red, colors->error.blue, colors->error.green, colors->error.alpha,
-                             colors->success.red, colors->success.blue, colors->success.green, colors->success.alpha);
-    }
-  else
-    {
-      key = g_strdup_printf (CACHE_PREFIX_ICON "%s,size=%d,scale=%d,style=%d",
-                             gicon_string, size, scale, icon_style);
-    }
-  g_free (gicon_string);
+  key = icon_cache_key (gicon_string, size, scale, icon_style, colors);
+  forget_prewarmed_icon (cache, key, FALSE);
 
   actor = create_invisible_actor ();
   clutter_actor_set_content_gravity  (actor, CLUTTER_CONTENT_GRAVITY_RESIZE_ASPECT);
@@ -1156,6 +1602,7 @@ st_texture_cache_load_gicon (StTextureCache    *cache,
           g_hash_table_remove (cache->priv->outstanding_requests, key);
           texture_load_data_free (request);
           g_object_unref (actor);
+          g_free (gicon_string);
           return NULL;
         }
 
@@ -1172,56 +1619,52 @@ st_texture_cache_load_gicon (StTextureCache    *cache,
       load_texture_async (cache, request);
     }
 
-  return actor;
-}
-
-static ClutterActor *
-load_from_pixbuf (GdkPixbuf *pixbuf,
-                  int        paint_scale,
-                  float      resource_scale)
-{
-  g_autoptr(ClutterContent) image = NULL;
-  ClutterActor *actor;
-
-  image = pixbuf_to_st_content_image (pixbuf, -1, -1, paint_scale, resource_scale);
+  if (gicon_string != NULL)
+    {
+      st_texture_cache_add_used_scale (cache, resource_scale);
+      remember_icon (cache, icon, gicon_string, size, paint_scale,
+                     icon_style, lookup_flags, colors, resource_scale);
+    }
 
-  actor = g_object_new (CLUTTER_TYPE_ACTOR,
-                        "request-mode", CLUTTER_REQUEST_CONTENT_SIZE,
-                        NULL);
-  clutter_actor_set_content (actor, image);
+  g_free (gicon_string);
 
   return actor;
 }
 
 static void
-hash_table_remove_with_scales (GHashTable *hash,
-                               GList      *scales,
-                               const char *base_key)
+hash_table_remove_with_prefix (GHashTable *hash,
+                               const char *prefix)
 {
-  GList *l;
+  GHashTableIter iter;
+  gpointer key;
 
-  for (l = scales; l; l = l->next)
+  g_hash_table_iter_init (&iter, hash);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
     {
-      double scale = *((double *)l->data);
-      g_autofree char *key = NULL;
-      key = g_strdup_printf ("%s%f", base_key, scale);
-      g_hash_table_remove (hash, key);
+      if (g_str_has_prefix (key, prefix))
+        g_hash_table_iter_remove (&iter);
     }
 }
 
 static void
-hash_table_insert_scale (GHashTable *hash,
-                         double      scale)
+remove_sliced_images_with_prefix (StTextureCache *cache,
+                                  const char     *prefix)
 {
-  double *saved_scale;
+  StTextureCachePrivate *priv = cache->priv;
+  GList *l, *next;
 
-  if (g_hash_table_contains (hash, &scale))
-    return;
+  for (l = priv->sliced_images_lru.head; l; l = next)
+    {
+      char *key = l->data;
 
-  saved_scale = g_new (double, 1);
-  *saved_scale = scale;
+      next = l->next;
 
-  g_hash_table_add (hash, saved_scale);
+      if (g_str_has_prefix (key, prefix))
+        {
+          g_queue_delete_link (&priv->sliced_images_lru, l);
+          g_hash_table_remove (priv->sliced_images, key);
+        }
+    }
 }
 
 static void
@@ -1232,25 +1675,34 @@ file_changed_cb (GFileMonitor      *monitor,
                  gpointer           user_data)
 {
   StTextureCache *cache = user_data;
-  char *key;
+  StTextureCachePrivate *priv = cache->priv;
+  g_autofree char *uri = NULL;
+  char *prefix;
   guint file_hash;
-  g_autoptr (GList) scales = NULL;
 
   if (event_type != G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT)
     return;
 
   file_hash = g_file_hash (file);
-  scales = g_hash_table_get_keys (cache->priv->used_scales);
 
-  key = g_strdup_printf (CACHE_PREFIX_FILE "%u", file_hash);
-  g_hash_table_remove (cache->priv->keyed_cache, key);
-  hash_table_remove_with_scales (cache->priv->keyed_cache, scales, key);
-  g_free (key);
+  prefix = g_strdup_printf (CACHE_PREFIX_FILE "%u:", file_hash);
+  hash_table_remove_with_prefix (priv->keyed_cache, prefix);
+  g_free (prefix);
+
+  prefix = g_strdup_printf (CACHE_PREFIX_FILE_FOR_COGL "%u:", file_hash);
+  hash_table_remove_with_prefix (priv->keyed_cache, prefix);
+  hash_table_remove_with_prefix (priv->failed_file_loads, prefix);
+  g_free (prefix);
+
+  prefix = g_strdup_printf (CACHE_PREFIX_FILE_FOR_CAIRO "%u:", file_hash);
+  hash_table_remove_with_prefix (priv->keyed_surface_cache, prefix);
+  hash_table_remove_with_prefix (priv->failed_file_loads, prefix);
+  g_free (prefix);
 
-  key = g_strdup_printf (CACHE_PREFIX_FILE_FOR_CAIRO "%u", file_hash);
-  g_hash_table_remove (cache->priv->keyed_surface_cache, key);
-  hash_table_remove_with_scales (cache->priv->keyed_surface_cache, scales, key);
-  g_free (key);
+  uri = g_file_get_uri (file);
+  prefix = g_strdup_printf (CACHE_PREFIX_SLICED "%s:", uri);
+  remove_sliced_images_with_prefix (cache, prefix);
+  g_free (prefix);
 
   g_signal_emit (cache, signals[TEXTURE_FILE_CHANGED], 0, file);
 }
@@ -1278,7 +1730,6 @@ ensure_monitor_for_file (StTextureCache *cache,
 }
 
 typedef struct {
-  GFile *gfile;
   gint   grid_width, grid_height;
   gint   paint_scale;
   gfloat resource_scale;
@@ -1288,16 +1739,34 @@ typedef struct {
   gpointer load_callback_data;
 } AsyncImageData;
 
+/* A sliced image being decoded, and the loads waiting for it */
+typedef struct {
+  char  *key;
+  GFile *gfile;
+  gint   scale;
+  gint   frame_width, frame_height;
+  gfloat resource_scale;
+  GSList *tasks;
+} SlicedImageRequest;
+
 static void
 on_data_destroy (gpointer data)
 {
   AsyncImageData *d = (AsyncImageData *)data;
-  g_object_unref (d->gfile);
   g_object_unref (d->actor);
   g_object_unref (d->cancellable);
   g_free (d);
 }
 
+static void
+sliced_image_request_free (SlicedImageRequest *request)
+{
+  g_free (request->key);
+  g_object_unref (request->gfile);
+  g_slist_free_full (request->tasks, g_object_unref);
+  g_free (request);
+}
+
 static void
 on_sliced_image_actor_destroyed (ClutterActor *actor,
                                  gpointer data)
@@ -1316,7 +1785,8 @@ on_sliced_image_loaded (GObject *source_object,
   GObject *cache = source_object;
   AsyncImageData *data = (AsyncImageData *)user_data;
   GTask *task = G_TASK (res);
-  GList *list, *pixbufs;
+  g_autoptr (StSlicedImage) image = NULL;
+  int i, n_frames;
 
   if (g_task_had_error (task) || g_cancellable_is_cancelled (data->cancellable))
     return;
@@ -1327,13 +1797,22 @@ on_sliced_image_loaded (GObject *source_object,
   clutter_actor_set_x_expand (data->actor, FALSE);
   clutter_actor_set_y_expand (data->actor, FALSE);
 
-  pixbufs = g_task_propagate_pointer (task, NULL);
+  image = g_task_propagate_pointer (task, NULL);
+  n_frames = image != NULL ? st_sliced_image_get_n_frames (image) : 0;
 
-  for (list = pixbufs; list; list = list->next)
+  /* Frames only hold a reference on the shared image, they are
+   * uploaded to its texture when first painted.
+   */
+  for (i = 0; i < n_frames; i++)
     {
-      ClutterActor *actor = load_from_pixbuf (GDK_PIXBUF (list->data),
-                                              data->paint_scale,
-                                              data->resource_scale);
+      g_autoptr (ClutterContent) content = NULL;
+      ClutterActor *actor;
+
+      content = st_sliced_image_create_frame_content (image, i);
+      actor = g_object_new (CLUTTER_TYPE_ACTOR,
+                            "request-mode", CLUTTER_REQUEST_CONTENT_SIZE,
+                            "content", content,
+                            NULL);
       clutter_actor_set_x_expand (actor, TRUE);
       clutter_actor_set_y_expand (actor, TRUE);
       clutter_actor_set_x_align (actor, CLUTTER_ACTOR_ALIGN_FILL);
@@ -1342,8 +1821,6 @@ on_sliced_image_loaded (GObject *source_object,
       clutter_actor_add_child (data->actor, actor);
     }
 
-  g_list_free_full (pixbufs, g_object_unref);
-
   g_signal_handlers_disconnect_by_func (data->actor,
                                         on_sliced_image_actor_destroyed,
                                         task);
@@ -1352,22 +1829,17 @@ on_sliced_image_loaded (GObject *source_object,
     data->load_callback (cache, data->load_callback_data);
 }
 
-static void
-free_glist_unref_gobjects (gpointer p)
-{
-  g_list_free_full (p, g_object_unref);
-}
-
 static void
 on_loader_size_prepared (GdkPixbufLoader *loader,
                          gint width,
                          gint height,
                          gpointer user_data)
 {
-  AsyncImageData *data = user_data;
-  int scale = ceilf (data->paint_scale * data->resource_scale);
+  SlicedImageRequest *request = user_data;
 
-  gdk_pixbuf_loader_set_size (loader, width * scale, height * scale);
+  gdk_pixbuf_loader_set_size (loader,
+                              width * request->scale,
+                              height * request->scale);
 }
 
 static void
@@ -1376,11 +1848,8 @@ load_sliced_image (GTask        *result,
                    gpointer      task_data,
                    GCancellable *cancellable)
 {
-  AsyncImageData *data;
-  GList *res = NULL;
-  GdkPixbuf *pix;
-  gint width, height, y, x;
-  gint scale_factor;
+  SlicedImageRequest *request;
+  GdkPixbuf *pix = NULL;
   GdkPixbufLoader *loader;
   GError *error = NULL;
   gchar *buffer = NULL;
@@ -1388,13 +1857,13 @@ load_sliced_image (GTask        *result,
 
   g_assert (cancellable);
 
-  data = task_data;
-  g_assert (data);
+  request = task_data;
+  g_assert (request);
 
   loader = gdk_pixbuf_loader_new ();
-  g_signal_connect (loader, "size-prepared", G_CALLBACK (on_loader_size_prepared), data);
+  g_signal_connect (loader, "size-prepared", G_CALLBACK (on_loader_size_prepared), request);
 
-  if (!g_file_load_contents (data->gfile, cancellable, &buffer, &length, NULL, &error))
+  if (!g_file_load_contents (request->gfile, cancellable, &buffer, &length, NULL, &error))
     {
       g_warning ("Failed to open sliced image: %s", error->message);
       goto out;
@@ -1409,29 +1878,166 @@ load_sliced_image (GTask        *result,
   if (!gdk_pixbuf_loader_close (loader, NULL))
     goto out;
 
-  pix = gdk_pixbuf_loader_get_pixbuf (loader);
-  width = gdk_pixbuf_get_width (pix);
-  height = gdk_pixbuf_get_height (pix);
-  scale_factor = ceilf (data->paint_scale * data->resource_scale);
-  for (y = 0; y < height; y += data->grid_height * scale_factor)
-    {
-      for (x = 0; x < width; x += data->grid_width * scale_factor)
-        {
-          GdkPixbuf *pixbuf = gdk_pixbuf_new_subpixbuf (pix, x, y,
-                                                        data->grid_width * scale_factor,
-                                                        data->grid_height * scale_factor);
-          g_assert (pixbuf != NULL);
-          res = g_list_append (res, pixbuf);
-        }
-    }
+  pix = g_object_ref (gdk_pixbuf_loader_get_pixbuf (loader));
 
  out:
-  /* We don't need the original pixbuf anymore, which is owned by the loader,
-   * though the subpixbufs will hold a reference. */
   g_object_unref (loader);
   g_free (buffer);
   g_clear_pointer (&error, g_error_free);
-  g_task_return_pointer (result, res, free_glist_unref_gobjects);
+  g_task_return_pointer (result, pix, g_object_unref);
+}
+
+/* Only the most recently used images are kept, images still shown stay
+ * alive through their frames anyway.
+ */
+#define MAX_CACHED_SLICED_IMAGES 8
+
+static StSlicedImage *
+lookup_sliced_image (StTextureCache *cache,
+                     const char     *key)
+{
+  StTextureCachePrivate *priv = cache->priv;
+  gpointer orig_key, image;
+
+  if (!g_hash_table_lookup_extended (priv->sliced_images, key, &orig_key, &image))
+    return NULL;
+
+  g_queue_remove (&priv->sliced_images_lru, orig_key);
+  g_queue_push_head (&priv->sliced_images_lru, orig_key);
+
+  return image;
+}
+
+static void
+insert_sliced_image (StTextureCache *cache,
+                     const char     *key,
+                     StSlicedImage  *image)
+{
+  StTextureCachePrivate *priv = cache->priv;
+  gpointer orig_key;
+  char *new_key;
+
+  if (g_hash_table_lookup_extended (priv->sliced_images, key, &orig_key, NULL))
+    {
+      g_queue_remove (&priv->sliced_images_lru, orig_key);
+      g_hash_table_remove (priv->sliced_images, key);
+    }
+
+  new_key = g_strdup (key);
+  g_hash_table_insert (priv->sliced_images, new_key, g_object_ref (image));
+  g_queue_push_head (&priv->sliced_images_lru, new_key);
+
+  while (priv->sliced_images_lru.length > MAX_CACHED_SLICED_IMAGES)
+    {
+      char *oldest = g_queue_pop_tail (&priv->sliced_images_lru);
+
+      g_hash_table_remove (priv->sliced_images, oldest);
+    }
+}
+
+static void
+on_sliced_image_decoded (GObject      *source,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+  StTextureCache *cache = ST_TEXTURE_CACHE (source);
+  SlicedImageRequest *request = user_data;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (StSlicedImage) image = NULL;
+  GSList *l;
+
+  pixbuf = g_task_propagate_pointer (G_TASK (result), NULL);
+
+  /* The cache was disposed */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result))))
+    {
+      for (l = request->tasks; l; l = l->next)
+        g_task_return_new_error (l->data,
+                                 G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                 "Texture cache was disposed");
+
+      sliced_image_request_free (request);
+      return;
+    }
+
+  g_hash_table_remove (cache->priv->outstanding_sliced_requests, request->key);
+
+  if (pixbuf != NULL)
+    {
+      image = st_sliced_image_new (pixbuf,
+                                   request->frame_width,
+                                   request->frame_height,
+                                   request->resource_scale);
+      insert_sliced_image (cache, request->key, image);
+    }
+
+  request->tasks = g_slist_reverse (request->tasks);
+  for (l = request->tasks; l; l = l->next)
+    g_task_return_pointer (l->data,
+                           image != NULL ? g_object_ref (image) : NULL,
+                           g_object_unref);
+
+  sliced_image_request_free (request);
+}
+
+static char *
+sliced_image_key (GFile *file,
+                  gint   grid_width,
+                  gint   grid_height,
+                  gint   paint_scale,
+                  gfloat resource_scale)
+{
+  g_autofree char *uri = g_file_get_uri (file);
+
+  return g_strdup_printf (CACHE_PREFIX_SLICED "%s:%dx%d:%d:%f",
+                          uri, grid_width, grid_height,
+                          paint_scale, resource_scale);
+}
+
+/* Decodes the image only once for all loads of the same key, frames
+ * are shared from then on.
+ */
+static void
+request_sliced_image (StTextureCache *cache,
+                      GFile          *file,
+                      const char     *key,
+                      AsyncImageData *data,
+                      GTask          *task)
+{
+  StTextureCachePrivate *priv = cache->priv;
+  StSlicedImage *image;
+  SlicedImageRequest *request;
+  GTask *load;
+
+  image = lookup_sliced_image (cache, key);
+  if (image != NULL)
+    {
+      g_task_return_pointer (task, g_object_ref (image), g_object_unref);
+      return;
+    }
+
+  request = g_hash_table_lookup (priv->outstanding_sliced_requests, key);
+  if (request != NULL)
+    {
+      request->tasks = g_slist_prepend (request->tasks, g_object_ref (task));
+      return;
+    }
+
+  request = g_new0 (SlicedImageRequest, 1);
+  request->key = g_strdup (key);
+  request->gfile = g_object_ref (file);
+  request->scale = ceilf (data->paint_scale * data->resource_scale);
+  request->frame_width = data->grid_width * request->scale;
+  request->frame_height = data->grid_height * request->scale;
+  request->resource_scale = data->resource_scale;
+  request->tasks = g_slist_prepend (NULL, g_object_ref (task));
+
+  g_hash_table_insert (priv->outstanding_sliced_requests, request->key, request);
+
+  load = g_task_new (cache, priv->cancellable, on_sliced_image_decoded, request);
+  g_task_set_task_data (load, request, NULL);
+  g_task_run_in_thread (load, load_sliced_image);
+  g_object_unref (load);
 }
 
 /**
@@ -1449,6 +2055,10 @@ load_sliced_image (GTask        *result,
  * note that the dimensions of the image loaded from @path
  * should be a multiple of the specified grid dimensions.
  *
+ * The image is decoded once and shared by all actors loading it at the
+ * same scale. Its frames are uploaded to a single texture the first
+ * time they are shown.
+ *
  * Returns: (transfer none): A new #ClutterActor
  */
 ClutterActor *
@@ -1465,6 +2075,7 @@ st_texture_cache_load_sliced_image (StTextureCache *cache,
   GTask *result;
   ClutterActor *actor = clutter_actor_new ();
   GCancellable *cancellable = g_cancellable_new ();
+  g_autofree char *key = NULL;
 
   g_return_val_if_fail (G_IS_FILE (file), NULL);
   g_assert (paint_scale > 0);
@@ -1475,7 +2086,6 @@ st_texture_cache_load_sliced_image (StTextureCache *cache,
   data->grid_height = grid_height;
   data->paint_scale = paint_scale;
   data->resource_scale = resource_scale;
-  data->gfile = g_object_ref (file);
   data->actor = actor;
   data->cancellable = cancellable;
   data->load_callback = load_callback;
@@ -1488,13 +2098,70 @@ st_texture_cache_load_sliced_image (StTextureCache *cache,
                     G_CALLBACK (on_sliced_image_actor_destroyed), result);
 
   g_task_set_task_data (result, data, on_data_destroy);
-  g_task_run_in_thread (result, load_sliced_image);
+
+  ensure_monitor_for_file (cache, file);
+
+  key = sliced_image_key (file, grid_width, grid_height,
+                          paint_scale, resource_scale);
+  request_sliced_image (cache, file, key, data, result);
 
   g_object_unref (result);
 
   return actor;
 }
 
+int
+_st_texture_cache_get_n_sliced_images (StTextureCache *cache)
+{
+  g_return_val_if_fail (ST_IS_TEXTURE_CACHE (cache), 0);
+
+  return g_hash_table_size (cache->priv->sliced_images);
+}
+
+gsize
+_st_texture_cache_get_prewarm_size (StTextureCache *cache)
+{
+  g_return_val_if_fail (ST_IS_TEXTURE_CACHE (cache), 0);
+
+  return cache->priv->prewarm_size;
+}
+
+gboolean
+_st_texture_cache_is_prewarming (StTextureCache *cache)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_return_val_if_fail (ST_IS_TEXTURE_CACHE (cache), FALSE);
+
+  if (cache->priv->prewarm_queue.head != NULL)
+    return TRUE;
+
+  g_hash_table_iter_init (&iter, cache->priv->outstanding_requests);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+      AsyncTextureLoadData *request = value;
+
+      if (request->prewarm_size > 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static char *
+file_cache_key (const char *prefix,
+                GFile      *file,
+                int         available_width,
+                int         available_height,
+                int         paint_scale,
+                float       resource_scale)
+{
+  return g_strdup_printf ("%s%u:%dx%d:%d:%f", prefix, g_file_hash (file),
+                          available_width, available_height,
+                          paint_scale, resource_scale);
+}
+
 /**
  * st_texture_cache_load_file_async:
  * @cache: A #StTextureCache
@@ -1508,6 +2175,10 @@ st_texture_cache_load_sliced_image (StTextureCache *cache,
  * size of zero.  At some later point, either the image will be loaded successfully
  * and at that point size will be negotiated, or upon an error, no image will be set.
  *
+ * The image is decoded at the size it will be displayed at. Loads of
+ * @file with the same size and scales that overlap share the decoding,
+ * but the image isn't kept afterwards.
+ *
  * Returns: (transfer none): A new #ClutterActor with no image loaded initially.
  */
 ClutterActor *
@@ -1522,12 +2193,12 @@ st_texture_cache_load_file_async (StTextureCache *cache,
   AsyncTextureLoadData *request;
   StTextureCachePolicy policy;
   gchar *key;
-  int scale;
 
-  scale = ceilf (paint_scale * resource_scale);
-  key = g_strdup_printf (CACHE_PREFIX_FILE "%u%d", g_file_hash (file), scale);
+  key = file_cache_key (CACHE_PREFIX_FILE, file,
+                        available_width, available_height,
+                        paint_scale, resource_scale);
 
-  policy = ST_TEXTURE_CACHE_POLICY_NONE; /* XXX */
+  policy = ST_TEXTURE_CACHE_POLICY_NONE;
 
   actor = create_invisible_actor ();
 
@@ -1558,179 +2229,195 @@ st_texture_cache_load_file_async (StTextureCache *cache,
   return actor;
 }
 
-static CoglTexture *
-st_texture_cache_load_file_sync_to_cogl_texture (StTextureCache *cache,
-                                                 StTextureCachePolicy policy,
-                                                 GFile          *file,
-                                                 int             available_width,
-                                                 int             available_height,
-                                                 int             paint_scale,
-                                                 gfloat          resource_scale,
-                                                 GError         **error)
+static void
+on_file_loaded_in_background (GObject      *source,
+                              GAsyncResult *result,
+                              gpointer      user_data)
 {
-  ClutterContent *image;
-  CoglTexture *texdata;
-  GdkPixbuf *pixbuf;
-  char *key;
-
-  key = g_strdup_printf (CACHE_PREFIX_FILE "%u%f", g_file_hash (file), resource_scale);
+  StTextureCache *cache = ST_TEXTURE_CACHE (source);
+  AsyncTextureLoadData *data = user_data;
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GError) error = NULL;
 
-  texdata = NULL;
-  image = g_hash_table_lookup (cache->priv->keyed_cache, key);
+  g_hash_table_remove (cache->priv->outstanding_requests, data->key);
 
-  if (image == NULL)
+  pixbuf = load_pixbuf_async_finish (cache, result, &error);
+  if (pixbuf == NULL)
     {
-      pixbuf = impl_load_pixbuf_file (file, available_width, available_height,
-                                      paint_scale, resource_scale, error);
-      if (!pixbuf)
-        goto out;
+      g_autofree char *uri = g_file_get_uri (data->file);
 
-      image = pixbuf_to_st_content_image (pixbuf,
-                                          available_height, available_width,
-                                          paint_scale, resource_scale);
-      g_object_unref (pixbuf);
+      g_warning ("Failed to load %s: %s", uri,
+                 error ? error->message : "unknown error");
+      g_hash_table_add (cache->priv->failed_file_loads, g_steal_pointer (&data->key));
+      goto out;
+    }
 
-      if (!image)
+  if (data->for_cairo)
+    {
+      g_hash_table_insert (cache->priv->keyed_surface_cache,
+                           g_strdup (data->key),
+                           pixbuf_to_cairo_surface (pixbuf));
+    }
+  else
+    {
+      ClutterContent *image;
+
+      image = pixbuf_to_st_content_image (pixbuf, -1, -1,
+                                          data->paint_scale,
+                                          data->resource_scale);
+      if (image == NULL)
         goto out;
 
-      if (policy == ST_TEXTURE_CACHE_POLICY_FOREVER)
-        {
-          g_hash_table_insert (cache->priv->keyed_cache, g_strdup (key), image);
-          hash_table_insert_scale (cache->priv->used_scales, (double)resource_scale);
-        }
+      g_hash_table_insert (cache->priv->keyed_cache, g_strdup (data->key), image);
     }
 
-  /* Because the texture is loaded synchronously, we won't call
-   * clutter_image_set_data(), so it's safe to use the texture
-   * of ClutterImage here. */
-  texdata = clutter_image_get_texture (CLUTTER_IMAGE (image));
-  cogl_object_ref (texdata);
+  st_texture_cache_add_used_scale (cache, data->resource_scale);
 
-  ensure_monitor_for_file (cache, file);
+  /* Let users of the file pick up the new image */
+  g_signal_emit (cache, signals[TEXTURE_FILE_LOADED], 0, data->file);
 
 out:
-  g_free (key);
-  return texdata;
+  texture_load_data_free (data);
 }
 
-static cairo_surface_t *
-st_texture_cache_load_file_sync_to_cairo_surface (StTextureCache        *cache,
-                                                  StTextureCachePolicy   policy,
-                                                  GFile                 *file,
-                                                  int                    available_width,
-                                                  int                    available_height,
-                                                  int                    paint_scale,
-                                                  gfloat                 resource_scale,
-                                                  GError               **error)
+/* Starts decoding @file in a thread, unless it is already being loaded
+ * or failed to load before. Once loaded, the image is added to the cache
+ * under @key and #StTextureCache::texture-file-loaded is emitted.
+ */
+static void
+load_file_in_background (StTextureCache *cache,
+                         const char     *key,
+                         GFile          *file,
+                         int             available_width,
+                         int             available_height,
+                         int             paint_scale,
+                         float           resource_scale,
+                         gboolean        for_cairo)
 {
-  cairo_surface_t *surface;
-  GdkPixbuf *pixbuf;
-  char *key;
-
-  key = g_strdup_printf (CACHE_PREFIX_FILE_FOR_CAIRO "%u%f", g_file_hash (file), resource_scale);
-
-  surface = g_hash_table_lookup (cache->priv->keyed_surface_cache, key);
-
-  if (surface == NULL)
-    {
-      pixbuf = impl_load_pixbuf_file (file, available_width, available_height,
-                                      paint_scale, resource_scale, error);
-      if (!pixbuf)
-        goto out;
+  StTextureCachePrivate *priv = cache->priv;
+  AsyncTextureLoadData *request;
+  GTask *task;
 
-      surface = pixbuf_to_cairo_surface (pixbuf);
-      g_object_unref (pixbuf);
+  if (g_hash_table_contains (priv->outstanding_requests, key) ||
+      g_hash_table_contains (priv->failed_file_loads, key))
+    return;
 
-      if (policy == ST_TEXTURE_CACHE_POLICY_FOREVER)
-        {
-          cairo_surface_reference (surface);
-          g_hash_table_insert (cache->priv->keyed_surface_cache,
-                               g_strdup (key), surface);
-          hash_table_insert_scale (cache->priv->used_scales, (double)resource_scale);
-        }
-    }
-  else
-    cairo_surface_reference (surface);
+  request = g_new0 (AsyncTextureLoadData, 1);
+  request->cache = cache;
+  request->key = g_strdup (key);
+  request->file = g_object_ref (file);
+  request->policy = ST_TEXTURE_CACHE_POLICY_FOREVER;
+  request->width = available_width;
+  request->height = available_height;
+  request->paint_scale = paint_scale;
+  request->resource_scale = resource_scale;
+  request->cover = TRUE;
+  request->for_cairo = for_cairo;
+
+  g_hash_table_insert (priv->outstanding_requests, g_strdup (key), request);
+
+  task = g_task_new (cache, NULL, on_file_loaded_in_background, request);
+  g_task_set_task_data (task, request, NULL);
+  g_task_run_in_thread (task, load_pixbuf_thread);
+  g_object_unref (task);
 
   ensure_monitor_for_file (cache, file);
-
-out:
-  g_free (key);
-  return surface;
 }
 
 /**
  * st_texture_cache_load_file_to_cogl_texture: (skip)
  * @cache: A #StTextureCache
  * @file: A #GFile in supported image format
+ * @available_width: width the image needs to cover, or -1 if not limited
+ * @available_height: height the image needs to cover, or -1 if not limited
  * @paint_scale: Scale factor of the display
  * @resource_scale: Resource scale factor
  *
- * This function synchronously loads the given file path
- * into a COGL texture.  On error, a warning is emitted
- * and %NULL is returned.
+ * Looks up the texture for the given file, decoded at the smallest size
+ * covering @available_width and @available_height while keeping its
+ * aspect ratio. This never blocks: if the texture isn't loaded yet, %NULL
+ * is returned and the file is loaded in the background, after which
+ * #StTextureCache::texture-file-loaded is emitted for @file. On error,
+ * a warning is emitted once.
  *
- * Returns: (transfer full): a new #CoglTexture
+ * Returns: (transfer full) (nullable): a new #CoglTexture
  */
 CoglTexture *
 st_texture_cache_load_file_to_cogl_texture (StTextureCache *cache,
                                             GFile          *file,
+                                            int             available_width,
+                                            int             available_height,
                                             gint            paint_scale,
                                             gfloat          resource_scale)
 {
+  ClutterContent *image;
   CoglTexture *texture;
-  GError *error = NULL;
+  g_autofree char *key = NULL;
 
-  texture = st_texture_cache_load_file_sync_to_cogl_texture (cache, ST_TEXTURE_CACHE_POLICY_FOREVER,
-                                                             file, -1, -1, paint_scale, resource_scale,
-                                                             &error);
+  key = file_cache_key (CACHE_PREFIX_FILE_FOR_COGL, file,
+                        available_width, available_height,
+                        paint_scale, resource_scale);
 
-  if (texture == NULL)
+  image = g_hash_table_lookup (cache->priv->keyed_cache, key);
+  if (image == NULL)
     {
-      char *uri = g_file_get_uri (file);
-      g_warning ("Failed to load %s: %s", uri, error->message);
-      g_clear_error (&error);
-      g_free (uri);
+      load_file_in_background (cache, key, file,
+                               available_width, available_height,
+                               paint_scale, resource_scale, FALSE);
+      return NULL;
     }
 
-  return texture;
+  /* The image data was set when it was loaded and is never changed,
+   * so it's safe to use the texture of ClutterImage here. */
+  texture = clutter_image_get_texture (CLUTTER_IMAGE (image));
+
+  return cogl_object_ref (texture);
 }
 
 /**
  * st_texture_cache_load_file_to_cairo_surface:
  * @cache: A #StTextureCache
  * @file: A #GFile in supported image format
+ * @available_width: width the image needs to cover, or -1 if not limited
+ * @available_height: height the image needs to cover, or -1 if not limited
  * @paint_scale: Scale factor of the display
  * @resource_scale: Resource scale factor
  *
- * This function synchronously loads the given file path
- * into a cairo surface.  On error, a warning is emitted
- * and %NULL is returned.
+ * Like st_texture_cache_load_file_to_cogl_texture(), but
+ * for a cairo surface.
+ *
+ * This function used to take neither @available_width nor
+ * @available_height, and to load the file synchronously. Callers
+ * now get %NULL until #StTextureCache::texture-file-loaded is emitted
+ * for @file, and should then call it again.
  *
- * Returns: (transfer full): a new #cairo_surface_t
+ * Returns: (transfer full) (nullable): a new #cairo_surface_t
  */
 cairo_surface_t *
 st_texture_cache_load_file_to_cairo_surface (StTextureCache *cache,
                                              GFile          *file,
+                                             int             available_width,
+                                             int             available_height,
                                              gint            paint_scale,
                                              gfloat          resource_scale)
 {
   cairo_surface_t *surface;
-  GError *error = NULL;
+  g_autofree char *key = NULL;
 
-  surface = st_texture_cache_load_file_sync_to_cairo_surface (cache, ST_TEXTURE_CACHE_POLICY_FOREVER,
-                                                              file, -1, -1, paint_scale, resource_scale,
-                                                              &error);
+  key = file_cache_key (CACHE_PREFIX_FILE_FOR_CAIRO, file,
+                        available_width, available_height,
+                        paint_scale, resource_scale);
 
+  surface = g_hash_table_lookup (cache->priv->keyed_surface_cache, key);
   if (surface == NULL)
     {
-      char *uri = g_file_get_uri (file);
-      g_warning ("Failed to load %s: %s", uri, error->message);
-      g_clear_error (&error);
-      g_free (uri);
+      load_file_in_background (cache, key, file,
+                               available_width, available_height,
+                               paint_scale, resource_scale, TRUE);
+      return NULL;
     }
 
-  return surface;
+  return cairo_surface_reference (surface);
 }
 
 static StTextureCache *instance = NULL;
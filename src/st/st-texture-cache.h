@@ -86,11 +86,15 @@ ClutterActor *st_texture_cache_load_file_async (StTextureCache    *cache,
 
 CoglTexture     *st_texture_cache_load_file_to_cogl_texture (StTextureCache *cache,
                                                              GFile          *file,
+                                                             int             available_width,
+                                                             int             available_height,
                                                              gint            paint_scale,
                                                              gfloat          resource_scale);
 
 cairo_surface_t *st_texture_cache_load_file_to_cairo_surface (StTextureCache *cache,
                                                               GFile          *file,
+                                                              int             available_width,
+                                                              int             available_height,
                                                               gint            paint_scale,
                                                               gfloat          resource_scale);
 
@@ -28,6 +28,37 @@
 #include "st-theme-context.h"
 #include "st-theme-node-private.h"
 
+/* Number of interned nodes kept alive after their last use */
+#define N_RECENT_NODES 256
+
+/* Texture memory that shared paint states may hold on to */
+#define PAINT_STATES_MAX_SIZE (32 * 1024 * 1024)
+
+typedef struct {
+  guint64 fingerprint;
+  int scale_factor;
+  float width;
+  float height;
+  float resource_scale;
+} PaintStateKey;
+
+typedef struct {
+  PaintStateKey key;
+
+  StThemeContext *context;
+  /* The node the state was rendered for, to tell apart nodes that
+   * only share their fingerprint. Not referenced, the entry is removed
+   * when it is finalized.
+   */
+  StThemeNode *node;
+  StThemeNodePaintState state;
+  int box_shadow_min_width;
+  int box_shadow_min_height;
+
+  gsize size;
+  GList link;
+} PaintStateEntry;
+
 struct _StThemeContext {
   GObject parent;
 
@@ -35,8 +66,18 @@ struct _StThemeContext {
   StThemeNode *root_node;
   StTheme *theme;
 
-  /* set of StThemeNode */
+  /* hash => chain of StThemeNode, linked through next_interned */
   GHashTable *nodes;
+  /* references on recently used interned nodes, most recent first */
+  GQueue recent_nodes;
+
+  /* PaintStateKey => PaintStateEntry, shared between nodes that paint
+   * the same at the same size
+   */
+  GHashTable *paint_states;
+  /* PaintStateEntry, most recently used first */
+  GQueue paint_states_lru;
+  gsize paint_states_size;
 
   gulong stylesheets_changed_id;
 
@@ -70,6 +111,9 @@ static void on_font_name_changed (StSettings     *settings,
                                   StThemeContext *context);
 static void on_icon_theme_changed (StTextureCache *cache,
                                    StThemeContext *context);
+static void on_texture_file_changed (StTextureCache *cache,
+                                     GFile          *file,
+                                     StThemeContext *context);
 static void st_theme_context_changed (StThemeContext *context);
 
 static void st_theme_context_set_property (GObject      *object,
@@ -94,6 +138,84 @@ st_theme_context_set_scale_factor (StThemeContext *context,
 }
 
 
+static void
+clear_interned_nodes (StThemeContext *context)
+{
+  GHashTableIter iter;
+  StThemeNode *node;
+  GList *link;
+
+  g_hash_table_iter_init (&iter, context->nodes);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &node))
+    {
+      while (node != NULL)
+        {
+          StThemeNode *next = node->next_interned;
+
+          node->next_interned = NULL;
+          node->interned = FALSE;
+          node = next;
+        }
+    }
+  g_hash_table_remove_all (context->nodes);
+
+  while ((link = g_queue_pop_head_link (&context->recent_nodes)) != NULL)
+    {
+      node = link->data;
+      link->data = NULL;
+      g_object_unref (node);
+    }
+}
+
+static guint
+paint_state_key_hash (gconstpointer data)
+{
+  const PaintStateKey *key = data;
+  guint hash;
+
+  hash = (guint) key->fingerprint ^ (guint) (key->fingerprint >> 32);
+  hash = hash * 31 + (guint) key->width;
+  hash = hash * 31 + (guint) key->height;
+  hash = hash * 31 + (guint) (key->resource_scale * 100);
+
+  return hash * 31 + key->scale_factor;
+}
+
+static gboolean
+paint_state_key_equal (gconstpointer a,
+                       gconstpointer b)
+{
+  const PaintStateKey *key_a = a;
+  const PaintStateKey *key_b = b;
+
+  return key_a->fingerprint == key_b->fingerprint &&
+         key_a->scale_factor == key_b->scale_factor &&
+         key_a->width == key_b->width &&
+         key_a->height == key_b->height &&
+         key_a->resource_scale == key_b->resource_scale;
+}
+
+static void paint_state_node_finalized (gpointer  data,
+                                        GObject  *node);
+
+static void
+paint_state_entry_free (PaintStateEntry *entry)
+{
+  st_theme_node_paint_state_free (&entry->state);
+  if (entry->node)
+    g_object_weak_unref (G_OBJECT (entry->node), paint_state_node_finalized, entry);
+  g_free (entry);
+}
+
+static void
+clear_paint_states (StThemeContext *context)
+{
+  /* The links are part of the entries the table frees */
+  g_hash_table_remove_all (context->paint_states);
+  g_queue_init (&context->paint_states_lru);
+  context->paint_states_size = 0;
+}
+
 static void
 st_theme_context_finalize (GObject *object)
 {
@@ -105,14 +227,29 @@ st_theme_context_finalize (GObject *object)
   g_signal_handlers_disconnect_by_func (st_texture_cache_get_default (),
                                        (gpointer) on_icon_theme_changed,
                                        context);
+  g_signal_handlers_disconnect_by_func (st_texture_cache_get_default (),
+                                        (gpointer) on_texture_file_changed,
+                                        context);
   g_signal_handlers_disconnect_by_func (clutter_get_default_backend (),
                                         (gpointer) st_theme_context_changed,
                                         context);
 
   g_clear_signal_handler (&context->stylesheets_changed_id, context->theme);
 
+  /* Entries hold references on nodes, which remove themselves from
+   * the interned nodes as they go away
+   */
+  if (context->paint_states)
+    {
+      clear_paint_states (context);
+      g_hash_table_unref (context->paint_states);
+    }
+
   if (context->nodes)
-    g_hash_table_unref (context->nodes);
+    {
+      clear_interned_nodes (context);
+      g_hash_table_unref (context->nodes);
+    }
   if (context->root_node)
     g_object_unref (context->root_node);
   if (context->theme)
@@ -175,14 +312,20 @@ st_theme_context_init (StThemeContext *context)
                     "icon-theme-changed",
                     G_CALLBACK (on_icon_theme_changed),
                     context);
+  g_signal_connect (st_texture_cache_get_default (),
+                    "texture-file-changed",
+                    G_CALLBACK (on_texture_file_changed),
+                    context);
   g_signal_connect_swapped (clutter_get_default_backend (),
                             "resolution-changed",
                             G_CALLBACK (st_theme_context_changed),
                             context);
 
-  context->nodes = g_hash_table_new_full ((GHashFunc) st_theme_node_hash,
-                                          (GEqualFunc) st_theme_node_equal,
-                                          g_object_unref, NULL);
+  context->nodes = g_hash_table_new (NULL, NULL);
+  context->paint_states = g_hash_table_new_full (paint_state_key_hash,
+                                                 paint_state_key_equal,
+                                                 NULL,
+                                                 (GDestroyNotify) paint_state_entry_free);
   context->scale_factor = 1;
 }
 
@@ -268,7 +411,8 @@ st_theme_context_changed (StThemeContext *context)
 {
   StThemeNode *old_root = context->root_node;
   context->root_node = NULL;
-  g_hash_table_remove_all (context->nodes);
+  clear_paint_states (context);
+  clear_interned_nodes (context);
 
   g_signal_emit (context, signals[CHANGED], 0);
 
@@ -287,6 +431,15 @@ on_font_name_changed (StSettings     *settings,
   pango_font_description_free (font_desc);
 }
 
+static void
+on_texture_file_changed (StTextureCache *cache,
+                         GFile          *file,
+                         StThemeContext *context)
+{
+  /* Files rarely change, so don't bother finding the states using it */
+  clear_paint_states (context);
+}
+
 static gboolean
 changed_idle (gpointer userdata)
 {
@@ -451,6 +604,95 @@ st_theme_context_get_root_node (StThemeContext *context)
   return context->root_node;
 }
 
+static void
+add_interned_node (StThemeContext *context,
+                   guint           hash,
+                   StThemeNode    *node)
+{
+  StThemeNode *last;
+
+  node->interned = TRUE;
+  node->interned_hash = hash;
+
+  last = g_hash_table_lookup (context->nodes, GUINT_TO_POINTER (hash));
+  if (last == NULL)
+    {
+      g_hash_table_insert (context->nodes, GUINT_TO_POINTER (hash), node);
+      return;
+    }
+
+  while (last->next_interned != NULL)
+    last = last->next_interned;
+
+  last->next_interned = node;
+}
+
+/* Nodes are only kept alive by the context while they are among the
+ * most recently used ones, so that nodes for styles that aren't used
+ * anymore (like the ones an animated inline style goes through) don't
+ * accumulate, while the ones that widgets switch back and forth to
+ * don't need to be recomputed.
+ */
+static void
+mark_node_used (StThemeContext *context,
+                StThemeNode    *node)
+{
+  GList *oldest;
+
+  if (node->recent_link.data != NULL)
+    {
+      g_queue_unlink (&context->recent_nodes, &node->recent_link);
+      g_queue_push_head_link (&context->recent_nodes, &node->recent_link);
+      return;
+    }
+
+  node->recent_link.data = g_object_ref (node);
+  g_queue_push_head_link (&context->recent_nodes, &node->recent_link);
+
+  if (context->recent_nodes.length <= N_RECENT_NODES)
+    return;
+
+  oldest = g_queue_pop_tail_link (&context->recent_nodes);
+  node = oldest->data;
+  oldest->data = NULL;
+  g_object_unref (node);
+}
+
+/*
+ * _st_theme_context_forget_node:
+ * @context: a #StThemeContext
+ * @node: a node interned in @context
+ *
+ * Removes @node from the interned nodes of @context, as it is being
+ * disposed.
+ */
+void
+_st_theme_context_forget_node (StThemeContext *context,
+                               StThemeNode    *node)
+{
+  gpointer hash = GUINT_TO_POINTER (node->interned_hash);
+  StThemeNode *prev;
+
+  prev = g_hash_table_lookup (context->nodes, hash);
+  if (prev == node)
+    {
+      if (node->next_interned != NULL)
+        g_hash_table_insert (context->nodes, hash, node->next_interned);
+      else
+        g_hash_table_remove (context->nodes, hash);
+    }
+  else
+    {
+      while (prev->next_interned != node)
+        prev = prev->next_interned;
+
+      prev->next_interned = node->next_interned;
+    }
+
+  node->next_interned = NULL;
+  node->interned = FALSE;
+}
+
 /**
  * st_theme_context_intern_node:
  * @context: a #StThemeContext
@@ -465,16 +707,221 @@ StThemeNode *
 st_theme_context_intern_node (StThemeContext *context,
                               StThemeNode    *node)
 {
-  StThemeNode *mine = g_hash_table_lookup (context->nodes, node);
+  guint hash = st_theme_node_hash (node);
+  StThemeNode *mine;
+
+  g_return_val_if_fail (node->context == context, node);
+
+  mine = g_hash_table_lookup (context->nodes, GUINT_TO_POINTER (hash));
+  for (; mine != NULL; mine = mine->next_interned)
+    {
+      /* this might be node or not - it doesn't actually matter */
+      if (st_theme_node_equal (mine, node))
+        break;
+    }
+
+  if (mine == NULL)
+    {
+      mine = node;
+      add_interned_node (context, hash, node);
+    }
+
+  mark_node_used (context, mine);
+  return mine;
+}
+
+/*
+ * _st_theme_context_lookup_node:
+ * @context: a #StThemeContext
+ * @key: the description of the node
+ *
+ * Like st_theme_context_intern_node(), but only creates a node when
+ * there isn't a matching one yet, so that looking up an existing node
+ * doesn't allocate anything.
+ *
+ * Returns: (transfer none): a node matching @key
+ */
+StThemeNode *
+_st_theme_context_lookup_node (StThemeContext       *context,
+                               const StThemeNodeKey *key)
+{
+  guint hash = _st_theme_node_key_hash (context, key);
+  StThemeNode *node;
 
-  /* this might be node or not - it doesn't actually matter */
-  if (mine != NULL)
-    return mine;
+  node = g_hash_table_lookup (context->nodes, GUINT_TO_POINTER (hash));
+  for (; node != NULL; node = node->next_interned)
+    {
+      if (_st_theme_node_matches_key (node, context, key))
+        break;
+    }
+
+  if (node == NULL)
+    {
+      node = _st_theme_node_new_for_key (context, key);
+      add_interned_node (context, hash, node);
+      mark_node_used (context, node);
+      g_object_unref (node);
+    }
+  else
+    {
+      mark_node_used (context, node);
+    }
 
-  g_hash_table_add (context->nodes, g_object_ref (node));
   return node;
 }
 
+static void
+init_paint_state_key (PaintStateKey *key,
+                      StThemeNode   *node,
+                      float          width,
+                      float          height,
+                      float          resource_scale)
+{
+  key->fingerprint = _st_theme_node_get_paint_fingerprint (node);
+  key->scale_factor = node->cached_scale_factor;
+  key->width = width;
+  key->height = height;
+  key->resource_scale = resource_scale;
+}
+
+static gsize
+get_texture_size (CoglTexture *texture)
+{
+  if (texture == NULL)
+    return 0;
+
+  return (gsize) cogl_texture_get_width (texture) *
+         cogl_texture_get_height (texture) * 4;
+}
+
+static void
+remove_paint_state (StThemeContext  *context,
+                    PaintStateEntry *entry)
+{
+  g_queue_unlink (&context->paint_states_lru, &entry->link);
+  context->paint_states_size -= entry->size;
+  g_hash_table_remove (context->paint_states, &entry->key);
+}
+
+static void
+paint_state_node_finalized (gpointer  data,
+                            GObject  *node)
+{
+  PaintStateEntry *entry = data;
+
+  entry->node = NULL;
+  remove_paint_state (entry->context, entry);
+}
+
+/*
+ * _st_theme_context_lookup_paint_state:
+ * @context: a #StThemeContext
+ * @node: the node to paint
+ * @width: the width to paint at
+ * @height: the height to paint at
+ * @resource_scale: the resource scale to paint at
+ * @state: the paint state to fill in
+ *
+ * Looks for the resources of a node that paints the same as @node at
+ * the same size, as added by _st_theme_context_add_paint_state(), and
+ * copies them to @state if there is one.
+ *
+ * Returns: %TRUE if @state was filled in
+ */
+gboolean
+_st_theme_context_lookup_paint_state (StThemeContext        *context,
+                                      StThemeNode           *node,
+                                      float                  width,
+                                      float                  height,
+                                      float                  resource_scale,
+                                      StThemeNodePaintState *state)
+{
+  PaintStateEntry *entry;
+  PaintStateKey key;
+
+  init_paint_state_key (&key, node, width, height, resource_scale);
+
+  entry = g_hash_table_lookup (context->paint_states, &key);
+  if (entry == NULL)
+    return FALSE;
+
+  if (entry->node != node && !st_theme_node_paint_equal (entry->node, node))
+    return FALSE;
+
+  g_queue_unlink (&context->paint_states_lru, &entry->link);
+  g_queue_push_head_link (&context->paint_states_lru, &entry->link);
+
+  st_theme_node_paint_state_copy (state, &entry->state);
+  st_theme_node_paint_state_set_node (state, node);
+
+  node->paint_data->box_shadow_min_width = entry->box_shadow_min_width;
+  node->paint_data->box_shadow_min_height = entry->box_shadow_min_height;
+
+  return TRUE;
+}
+
+/*
+ * _st_theme_context_add_paint_state:
+ * @context: a #StThemeContext
+ * @node: the node @state was rendered for
+ * @state: a paint state holding resources for @node
+ *
+ * Makes the resources of @state available to other nodes painting the
+ * same at the same size, so that they don't need to render their own.
+ * The least recently used ones are dropped once they hold on to too
+ * much texture memory, and they are dropped along with @node.
+ */
+void
+_st_theme_context_add_paint_state (StThemeContext        *context,
+                                   StThemeNode           *node,
+                                   StThemeNodePaintState *state)
+{
+  PaintStateEntry *entry;
+  CoglTexture *shadow_texture = NULL;
+  gsize size;
+
+  /* Corners are already shared by the corner cache, so states without
+   * textures of their own aren't worth sharing
+   */
+  if (state->box_shadow_pipeline != NULL)
+    shadow_texture = cogl_pipeline_get_layer_texture (state->box_shadow_pipeline, 0);
+
+  size = get_texture_size (COGL_TEXTURE (state->prerendered_texture)) +
+         get_texture_size (shadow_texture);
+  if (size == 0 || size > PAINT_STATES_MAX_SIZE)
+    return;
+
+  entry = g_new0 (PaintStateEntry, 1);
+  init_paint_state_key (&entry->key, node,
+                        state->alloc_width, state->alloc_height,
+                        state->resource_scale);
+
+  if (g_hash_table_contains (context->paint_states, &entry->key))
+    {
+      g_free (entry);
+      return;
+    }
+
+  entry->context = context;
+  entry->node = node;
+  g_object_weak_ref (G_OBJECT (node), paint_state_node_finalized, entry);
+  st_theme_node_paint_state_init (&entry->state);
+  st_theme_node_paint_state_copy (&entry->state, state);
+  st_theme_node_paint_state_set_node (&entry->state, NULL);
+  entry->box_shadow_min_width = node->paint_data->box_shadow_min_width;
+  entry->box_shadow_min_height = node->paint_data->box_shadow_min_height;
+  entry->size = size;
+  entry->link.data = entry;
+
+  g_hash_table_insert (context->paint_states, &entry->key, entry);
+  g_queue_push_head_link (&context->paint_states_lru, &entry->link);
+  context->paint_states_size += size;
+
+  while (context->paint_states_size > PAINT_STATES_MAX_SIZE)
+    remove_paint_state (context,
+                        g_queue_peek_tail_link (&context->paint_states_lru)->data);
+}
+
 /**
  * st_theme_context_get_scale_factor:
  * @context: a #StThemeContext
@@ -28,6 +28,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 #include "st-shadow.h"
@@ -72,27 +73,32 @@ elliptical_arc (cairo_t *cr,
   cairo_restore (cr);
 }
 
-static CoglTexture *
-create_corner_material (StCornerSpec *corner)
+static guint
+get_corner_size (StCornerSpec *corner,
+                 guint        *logical_size)
+{
+  guint max_border_width;
+
+  max_border_width = MAX(corner->border_width_2, corner->border_width_1);
+  *logical_size = 2 * MAX(max_border_width, corner->radius);
+
+  return ceilf (*logical_size * corner->resource_scale);
+}
+
+static void
+draw_corner (StCornerSpec *corner,
+             guint8       *data,
+             guint         rowstride,
+             guint         size)
 {
-  ClutterBackend *backend = clutter_get_default_backend ();
-  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
-  GError *error = NULL;
-  CoglTexture *texture;
   cairo_t *cr;
   cairo_surface_t *surface;
-  guint rowstride;
-  guint8 *data;
-  guint size;
   guint logical_size;
   guint max_border_width;
   double device_scaling;
 
   max_border_width = MAX(corner->border_width_2, corner->border_width_1);
-  logical_size = 2 * MAX(max_border_width, corner->radius);
-  size = ceilf (logical_size * corner->resource_scale);
-  rowstride = size * 4;
-  data = g_new0 (guint8, size * rowstride);
+  get_corner_size (corner, &logical_size);
 
   surface = cairo_image_surface_create_for_data (data,
                                                  CAIRO_FORMAT_ARGB32,
@@ -179,6 +185,23 @@ create_corner_material (StCornerSpec *corner)
   cairo_destroy (cr);
 
   cairo_surface_destroy (surface);
+}
+
+static CoglTexture *
+create_corner_texture (StCornerSpec *corner,
+                       guint         size)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  GError *error = NULL;
+  CoglTexture *texture;
+  guint rowstride;
+  guint8 *data;
+
+  rowstride = size * 4;
+  data = g_new0 (guint8, size * rowstride);
+
+  draw_corner (corner, data, rowstride, size);
 
   texture = COGL_TEXTURE (cogl_texture_2d_new_from_data (ctx, size, size,
                                                          CLUTTER_CAIRO_FORMAT_ARGB32,
@@ -197,26 +220,401 @@ create_corner_material (StCornerSpec *corner)
   return texture;
 }
 
-static char *
-corner_to_string (StCornerSpec *corner)
+/* Corners are small and there are many different ones, so they are
+ * packed into shared atlas textures. Each atlas is split into shelves
+ * of equally sized slots, and each corner is drawn in a slot with a
+ * 1 pixel border repeating its edges, so that filtering doesn't pick
+ * up its neighbours. Corners that are too large get their own texture.
+ *
+ * Corners are kept while pipelines using them are alive, and the most
+ * recently used of the others are kept in case they are needed again.
+ */
+#define CORNER_ATLAS_SIZE 512
+#define CORNER_SLOT_ALIGNMENT 8
+#define MAX_CORNER_SLOT_SIZE 128
+#define N_UNUSED_CORNERS 64
+
+typedef struct _CornerAtlas CornerAtlas;
+typedef struct _CornerShelf CornerShelf;
+typedef struct _CornerEntry CornerEntry;
+
+struct _CornerAtlas {
+  CoglTexture *texture;
+  GSList *shelves;
+  guint used_height;
+  guint n_corners;
+};
+
+struct _CornerShelf {
+  CornerAtlas *atlas;
+  guint y;
+  guint slot_size;
+  guint n_slots;
+  guint64 used_slots;
+};
+
+struct _CornerEntry {
+  StCornerSpec spec;
+
+  /* A region of an atlas, or a texture of its own if shelf is NULL */
+  CoglTexture *texture;
+  CornerShelf *shelf;
+  guint slot;
+
+  guint n_users;
+  GList unused_link;
+};
+
+static struct {
+  /* StCornerSpec => CornerEntry */
+  GHashTable *corners;
+  /* CornerEntry without users, most recently used first */
+  GQueue unused;
+  GSList *atlases;
+
+  guint hits;
+  guint misses;
+} corner_cache;
+
+static CoglUserDataKey corner_entry_key;
+
+static guint
+corner_spec_hash (gconstpointer data)
 {
-  return g_strdup_printf ("st-theme-node-corner:%02x%02x%02x%02x,%02x%02x%02x%02x,%02x%02x%02x%02x,%u,%u,%u,%.4f",
-                          corner->color.red, corner->color.blue, corner->color.green, corner->color.alpha,
-                          corner->border_color_1.red, corner->border_color_1.green, corner->border_color_1.blue, corner->border_color_1.alpha,
-                          corner->border_color_2.red, corner->border_color_2.green, corner->border_color_2.blue, corner->border_color_2.alpha,
-                          corner->radius,
-                          corner->border_width_1,
-                          corner->border_width_2,
-                          corner->resource_scale);
+  const StCornerSpec *corner = data;
+  guint hash;
+
+  hash = clutter_color_hash (&corner->color);
+  hash = hash * 31 + clutter_color_hash (&corner->border_color_1);
+  hash = hash * 31 + clutter_color_hash (&corner->border_color_2);
+  hash = hash * 31 + corner->radius;
+  hash = hash * 31 + corner->border_width_1;
+  hash = hash * 31 + corner->border_width_2;
+
+  return hash * 31 + (guint) (corner->resource_scale * 100);
 }
 
-static CoglTexture *
-load_corner (StTextureCache  *cache,
-             const char      *key,
-             void            *datap,
-             GError         **error)
+static gboolean
+corner_spec_equal (gconstpointer a,
+                   gconstpointer b)
+{
+  const StCornerSpec *corner_a = a;
+  const StCornerSpec *corner_b = b;
+
+  return clutter_color_equal (&corner_a->color, &corner_b->color) &&
+         clutter_color_equal (&corner_a->border_color_1, &corner_b->border_color_1) &&
+         clutter_color_equal (&corner_a->border_color_2, &corner_b->border_color_2) &&
+         corner_a->radius == corner_b->radius &&
+         corner_a->border_width_1 == corner_b->border_width_1 &&
+         corner_a->border_width_2 == corner_b->border_width_2 &&
+         corner_a->resource_scale == corner_b->resource_scale;
+}
+
+static CornerAtlas *
+corner_atlas_new (void)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  g_autoptr (GError) error = NULL;
+  CoglTexture *texture;
+  CornerAtlas *atlas;
+
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx,
+                                                         CORNER_ATLAS_SIZE,
+                                                         CORNER_ATLAS_SIZE));
+  if (!cogl_texture_allocate (texture, &error))
+    {
+      g_warning ("Failed to allocate corner atlas: %s", error->message);
+      cogl_object_unref (texture);
+      return NULL;
+    }
+
+  atlas = g_new0 (CornerAtlas, 1);
+  atlas->texture = texture;
+  corner_cache.atlases = g_slist_prepend (corner_cache.atlases, atlas);
+
+  return atlas;
+}
+
+static void
+corner_atlas_free (CornerAtlas *atlas)
+{
+  corner_cache.atlases = g_slist_remove (corner_cache.atlases, atlas);
+
+  g_slist_free_full (atlas->shelves, g_free);
+  cogl_object_unref (atlas->texture);
+  g_free (atlas);
+}
+
+static gboolean
+corner_shelf_take_slot (CornerShelf *shelf,
+                        guint       *slot)
+{
+  guint i;
+
+  for (i = 0; i < shelf->n_slots; i++)
+    {
+      if ((shelf->used_slots & (G_GUINT64_CONSTANT (1) << i)) == 0)
+        {
+          shelf->used_slots |= G_GUINT64_CONSTANT (1) << i;
+          shelf->atlas->n_corners++;
+          *slot = i;
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static CornerShelf *
+allocate_corner_slot (guint  slot_size,
+                      guint *slot)
+{
+  CornerAtlas *atlas;
+  CornerShelf *shelf;
+  GSList *l, *k;
+
+  for (l = corner_cache.atlases; l; l = l->next)
+    {
+      atlas = l->data;
+
+      for (k = atlas->shelves; k; k = k->next)
+        {
+          shelf = k->data;
+
+          if (shelf->slot_size == slot_size &&
+              corner_shelf_take_slot (shelf, slot))
+            return shelf;
+        }
+    }
+
+  atlas = NULL;
+  for (l = corner_cache.atlases; l; l = l->next)
+    {
+      CornerAtlas *candidate = l->data;
+
+      if (CORNER_ATLAS_SIZE - candidate->used_height >= slot_size)
+        {
+          atlas = candidate;
+          break;
+        }
+    }
+
+  if (atlas == NULL)
+    atlas = corner_atlas_new ();
+  if (atlas == NULL)
+    return NULL;
+
+  shelf = g_new0 (CornerShelf, 1);
+  shelf->atlas = atlas;
+  shelf->y = atlas->used_height;
+  shelf->slot_size = slot_size;
+  shelf->n_slots = MIN (CORNER_ATLAS_SIZE / slot_size, 64);
+  atlas->shelves = g_slist_prepend (atlas->shelves, shelf);
+  atlas->used_height += slot_size;
+
+  corner_shelf_take_slot (shelf, slot);
+
+  return shelf;
+}
+
+/* Repeats the outermost pixels of the @size × @size image at (1, 1)
+ * in the 1 pixel border around it
+ */
+static void
+extrude_corner_edges (guint8 *data,
+                      guint   rowstride,
+                      guint   size)
+{
+  guint i;
+
+  for (i = 1; i <= size; i++)
+    {
+      guint8 *row = data + i * rowstride;
+
+      memcpy (row, row + 4, 4);
+      memcpy (row + (size + 1) * 4, row + size * 4, 4);
+    }
+
+  memcpy (data, data + rowstride, rowstride);
+  memcpy (data + (size + 1) * rowstride, data + size * rowstride, rowstride);
+}
+
+static gboolean
+pack_corner (CornerEntry *entry,
+             guint        size)
+{
+  ClutterBackend *backend = clutter_get_default_backend ();
+  CoglContext *ctx = clutter_backend_get_cogl_context (backend);
+  CornerShelf *shelf;
+  guint padded_size, slot_size, slot, x, y;
+  guint rowstride;
+  guint8 *data;
+  gboolean uploaded;
+
+  padded_size = size + 2;
+  slot_size = ALIGN (padded_size, CORNER_SLOT_ALIGNMENT);
+  if (slot_size > MAX_CORNER_SLOT_SIZE)
+    return FALSE;
+
+  shelf = allocate_corner_slot (slot_size, &slot);
+  if (shelf == NULL)
+    return FALSE;
+
+  x = slot * slot_size;
+  y = shelf->y;
+
+  rowstride = padded_size * 4;
+  data = g_new0 (guint8, padded_size * rowstride);
+
+  draw_corner (&entry->spec, data + rowstride + 4, rowstride, size);
+  extrude_corner_edges (data, rowstride, size);
+
+  uploaded = cogl_texture_set_region (shelf->atlas->texture,
+                                      0, 0, x, y,
+                                      padded_size, padded_size,
+                                      padded_size, padded_size,
+                                      CLUTTER_CAIRO_FORMAT_ARGB32,
+                                      rowstride,
+                                      data);
+  g_free (data);
+
+  if (!uploaded)
+    {
+      shelf->used_slots &= ~(G_GUINT64_CONSTANT (1) << slot);
+      shelf->atlas->n_corners--;
+      return FALSE;
+    }
+
+  entry->shelf = shelf;
+  entry->slot = slot;
+  entry->texture = COGL_TEXTURE (cogl_sub_texture_new (ctx,
+                                                       shelf->atlas->texture,
+                                                       x + 1, y + 1,
+                                                       size, size));
+
+  return TRUE;
+}
+
+static void
+corner_entry_free (CornerEntry *entry)
+{
+  CornerShelf *shelf = entry->shelf;
+
+  cogl_clear_object (&entry->texture);
+
+  if (shelf != NULL)
+    {
+      shelf->used_slots &= ~(G_GUINT64_CONSTANT (1) << entry->slot);
+      if (--shelf->atlas->n_corners == 0)
+        corner_atlas_free (shelf->atlas);
+    }
+
+  g_free (entry);
+}
+
+static CornerEntry *
+corner_entry_new (StCornerSpec *corner)
 {
-  return create_corner_material ((StCornerSpec *) datap);
+  CornerEntry *entry;
+  guint logical_size, size;
+
+  entry = g_new0 (CornerEntry, 1);
+  entry->spec = *corner;
+  entry->unused_link.data = entry;
+
+  size = get_corner_size (corner, &logical_size);
+
+  if (!pack_corner (entry, size))
+    entry->texture = create_corner_texture (corner, size);
+
+  if (entry->texture == NULL)
+    {
+      corner_entry_free (entry);
+      return NULL;
+    }
+
+  return entry;
+}
+
+static void
+on_corner_material_destroyed (void *data)
+{
+  CornerEntry *entry = data;
+
+  if (--entry->n_users > 0)
+    return;
+
+  g_queue_push_head_link (&corner_cache.unused, &entry->unused_link);
+
+  while (corner_cache.unused.length > N_UNUSED_CORNERS)
+    {
+      GList *oldest = g_queue_pop_tail_link (&corner_cache.unused);
+
+      g_hash_table_remove (corner_cache.corners,
+                           &((CornerEntry *) oldest->data)->spec);
+    }
+}
+
+static CoglPipeline *
+lookup_corner_material (StCornerSpec *corner)
+{
+  CoglPipeline *material;
+  CornerEntry *entry;
+
+  if (G_UNLIKELY (corner_cache.corners == NULL))
+    corner_cache.corners = g_hash_table_new_full (corner_spec_hash,
+                                                  corner_spec_equal,
+                                                  NULL,
+                                                  (GDestroyNotify) corner_entry_free);
+
+  entry = g_hash_table_lookup (corner_cache.corners, corner);
+  if (entry != NULL)
+    {
+      corner_cache.hits++;
+
+      /* Cached corners without users are all in the unused queue */
+      if (entry->n_users == 0)
+        g_queue_unlink (&corner_cache.unused, &entry->unused_link);
+    }
+  else
+    {
+      corner_cache.misses++;
+
+      entry = corner_entry_new (corner);
+      if (entry == NULL)
+        return NULL;
+
+      g_hash_table_insert (corner_cache.corners, &entry->spec, entry);
+    }
+
+  material = _st_create_texture_pipeline (entry->texture);
+  entry->n_users++;
+  cogl_object_set_user_data (COGL_OBJECT (material), &corner_entry_key,
+                             entry, on_corner_material_destroyed);
+
+  return material;
+}
+
+/*
+ * _st_theme_node_get_corner_cache_stats:
+ * @hits: (out): number of corner lookups that found an existing corner
+ * @misses: (out): number of corner lookups that had to draw it
+ * @n_corners: (out): number of corners currently cached
+ * @n_atlases: (out): number of atlas textures the corners are packed in
+ *
+ * Gets statistics about the cache of rounded corner textures.
+ */
+void
+_st_theme_node_get_corner_cache_stats (guint *hits,
+                                       guint *misses,
+                                       guint *n_corners,
+                                       guint *n_atlases)
+{
+  *hits = corner_cache.hits;
+  *misses = corner_cache.misses;
+  *n_corners = corner_cache.corners ? g_hash_table_size (corner_cache.corners) : 0;
+  *n_atlases = g_slist_length (corner_cache.atlases);
 }
 
 /* To match the CSS specification, we want the border to look like it was
@@ -367,15 +765,9 @@ st_theme_node_lookup_corner (StThemeNode    *node,
                              float           resource_scale,
                              StCorner        corner_id)
 {
-  CoglTexture *texture = NULL;
-  CoglPipeline *material = NULL;
-  char *key;
-  StTextureCache *cache;
   StCornerSpec corner;
   guint radius[4];
 
-  cache = st_texture_cache_get_default ();
-
   st_theme_node_reduce_border_radius (node, width, height, radius);
 
   if (radius[corner_id] == 0)
@@ -421,18 +813,7 @@ st_theme_node_lookup_corner (StThemeNode    *node,
         corner.color = (ClutterColor) {0, 0, 0, 255};
     }
 
-  key = corner_to_string (&corner);
-  texture = st_texture_cache_load (cache, key, ST_TEXTURE_CACHE_POLICY_FOREVER, load_corner, &corner, NULL);
-
-  if (texture)
-    {
-      material = _st_create_texture_pipeline (texture);
-      cogl_object_unref (texture);
-    }
-
-  g_free (key);
-
-  return material;
+  return lookup_corner_material (&corner);
 }
 
 static void
@@ -444,10 +825,11 @@ get_background_scale (StThemeNode *node,
                       gdouble     *scale_w,
                       gdouble     *scale_h)
 {
+  const StThemeNodeBackground *background = _st_theme_node_get_background (node);
   *scale_w = -1.0;
   *scale_h = -1.0;
 
-  switch (node->background_size)
+  switch (background->size)
     {
       case ST_BACKGROUND_SIZE_AUTO:
         *scale_w = 1.0f;
@@ -461,14 +843,14 @@ get_background_scale (StThemeNode *node,
                         painting_area_height / background_image_height);
         break;
       case ST_BACKGROUND_SIZE_FIXED:
-        if (node->background_size_w > -1)
+        if (background->size_w > -1)
           {
-            *scale_w = node->background_size_w / background_image_width;
-            if (node->background_size_h > -1)
-              *scale_h = node->background_size_h / background_image_height;
+            *scale_w = background->size_w / background_image_width;
+            if (background->size_h > -1)
+              *scale_h = background->size_h / background_image_height;
           }
-        else if (node->background_size_h > -1)
-          *scale_w = node->background_size_h / background_image_height;
+        else if (background->size_h > -1)
+          *scale_w = background->size_h / background_image_height;
         break;
       default:
         g_assert_not_reached();
@@ -487,11 +869,12 @@ get_background_coordinates (StThemeNode *node,
                             gdouble     *x,
                             gdouble     *y)
 {
+  const StThemeNodeBackground *background = _st_theme_node_get_background (node);
   /* honor the specified position if any */
-  if (node->background_position_set)
+  if (background->position_set)
     {
-      *x = node->background_position_x;
-      *y = node->background_position_y;
+      *x = background->position_x;
+      *y = background->position_y;
     }
   else
     {
@@ -514,8 +897,8 @@ get_background_position (StThemeNode             *self,
   gdouble scale_w, scale_h;
 
   /* get the background image size */
-  background_image_width = cogl_texture_get_width (self->background_texture);
-  background_image_height = cogl_texture_get_height (self->background_texture);
+  background_image_width = cogl_texture_get_width (self->paint_data->background_texture);
+  background_image_height = cogl_texture_get_height (self->paint_data->background_texture);
 
   background_image_width /= resource_scale;
   background_image_height /= resource_scale;
@@ -539,7 +922,7 @@ get_background_position (StThemeNode             *self,
                               background_image_width, background_image_height,
                               &x1, &y1);
 
-  if (self->background_repeat)
+  if (_st_theme_node_get_background (self)->repeat)
     {
       gdouble width = allocation->x2 - allocation->x1 + x1;
       gdouble height = allocation->y2 - allocation->y1 + y1;
@@ -581,7 +964,7 @@ st_theme_node_has_visible_outline (StThemeNode *node)
   if (node->background_color.alpha > 0)
     return TRUE;
 
-  if (node->background_gradient_end.alpha > 0)
+  if (_st_theme_node_get_background (node)->gradient_end.alpha > 0)
     return TRUE;
 
   if (node->border_radius[ST_CORNER_TOPLEFT] > 0 ||
@@ -604,14 +987,15 @@ create_cairo_pattern_of_background_gradient (StThemeNode *node,
                                              float        width,
                                              float        height)
 {
+  const StThemeNodeBackground *background = _st_theme_node_get_background (node);
   cairo_pattern_t *pattern;
 
-  g_return_val_if_fail (node->background_gradient_type != ST_GRADIENT_NONE,
+  g_return_val_if_fail (background->gradient_type != ST_GRADIENT_NONE,
                         NULL);
 
-  if (node->background_gradient_type == ST_GRADIENT_VERTICAL)
+  if (background->gradient_type == ST_GRADIENT_VERTICAL)
     pattern = cairo_pattern_create_linear (0, 0, 0, height);
-  else if (node->background_gradient_type == ST_GRADIENT_HORIZONTAL)
+  else if (background->gradient_type == ST_GRADIENT_HORIZONTAL)
     pattern = cairo_pattern_create_linear (0, 0, width, 0);
   else
     {
@@ -628,13 +1012,79 @@ create_cairo_pattern_of_background_gradient (StThemeNode *node,
                                      node->background_color.blue / 255.,
                                      node->background_color.alpha / 255.);
   cairo_pattern_add_color_stop_rgba (pattern, 1,
-                                     node->background_gradient_end.red / 255.,
-                                     node->background_gradient_end.green / 255.,
-                                     node->background_gradient_end.blue / 255.,
-                                     node->background_gradient_end.alpha / 255.);
+                                     background->gradient_end.red / 255.,
+                                     background->gradient_end.green / 255.,
+                                     background->gradient_end.blue / 255.,
+                                     background->gradient_end.alpha / 255.);
   return pattern;
 }
 
+/* Background images are rounded up to this many pixels when decoded for
+ * the area they are painted in, so resizing doesn't decode them each time.
+ */
+#define BACKGROUND_IMAGE_SIZE_STEP 32
+
+static int
+round_background_image_size (float size)
+{
+  int rounded = ceilf (size);
+
+  if (rounded <= 0)
+    return -1;
+
+  return (rounded + BACKGROUND_IMAGE_SIZE_STEP - 1) / BACKGROUND_IMAGE_SIZE_STEP * BACKGROUND_IMAGE_SIZE_STEP;
+}
+
+/* Computes the size, in logical pixels, the background image needs to
+ * be decoded to cover when painted in an area of @width by @height.
+ * Images that are painted at their natural size are never scaled.
+ */
+static void
+get_background_image_target_size (StThemeNode *node,
+                                  float        width,
+                                  float        height,
+                                  int         *target_width,
+                                  int         *target_height)
+{
+  const StThemeNodeBackground *background = _st_theme_node_get_background (node);
+
+  *target_width = *target_height = -1;
+
+  switch (background->size)
+    {
+    case ST_BACKGROUND_SIZE_CONTAIN:
+    case ST_BACKGROUND_SIZE_COVER:
+      *target_width = round_background_image_size (width);
+      *target_height = round_background_image_size (height);
+
+      /* An area we don't know the size of could need the full image */
+      if (*target_width < 0 || *target_height < 0)
+        *target_width = *target_height = -1;
+      break;
+
+    case ST_BACKGROUND_SIZE_FIXED:
+      *target_width = round_background_image_size (background->size_w);
+      if (background->size_h >= 0)
+        *target_height = round_background_image_size (background->size_h);
+      break;
+
+    case ST_BACKGROUND_SIZE_AUTO:
+    default:
+      break;
+    }
+}
+
+/* Whether an image decoded to cover @decoded is large enough to cover @needed */
+static gboolean
+background_image_size_covers (int decoded,
+                              int needed)
+{
+  if (decoded < 0)
+    return TRUE;
+
+  return needed >= 0 && decoded >= needed;
+}
+
 static cairo_pattern_t *
 create_cairo_pattern_of_background_image (StThemeNode *node,
                                           float        width,
@@ -642,6 +1092,7 @@ create_cairo_pattern_of_background_image (StThemeNode *node,
                                           float        resource_scale,
                                           gboolean    *needs_background_fill)
 {
+  const StThemeNodeBackground *background = _st_theme_node_get_background (node);
   cairo_surface_t *surface;
   cairo_pattern_t *pattern;
   cairo_content_t  content;
@@ -653,17 +1104,26 @@ create_cairo_pattern_of_background_image (StThemeNode *node,
   gdouble background_image_width, background_image_height;
   gdouble x, y;
   gdouble scale_w, scale_h;
+  int target_width, target_height;
 
   file = st_theme_node_get_background_image (node);
 
   texture_cache = st_texture_cache_get_default ();
 
+  get_background_image_target_size (node, width, height,
+                                    &target_width, &target_height);
   surface = st_texture_cache_load_file_to_cairo_surface (texture_cache, file,
+                                                         target_width,
+                                                         target_height,
                                                          node->cached_scale_factor,
                                                          resource_scale);
 
   if (surface == NULL)
-    return NULL;
+    {
+      if (node->paint_data != NULL)
+        node->paint_data->missing_images = TRUE;
+      return NULL;
+    }
 
   g_assert (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE);
 
@@ -702,7 +1162,7 @@ create_cairo_pattern_of_background_image (StThemeNode *node,
                               &x, &y);
   cairo_matrix_translate (&matrix, -x, -y);
 
-  if (node->background_repeat)
+  if (background->repeat)
     cairo_pattern_set_extend (pattern, CAIRO_EXTEND_REPEAT);
 
   /* If it's opaque, fills up the entire allocated
@@ -710,7 +1170,7 @@ create_cairo_pattern_of_background_image (StThemeNode *node,
    */
   if (content != CAIRO_CONTENT_COLOR_ALPHA)
     {
-      if (node->background_repeat ||
+      if (background->repeat ||
           (x >= 0 &&
            y >= 0 &&
            background_image_width - x >= width &&
@@ -1013,6 +1473,7 @@ st_theme_node_prerender_background (StThemeNode *node,
                                     float        actor_height,
                                     float        resource_scale)
 {
+  const StThemeNodeBackground *background = _st_theme_node_get_background (node);
   ClutterBackend *backend = clutter_get_default_backend ();
   CoglContext *ctx = clutter_backend_get_cogl_context (backend);
   GError *error = NULL;
@@ -1097,7 +1558,7 @@ st_theme_node_prerender_background (StThemeNode *node,
   /* Note we don't support translucent background images on top
    * of gradients. It's strictly either/or.
    */
-  if (node->background_gradient_type != ST_GRADIENT_NONE)
+  if (background->gradient_type != ST_GRADIENT_NONE)
     {
       pattern = create_cairo_pattern_of_background_gradient (node, width, height);
       draw_solid_background = FALSE;
@@ -1108,7 +1569,7 @@ st_theme_node_prerender_background (StThemeNode *node,
        * left over from filling the border, etc.
        */
       if (node->background_color.alpha < 255 ||
-          node->background_gradient_end.alpha < 255)
+          background->gradient_end.alpha < 255)
         background_is_translucent = TRUE;
       else
         background_is_translucent = FALSE;
@@ -1368,18 +1829,35 @@ static void st_theme_node_paint_borders (StThemeNodePaintState *state,
                                          StPaintBordersMode     mode,
                                          guint8                 paint_opacity);
 
+static StThemeNodePaintData *
+st_theme_node_ensure_paint_data (StThemeNode *node)
+{
+  if (node->paint_data == NULL)
+    {
+      node->paint_data = g_new0 (StThemeNodePaintData, 1);
+      st_theme_node_paint_state_init (&node->paint_data->cached_state);
+    }
+
+  return node->paint_data;
+}
+
 void
 st_theme_node_invalidate_border_image (StThemeNode *node)
 {
-  cogl_clear_object (&node->border_slices_texture);
-  cogl_clear_object (&node->border_slices_pipeline);
+  if (node->paint_data == NULL)
+    return;
+
+  cogl_clear_object (&node->paint_data->border_slices_texture);
+  cogl_clear_object (&node->paint_data->border_slices_pipeline);
 }
 
 static gboolean
 st_theme_node_load_border_image (StThemeNode *node,
                                  gfloat       resource_scale)
 {
-  if (node->border_slices_texture == NULL)
+  StThemeNodePaintData *paint_data = node->paint_data;
+
+  if (paint_data->border_slices_texture == NULL)
     {
       StBorderImage *border_image;
       GFile *file;
@@ -1390,65 +1868,90 @@ st_theme_node_load_border_image (StThemeNode *node,
 
       file = st_border_image_get_file (border_image);
 
-      node->border_slices_texture = st_texture_cache_load_file_to_cogl_texture (st_texture_cache_get_default (),
-                                                                                file,
-                                                                                node->cached_scale_factor,
-                                                                                resource_scale);
-      if (node->border_slices_texture == NULL)
+      paint_data->border_slices_texture = st_texture_cache_load_file_to_cogl_texture (st_texture_cache_get_default (),
+                                                                                      file,
+                                                                                      -1, -1,
+                                                                                      node->cached_scale_factor,
+                                                                                      resource_scale);
+      if (paint_data->border_slices_texture == NULL)
         goto out;
 
-      node->border_slices_pipeline = _st_create_texture_pipeline (node->border_slices_texture);
+      paint_data->border_slices_pipeline = _st_create_texture_pipeline (paint_data->border_slices_texture);
     }
 
  out:
-  return node->border_slices_texture != NULL;
+  return paint_data->border_slices_texture != NULL;
 }
 
 void
 st_theme_node_invalidate_background_image (StThemeNode *node)
 {
-  cogl_clear_object (&node->background_texture);
-  cogl_clear_object (&node->background_pipeline);
-  cogl_clear_object (&node->background_shadow_pipeline);
+  if (node->paint_data == NULL)
+    return;
+
+  cogl_clear_object (&node->paint_data->background_texture);
+  cogl_clear_object (&node->paint_data->background_pipeline);
+  cogl_clear_object (&node->paint_data->background_shadow_pipeline);
 }
 
 static gboolean
 st_theme_node_load_background_image (StThemeNode *node,
+                                     float        width,
+                                     float        height,
                                      gfloat       resource_scale)
 {
-  if (node->background_texture == NULL)
-    {
-      GFile *background_image;
-      StShadow *background_image_shadow_spec;
+  StThemeNodePaintData *paint_data = node->paint_data;
+  GFile *background_image;
+  StShadow *background_image_shadow_spec;
+  CoglTexture *texture;
+  int target_width, target_height;
 
-      background_image = st_theme_node_get_background_image (node);
-      if (background_image == NULL)
-        goto out;
+  background_image = st_theme_node_get_background_image (node);
+  if (background_image == NULL)
+    goto out;
 
-      background_image_shadow_spec = st_theme_node_get_background_image_shadow (node);
-      node->background_texture = st_texture_cache_load_file_to_cogl_texture (st_texture_cache_get_default (),
-                                                                             background_image,
-                                                                             node->cached_scale_factor,
-                                                                             resource_scale);
-      if (node->background_texture == NULL)
-        goto out;
+  get_background_image_target_size (node, width, height,
+                                    &target_width, &target_height);
 
-      node->background_pipeline = _st_create_texture_pipeline (node->background_texture);
+  if (paint_data->background_texture != NULL &&
+      background_image_size_covers (paint_data->background_texture_width, target_width) &&
+      background_image_size_covers (paint_data->background_texture_height, target_height))
+    goto out;
 
-      if (node->background_repeat)
-        cogl_pipeline_set_layer_wrap_mode (node->background_pipeline, 0,
-                                           COGL_PIPELINE_WRAP_MODE_REPEAT);
+  texture = st_texture_cache_load_file_to_cogl_texture (st_texture_cache_get_default (),
+                                                        background_image,
+                                                        target_width,
+                                                        target_height,
+                                                        node->cached_scale_factor,
+                                                        resource_scale);
 
-      if (background_image_shadow_spec)
-        {
-          node->background_shadow_pipeline = _st_create_shadow_pipeline (background_image_shadow_spec,
-                                                                         node->background_texture,
-                                                                         resource_scale);
-        }
+  /* Keep painting the texture we had, if any, until the one for the
+   * new size is loaded.
+   */
+  if (texture == NULL)
+    goto out;
+
+  st_theme_node_invalidate_background_image (node);
+
+  paint_data->background_texture = texture;
+  paint_data->background_texture_width = target_width;
+  paint_data->background_texture_height = target_height;
+  paint_data->background_pipeline = _st_create_texture_pipeline (paint_data->background_texture);
+
+  if (_st_theme_node_get_background (node)->repeat)
+    cogl_pipeline_set_layer_wrap_mode (paint_data->background_pipeline, 0,
+                                       COGL_PIPELINE_WRAP_MODE_REPEAT);
+
+  background_image_shadow_spec = st_theme_node_get_background_image_shadow (node);
+  if (background_image_shadow_spec)
+    {
+      paint_data->background_shadow_pipeline = _st_create_shadow_pipeline (background_image_shadow_spec,
+                                                                           paint_data->background_texture,
+                                                                           resource_scale);
     }
 
  out:
-  return node->background_texture != NULL;
+  return paint_data->background_texture != NULL;
 }
 
 static gboolean
@@ -1505,6 +2008,7 @@ st_theme_node_render_resources (StThemeNodePaintState *state,
   state->alloc_width = width;
   state->alloc_height = height;
   state->resource_scale = resource_scale;
+  node->paint_data->missing_images = FALSE;
 
   _st_theme_node_ensure_background (node);
   _st_theme_node_ensure_geometry (node);
@@ -1567,7 +2071,7 @@ st_theme_node_render_resources (StThemeNodePaintState *state,
    * background image won't overlap with the node borders,
    * then we could use cogl for that case.
    */
-  if ((node->background_gradient_type != ST_GRADIENT_NONE)
+  if ((_st_theme_node_get_background (node)->gradient_type != ST_GRADIENT_NONE)
       || (has_inset_box_shadow && (has_border || node->background_color.alpha > 0))
       || (st_theme_node_get_background_image (node) && (has_border || has_border_radius))
       || has_large_corners)
@@ -1583,9 +2087,16 @@ st_theme_node_render_resources (StThemeNodePaintState *state,
     {
       st_theme_node_compute_maximum_borders (state);
 
-      if (st_theme_node_load_border_image (node, resource_scale))
+      /* Until the border image is loaded, its shadow is rendered
+       * from the rest of the node
+       */
+      if (!st_theme_node_load_border_image (node, resource_scale) &&
+          st_theme_node_get_border_image (node) != NULL)
+        node->paint_data->missing_images = TRUE;
+
+      if (node->paint_data->border_slices_texture != NULL)
         state->box_shadow_pipeline = _st_create_shadow_pipeline (box_shadow_spec,
-                                                                 node->border_slices_texture,
+                                                                 node->paint_data->border_slices_texture,
                                                                  state->resource_scale);
       else if (state->prerendered_texture != NULL)
         state->box_shadow_pipeline = _st_create_shadow_pipeline (box_shadow_spec,
@@ -1596,14 +2107,14 @@ st_theme_node_render_resources (StThemeNodePaintState *state,
     }
 
   /* If we don't have cached textures yet, check whether we can cache
-     them. */
-  if (!node->cached_textures)
+     them, unless they lack images that are still loading. */
+  if (!node->cached_textures && !node->paint_data->missing_images)
     {
       if (state->prerendered_pipeline == NULL &&
-          width >= node->box_shadow_min_width &&
-          height >= node->box_shadow_min_height)
+          width >= node->paint_data->box_shadow_min_width &&
+          height >= node->paint_data->box_shadow_min_height)
         {
-          st_theme_node_paint_state_copy (&node->cached_state, state);
+          st_theme_node_paint_state_copy (&node->paint_data->cached_state, state);
           node->cached_textures = TRUE;
         }
     }
@@ -1630,7 +2141,7 @@ st_theme_node_update_resources (StThemeNodePaintState *state,
     {
       cogl_clear_object (&state->prerendered_pipeline);
 
-      if (node->border_slices_texture == NULL &&
+      if (node->paint_data->border_slices_texture == NULL &&
           state->box_shadow_pipeline != NULL)
         {
           cogl_clear_object (&state->box_shadow_pipeline);
@@ -1642,6 +2153,7 @@ st_theme_node_update_resources (StThemeNodePaintState *state,
   state->alloc_width = width;
   state->alloc_height = height;
   state->resource_scale = resource_scale;
+  node->paint_data->missing_images = FALSE;
 
   box_shadow_spec = st_theme_node_get_box_shadow (node);
 
@@ -1690,7 +2202,7 @@ st_theme_node_ensure_color_pipeline (StThemeNode *node)
 {
   static CoglPipeline *color_pipeline_template = NULL;
 
-  if (node->color_pipeline != NULL)
+  if (node->paint_data->color_pipeline != NULL)
     return;
 
   if (G_UNLIKELY (color_pipeline_template == NULL))
@@ -1701,7 +2213,7 @@ st_theme_node_ensure_color_pipeline (StThemeNode *node)
       color_pipeline_template = cogl_pipeline_new (ctx);
     }
 
-  node->color_pipeline = cogl_pipeline_copy (color_pipeline_template);
+  node->paint_data->color_pipeline = cogl_pipeline_copy (color_pipeline_template);
 }
 
 static void
@@ -1762,7 +2274,7 @@ st_theme_node_paint_borders (StThemeNodePaintState *state,
       if (alpha > 0)
         {
           st_theme_node_ensure_color_pipeline (node);
-          cogl_pipeline_set_color4ub (node->color_pipeline,
+          cogl_pipeline_set_color4ub (node->paint_data->color_pipeline,
                                       effective_border.red * alpha / 255,
                                       effective_border.green * alpha / 255,
                                       effective_border.blue * alpha / 255,
@@ -1810,7 +2322,7 @@ st_theme_node_paint_borders (StThemeNodePaintState *state,
                              : height - border_width[ST_SIDE_BOTTOM];
 
           cogl_framebuffer_draw_rectangles (framebuffer,
-                                            node->color_pipeline,
+                                            node->paint_data->color_pipeline,
 					    rects, 4);
         }
     }
@@ -1875,7 +2387,7 @@ st_theme_node_paint_borders (StThemeNodePaintState *state,
   if (alpha > 0)
     {
       st_theme_node_ensure_color_pipeline (node);
-      cogl_pipeline_set_color4ub (node->color_pipeline,
+      cogl_pipeline_set_color4ub (node->paint_data->color_pipeline,
                                   node->background_color.red * alpha / 255,
                                   node->background_color.green * alpha / 255,
                                   node->background_color.blue * alpha / 255,
@@ -1967,7 +2479,7 @@ st_theme_node_paint_borders (StThemeNodePaintState *state,
                 break;
             }
           cogl_framebuffer_draw_rectangles (framebuffer,
-                                            node->color_pipeline,
+                                            node->paint_data->color_pipeline,
                                             verts, n_rects);
         }
 
@@ -1983,19 +2495,19 @@ st_theme_node_paint_borders (StThemeNodePaintState *state,
        * necessary, then the main rectangle
        */
       if (max_border_radius > border_width[ST_SIDE_TOP])
-        cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+        cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                          MAX(max_border_radius, border_width[ST_SIDE_LEFT]),
                                          border_width[ST_SIDE_TOP],
                                          width - MAX(max_border_radius, border_width[ST_SIDE_RIGHT]),
                                          max_border_radius);
       if (max_border_radius > border_width[ST_SIDE_BOTTOM])
-        cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+        cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                          MAX(max_border_radius, border_width[ST_SIDE_LEFT]),
                                          height - max_border_radius,
                                          width - MAX(max_border_radius, border_width[ST_SIDE_RIGHT]),
                                          height - border_width[ST_SIDE_BOTTOM]);
 
-      cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+      cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                        border_width[ST_SIDE_LEFT],
                                        MAX(border_width[ST_SIDE_TOP], max_border_radius),
                                        width - border_width[ST_SIDE_RIGHT],
@@ -2264,24 +2776,24 @@ st_theme_node_paint_sliced_shadow (StThemeNodePaintState *state,
                                    xend, yoffset, xend + shadow_width, yoffset + shadow_height);
 
   st_theme_node_ensure_color_pipeline (node);
-  cogl_pipeline_set_color4ub (node->color_pipeline, 0xff, 0x0, 0x0, 0xff);
+  cogl_pipeline_set_color4ub (node->paint_data->color_pipeline, 0xff, 0x0, 0x0, 0xff);
 
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xoffset, top, xend, top + 1);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xoffset, bottom, xend, bottom + 1);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    left, yoffset, left + 1, yend);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    right, yoffset, right + 1, yend);
 
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend, yoffset, xend + shadow_width, yoffset + 1);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend, yoffset + shadow_height, xend + shadow_width, yoffset + shadow_height + 1);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend, yoffset, xend + 1, yoffset + shadow_height);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend + shadow_width, yoffset, xend + shadow_width + 1, yoffset + shadow_height);
 
   s_top *= shadow_height;
@@ -2289,13 +2801,13 @@ st_theme_node_paint_sliced_shadow (StThemeNodePaintState *state,
   s_left *= shadow_width;
   s_right *= shadow_width;
 
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend, yoffset + s_top, xend + shadow_width, yoffset + s_top + 1);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend, yoffset + s_bottom, xend + shadow_width, yoffset + s_bottom + 1);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend + s_left, yoffset, xend + s_left + 1, yoffset + shadow_height);
-  cogl_framebuffer_draw_rectangle (framebuffer, node->color_pipeline,
+  cogl_framebuffer_draw_rectangle (framebuffer, node->paint_data->color_pipeline,
                                    xend + s_right, yoffset, xend + s_right + 1, yoffset + shadow_height);
 
 #endif
@@ -2351,6 +2863,7 @@ st_theme_node_compute_maximum_borders (StThemeNodePaintState *state)
 {
   int max_borders[4], center_radius;
   StThemeNode * node = state->node;
+  StThemeNodePaintData *paint_data = node->paint_data;
 
   /* Compute maximum borders sizes */
   max_borders[ST_SIDE_TOP] = MAX (node->border_radius[ST_CORNER_TOPLEFT],
@@ -2364,18 +2877,18 @@ st_theme_node_compute_maximum_borders (StThemeNodePaintState *state)
 
   center_radius = (node->box_shadow->blur > 0) ? (2 * node->box_shadow->blur + 1) : 1;
 
-  node->box_shadow_min_width = max_borders[ST_SIDE_LEFT] + max_borders[ST_SIDE_RIGHT] + center_radius;
-  node->box_shadow_min_height = max_borders[ST_SIDE_TOP] + max_borders[ST_SIDE_BOTTOM] + center_radius;
-  if (state->alloc_width < node->box_shadow_min_width ||
-      state->alloc_height < node->box_shadow_min_height)
+  paint_data->box_shadow_min_width = max_borders[ST_SIDE_LEFT] + max_borders[ST_SIDE_RIGHT] + center_radius;
+  paint_data->box_shadow_min_height = max_borders[ST_SIDE_TOP] + max_borders[ST_SIDE_BOTTOM] + center_radius;
+  if (state->alloc_width < paint_data->box_shadow_min_width ||
+      state->alloc_height < paint_data->box_shadow_min_height)
     {
       state->box_shadow_width = state->alloc_width;
       state->box_shadow_height = state->alloc_height;
     }
   else
     {
-      state->box_shadow_width = node->box_shadow_min_width;
-      state->box_shadow_height = node->box_shadow_min_height;
+      state->box_shadow_width = paint_data->box_shadow_min_width;
+      state->box_shadow_height = paint_data->box_shadow_min_height;
     }
 }
 
@@ -2386,6 +2899,7 @@ st_theme_node_paint_sliced_border_image (StThemeNode           *node,
                                          float                  height,
                                          guint8                 paint_opacity)
 {
+  StThemeNodePaintData *paint_data = node->paint_data;
   gfloat ex, ey;
   gfloat tx1, ty1, tx2, ty2;
   gint border_left, border_right, border_top, border_bottom;
@@ -2399,8 +2913,8 @@ st_theme_node_paint_sliced_border_image (StThemeNode           *node,
   st_border_image_get_borders (border_image,
                                &border_left, &border_right, &border_top, &border_bottom);
 
-  img_width = cogl_texture_get_width (node->border_slices_texture);
-  img_height = cogl_texture_get_height (node->border_slices_texture);
+  img_width = cogl_texture_get_width (paint_data->border_slices_texture);
+  img_height = cogl_texture_get_height (paint_data->border_slices_texture);
 
   tx1 = border_left / img_width;
   tx2 = (img_width - border_right) / img_width;
@@ -2415,7 +2929,7 @@ st_theme_node_paint_sliced_border_image (StThemeNode           *node,
   if (ey < 0)
     ey = border_bottom;          /* FIXME ? */
 
-  pipeline = node->border_slices_pipeline;
+  pipeline = paint_data->border_slices_pipeline;
   cogl_pipeline_set_color4ub (pipeline,
                               paint_opacity, paint_opacity, paint_opacity, paint_opacity);
 
@@ -2498,7 +3012,7 @@ st_theme_node_paint_outline (StThemeNode           *node,
   alpha = paint_opacity * outline_color.alpha / 255;
 
   st_theme_node_ensure_color_pipeline (node);
-  cogl_pipeline_set_color4ub (node->color_pipeline,
+  cogl_pipeline_set_color4ub (node->paint_data->color_pipeline,
                               effective_outline.red * alpha / 255,
                               effective_outline.green * alpha / 255,
                               effective_outline.blue * alpha / 255,
@@ -2534,7 +3048,7 @@ st_theme_node_paint_outline (StThemeNode           *node,
   rects[14] = 0;
   rects[15] = height;
 
-  cogl_framebuffer_draw_rectangles (framebuffer, node->color_pipeline, rects, 4);
+  cogl_framebuffer_draw_rectangles (framebuffer, node->paint_data->color_pipeline, rects, 4);
 }
 
 static gboolean
@@ -2544,6 +3058,7 @@ st_theme_node_needs_new_box_shadow_for_size (StThemeNodePaintState *state,
                                              float                  height,
                                              float                  resource_scale)
 {
+  StThemeNodePaintData *paint_data = node->paint_data;
   if (!node->rendered_once)
     return TRUE;
 
@@ -2558,22 +3073,22 @@ st_theme_node_needs_new_box_shadow_for_size (StThemeNodePaintState *state,
     return FALSE;
 
   /* If there is no shadow, no need to recompute a new box-shadow. */
-  if (node->box_shadow_min_width == 0 ||
-      node->box_shadow_min_height == 0)
+  if (paint_data->box_shadow_min_width == 0 ||
+      paint_data->box_shadow_min_height == 0)
     return FALSE;
 
   /* If the new size is inferior to the box-shadow minimum size (we
      already know the size has changed), we need to recompute the
      box-shadow. */
-  if (width < node->box_shadow_min_width ||
-      height < node->box_shadow_min_height)
+  if (width < paint_data->box_shadow_min_width ||
+      height < paint_data->box_shadow_min_height)
     return TRUE;
 
   /* Now checking whether the size of the node has crossed the minimum
      box-shadow size boundary, from below to above the minimum size .
      If that's the case, we need to recompute the box-shadow */
-  if (state->alloc_width < node->box_shadow_min_width ||
-      state->alloc_height < node->box_shadow_min_height)
+  if (state->alloc_width < paint_data->box_shadow_min_width ||
+      state->alloc_height < paint_data->box_shadow_min_height)
     return TRUE;
 
   return FALSE;
@@ -2587,6 +3102,7 @@ st_theme_node_paint (StThemeNode           *node,
                      guint8                 paint_opacity,
                      float                  resource_scale)
 {
+  StThemeNodePaintData *paint_data;
   float width, height;
   ClutterActorBox allocation;
 
@@ -2600,6 +3116,8 @@ st_theme_node_paint (StThemeNode           *node,
   if (width <= 0 || height <= 0 || resource_scale <= 0.0f)
     return;
 
+  paint_data = st_theme_node_ensure_paint_data (node);
+
   /* Check whether we need to recreate the textures of the paint
    * state, either because :
    *  1) the theme node associated to the paint state has changed
@@ -2614,17 +3132,32 @@ st_theme_node_paint (StThemeNode           *node,
          rendering. We end up sharing textures a cross different
          widgets. */
       if (node->rendered_once && node->cached_textures &&
-          width >= node->box_shadow_min_width && height >= node->box_shadow_min_height &&
+          width >= paint_data->box_shadow_min_width && height >= paint_data->box_shadow_min_height &&
           fabsf (resource_scale - state->resource_scale) < FLT_EPSILON)
-        st_theme_node_paint_state_copy (state, &node->cached_state);
-      else
-        st_theme_node_render_resources (state, node, width, height, resource_scale);
+        st_theme_node_paint_state_copy (state, &paint_data->cached_state);
+      else if (!_st_theme_context_lookup_paint_state (node->context, node,
+                                                      width, height,
+                                                      resource_scale, state))
+        {
+          st_theme_node_render_resources (state, node, width, height, resource_scale);
+          if (!paint_data->missing_images)
+            _st_theme_context_add_paint_state (node->context, node, state);
+        }
 
       node->rendered_once = TRUE;
     }
   else if (state->alloc_width != width || state->alloc_height != height ||
            fabsf (state->resource_scale - resource_scale) > FLT_EPSILON)
-    st_theme_node_update_resources (state, node, width, height, resource_scale);
+    {
+      if (!_st_theme_context_lookup_paint_state (node->context, node,
+                                                 width, height,
+                                                 resource_scale, state))
+        {
+          st_theme_node_update_resources (state, node, width, height, resource_scale);
+          if (!paint_data->missing_images)
+            _st_theme_context_add_paint_state (node->context, node, state);
+        }
+    }
 
   /* Rough notes about the relationship of borders and backgrounds in CSS3;
    * see http://www.w3.org/TR/css3-background/ for more accurate details.
@@ -2654,8 +3187,8 @@ st_theme_node_paint (StThemeNode           *node,
 
   if (state->box_shadow_pipeline)
     {
-      if (state->alloc_width < node->box_shadow_min_width ||
-          state->alloc_height < node->box_shadow_min_height)
+      if (state->alloc_width < paint_data->box_shadow_min_width ||
+          state->alloc_height < paint_data->box_shadow_min_height)
         _st_paint_shadow_with_opacity (node->box_shadow,
                                        framebuffer,
                                        state->box_shadow_pipeline,
@@ -2686,7 +3219,7 @@ st_theme_node_paint (StThemeNode           *node,
                                        paint_opacity);
         }
 
-      if (node->border_slices_pipeline != NULL)
+      if (paint_data->border_slices_pipeline != NULL)
         st_theme_node_paint_sliced_border_image (node, framebuffer, width, height, paint_opacity);
     }
   else
@@ -2697,22 +3230,27 @@ st_theme_node_paint (StThemeNode           *node,
   st_theme_node_paint_outline (node, framebuffer, box, paint_opacity);
 
   if (state->prerendered_pipeline == NULL &&
-      st_theme_node_load_background_image (node, resource_scale))
+      st_theme_node_load_background_image (node,
+                                           allocation.x2 - allocation.x1,
+                                           allocation.y2 - allocation.y1,
+                                           resource_scale))
     {
       ClutterActorBox background_box;
       ClutterActorBox texture_coords;
       gboolean has_visible_outline;
+      gboolean background_repeat;
 
       /* If the node doesn't have an opaque or repeating background or
        * a border then we let its background image shadows leak out,
        * but otherwise we clip it.
        */
       has_visible_outline = st_theme_node_has_visible_outline (node);
+      background_repeat = _st_theme_node_get_background (node)->repeat;
 
       get_background_position (node, &allocation, resource_scale,
                                &background_box, &texture_coords);
 
-      if (has_visible_outline || node->background_repeat)
+      if (has_visible_outline || background_repeat)
         cogl_framebuffer_push_rectangle_clip (framebuffer,
                                               allocation.x1, allocation.y1,
                                               allocation.x2, allocation.y2);
@@ -2730,20 +3268,20 @@ st_theme_node_paint (StThemeNode           *node,
        * there is nothing (like a border, or the edge of the background color)
        * to logically confine it.
        */
-      if (node->background_shadow_pipeline != NULL)
+      if (paint_data->background_shadow_pipeline != NULL)
         _st_paint_shadow_with_opacity (node->background_image_shadow,
                                        framebuffer,
-                                       node->background_shadow_pipeline,
+                                       paint_data->background_shadow_pipeline,
                                        &background_box,
                                        paint_opacity);
 
-      paint_material_with_opacity (node->background_pipeline,
+      paint_material_with_opacity (paint_data->background_pipeline,
                                    framebuffer,
                                    &background_box,
                                    &texture_coords,
                                    paint_opacity);
 
-      if (has_visible_outline || node->background_repeat)
+      if (has_visible_outline || background_repeat)
         cogl_framebuffer_pop_clip (framebuffer);
     }
 }
@@ -2862,3 +3400,40 @@ st_theme_node_paint_state_invalidate_for_file (StThemeNodePaintState *state,
 
   return FALSE;
 }
+
+static gboolean
+st_theme_node_uses_file (StThemeNode *node,
+                         GFile       *file)
+{
+  StBorderImage *border_image;
+  GFile *theme_file;
+
+  theme_file = st_theme_node_get_background_image (node);
+  if (theme_file != NULL && g_file_equal (theme_file, file))
+    return TRUE;
+
+  border_image = st_theme_node_get_border_image (node);
+  theme_file = border_image ? st_border_image_get_file (border_image) : NULL;
+  return theme_file != NULL && g_file_equal (theme_file, file);
+}
+
+/*
+ * _st_theme_node_paint_state_invalidate_for_loaded_file:
+ * @state: a #StThemeNodePaintState
+ * @file: a #GFile that finished loading
+ *
+ * Drops the resources of @state if its node uses @file, since they
+ * may have been rendered before @file was loaded.
+ *
+ * Returns: %TRUE if @state was invalidated
+ */
+gboolean
+_st_theme_node_paint_state_invalidate_for_loaded_file (StThemeNodePaintState *state,
+                                                       GFile                 *file)
+{
+  if (state->node == NULL || !st_theme_node_uses_file (state->node, file))
+    return FALSE;
+
+  st_theme_node_paint_state_free (state);
+  return TRUE;
+}
@@ -28,6 +28,68 @@
 
 G_BEGIN_DECLS
 
+/* Describes a node without creating it, to look up interned nodes;
+ * classes are whitespace separated, and @extra_pseudo_class, when set,
+ * is a single pseudo class appended after @pseudo_class.
+ */
+typedef struct _StThemeNodeKey StThemeNodeKey;
+struct _StThemeNodeKey {
+  StThemeNode *parent_node;
+  StTheme *theme;
+  GType element_type;
+  const char *element_id;
+  const char *element_class;
+  const char *pseudo_class;
+  const char *extra_pseudo_class;
+  const char *inline_style;
+};
+
+/* Background properties beyond the color, which most nodes don't set;
+ * only allocated once one of them is.
+ */
+typedef struct _StThemeNodeBackground StThemeNodeBackground;
+struct _StThemeNodeBackground {
+  /* If gradient is set, then background_color is the gradient start */
+  StGradientType gradient_type;
+  ClutterColor gradient_end;
+
+  int position_x;
+  int position_y;
+
+  StBackgroundSize size;
+  int size_w;
+  int size_h;
+
+  guint position_set : 1;
+  guint repeat : 1;
+};
+
+/* Resources cached by st_theme_node_paint(), only allocated for nodes
+ * that actually get painted.
+ */
+typedef struct _StThemeNodePaintData StThemeNodePaintData;
+struct _StThemeNodePaintData {
+  CoglPipeline *border_slices_texture;
+  CoglPipeline *border_slices_pipeline;
+  CoglPipeline *background_texture;
+  CoglPipeline *background_pipeline;
+  CoglPipeline *background_shadow_pipeline;
+  CoglPipeline *color_pipeline;
+
+  StThemeNodePaintState cached_state;
+
+  int box_shadow_min_width;
+  int box_shadow_min_height;
+
+  /* The size background_texture was decoded to cover, -1 if unlimited */
+  int background_texture_width;
+  int background_texture_height;
+
+  /* Set while rendering if an image wasn't loaded yet, the result is
+   * then not shared with other paint states */
+  guint missing_images : 1;
+};
+
 struct _StThemeNode {
   GObject parent;
 
@@ -38,26 +100,31 @@ struct _StThemeNode {
   PangoFontDescription *font_desc;
 
   ClutterColor background_color;
-  /* If gradient is set, then background_color is the gradient start */
-  StGradientType background_gradient_type;
-  ClutterColor background_gradient_end;
-
-  int background_position_x;
-  int background_position_y;
-
-  StBackgroundSize background_size;
-  gint background_size_w;
-  gint background_size_h;
-
   ClutterColor foreground_color;
   ClutterColor border_color[4];
   ClutterColor outline_color;
 
-  int border_width[4];
-  int border_radius[4];
-  int outline_width;
-  guint padding[4];
-  guint margin[4];
+  /* Lengths in physical pixels, clamped to G_MAXUINT16 */
+  guint16 border_width[4];
+  guint16 border_radius[4];
+  guint16 padding[4];
+  guint16 margin[4];
+  guint16 outline_width;
+
+  guint properties_computed : 1;
+  guint geometry_computed : 1;
+  guint background_computed : 1;
+  guint foreground_computed : 1;
+  guint border_image_computed : 1;
+  guint box_shadow_computed : 1;
+  guint background_image_shadow_computed : 1;
+  guint text_shadow_computed : 1;
+  guint link_type : 2;
+  guint rendered_once : 1;
+  guint cached_textures : 1;
+  guint interned : 1;
+  guint geometry_fingerprint_computed : 1;
+  guint paint_fingerprint_computed : 1;
 
   int width;
   int height;
@@ -68,6 +135,11 @@ struct _StThemeNode {
 
   int transition_duration;
 
+  int cached_scale_factor;
+
+  guint64 geometry_fingerprint;
+  guint64 paint_fingerprint;
+
   GFile *background_image;
   StBorderImage *border_image;
   StShadow *box_shadow;
@@ -81,49 +153,69 @@ struct _StThemeNode {
   GStrv pseudo_classes;
   char *inline_style;
 
-  CRDeclaration **properties;
-  int n_properties;
+  /* Allocated on demand, see above */
+  StThemeNodeBackground *background;
+  StThemeNodePaintData *paint_data;
 
   /* We hold onto these separately so we can destroy them on finalize */
   CRDeclaration *inline_properties;
 
-  guint background_position_set : 1;
-  guint background_repeat : 1;
-
-  guint properties_computed : 1;
-  guint geometry_computed : 1;
-  guint background_computed : 1;
-  guint foreground_computed : 1;
-  guint border_image_computed : 1;
-  guint box_shadow_computed : 1;
-  guint background_image_shadow_computed : 1;
-  guint text_shadow_computed : 1;
-  guint link_type : 2;
-  guint rendered_once : 1;
-  guint cached_textures : 1;
-
-  int box_shadow_min_width;
-  int box_shadow_min_height;
-
-  guint stylesheets_changed_id;
-
-  CoglPipeline *border_slices_texture;
-  CoglPipeline *border_slices_pipeline;
-  CoglPipeline *background_texture;
-  CoglPipeline *background_pipeline;
-  CoglPipeline *background_shadow_pipeline;
-  CoglPipeline *color_pipeline;
-
-  StThemeNodePaintState cached_state;
+  CRDeclaration **properties;
+  int n_properties;
 
-  int cached_scale_factor;
+  /* Interned nodes are chained by hash in the context, which doesn't
+   * hold a reference on them; recently used ones are additionally kept
+   * alive through recent_link.
+   */
+  guint interned_hash;
+  StThemeNode *next_interned;
+  GList recent_link;
 };
 
+/* Keep an eye on the per-node footprint, there can be many thousands */
+G_STATIC_ASSERT (GLIB_SIZEOF_VOID_P != 8 || sizeof (StThemeNode) <= 328);
+
 void _st_theme_node_ensure_background (StThemeNode *node);
 void _st_theme_node_ensure_geometry (StThemeNode *node);
 void _st_theme_node_apply_margins (StThemeNode *node,
                                    ClutterActor *actor);
 
+const StThemeNodeBackground *_st_theme_node_get_background (StThemeNode *node);
+guint64 _st_theme_node_get_geometry_fingerprint (StThemeNode *node);
+guint64 _st_theme_node_get_paint_fingerprint (StThemeNode *node);
+
+void _st_theme_node_get_corner_cache_stats (guint *hits,
+                                            guint *misses,
+                                            guint *n_corners,
+                                            guint *n_atlases);
+
+
+guint _st_theme_node_key_hash (StThemeContext       *context,
+                               const StThemeNodeKey *key);
+gboolean _st_theme_node_matches_key (StThemeNode          *node,
+                                     StThemeContext       *context,
+                                     const StThemeNodeKey *key);
+StThemeNode *_st_theme_node_new_for_key (StThemeContext       *context,
+                                         const StThemeNodeKey *key);
+
+StThemeNode *_st_theme_context_lookup_node (StThemeContext       *context,
+                                            const StThemeNodeKey *key);
+void _st_theme_context_forget_node (StThemeContext *context,
+                                    StThemeNode    *node);
+
+gboolean _st_theme_context_lookup_paint_state (StThemeContext        *context,
+                                               StThemeNode           *node,
+                                               float                  width,
+                                               float                  height,
+                                               float                  resource_scale,
+                                               StThemeNodePaintState *state);
+void _st_theme_context_add_paint_state (StThemeContext        *context,
+                                        StThemeNode           *node,
+                                        StThemeNodePaintState *state);
+
+gboolean _st_theme_node_paint_state_invalidate_for_loaded_file (StThemeNodePaintState *state,
+                                                                GFile                 *file);
+
 G_END_DECLS
 
 #endif /* __ST_THEME_NODE_PRIVATE_H__ */
@@ -46,8 +46,6 @@ static void
 st_theme_node_init (StThemeNode *node)
 {
   node->transition_duration = -1;
-
-  st_theme_node_paint_state_init (&node->cached_state);
 }
 
 static void
@@ -71,8 +69,10 @@ maybe_free_properties (StThemeNode *node)
 
   if (node->inline_properties)
     {
-      /* This destroys the list, not just the head of the list */
-      cr_declaration_destroy (node->inline_properties);
+      /* This destroys the list, not just the head of the list,
+       * once it isn't shared anymore
+       */
+      cr_declaration_unref (node->inline_properties);
       node->inline_properties = NULL;
     }
 }
@@ -82,6 +82,9 @@ st_theme_node_dispose (GObject *gobject)
 {
   StThemeNode *node = ST_THEME_NODE (gobject);
 
+  if (node->interned)
+    _st_theme_context_forget_node (node->context, node);
+
   if (node->parent_node)
     {
       g_object_unref (node->parent_node);
@@ -100,7 +103,8 @@ st_theme_node_dispose (GObject *gobject)
       node->icon_colors = NULL;
     }
 
-  st_theme_node_paint_state_free (&node->cached_state);
+  if (node->paint_data)
+    st_theme_node_paint_state_free (&node->paint_data->cached_state);
 
   g_clear_object (&node->theme);
 
@@ -127,16 +131,27 @@ st_theme_node_finalize (GObject *object)
 
   g_clear_object (&node->background_image);
 
-  cogl_clear_object (&node->background_texture);
-  cogl_clear_object (&node->background_pipeline);
-  cogl_clear_object (&node->background_shadow_pipeline);
-  cogl_clear_object (&node->border_slices_texture);
-  cogl_clear_object (&node->border_slices_pipeline);
-  cogl_clear_object (&node->color_pipeline);
+  if (node->paint_data)
+    {
+      StThemeNodePaintData *paint_data = node->paint_data;
+
+      cogl_clear_object (&paint_data->background_texture);
+      cogl_clear_object (&paint_data->background_pipeline);
+      cogl_clear_object (&paint_data->background_shadow_pipeline);
+      cogl_clear_object (&paint_data->border_slices_texture);
+      cogl_clear_object (&paint_data->border_slices_pipeline);
+      cogl_clear_object (&paint_data->color_pipeline);
+
+      g_clear_pointer (&node->paint_data, g_free);
+    }
+
+  g_clear_pointer (&node->background, g_free);
 
   G_OBJECT_CLASS (st_theme_node_parent_class)->finalize (object);
 }
 
+#define CLASS_DELIMITERS " \t\f\r\n"
+
 static GStrv
 split_on_whitespace (const gchar *s)
 {
@@ -151,12 +166,12 @@ split_on_whitespace (const gchar *s)
   arr = g_ptr_array_new ();
   l = g_strdup (s);
 
-  cur = strtok_r (l, " \t\f\r\n", &temp);
+  cur = strtok_r (l, CLASS_DELIMITERS, &temp);
 
   while (cur != NULL)
     {
       g_ptr_array_add (arr, g_strdup (cur));
-      cur = strtok_r (NULL, " \t\f\r\n", &temp);
+      cur = strtok_r (NULL, CLASS_DELIMITERS, &temp);
     }
 
   g_free (l);
@@ -397,6 +412,21 @@ st_theme_node_equal (StThemeNode *node_a, StThemeNode *node_b)
   return TRUE;
 }
 
+/* Same as g_str_hash(), for a class name that isn't nul-terminated */
+static guint
+hash_class (const char *name,
+            gsize       len)
+{
+  const signed char *p = (const signed char *) name;
+  guint32 hash = 5381;
+  gsize i;
+
+  for (i = 0; i < len; i++)
+    hash = (hash << 5) + hash + p[i];
+
+  return hash;
+}
+
 /**
  * st_theme_node_hash:
  * @node: a #StThemeNode
@@ -430,7 +460,7 @@ st_theme_node_hash (StThemeNode *node)
       gchar **it;
 
       for (it = node->element_classes; *it != NULL; it++)
-        hash = hash * 33 + g_str_hash (*it) + 1;
+        hash = hash * 33 + hash_class (*it, strlen (*it)) + 1;
     }
 
   if (node->pseudo_classes != NULL)
@@ -438,12 +468,194 @@ st_theme_node_hash (StThemeNode *node)
       gchar **it;
 
       for (it = node->pseudo_classes; *it != NULL; it++)
-        hash = hash * 33 + g_str_hash (*it) + 1;
+        hash = hash * 33 + hash_class (*it, strlen (*it)) + 1;
     }
 
   return hash;
 }
 
+/* Iterates over the whitespace separated classes of @str without
+ * copying them; returns %FALSE when there are no classes left.
+ */
+static gboolean
+next_class (const char **str,
+            const char **name,
+            gsize       *len)
+{
+  const char *p = *str;
+
+  if (p == NULL)
+    return FALSE;
+
+  p += strspn (p, CLASS_DELIMITERS);
+  if (*p == '\0')
+    {
+      *str = p;
+      return FALSE;
+    }
+
+  *name = p;
+  *len = strcspn (p, CLASS_DELIMITERS);
+  *str = p + *len;
+
+  return TRUE;
+}
+
+static StTheme *
+key_get_theme (const StThemeNodeKey *key)
+{
+  if (key->theme == NULL && key->parent_node != NULL)
+    return key->parent_node->theme;
+
+  return key->theme;
+}
+
+static guint
+hash_classes (guint       hash,
+              const char *classes,
+              const char *extra_class)
+{
+  const char *name;
+  gsize len;
+
+  while (next_class (&classes, &name, &len))
+    hash = hash * 33 + hash_class (name, len) + 1;
+
+  if (extra_class != NULL)
+    hash = hash * 33 + hash_class (extra_class, strlen (extra_class)) + 1;
+
+  return hash;
+}
+
+static gboolean
+classes_match (GStrv       strv,
+               const char *classes,
+               const char *extra_class)
+{
+  const char *name;
+  gsize len;
+  int i = 0;
+
+  if ((strv == NULL) != (classes == NULL && extra_class == NULL))
+    return FALSE;
+
+  if (strv == NULL)
+    return TRUE;
+
+  while (next_class (&classes, &name, &len))
+    {
+      if (strv[i] == NULL ||
+          strncmp (strv[i], name, len) != 0 ||
+          strv[i][len] != '\0')
+        return FALSE;
+
+      i++;
+    }
+
+  if (extra_class != NULL)
+    {
+      if (g_strcmp0 (strv[i], extra_class) != 0)
+        return FALSE;
+
+      i++;
+    }
+
+  return strv[i] == NULL;
+}
+
+/*
+ * _st_theme_node_key_hash:
+ * @context: the context the node would be created for
+ * @key: the description of the node
+ *
+ * Returns: the same value as st_theme_node_hash() for the node that
+ *   _st_theme_node_new_for_key() would create, without creating it.
+ */
+guint
+_st_theme_node_key_hash (StThemeContext       *context,
+                         const StThemeNodeKey *key)
+{
+  guint hash;
+
+  hash = GPOINTER_TO_UINT (key->parent_node);
+
+  hash = hash * 33 + GPOINTER_TO_UINT (context);
+  hash = hash * 33 + GPOINTER_TO_UINT (key_get_theme (key));
+  hash = hash * 33 + ((guint) key->element_type);
+  hash = hash * 33 + ((guint) st_theme_context_get_scale_factor (context));
+
+  if (key->element_id != NULL)
+    hash = hash * 33 + g_str_hash (key->element_id);
+
+  if (key->inline_style != NULL)
+    hash = hash * 33 + g_str_hash (key->inline_style);
+
+  if (key->element_class != NULL)
+    hash = hash_classes (hash, key->element_class, NULL);
+
+  if (key->pseudo_class != NULL || key->extra_pseudo_class != NULL)
+    hash = hash_classes (hash, key->pseudo_class, key->extra_pseudo_class);
+
+  return hash;
+}
+
+/*
+ * _st_theme_node_matches_key:
+ * @node: a #StThemeNode
+ * @context: the context the node would be created for
+ * @key: the description of the node
+ *
+ * Returns: %TRUE if @node is equal, as per st_theme_node_equal(), to the
+ *   node that _st_theme_node_new_for_key() would create.
+ */
+gboolean
+_st_theme_node_matches_key (StThemeNode          *node,
+                            StThemeContext       *context,
+                            const StThemeNodeKey *key)
+{
+  if (node->parent_node != key->parent_node ||
+      node->context != context ||
+      node->theme != key_get_theme (key) ||
+      node->element_type != key->element_type ||
+      node->cached_scale_factor != st_theme_context_get_scale_factor (context) ||
+      g_strcmp0 (node->element_id, key->element_id) ||
+      g_strcmp0 (node->inline_style, key->inline_style))
+    return FALSE;
+
+  return classes_match (node->element_classes, key->element_class, NULL) &&
+         classes_match (node->pseudo_classes,
+                        key->pseudo_class, key->extra_pseudo_class);
+}
+
+/*
+ * _st_theme_node_new_for_key:
+ * @context: the context representing global state for this themed tree
+ * @key: the description of the node
+ *
+ * Creates a new #StThemeNode as described by @key.
+ *
+ * Returns: (transfer full): a new #StThemeNode
+ */
+StThemeNode *
+_st_theme_node_new_for_key (StThemeContext       *context,
+                            const StThemeNodeKey *key)
+{
+  g_autofree char *pseudo_class = NULL;
+
+  if (key->extra_pseudo_class == NULL)
+    pseudo_class = g_strdup (key->pseudo_class);
+  else if (key->pseudo_class == NULL)
+    pseudo_class = g_strdup (key->extra_pseudo_class);
+  else
+    pseudo_class = g_strconcat (key->pseudo_class, " ",
+                                key->extra_pseudo_class, NULL);
+
+  return st_theme_node_new (context, key->parent_node, key->theme,
+                            key->element_type, key->element_id,
+                            key->element_class, pseudo_class,
+                            key->inline_style);
+}
+
 static void
 ensure_properties (StThemeNode *node)
 {
@@ -463,7 +675,7 @@ ensure_properties (StThemeNode *node)
           if (!properties)
             properties = g_ptr_array_new ();
 
-          node->inline_properties = _st_theme_parse_declaration_list (node->inline_style);
+          node->inline_properties = _st_theme_lookup_declaration_list (node->inline_style);
           for (cur_decl = node->inline_properties; cur_decl; cur_decl = cur_decl->next)
             g_ptr_array_add (properties, cur_decl);
         }
@@ -1265,6 +1477,13 @@ st_theme_node_get_length (StThemeNode *node,
     return 0.0;
 }
 
+/* Lengths are stored in 16 bits in the node */
+static guint16
+clamp_length (int value)
+{
+  return CLAMP (value, 0, G_MAXUINT16);
+}
+
 static void
 do_border_radius_term (StThemeNode *node,
                        CRTerm      *term,
@@ -1278,6 +1497,8 @@ do_border_radius_term (StThemeNode *node,
   if (get_length_from_term_int (node, term, FALSE, &value) != VALUE_FOUND)
     return;
 
+  value = clamp_length (value);
+
   if (topleft)
     node->border_radius[ST_CORNER_TOPLEFT] = value;
   if (topright)
@@ -1469,7 +1690,7 @@ do_border_property (StThemeNode   *node,
           if (color_set)
             node->border_color[j] = color;
           if (width_set)
-            node->border_width[j] = width;
+            node->border_width[j] = clamp_length (width);
         }
     }
   else
@@ -1477,7 +1698,7 @@ do_border_property (StThemeNode   *node,
       if (color_set)
         node->border_color[side] = color;
       if (width_set)
-        node->border_width[side] = width;
+        node->border_width[side] = clamp_length (width);
     }
 }
 
@@ -1570,7 +1791,7 @@ do_outline_property (StThemeNode   *node,
   if (color_set)
     node->outline_color = color;
   if (width_set)
-    node->outline_width = width;
+    node->outline_width = clamp_length (width);
 }
 
 static void
@@ -1586,6 +1807,8 @@ do_padding_property_term (StThemeNode *node,
   if (get_length_from_term_int (node, term, FALSE, &value) != VALUE_FOUND)
     return;
 
+  value = clamp_length (value);
+
   if (left)
     node->padding[ST_SIDE_LEFT] = value;
   if (right)
@@ -1668,6 +1891,8 @@ do_margin_property_term (StThemeNode *node,
   if (get_length_from_term_int (node, term, FALSE, &value) != VALUE_FOUND)
     return;
 
+  value = clamp_length (value);
+
   if (left)
     node->margin[ST_SIDE_LEFT] = value;
   if (right)
@@ -2032,20 +2257,50 @@ st_theme_node_get_max_height (StThemeNode *node)
   return node->max_height;
 }
 
+static const StThemeNodeBackground default_background = {
+  .gradient_type = ST_GRADIENT_NONE,
+  .size = ST_BACKGROUND_SIZE_AUTO,
+};
+
+static StThemeNodeBackground *
+ensure_background_details (StThemeNode *node)
+{
+  if (node->background == NULL)
+    node->background = g_memdup2 (&default_background,
+                                  sizeof (StThemeNodeBackground));
+
+  return node->background;
+}
+
+/**
+ * _st_theme_node_get_background:
+ * @node: a #StThemeNode
+ *
+ * Gets the background properties of @node other than its color and
+ * image; these are shared defaults for nodes that set none of them.
+ *
+ * Returns: (transfer none): the background properties
+ */
+const StThemeNodeBackground *
+_st_theme_node_get_background (StThemeNode *node)
+{
+  _st_theme_node_ensure_background (node);
+
+  return node->background ? node->background : &default_background;
+}
+
 void
 _st_theme_node_ensure_background (StThemeNode *node)
 {
+  StThemeNodeBackground *background;
   int i;
 
   if (node->background_computed)
     return;
 
-  node->background_repeat = FALSE;
   node->background_computed = TRUE;
   node->background_color = TRANSPARENT_COLOR;
-  node->background_gradient_type = ST_GRADIENT_NONE;
-  node->background_position_set = FALSE;
-  node->background_size = ST_BACKGROUND_SIZE_AUTO;
+  g_clear_pointer (&node->background, g_free);
 
   ensure_properties (node);
 
@@ -2071,8 +2326,11 @@ _st_theme_node_ensure_background (StThemeNode *node)
           /* background: property sets all terms to specified or default values */
           node->background_color = TRANSPARENT_COLOR;
           g_clear_object (&node->background_image);
-          node->background_position_set = FALSE;
-          node->background_size = ST_BACKGROUND_SIZE_AUTO;
+          if (node->background)
+            {
+              node->background->position_set = FALSE;
+              node->background->size = ST_BACKGROUND_SIZE_AUTO;
+            }
 
           for (term = decl->value; term; term = term->next)
             {
@@ -2113,70 +2371,76 @@ _st_theme_node_ensure_background (StThemeNode *node)
         }
       else if (strcmp (property_name, "-position") == 0)
         {
-          GetFromTermResult result = get_length_from_term_int (node, decl->value, FALSE, &node->background_position_x);
+          GetFromTermResult result;
+
+          background = ensure_background_details (node);
+
+          result = get_length_from_term_int (node, decl->value, FALSE, &background->position_x);
           if (result == VALUE_NOT_FOUND)
             {
-              node->background_position_set = FALSE;
+              background->position_set = FALSE;
               continue;
             }
           else
-            node->background_position_set = TRUE;
+            background->position_set = TRUE;
 
-          result = get_length_from_term_int (node, decl->value->next, FALSE, &node->background_position_y);
+          result = get_length_from_term_int (node, decl->value->next, FALSE, &background->position_y);
 
           if (result == VALUE_NOT_FOUND)
             {
-              node->background_position_set = FALSE;
+              background->position_set = FALSE;
               continue;
             }
           else
-            node->background_position_set = TRUE;
+            background->position_set = TRUE;
         }
       else if (strcmp (property_name, "-repeat") == 0)
         {
           if (decl->value->type == TERM_IDENT)
             {
               if (strcmp (decl->value->content.str->stryng->str, "repeat") == 0)
-                node->background_repeat = TRUE;
+                ensure_background_details (node)->repeat = TRUE;
             }
         }
       else if (strcmp (property_name, "-size") == 0)
         {
+          background = ensure_background_details (node);
+
           if (decl->value->type == TERM_IDENT)
             {
               if (strcmp (decl->value->content.str->stryng->str, "contain") == 0)
-                node->background_size = ST_BACKGROUND_SIZE_CONTAIN;
+                background->size = ST_BACKGROUND_SIZE_CONTAIN;
               else if (strcmp (decl->value->content.str->stryng->str, "cover") == 0)
-                node->background_size = ST_BACKGROUND_SIZE_COVER;
+                background->size = ST_BACKGROUND_SIZE_COVER;
               else if ((strcmp (decl->value->content.str->stryng->str, "auto") == 0) && (decl->value->next) && (decl->value->next->type == TERM_NUMBER))
                 {
-                  GetFromTermResult result = get_length_from_term_int (node, decl->value->next, FALSE, &node->background_size_h);
+                  GetFromTermResult result = get_length_from_term_int (node, decl->value->next, FALSE, &background->size_h);
 
-                  node->background_size_w = -1;
-                  node->background_size = (result == VALUE_FOUND) ? ST_BACKGROUND_SIZE_FIXED : ST_BACKGROUND_SIZE_AUTO;
+                  background->size_w = -1;
+                  background->size = (result == VALUE_FOUND) ? ST_BACKGROUND_SIZE_FIXED : ST_BACKGROUND_SIZE_AUTO;
                 }
               else
-                node->background_size = ST_BACKGROUND_SIZE_AUTO;
+                background->size = ST_BACKGROUND_SIZE_AUTO;
             }
           else if (decl->value->type == TERM_NUMBER)
             {
-              GetFromTermResult result = get_length_from_term_int (node, decl->value, FALSE, &node->background_size_w);
+              GetFromTermResult result = get_length_from_term_int (node, decl->value, FALSE, &background->size_w);
               if (result == VALUE_NOT_FOUND)
                 continue;
 
-              node->background_size = ST_BACKGROUND_SIZE_FIXED;
+              background->size = ST_BACKGROUND_SIZE_FIXED;
 
               if ((decl->value->next) && (decl->value->next->type == TERM_NUMBER))
                 {
-                  result = get_length_from_term_int (node, decl->value->next, FALSE, &node->background_size_h);
+                  result = get_length_from_term_int (node, decl->value->next, FALSE, &background->size_h);
 
                   if (result == VALUE_FOUND)
                     continue;
                 }
-              node->background_size_h = -1;
+              background->size_h = -1;
             }
           else
-            node->background_size = ST_BACKGROUND_SIZE_AUTO;
+            background->size = ST_BACKGROUND_SIZE_AUTO;
         }
       else if (strcmp (property_name, "-color") == 0)
         {
@@ -2230,19 +2494,20 @@ _st_theme_node_ensure_background (StThemeNode *node)
           CRTerm *term = decl->value;
           if (strcmp (term->content.str->stryng->str, "vertical") == 0)
             {
-              node->background_gradient_type = ST_GRADIENT_VERTICAL;
+              ensure_background_details (node)->gradient_type = ST_GRADIENT_VERTICAL;
             }
           else if (strcmp (term->content.str->stryng->str, "horizontal") == 0)
             {
-              node->background_gradient_type = ST_GRADIENT_HORIZONTAL;
+              ensure_background_details (node)->gradient_type = ST_GRADIENT_HORIZONTAL;
             }
           else if (strcmp (term->content.str->stryng->str, "radial") == 0)
             {
-              node->background_gradient_type = ST_GRADIENT_RADIAL;
+              ensure_background_details (node)->gradient_type = ST_GRADIENT_RADIAL;
             }
           else if (strcmp (term->content.str->stryng->str, "none") == 0)
             {
-              node->background_gradient_type = ST_GRADIENT_NONE;
+              if (node->background)
+                node->background->gradient_type = ST_GRADIENT_NONE;
             }
           else
             {
@@ -2256,7 +2521,8 @@ _st_theme_node_ensure_background (StThemeNode *node)
         }
       else if (strcmp (property_name, "-gradient-end") == 0)
         {
-          get_color_from_term (node, decl->value, &node->background_gradient_end);
+          background = ensure_background_details (node);
+          get_color_from_term (node, decl->value, &background->gradient_end);
         }
     }
 }
@@ -2360,11 +2626,11 @@ st_theme_node_get_background_gradient (StThemeNode    *node,
 
   _st_theme_node_ensure_background (node);
 
-  *type = node->background_gradient_type;
+  *type = _st_theme_node_get_background (node)->gradient_type;
   if (*type != ST_GRADIENT_NONE)
     {
       *start = node->background_color;
-      *end = node->background_gradient_end;
+      *end = node->background->gradient_end;
     }
 }
 
@@ -4142,6 +4408,214 @@ st_theme_node_get_paint_box (StThemeNode           *node,
     }
 }
 
+/* Fingerprints summarize the computed values that geometry and paint
+ * equality depend on, so that nodes that differ can be told apart
+ * without comparing them field by field. Values that compare equal must
+ * always add the same bits.
+ */
+static inline guint64
+fingerprint_add (guint64 fingerprint,
+                 guint64 value)
+{
+  return fingerprint ^ (value + G_GUINT64_CONSTANT (0x9e3779b97f4a7c15) +
+                        (fingerprint << 6) + (fingerprint >> 2));
+}
+
+static guint64
+fingerprint_add_double (guint64 fingerprint,
+                        double  value)
+{
+  union {
+    double d;
+    guint64 u;
+  } bits;
+
+  /* Turns -0.0 into 0.0, as they compare equal */
+  bits.d = value + 0.0;
+
+  return fingerprint_add (fingerprint, bits.u);
+}
+
+static guint64
+fingerprint_add_color (guint64             fingerprint,
+                       const ClutterColor *color)
+{
+  return fingerprint_add (fingerprint, clutter_color_to_pixel (color));
+}
+
+static guint64
+fingerprint_add_shadow (guint64   fingerprint,
+                        StShadow *shadow)
+{
+  if (shadow == NULL)
+    return fingerprint_add (fingerprint, 0);
+
+  fingerprint = fingerprint_add (fingerprint, 1);
+  fingerprint = fingerprint_add_color (fingerprint, &shadow->color);
+  fingerprint = fingerprint_add_double (fingerprint, shadow->xoffset);
+  fingerprint = fingerprint_add_double (fingerprint, shadow->yoffset);
+  fingerprint = fingerprint_add_double (fingerprint, shadow->blur);
+  fingerprint = fingerprint_add_double (fingerprint, shadow->spread);
+
+  return fingerprint_add (fingerprint, shadow->inset != FALSE);
+}
+
+/**
+ * _st_theme_node_get_geometry_fingerprint:
+ * @node: a #StThemeNode
+ *
+ * Gets a fingerprint of everything st_theme_node_geometry_equal()
+ * compares: nodes with equal geometry always have the same fingerprint.
+ *
+ * Returns: the geometry fingerprint of @node
+ */
+guint64
+_st_theme_node_get_geometry_fingerprint (StThemeNode *node)
+{
+  guint64 fingerprint;
+  StSide side;
+
+  if (node->geometry_fingerprint_computed)
+    return node->geometry_fingerprint;
+
+  _st_theme_node_ensure_geometry (node);
+
+  fingerprint = fingerprint_add (0, node->cached_scale_factor);
+
+  for (side = ST_SIDE_TOP; side <= ST_SIDE_LEFT; side++)
+    {
+      fingerprint = fingerprint_add (fingerprint, node->border_width[side]);
+      fingerprint = fingerprint_add (fingerprint, node->padding[side]);
+    }
+
+  fingerprint = fingerprint_add (fingerprint, (guint) node->width);
+  fingerprint = fingerprint_add (fingerprint, (guint) node->height);
+  fingerprint = fingerprint_add (fingerprint, (guint) node->min_width);
+  fingerprint = fingerprint_add (fingerprint, (guint) node->min_height);
+  fingerprint = fingerprint_add (fingerprint, (guint) node->max_width);
+  fingerprint = fingerprint_add (fingerprint, (guint) node->max_height);
+
+  node->geometry_fingerprint = fingerprint;
+  node->geometry_fingerprint_computed = TRUE;
+
+  return fingerprint;
+}
+
+/**
+ * _st_theme_node_get_paint_fingerprint:
+ * @node: a #StThemeNode
+ *
+ * Gets a fingerprint of everything st_theme_node_paint_equal() compares:
+ * nodes that paint equal always have the same fingerprint, so it can be
+ * used as a hash to share paint resources between them.
+ *
+ * Returns: the paint fingerprint of @node
+ */
+guint64
+_st_theme_node_get_paint_fingerprint (StThemeNode *node)
+{
+  const StThemeNodeBackground *background;
+  StBorderImage *border_image;
+  guint64 fingerprint;
+  int i;
+
+  if (node->paint_fingerprint_computed)
+    return node->paint_fingerprint;
+
+  background = _st_theme_node_get_background (node);
+
+  fingerprint = fingerprint_add_color (0, &node->background_color);
+  fingerprint = fingerprint_add (fingerprint, background->gradient_type);
+  if (background->gradient_type != ST_GRADIENT_NONE)
+    fingerprint = fingerprint_add_color (fingerprint, &background->gradient_end);
+
+  if (node->background_image != NULL)
+    {
+      fingerprint = fingerprint_add (fingerprint, g_file_hash (node->background_image));
+      fingerprint = fingerprint_add (fingerprint, background->position_set);
+      if (background->position_set)
+        {
+          fingerprint = fingerprint_add (fingerprint, (guint) background->position_x);
+          fingerprint = fingerprint_add (fingerprint, (guint) background->position_y);
+        }
+      fingerprint = fingerprint_add (fingerprint, background->size);
+      if (background->size == ST_BACKGROUND_SIZE_FIXED)
+        {
+          fingerprint = fingerprint_add (fingerprint, (guint) background->size_w);
+          fingerprint = fingerprint_add (fingerprint, (guint) background->size_h);
+        }
+      fingerprint = fingerprint_add (fingerprint, background->repeat);
+    }
+  else
+    {
+      fingerprint = fingerprint_add (fingerprint, 0);
+    }
+
+  _st_theme_node_ensure_geometry (node);
+
+  for (i = 0; i < 4; i++)
+    {
+      fingerprint = fingerprint_add (fingerprint, node->border_width[i]);
+      if (node->border_width[i] > 0)
+        fingerprint = fingerprint_add_color (fingerprint, &node->border_color[i]);
+
+      fingerprint = fingerprint_add (fingerprint, node->border_radius[i]);
+    }
+
+  fingerprint = fingerprint_add (fingerprint, node->outline_width);
+  if (node->outline_width > 0)
+    fingerprint = fingerprint_add_color (fingerprint, &node->outline_color);
+
+  border_image = st_theme_node_get_border_image (node);
+  if (border_image != NULL)
+    {
+      int borders[4];
+
+      st_border_image_get_borders (border_image,
+                                   &borders[ST_SIDE_TOP], &borders[ST_SIDE_RIGHT],
+                                   &borders[ST_SIDE_BOTTOM], &borders[ST_SIDE_LEFT]);
+
+      fingerprint = fingerprint_add (fingerprint,
+                                     g_file_hash (st_border_image_get_file (border_image)));
+      for (i = 0; i < 4; i++)
+        fingerprint = fingerprint_add (fingerprint, (guint) borders[i]);
+    }
+  else
+    {
+      fingerprint = fingerprint_add (fingerprint, 0);
+    }
+
+  fingerprint = fingerprint_add_shadow (fingerprint, st_theme_node_get_box_shadow (node));
+  fingerprint = fingerprint_add_shadow (fingerprint, st_theme_node_get_background_image_shadow (node));
+
+  node->paint_fingerprint = fingerprint;
+  node->paint_fingerprint_computed = TRUE;
+
+  return fingerprint;
+}
+
+static gboolean
+background_layout_equal (const StThemeNodeBackground *background,
+                         const StThemeNodeBackground *other)
+{
+  if (background->position_set != other->position_set ||
+      background->size != other->size ||
+      background->repeat != other->repeat)
+    return FALSE;
+
+  if (background->position_set &&
+      (background->position_x != other->position_x ||
+       background->position_y != other->position_y))
+    return FALSE;
+
+  if (background->size == ST_BACKGROUND_SIZE_FIXED &&
+      (background->size_w != other->size_w ||
+       background->size_h != other->size_h))
+    return FALSE;
+
+  return TRUE;
+}
+
 /**
  * st_theme_node_geometry_equal:
  * @node: a #StThemeNode
@@ -4166,11 +4640,15 @@ st_theme_node_geometry_equal (StThemeNode *node,
 
   g_return_val_if_fail (ST_IS_THEME_NODE (other), FALSE);
 
-  if (node->cached_scale_factor != other->cached_scale_factor)
+  /* Different fingerprints always mean different geometry; equal ones
+   * most likely mean equal geometry, but that needs checking
+   */
+  if (_st_theme_node_get_geometry_fingerprint (node) !=
+      _st_theme_node_get_geometry_fingerprint (other))
     return FALSE;
 
-  _st_theme_node_ensure_geometry (node);
-  _st_theme_node_ensure_geometry (other);
+  if (node->cached_scale_factor != other->cached_scale_factor)
+    return FALSE;
 
   for (side = ST_SIDE_TOP; side <= ST_SIDE_LEFT; side++)
     {
@@ -4217,26 +4695,30 @@ st_theme_node_paint_equal (StThemeNode *node,
   if (node == other)
     return TRUE;
 
-  _st_theme_node_ensure_background (node);
-  _st_theme_node_ensure_background (other);
+  /* As for geometry, only matching fingerprints need a closer look */
+  if (_st_theme_node_get_paint_fingerprint (node) !=
+      _st_theme_node_get_paint_fingerprint (other))
+    return FALSE;
 
   if (!clutter_color_equal (&node->background_color, &other->background_color))
     return FALSE;
 
-  if (node->background_gradient_type != other->background_gradient_type)
+  if (_st_theme_node_get_background (node)->gradient_type !=
+      _st_theme_node_get_background (other)->gradient_type)
     return FALSE;
 
-  if (node->background_gradient_type != ST_GRADIENT_NONE &&
-      !clutter_color_equal (&node->background_gradient_end, &other->background_gradient_end))
+  if (node->background != NULL && node->background->gradient_type != ST_GRADIENT_NONE &&
+      !clutter_color_equal (&node->background->gradient_end, &other->background->gradient_end))
     return FALSE;
 
-  if ((node->background_image != NULL) &&
-      (other->background_image != NULL) &&
-      !g_file_equal (node->background_image, other->background_image))
+  if ((node->background_image == NULL) != (other->background_image == NULL))
     return FALSE;
 
-  _st_theme_node_ensure_geometry (node);
-  _st_theme_node_ensure_geometry (other);
+  if (node->background_image != NULL &&
+      (!g_file_equal (node->background_image, other->background_image) ||
+       !background_layout_equal (_st_theme_node_get_background (node),
+                                 _st_theme_node_get_background (other))))
+    return FALSE;
 
   for (i = 0; i < 4; i++)
     {
@@ -34,7 +34,7 @@ GFile *_st_theme_resolve_url (StTheme      *theme,
                               CRStyleSheet *base_stylesheet,
                               const char   *url);
 
-CRDeclaration *_st_theme_parse_declaration_list (const char *str);
+CRDeclaration *_st_theme_lookup_declaration_list (const char *str);
 
 G_END_DECLS
 
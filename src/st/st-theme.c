@@ -212,11 +212,80 @@ parse_stylesheet (GFile   *file,
   return stylesheet;
 }
 
+/* Parsed inline styles, most recently used first */
+#define N_CACHED_DECLARATION_LISTS 64
+
+typedef struct {
+  char *str;
+  CRDeclaration *declarations;
+  GList link;
+} CachedDeclarationList;
+
+static GHashTable *declaration_lists;
+static GQueue declaration_lists_lru = G_QUEUE_INIT;
+
+static void
+cached_declaration_list_free (CachedDeclarationList *list)
+{
+  if (list->declarations)
+    cr_declaration_unref (list->declarations);
+  g_free (list->str);
+  g_free (list);
+}
+
+/*
+ * _st_theme_lookup_declaration_list:
+ * @str: a CSS declaration list, as found in inline styles
+ *
+ * Parses @str, reusing the result of recent calls for the same string,
+ * as widgets often share their inline style, or switch back and forth
+ * between a few of them.
+ *
+ * Returns: (transfer full) (nullable): the declarations, to be released
+ *   with cr_declaration_unref(), or %NULL if @str didn't parse
+ */
 CRDeclaration *
-_st_theme_parse_declaration_list (const char *str)
+_st_theme_lookup_declaration_list (const char *str)
 {
-  return cr_declaration_parse_list_from_buf ((const guchar *)str,
-                                             CR_UTF_8);
+  CachedDeclarationList *list;
+
+  if (declaration_lists == NULL)
+    declaration_lists = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                               (GDestroyNotify) cached_declaration_list_free);
+
+  list = g_hash_table_lookup (declaration_lists, str);
+  if (list != NULL)
+    {
+      g_queue_unlink (&declaration_lists_lru, &list->link);
+    }
+  else
+    {
+      list = g_new0 (CachedDeclarationList, 1);
+      list->str = g_strdup (str);
+      list->declarations =
+        cr_declaration_parse_list_from_buf ((const guchar *)str, CR_UTF_8);
+      list->link.data = list;
+
+      if (list->declarations)
+        cr_declaration_ref (list->declarations);
+
+      g_hash_table_insert (declaration_lists, list->str, list);
+
+      if (declaration_lists_lru.length == N_CACHED_DECLARATION_LISTS)
+        {
+          GList *oldest = g_queue_pop_tail_link (&declaration_lists_lru);
+          CachedDeclarationList *oldest_list = oldest->data;
+
+          g_hash_table_remove (declaration_lists, oldest_list->str);
+        }
+    }
+
+  g_queue_push_head_link (&declaration_lists_lru, &list->link);
+
+  if (list->declarations)
+    cr_declaration_ref (list->declarations);
+
+  return list->declarations;
 }
 
 /* Just g_warning for now until we have something nicer to do */
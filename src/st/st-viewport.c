@@ -72,6 +72,10 @@ typedef struct
   StAdjustment *hadjustment;
   StAdjustment *vadjustment;
   gboolean clip_to_view;
+
+  /* Set by the scroll view while it paints part of its content */
+  gboolean has_paint_region;
+  ClutterActorBox paint_region;
 } StViewportPrivate;
 
 G_DEFINE_TYPE_WITH_CODE (StViewport, st_viewport, ST_TYPE_WIDGET,
@@ -188,6 +192,18 @@ st_viewport_set_clip_to_view (StViewport *viewport,
     }
 }
 
+void
+_st_viewport_set_paint_region (StViewport            *viewport,
+                               const ClutterActorBox *region)
+{
+  StViewportPrivate *priv =
+    st_viewport_get_instance_private (viewport);
+
+  priv->has_paint_region = region != NULL;
+  if (region != NULL)
+    priv->paint_region = *region;
+}
+
 static void
 st_viewport_get_property (GObject    *object,
                           guint       property_id,
@@ -380,6 +396,39 @@ st_viewport_apply_transform (ClutterActor      *actor,
   parent_class->apply_transform (actor, matrix);
 }
 
+/* Whether @child may paint inside @region, in the coordinates of the
+ * scrolled content. Transformed children are painted regardless.
+ */
+static gboolean
+child_in_paint_region (ClutterActor          *child,
+                       const ClutterActorBox *region)
+{
+  const ClutterPaintVolume *volume;
+  graphene_point3d_t origin;
+  ClutterActorBox allocation;
+  float translation_x, translation_y;
+  float x, y;
+
+  if (clutter_actor_is_scaled (child) || clutter_actor_is_rotated (child))
+    return TRUE;
+
+  volume = clutter_actor_get_paint_volume (child);
+  if (volume == NULL)
+    return TRUE;
+
+  clutter_actor_get_allocation_box (child, &allocation);
+  clutter_actor_get_translation (child, &translation_x, &translation_y, NULL);
+  clutter_paint_volume_get_origin (volume, &origin);
+
+  x = allocation.x1 + translation_x + origin.x;
+  y = allocation.y1 + translation_y + origin.y;
+
+  return x < region->x2 &&
+         y < region->y2 &&
+         x + clutter_paint_volume_get_width (volume) > region->x1 &&
+         y + clutter_paint_volume_get_height (volume) > region->y1;
+}
+
 /* If we are translated, then we need to translate back before chaining
  * up or the background and borders will be drawn in the wrong place */
 static void
@@ -411,6 +460,7 @@ st_viewport_paint (ClutterActor        *actor,
   int x, y;
   ClutterActorBox allocation_box;
   ClutterActorBox content_box;
+  ClutterActorBox paint_region;
   ClutterActor *child;
   CoglFramebuffer *fb = clutter_paint_context_get_framebuffer (paint_context);
 
@@ -449,10 +499,25 @@ st_viewport_paint (ClutterActor        *actor,
                                             (int)content_box.y2);
     }
 
+  if (priv->has_paint_region)
+    {
+      paint_region = priv->paint_region;
+      paint_region.x1 += x;
+      paint_region.y1 += y;
+      paint_region.x2 += x;
+      paint_region.y2 += y;
+    }
+
   for (child = clutter_actor_get_first_child (actor);
        child != NULL;
        child = clutter_actor_get_next_sibling (child))
-    clutter_actor_paint (child, paint_context);
+    {
+      if (priv->has_paint_region &&
+          !child_in_paint_region (child, &paint_region))
+        continue;
+
+      clutter_actor_paint (child, paint_context);
+    }
 
   if (priv->clip_to_view && (priv->hadjustment || priv->vadjustment))
     cogl_framebuffer_pop_clip (fb);
@@ -64,6 +64,10 @@ struct _StWidgetPrivate
 
   StThemeNodeTransition *transition_animation;
 
+  /* Where theme_node was found; only valid while it is set */
+  ClutterStage *stage;
+  StThemeContext *theme_context;
+
   guint is_style_dirty : 1;
   guint first_child_dirty : 1;
   guint last_child_dirty : 1;
@@ -74,6 +78,7 @@ struct _StWidgetPrivate
   guint can_focus : 1;
 
   gulong texture_file_changed_id;
+  gulong texture_file_loaded_id;
   guint update_child_styles_id;
 
   AtkObject *accessible;
@@ -313,6 +318,26 @@ st_widget_texture_cache_changed (StTextureCache *cache,
     clutter_actor_queue_redraw (CLUTTER_ACTOR (actor));
 }
 
+static void
+st_widget_texture_file_loaded (StTextureCache *cache,
+                               GFile          *file,
+                               gpointer        user_data)
+{
+  StWidget *actor = ST_WIDGET (user_data);
+  StWidgetPrivate *priv = st_widget_get_instance_private (actor);
+  gboolean changed = FALSE;
+  int i;
+
+  for (i = 0; i < G_N_ELEMENTS (priv->paint_states); i++)
+    {
+      StThemeNodePaintState *paint_state = &priv->paint_states[i];
+      changed |= _st_theme_node_paint_state_invalidate_for_loaded_file (paint_state, file);
+    }
+
+  if (changed && clutter_actor_is_mapped (CLUTTER_ACTOR (actor)))
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (actor));
+}
+
 static void
 st_widget_dispose (GObject *gobject)
 {
@@ -320,6 +345,8 @@ st_widget_dispose (GObject *gobject)
   StWidgetPrivate *priv = st_widget_get_instance_private (actor);
 
   g_clear_pointer (&priv->theme_node, g_object_unref);
+  priv->stage = NULL;
+  priv->theme_context = NULL;
 
   st_widget_remove_transition (actor);
 
@@ -327,6 +354,8 @@ st_widget_dispose (GObject *gobject)
 
   g_clear_signal_handler (&priv->texture_file_changed_id,
                           st_texture_cache_get_default ());
+  g_clear_signal_handler (&priv->texture_file_loaded_id,
+                          st_texture_cache_get_default ());
 
   g_clear_object (&priv->first_visible_child);
   g_clear_object (&priv->last_visible_child);
@@ -533,6 +562,8 @@ st_widget_style_changed (StWidget *widget)
     {
       old_theme_node = priv->theme_node;
       priv->theme_node = NULL;
+      priv->stage = NULL;
+      priv->theme_context = NULL;
     }
 
   /* update the style only if we are mapped */
@@ -598,20 +629,33 @@ st_widget_get_theme_node (StWidget *widget)
 
   if (priv->theme_node == NULL)
     {
-      StThemeContext *context;
-      StThemeNode *tmp_node;
       StThemeNode *parent_node = NULL;
       ClutterStage *stage = NULL;
       ClutterActor *parent;
-      char *pseudo_class, *direction_pseudo_class;
+      StThemeNodeKey key;
 
+      /* The closest widget ancestor already knows the stage from
+       * computing its own theme node, so only walk up to it.
+       */
       parent = clutter_actor_get_parent (CLUTTER_ACTOR (widget));
       while (parent != NULL)
         {
-          if (parent_node == NULL && ST_IS_WIDGET (parent))
-            parent_node = st_widget_get_theme_node (ST_WIDGET (parent));
+          if (ST_IS_WIDGET (parent))
+            {
+              StWidgetPrivate *parent_priv =
+                st_widget_get_instance_private (ST_WIDGET (parent));
+
+              parent_node = st_widget_get_theme_node (ST_WIDGET (parent));
+              stage = parent_priv->stage;
+              priv->theme_context = parent_priv->theme_context;
+              break;
+            }
           else if (CLUTTER_IS_STAGE (parent))
-            stage = CLUTTER_STAGE (parent);
+            {
+              stage = CLUTTER_STAGE (parent);
+              priv->theme_context = st_theme_context_get_for_stage (stage);
+              break;
+            }
 
           parent = clutter_actor_get_parent (parent);
         }
@@ -629,35 +673,27 @@ st_widget_get_theme_node (StWidget *widget)
       if (parent_node == NULL)
         parent_node = get_root_theme_node (CLUTTER_STAGE (stage));
 
+      key = (StThemeNodeKey) {
+        .parent_node = parent_node,
+        .element_type = G_OBJECT_TYPE (widget),
+        .element_id = clutter_actor_get_name (CLUTTER_ACTOR (widget)),
+        .element_class = priv->style_class,
+        .pseudo_class = priv->pseudo_class,
+        .inline_style = priv->inline_style,
+      };
+
       /* Always append a "magic" pseudo class indicating the text
        * direction, to allow to adapt the CSS when necessary without
        * requiring separate style sheets.
        */
       if (clutter_actor_get_text_direction (CLUTTER_ACTOR (widget)) == CLUTTER_TEXT_DIRECTION_RTL)
-        direction_pseudo_class = (char *)"rtl";
+        key.extra_pseudo_class = "rtl";
       else
-        direction_pseudo_class = (char *)"ltr";
+        key.extra_pseudo_class = "ltr";
 
-      if (priv->pseudo_class)
-        pseudo_class = g_strconcat(priv->pseudo_class, " ",
-                                   direction_pseudo_class, NULL);
-      else
-        pseudo_class = direction_pseudo_class;
-
-      context = st_theme_context_get_for_stage (stage);
-      tmp_node = st_theme_node_new (context, parent_node, NULL,
-                                    G_OBJECT_TYPE (widget),
-                                    clutter_actor_get_name (CLUTTER_ACTOR (widget)),
-                                    priv->style_class,
-                                    pseudo_class,
-                                    priv->inline_style);
-
-      if (pseudo_class != direction_pseudo_class)
-        g_free (pseudo_class);
-
-      priv->theme_node = g_object_ref (st_theme_context_intern_node (context,
-                                                                     tmp_node));
-      g_object_unref (tmp_node);
+      priv->stage = stage;
+      priv->theme_node =
+        g_object_ref (_st_theme_context_lookup_node (priv->theme_context, &key));
     }
 
   return priv->theme_node;
@@ -1665,6 +1701,8 @@ st_widget_init (StWidget *actor)
   g_signal_connect (actor, "notify::last-child", G_CALLBACK (st_widget_last_child_notify), NULL);
   priv->texture_file_changed_id = g_signal_connect (st_texture_cache_get_default (), "texture-file-changed",
                                                     G_CALLBACK (st_widget_texture_cache_changed), actor);
+  priv->texture_file_loaded_id = g_signal_connect (st_texture_cache_get_default (), "texture-file-loaded",
+                                                   G_CALLBACK (st_widget_texture_file_loaded), actor);
 
   for (i = 0; i < G_N_ELEMENTS (priv->paint_states); i++)
     st_theme_node_paint_state_init (&priv->paint_states[i]);
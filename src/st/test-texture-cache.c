@@ -0,0 +1,491 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * test-texture-cache.c: test program for the texture cache
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 2.1 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <clutter/clutter.h>
+#include "st-private.h"
+#include "st-sliced-image.h"
+#include "st-texture-cache.h"
+#include <meta-test/meta-context-test.h>
+
+static gboolean fail;
+
+static const char *test;
+
+#define TIMEOUT_US (10 * G_USEC_PER_SEC)
+
+static gboolean
+wait_for (int      *value,
+          int       expected,
+          gboolean  at_most)
+{
+  gint64 deadline = g_get_monotonic_time () + TIMEOUT_US;
+
+  while (at_most ? *value > expected : *value < expected)
+    {
+      if (g_get_monotonic_time () > deadline)
+        return FALSE;
+
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+
+  return TRUE;
+}
+
+static GdkPixbuf *
+new_solid_pixbuf (int     width,
+                  int     height,
+                  guint32 color)
+{
+  GdkPixbuf *pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, width, height);
+
+  gdk_pixbuf_fill (pixbuf, color);
+
+  return pixbuf;
+}
+
+static GFile *
+new_image_file (void)
+{
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GFileIOStream) stream = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *path = NULL;
+  GFile *file;
+
+  file = g_file_new_tmp ("test-texture-cache-XXXXXX.png", &stream, &error);
+  if (file == NULL)
+    g_error ("Failed to create image file: %s", error->message);
+
+  pixbuf = new_solid_pixbuf (16, 16, 0x336699ff);
+  path = g_file_get_path (file);
+  if (!gdk_pixbuf_save (pixbuf, path, "png", &error, NULL))
+    g_error ("Failed to save image file: %s", error->message);
+
+  return file;
+}
+
+static void
+test_sliced_image_padding (void)
+{
+  g_autoptr (GdkPixbuf) pixbuf = NULL;
+  g_autoptr (GdkPixbuf) blue = NULL;
+  g_autoptr (StSlicedImage) image = NULL;
+  g_autofree guint8 *data = NULL;
+  CoglTexture *frames[2];
+  CoglTexture *parent;
+  int width, height, x, y;
+
+  test = "sliced_image_padding";
+
+  /* Two 4×4 frames side by side, a red and a blue one */
+  pixbuf = new_solid_pixbuf (8, 4, 0xff0000ff);
+  blue = new_solid_pixbuf (4, 4, 0x0000ffff);
+  gdk_pixbuf_copy_area (blue, 0, 0, 4, 4, pixbuf, 4, 0);
+
+  image = st_sliced_image_new (pixbuf, 4, 4, 1.0);
+  frames[0] = st_sliced_image_get_frame_texture (image, 0);
+  frames[1] = st_sliced_image_get_frame_texture (image, 1);
+
+  if (frames[0] == NULL || frames[1] == NULL)
+    {
+      g_print ("%s: frames weren't uploaded\n", test);
+      fail = TRUE;
+      return;
+    }
+
+  if (cogl_texture_get_width (frames[0]) != 4 ||
+      cogl_texture_get_height (frames[0]) != 4)
+    {
+      g_print ("%s: expected a 4×4 frame, got %d×%d\n", test,
+               cogl_texture_get_width (frames[0]),
+               cogl_texture_get_height (frames[0]));
+      fail = TRUE;
+    }
+
+  parent = cogl_sub_texture_get_parent (COGL_SUB_TEXTURE (frames[0]));
+  width = cogl_texture_get_width (parent);
+  height = cogl_texture_get_height (parent);
+
+  if (width != 12 || height != 6)
+    {
+      g_print ("%s: expected a 12×6 texture, got %d×%d\n", test, width, height);
+      fail = TRUE;
+      return;
+    }
+
+  /* Each frame is surrounded by its own edges, so the pixels next to
+   * it never have the color of the other frame
+   */
+  data = g_malloc (width * height * 4);
+  cogl_texture_get_data (parent, COGL_PIXEL_FORMAT_RGBA_8888, width * 4, data);
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          const guint8 *pixel = data + y * width * 4 + x * 4;
+          gboolean red = x < 6;
+
+          if (pixel[0] != (red ? 0xff : 0) || pixel[2] != (red ? 0 : 0xff))
+            {
+              g_print ("%s: pixel %d,%d is #%02x%02x%02x, part of the %s frame\n",
+                       test, x, y, pixel[0], pixel[1], pixel[2],
+                       red ? "red" : "blue");
+              fail = TRUE;
+              return;
+            }
+        }
+    }
+}
+
+static void
+on_loaded (gpointer cache,
+           gpointer user_data)
+{
+  int *n_loaded = user_data;
+
+  (*n_loaded)++;
+}
+
+/* As MAX_CACHED_SLICED_IMAGES in st-texture-cache.c */
+#define MAX_CACHED_SLICED_IMAGES 8
+
+static void
+test_sliced_image_cache_bound (GFile *file)
+{
+  StTextureCache *cache;
+  int n_loaded = 0;
+  int i;
+
+  test = "sliced_image_cache_bound";
+
+  cache = g_object_new (ST_TYPE_TEXTURE_CACHE, NULL);
+
+  /* Every grid size is decoded separately, and stays cached after
+   * its actor is gone
+   */
+  for (i = 1; i <= MAX_CACHED_SLICED_IMAGES + 4; i++)
+    {
+      ClutterActor *actor;
+
+      actor = st_texture_cache_load_sliced_image (cache, file, i, i, 1, 1.0,
+                                                  on_loaded, &n_loaded);
+      g_object_ref_sink (actor);
+
+      if (!wait_for (&n_loaded, i, FALSE))
+        {
+          g_print ("%s: %dpx frames weren't loaded\n", test, i);
+          fail = TRUE;
+        }
+
+      clutter_actor_destroy (actor);
+      g_object_unref (actor);
+    }
+
+  if (_st_texture_cache_get_n_sliced_images (cache) > MAX_CACHED_SLICED_IMAGES)
+    {
+      g_print ("%s: %d sliced images are cached, expected at most %d\n",
+               test, _st_texture_cache_get_n_sliced_images (cache),
+               MAX_CACHED_SLICED_IMAGES);
+      fail = TRUE;
+    }
+
+  g_object_unref (cache);
+}
+
+static void
+on_file_signal (StTextureCache *cache,
+                GFile          *file,
+                gpointer        user_data)
+{
+  int *n_emissions = user_data;
+
+  (*n_emissions)++;
+}
+
+static void
+test_file_to_cogl_texture (GFile *file)
+{
+  StTextureCache *cache;
+  CoglTexture *texture;
+  int n_loaded = 0;
+  int n_changed = 0;
+
+  test = "file_to_cogl_texture";
+
+  cache = g_object_new (ST_TYPE_TEXTURE_CACHE, NULL);
+  g_signal_connect (cache, "texture-file-loaded",
+                    G_CALLBACK (on_file_signal), &n_loaded);
+  g_signal_connect (cache, "texture-file-changed",
+                    G_CALLBACK (on_file_signal), &n_changed);
+
+  /* The first lookup only starts loading the image */
+  texture = st_texture_cache_load_file_to_cogl_texture (cache, file, 8, 4, 1, 1.0);
+  if (texture != NULL)
+    {
+      g_print ("%s: image was loaded synchronously\n", test);
+      fail = TRUE;
+      cogl_object_unref (texture);
+    }
+
+  if (!wait_for (&n_loaded, 1, FALSE))
+    {
+      g_print ("%s: image wasn't reported as loaded\n", test);
+      fail = TRUE;
+    }
+
+  if (n_changed != 0)
+    {
+      g_print ("%s: loading the image was reported as a file change\n", test);
+      fail = TRUE;
+    }
+
+  /* Decoded at the smallest size covering 8×4 */
+  texture = st_texture_cache_load_file_to_cogl_texture (cache, file, 8, 4, 1, 1.0);
+  if (texture == NULL)
+    {
+      g_print ("%s: loaded image wasn't cached\n", test);
+      fail = TRUE;
+    }
+  else
+    {
+      if (cogl_texture_get_width (texture) != 8 ||
+          cogl_texture_get_height (texture) != 8)
+        {
+          g_print ("%s: expected an 8×8 texture, got %d×%d\n", test,
+                   cogl_texture_get_width (texture),
+                   cogl_texture_get_height (texture));
+          fail = TRUE;
+        }
+
+      cogl_object_unref (texture);
+    }
+
+  g_object_unref (cache);
+}
+
+/* As PREWARM_BUDGET in st-texture-cache.c */
+#define PREWARM_BUDGET (16 * 1024 * 1024)
+
+#define PREWARM_ICON_SIZE 512
+
+static gboolean
+wait_for_prewarm (StTextureCache *cache)
+{
+  gint64 deadline = g_get_monotonic_time () + TIMEOUT_US;
+
+  while (_st_texture_cache_is_prewarming (cache))
+    {
+      if (_st_texture_cache_get_prewarm_size (cache) > PREWARM_BUDGET)
+        return FALSE;
+
+      if (g_get_monotonic_time () > deadline)
+        return FALSE;
+
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+
+  return _st_texture_cache_get_prewarm_size (cache) <= PREWARM_BUDGET;
+}
+
+/* Whether @icon is cached at @resource_scale, as loading it sets the
+ * content of the actor right away then */
+static gboolean
+is_icon_cached (StTextureCache *cache,
+                GIcon          *icon,
+                float           resource_scale)
+{
+  ClutterActor *actor;
+  gboolean cached;
+
+  actor = st_texture_cache_load_gicon (cache, NULL, icon,
+                                       PREWARM_ICON_SIZE, 1, resource_scale);
+  g_object_ref_sink (actor);
+  cached = clutter_actor_get_content (actor) != NULL;
+  clutter_actor_destroy (actor);
+  g_object_unref (actor);
+
+  return cached;
+}
+
+static void
+test_icon_prewarm (void)
+{
+  /* Icons that fit in the budget at scale 2, less than there are */
+  const int n_prewarmable = PREWARM_BUDGET / (PREWARM_ICON_SIZE * PREWARM_ICON_SIZE * 4 * 4);
+  const int n_icons = n_prewarmable + 2;
+  g_autoptr (GPtrArray) files = NULL;
+  g_autoptr (GPtrArray) icons = NULL;
+  StTextureCache *cache;
+  GIcon *latest;
+  int n_cached = 0;
+  int i;
+
+  test = "icon_prewarm";
+
+  cache = g_object_new (ST_TYPE_TEXTURE_CACHE, NULL);
+  files = g_ptr_array_new_with_free_func (g_object_unref);
+  icons = g_ptr_array_new_with_free_func (g_object_unref);
+
+  for (i = 0; i < n_icons + 2; i++)
+    {
+      GFile *file = new_image_file ();
+
+      g_ptr_array_add (files, file);
+      g_ptr_array_add (icons, g_file_icon_new (file));
+    }
+
+  /* Icons loaded at scale 1 are remembered... */
+  for (i = 0; i < n_icons; i++)
+    is_icon_cached (cache, icons->pdata[i], 1.0);
+
+  /* ...and prewarmed once scale 2 is used, within the budget */
+  is_icon_cached (cache, icons->pdata[n_icons], 2.0);
+
+  if (!wait_for_prewarm (cache))
+    {
+      g_print ("%s: prewarming took %" G_GSIZE_FORMAT " bytes, more than the budget\n",
+               test, _st_texture_cache_get_prewarm_size (cache));
+      fail = TRUE;
+    }
+
+  /* Icons prewarmed longest ago make room for new ones, so prewarming
+   * goes on once the budget was used up */
+  latest = icons->pdata[n_icons + 1];
+  is_icon_cached (cache, latest, 1.0);
+
+  if (!wait_for_prewarm (cache))
+    {
+      g_print ("%s: prewarming took %" G_GSIZE_FORMAT " bytes, more than the budget\n",
+               test, _st_texture_cache_get_prewarm_size (cache));
+      fail = TRUE;
+    }
+
+  if (!is_icon_cached (cache, latest, 2.0))
+    {
+      g_print ("%s: icon wasn't prewarmed once the budget was used up\n", test);
+      fail = TRUE;
+    }
+
+  for (i = 0; i < n_icons; i++)
+    {
+      if (is_icon_cached (cache, icons->pdata[i], 2.0))
+        n_cached++;
+    }
+
+  if (n_cached == 0 || n_cached >= n_prewarmable)
+    {
+      g_print ("%s: %d remembered icons were prewarmed, expected between 1 and %d\n",
+               test, n_cached, n_prewarmable - 1);
+      fail = TRUE;
+    }
+
+  g_object_unref (cache);
+
+  for (i = 0; i < (int) files->len; i++)
+    g_file_delete (files->pdata[i], NULL, NULL);
+}
+
+static void
+on_actor_finalized (gpointer  data,
+                    GObject  *actor)
+{
+  int *n_actors = data;
+
+  (*n_actors)--;
+}
+
+static void
+test_sliced_image_dispose (GFile *file)
+{
+  StTextureCache *cache;
+  int n_loaded = 0;
+  int n_actors = 0;
+  int i;
+
+  test = "sliced_image_dispose";
+
+  cache = g_object_new (ST_TYPE_TEXTURE_CACHE, NULL);
+
+  /* The second load waits for the image decoded for the first one */
+  for (i = 0; i < 2; i++)
+    {
+      ClutterActor *actor;
+
+      actor = st_texture_cache_load_sliced_image (cache, file, 16, 16, 1, 1.0,
+                                                  on_loaded, &n_loaded);
+      g_object_ref_sink (actor);
+      g_object_weak_ref (G_OBJECT (actor), on_actor_finalized, &n_actors);
+      n_actors++;
+
+      /* Only the load holds on to the actor from now on */
+      g_object_unref (actor);
+    }
+
+  g_object_run_dispose (G_OBJECT (cache));
+
+  /* Both loads complete once decoding stops, without images */
+  if (!wait_for (&n_actors, 0, TRUE))
+    {
+      g_print ("%s: %d loads didn't complete after dispose\n", test, n_actors);
+      fail = TRUE;
+    }
+
+  if (n_loaded != 0)
+    {
+      g_print ("%s: %d loads were reported after dispose\n", test, n_loaded);
+      fail = TRUE;
+    }
+
+  g_object_unref (cache);
+}
+
+int
+main (int argc, char **argv)
+{
+  MetaContext *context;
+  g_autoptr (GError) error = NULL;
+  g_autoptr (GFile) file = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_NESTED,
+                                      META_CONTEXT_TEST_FLAG_NONE);
+  if (!meta_context_configure (context, &argc, &argv, &error))
+    g_error ("Failed to configure: %s", error->message);
+
+  if (!meta_context_setup (context, &error))
+    g_error ("Failed to setup: %s", error->message);
+
+  /* Loads must complete cleanly, also when cancelled */
+  g_log_set_always_fatal (G_LOG_LEVEL_CRITICAL | G_LOG_LEVEL_WARNING);
+
+  file = new_image_file ();
+
+  test_sliced_image_padding ();
+  test_sliced_image_cache_bound (file);
+  test_sliced_image_dispose (file);
+  test_file_to_cogl_texture (file);
+  test_icon_prewarm ();
+
+  g_file_delete (file, NULL, NULL);
+
+  g_object_unref (context);
+
+  return fail ? 1 : 0;
+}
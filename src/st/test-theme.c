@@ -21,8 +21,10 @@
 #include <clutter/clutter.h>
 #include "st-theme.h"
 #include "st-theme-context.h"
+#include "st-theme-node-private.h"
 #include "st-label.h"
 #include "st-button.h"
+#include "st-texture-cache.h"
 #include <math.h>
 #include <string.h>
 #include <meta-test/meta-context-test.h>
@@ -535,6 +537,560 @@ test_inline_style (void)
                  st_theme_node_get_padding (text3, ST_SIDE_BOTTOM));
 }
 
+static void
+test_interned_nodes (void)
+{
+  StThemeContext *theme_context;
+  StWidget *label1, *label2;
+  StThemeNode *node, *expected;
+  const char *direction;
+
+  test = "interned_nodes";
+  theme_context = st_theme_context_get_for_stage (CLUTTER_STAGE (stage));
+
+  label1 = st_label_new ("foo");
+  st_widget_set_style_class_name (label1, " special-text\textra ");
+  st_widget_set_style_pseudo_class (label1, "visited");
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (label1));
+
+  label2 = st_label_new ("bar");
+  st_widget_set_style_class_name (label2, "special-text extra");
+  st_widget_set_style_pseudo_class (label2, "visited");
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (label2));
+
+  if (clutter_actor_get_text_direction (CLUTTER_ACTOR (label1)) == CLUTTER_TEXT_DIRECTION_RTL)
+    direction = "visited rtl";
+  else
+    direction = "visited ltr";
+
+  /* Widgets that style the same share their node, and that node is the
+   * one interning an equal node created by hand returns
+   */
+  node = st_widget_get_theme_node (label1);
+  if (node != st_widget_get_theme_node (label2))
+    {
+      g_print ("%s: labels with the same style don't share their node\n", test);
+      fail = TRUE;
+    }
+
+  expected = st_theme_node_new (theme_context, root, NULL,
+                                ST_TYPE_LABEL, NULL, "special-text extra",
+                                direction, NULL);
+  if (st_theme_node_hash (expected) != st_theme_node_hash (node) ||
+      st_theme_context_intern_node (theme_context, expected) != node)
+    {
+      g_print ("%s: widget node doesn't match the equivalent node\n", test);
+      fail = TRUE;
+    }
+  g_object_unref (expected);
+
+  st_widget_set_style_pseudo_class (label2, "hover");
+  if (st_widget_get_theme_node (label2) == node)
+    {
+      g_print ("%s: labels with different styles share their node\n", test);
+      fail = TRUE;
+    }
+
+  clutter_actor_destroy (CLUTTER_ACTOR (label1));
+  clutter_actor_destroy (CLUTTER_ACTOR (label2));
+}
+
+/* sizeof (StThemeNode) on 64-bit before properties and paint resources
+ * were split off into groups allocated on demand
+ */
+#define BASELINE_NODE_SIZE 512
+
+static void
+test_node_size (void)
+{
+  StThemeContext *theme_context;
+  StThemeNode *gradient;
+  StGradientType type;
+  ClutterColor start, end;
+
+  test = "node_size";
+  theme_context = st_theme_context_get_for_stage (CLUTTER_STAGE (stage));
+
+  g_print ("%s: %" G_GSIZE_FORMAT " bytes per node, down from %d, plus %"
+           G_GSIZE_FORMAT " for uncommon background properties and %"
+           G_GSIZE_FORMAT " once painted\n",
+           test, sizeof (StThemeNode), BASELINE_NODE_SIZE,
+           sizeof (StThemeNodeBackground), sizeof (StThemeNodePaintData));
+
+  if (GLIB_SIZEOF_VOID_P == 8 && sizeof (StThemeNode) >= BASELINE_NODE_SIZE)
+    {
+      g_print ("%s: nodes aren't smaller than the baseline\n", test);
+      fail = TRUE;
+    }
+
+  /* Nodes only pay for the groups of properties they set */
+  assert_background_color (group1, "group1", 0xff0000ff);
+  if (group1->background != NULL || group1->paint_data != NULL)
+    {
+      g_print ("%s: group1 allocated properties it doesn't use\n", test);
+      fail = TRUE;
+    }
+
+  gradient = st_theme_node_new (theme_context, root, NULL,
+                                CLUTTER_TYPE_ACTOR, NULL, NULL, NULL,
+                                "background-gradient-direction: vertical;"
+                                "background-gradient-start: #ff0000;"
+                                "background-gradient-end: #0000ff;");
+  st_theme_node_get_background_gradient (gradient, &type, &start, &end);
+  if (type != ST_GRADIENT_VERTICAL || clutter_color_to_pixel (&end) != 0x0000ffff)
+    {
+      g_print ("%s: gradient properties weren't stored\n", test);
+      fail = TRUE;
+    }
+  g_object_unref (gradient);
+}
+
+static StThemeNode *
+new_styled_node (const char *style)
+{
+  StThemeContext *theme_context;
+
+  theme_context = st_theme_context_get_for_stage (CLUTTER_STAGE (stage));
+
+  return st_theme_node_new (theme_context, root, NULL,
+                            CLUTTER_TYPE_ACTOR, NULL, NULL, NULL, style);
+}
+
+static void
+test_node_equality (void)
+{
+  StThemeNode *node, *same, *recolored, *resized;
+
+  test = "node_equality";
+
+  node = new_styled_node ("padding: 4px; border: 2px solid #ff0000; box-shadow: 0 1px 2px #000000;");
+  same = new_styled_node ("padding: 4px; border: 2px solid #ff0000; box-shadow: 0 1px 2px #000000;");
+  recolored = new_styled_node ("padding: 4px; border: 2px solid #00ff00; box-shadow: 0 1px 2px #000000;");
+  resized = new_styled_node ("padding: 5px; border: 2px solid #ff0000; box-shadow: 0 1px 2px #000000;");
+
+  if (!st_theme_node_geometry_equal (node, same) ||
+      !st_theme_node_paint_equal (node, same) ||
+      _st_theme_node_get_paint_fingerprint (node) != _st_theme_node_get_paint_fingerprint (same))
+    {
+      g_print ("%s: identically styled nodes aren't equal\n", test);
+      fail = TRUE;
+    }
+
+  if (!st_theme_node_geometry_equal (node, recolored) ||
+      st_theme_node_paint_equal (node, recolored))
+    {
+      g_print ("%s: changing the border color isn't only a paint change\n", test);
+      fail = TRUE;
+    }
+
+  if (st_theme_node_geometry_equal (node, resized))
+    {
+      g_print ("%s: changing the padding isn't a geometry change\n", test);
+      fail = TRUE;
+    }
+
+  /* text1 inherits a background image, text2 doesn't */
+  if (st_theme_node_paint_equal (text1, text2))
+    {
+      g_print ("%s: adding a background image isn't a paint change\n", test);
+      fail = TRUE;
+    }
+
+  g_object_unref (node);
+  g_object_unref (same);
+  g_object_unref (recolored);
+  g_object_unref (resized);
+}
+
+static void
+test_shared_paint_state (void)
+{
+  const char *style = "background-gradient-direction: vertical;"
+                      "background-gradient-start: #ff0000;"
+                      "background-gradient-end: #0000ff;"
+                      "border-radius: 4px;";
+  ClutterActorBox box = { 0, 0, 64, 32 };
+  StThemeNodePaintState state1, state2;
+  StThemeNode *node1, *node2;
+  CoglContext *ctx;
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+  GError *error = NULL;
+
+  test = "shared_paint_state";
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, 64, 32));
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    g_error ("Failed to allocate framebuffer: %s", error->message);
+
+  /* Distinct nodes that paint the same at the same size share what
+   * they rendered, gradients being prerendered to a texture
+   */
+  node1 = new_styled_node (style);
+  node2 = new_styled_node (style);
+
+  st_theme_node_paint_state_init (&state1);
+  st_theme_node_paint_state_init (&state2);
+  st_theme_node_paint (node1, &state1, COGL_FRAMEBUFFER (offscreen), &box, 0xff, 1.0);
+  st_theme_node_paint (node2, &state2, COGL_FRAMEBUFFER (offscreen), &box, 0xff, 1.0);
+
+  if (state1.prerendered_texture == NULL ||
+      state1.prerendered_texture != state2.prerendered_texture)
+    {
+      g_print ("%s: equal nodes didn't share their prerendered background\n", test);
+      fail = TRUE;
+    }
+
+  st_theme_node_paint_state_free (&state1);
+  st_theme_node_paint_state_free (&state2);
+
+  /* Shared states don't keep their node alive */
+  g_object_add_weak_pointer (G_OBJECT (node1), (gpointer *) &node1);
+  g_object_unref (node1);
+  if (node1 != NULL)
+    {
+      g_print ("%s: node of a shared paint state wasn't finalized\n", test);
+      fail = TRUE;
+      g_object_remove_weak_pointer (G_OBJECT (node1), (gpointer *) &node1);
+    }
+
+  g_object_unref (node2);
+  g_object_unref (offscreen);
+  cogl_object_unref (texture);
+}
+
+/* Paints a node whose four corners are the same, and releases them */
+static void
+paint_rounded_node (CoglFramebuffer *framebuffer,
+                    guint            color)
+{
+  ClutterActorBox box = { 0, 0, 48, 48 };
+  StThemeNodePaintState state;
+  StThemeNode *node;
+  char *style;
+
+  style = g_strdup_printf ("background-color: #%06x; border-radius: 6px;", color);
+  node = new_styled_node (style);
+
+  st_theme_node_paint_state_init (&state);
+  st_theme_node_paint (node, &state, framebuffer, &box, 0xff, 1.0);
+  st_theme_node_paint_state_free (&state);
+
+  g_object_unref (node);
+  g_free (style);
+}
+
+/* Whether painting a node of the given color found its corner cached */
+static gboolean
+corner_is_cached (CoglFramebuffer *framebuffer,
+                  guint            color)
+{
+  guint hits, misses, old_hits, old_misses, n_corners, n_atlases;
+
+  _st_theme_node_get_corner_cache_stats (&old_hits, &old_misses, &n_corners, &n_atlases);
+  paint_rounded_node (framebuffer, color);
+  _st_theme_node_get_corner_cache_stats (&hits, &misses, &n_corners, &n_atlases);
+
+  return misses == old_misses;
+}
+
+/* As N_UNUSED_CORNERS in st-theme-node-drawing.c */
+#define N_UNUSED_CORNERS 64
+
+/* 6px corners take 16×16 slots, 1024 of which fit in a 512×512 atlas */
+#define N_CORNERS_PER_ATLAS 1024
+
+static void
+test_corner_cache_eviction (CoglFramebuffer *framebuffer)
+{
+  guint hits, misses, n_corners, n_atlases, old_n_atlases, max_n_atlases;
+  guint color;
+
+  _st_theme_node_get_corner_cache_stats (&hits, &misses, &n_corners, &old_n_atlases);
+
+  /* Corners without users are evicted least recently used first */
+  color = 0x010000;
+  paint_rounded_node (framebuffer, color);
+
+  for (color = 0x010001; color < 0x010000 + N_UNUSED_CORNERS; color++)
+    paint_rounded_node (framebuffer, color);
+
+  if (!corner_is_cached (framebuffer, 0x010000))
+    {
+      g_print ("%s: corner was evicted before %d others were used\n",
+               test, N_UNUSED_CORNERS);
+      fail = TRUE;
+    }
+
+  /* Using it again made it the most recently used one */
+  for (; color < 0x010000 + 2 * N_UNUSED_CORNERS - 1; color++)
+    paint_rounded_node (framebuffer, color);
+
+  if (!corner_is_cached (framebuffer, 0x010000))
+    {
+      g_print ("%s: corner that was used again was evicted\n", test);
+      fail = TRUE;
+    }
+
+  if (corner_is_cached (framebuffer, 0x010001))
+    {
+      g_print ("%s: least recently used corner wasn't evicted\n", test);
+      fail = TRUE;
+    }
+
+  _st_theme_node_get_corner_cache_stats (&hits, &misses, &n_corners, &n_atlases);
+  if (n_corners > N_UNUSED_CORNERS)
+    {
+      g_print ("%s: %u unused corners are cached, expected at most %d\n",
+               test, n_corners, N_UNUSED_CORNERS);
+      fail = TRUE;
+    }
+
+  /* Going through more corners than fit in an atlas only works out
+   * in the same atlas if the slots of evicted corners are reused
+   */
+  max_n_atlases = 0;
+  for (color = 0x020000; color < 0x020000 + 2 * N_CORNERS_PER_ATLAS; color++)
+    {
+      paint_rounded_node (framebuffer, color);
+
+      _st_theme_node_get_corner_cache_stats (&hits, &misses, &n_corners, &n_atlases);
+      max_n_atlases = MAX (max_n_atlases, n_atlases);
+    }
+
+  if (max_n_atlases > MAX (old_n_atlases, 1))
+    {
+      g_print ("%s: slots of evicted corners weren't reused, %u atlases were used\n",
+               test, max_n_atlases);
+      fail = TRUE;
+    }
+}
+
+static void
+test_corner_cache (void)
+{
+  ClutterActorBox small_box = { 0, 0, 32, 32 };
+  ClutterActorBox large_box = { 0, 0, 48, 48 };
+  StThemeNodePaintState state1, state2;
+  StThemeNode *node1, *node2;
+  CoglContext *ctx;
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+  GError *error = NULL;
+  guint hits, misses, old_hits, old_misses, n_corners, n_atlases;
+  int i;
+
+  test = "corner_cache";
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, 48, 48));
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    g_error ("Failed to allocate framebuffer: %s", error->message);
+
+  node1 = new_styled_node ("background-color: #336699; border-radius: 6px;");
+  node2 = new_styled_node ("background-color: #336699; border-radius: 6px;");
+
+  _st_theme_node_get_corner_cache_stats (&old_hits, &old_misses, &n_corners, &n_atlases);
+
+  /* All four corners are the same, and so are the ones of another
+   * node painting the same at another size
+   */
+  st_theme_node_paint_state_init (&state1);
+  st_theme_node_paint_state_init (&state2);
+  st_theme_node_paint (node1, &state1, COGL_FRAMEBUFFER (offscreen), &small_box, 0xff, 1.0);
+  st_theme_node_paint (node2, &state2, COGL_FRAMEBUFFER (offscreen), &large_box, 0xff, 1.0);
+
+  _st_theme_node_get_corner_cache_stats (&hits, &misses, &n_corners, &n_atlases);
+  if (misses - old_misses > 1 || hits - old_hits < 7)
+    {
+      g_print ("%s: expected at most 1 miss and 7 hits, got %u and %u\n",
+               test, misses - old_misses, hits - old_hits);
+      fail = TRUE;
+    }
+
+  if (n_atlases == 0)
+    {
+      g_print ("%s: small corners weren't packed in an atlas\n", test);
+      fail = TRUE;
+    }
+
+  for (i = 0; i < 4; i++)
+    {
+      if (state1.corner_material[i] == NULL ||
+          cogl_pipeline_get_layer_texture (state1.corner_material[i], 0) !=
+          cogl_pipeline_get_layer_texture (state2.corner_material[i], 0))
+        {
+          g_print ("%s: corner %d isn't shared\n", test, i);
+          fail = TRUE;
+        }
+    }
+
+  st_theme_node_paint_state_free (&state1);
+  st_theme_node_paint_state_free (&state2);
+  g_object_unref (node1);
+  g_object_unref (node2);
+
+  test_corner_cache_eviction (COGL_FRAMEBUFFER (offscreen));
+
+  g_object_unref (offscreen);
+  cogl_object_unref (texture);
+}
+
+static void
+on_texture_file_loaded (StTextureCache *cache,
+                        GFile          *file,
+                        gboolean       *loaded)
+{
+  *loaded = TRUE;
+}
+
+static void
+test_pending_border_image (void)
+{
+  ClutterActorBox box = { 0, 0, 32, 32 };
+  StThemeNodePaintState state;
+  StThemeNode *node;
+  CoglContext *ctx;
+  CoglTexture *texture;
+  CoglOffscreen *offscreen;
+  cairo_surface_t *surface;
+  GError *error = NULL;
+  GFileIOStream *stream;
+  GFile *file;
+  char *path, *style;
+  gboolean loaded = FALSE;
+  gulong loaded_id;
+  gint64 deadline;
+
+  test = "pending_border_image";
+
+  file = g_file_new_tmp ("test-theme-XXXXXX.png", &stream, &error);
+  if (file == NULL)
+    g_error ("Failed to create image file: %s", error->message);
+  g_object_unref (stream);
+
+  path = g_file_get_path (file);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 12, 12);
+  if (cairo_surface_write_to_png (surface, path) != CAIRO_STATUS_SUCCESS)
+    g_error ("Failed to save image file %s", path);
+  cairo_surface_destroy (surface);
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  texture = COGL_TEXTURE (cogl_texture_2d_new_with_size (ctx, 32, 32));
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    g_error ("Failed to allocate framebuffer: %s", error->message);
+
+  loaded_id = g_signal_connect (st_texture_cache_get_default (), "texture-file-loaded",
+                                G_CALLBACK (on_texture_file_loaded), &loaded);
+
+  style = g_strdup_printf ("border-image: url('%s') 4; box-shadow: 0 2px 4px #000000;", path);
+  node = new_styled_node (style);
+
+  /* The shadow of the border image can't be rendered before it is loaded */
+  st_theme_node_paint_state_init (&state);
+  st_theme_node_paint (node, &state, COGL_FRAMEBUFFER (offscreen), &box, 0xff, 1.0);
+
+  if (node->cached_textures)
+    {
+      g_print ("%s: textures without the border image were cached\n", test);
+      fail = TRUE;
+    }
+
+  deadline = g_get_monotonic_time () + 10 * G_USEC_PER_SEC;
+  while (!loaded && g_get_monotonic_time () < deadline)
+    {
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+
+  if (!loaded)
+    {
+      g_print ("%s: border image wasn't loaded\n", test);
+      fail = TRUE;
+    }
+
+  _st_theme_node_paint_state_invalidate_for_loaded_file (&state, file);
+  st_theme_node_paint (node, &state, COGL_FRAMEBUFFER (offscreen), &box, 0xff, 1.0);
+
+  if (!node->cached_textures)
+    {
+      g_print ("%s: textures with the border image weren't cached\n", test);
+      fail = TRUE;
+    }
+
+  st_theme_node_paint_state_free (&state);
+  g_signal_handler_disconnect (st_texture_cache_get_default (), loaded_id);
+  g_object_unref (node);
+  g_object_unref (offscreen);
+  cogl_object_unref (texture);
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (style);
+  g_free (path);
+}
+
+static void
+on_node_finalized (gpointer  data,
+                   GObject  *node)
+{
+  int *n_nodes = data;
+
+  (*n_nodes)--;
+}
+
+static int
+animate_style (StWidget *widget,
+               int       first_value,
+               int       n_values)
+{
+  static int n_nodes = 0;
+  int i;
+
+  for (i = first_value; i < first_value + n_values; i++)
+    {
+      g_autofree char *style = g_strdup_printf ("padding: %dpx;", i);
+      StThemeNode *node;
+
+      st_widget_set_style (widget, style);
+      node = st_widget_get_theme_node (widget);
+      assert_length ("animated", "padding-top", i,
+                     st_theme_node_get_padding (node, ST_SIDE_TOP));
+
+      g_object_weak_ref (G_OBJECT (node), on_node_finalized, &n_nodes);
+      n_nodes++;
+    }
+
+  return n_nodes;
+}
+
+static void
+test_animated_style (void)
+{
+  StWidget *label;
+  int n_nodes;
+
+  test = "animated_style";
+
+  label = st_label_new ("foo");
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (label));
+
+  /* Every value creates a new node, but the ones that aren't used
+   * anymore mustn't be kept around forever
+   */
+  n_nodes = animate_style (label, 0, 1000);
+  if (animate_style (label, 1000, 1000) > n_nodes)
+    {
+      g_print ("%s: interned nodes keep growing while a style animates\n", test);
+      fail = TRUE;
+    }
+
+  clutter_actor_destroy (CLUTTER_ACTOR (label));
+}
+
 int
 main (int argc, char **argv)
 {
@@ -615,6 +1171,13 @@ main (int argc, char **argv)
   test_font_features ();
   test_pseudo_class ();
   test_inline_style ();
+  test_interned_nodes ();
+  test_node_size ();
+  test_node_equality ();
+  test_shared_paint_state ();
+  test_corner_cache ();
+  test_pending_border_image ();
+  test_animated_style ();
 
   g_object_unref (button);
   g_object_unref (group1);
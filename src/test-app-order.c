@@ -0,0 +1,290 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "shell-app-order-private.h"
+
+#define N_APPS 200
+#define N_CHURN_STEPS 20000
+#define N_BENCHMARK_ROUNDS 10000
+
+/* Few distinct user times, so that many apps sort equal */
+#define MAX_USER_TIME 50
+
+typedef struct
+{
+  ShellAppOrderKey key;
+  gboolean running;
+} TestApp;
+
+static TestApp apps[N_APPS];
+
+/* User times are picked after this one, which they may wrap around */
+static guint32 user_time_base;
+
+static int
+compare_apps (gconstpointer a,
+              gconstpointer b)
+{
+  const TestApp *app = a, *other = b;
+
+  return shell_app_order_key_compare (&app->key, &other->key);
+}
+
+/* How shell_app_system_get_running() used to sort running apps */
+static GSList *
+sort_running_apps (void)
+{
+  GSList *ret = NULL;
+  int i;
+
+  for (i = 0; i < N_APPS; i++)
+    {
+      if (apps[i].running)
+        ret = g_slist_prepend (ret, &apps[i]);
+    }
+
+  return g_slist_sort (ret, compare_apps);
+}
+
+static void
+random_key (GRand            *rand,
+            ShellAppOrderKey *key)
+{
+  key->minimized = g_rand_int_range (rand, 0, 4) == 0;
+  key->has_windows = g_rand_int_range (rand, 0, 8) != 0;
+  key->last_user_time = user_time_base + g_rand_int_range (rand, 0, MAX_USER_TIME);
+}
+
+/* Apps that sort equal may come in any order */
+static void
+assert_order (ShellAppOrder *order)
+{
+  g_autoptr (GSList) expected = sort_running_apps ();
+  g_autoptr (GHashTable) seen = g_hash_table_new (NULL, NULL);
+  gpointer *actual;
+  GSList *l;
+  guint n_actual, i;
+
+  actual = shell_app_order_peek (order, &n_actual);
+  g_assert_cmpuint (n_actual, ==, g_slist_length (expected));
+
+  for (l = expected, i = 0; l; l = l->next, i++)
+    {
+      TestApp *app = actual[i];
+
+      g_assert_true (app->running);
+      g_assert_cmpint (compare_apps (app, l->data), ==, 0);
+      g_assert_true (g_hash_table_add (seen, app));
+    }
+
+  /* Also check the user times by how long after the base they are,
+   * which doesn't depend on the comparison itself */
+  for (i = 1; i < n_actual; i++)
+    {
+      TestApp *previous = actual[i - 1], *app = actual[i];
+
+      if (previous->key.minimized != app->key.minimized ||
+          previous->key.has_windows != app->key.has_windows)
+        continue;
+
+      g_assert_cmpuint (previous->key.last_user_time - user_time_base, >=,
+                        app->key.last_user_time - user_time_base);
+    }
+}
+
+static void
+test_churn_from (guint32 base)
+{
+  g_autoptr (GRand) rand = g_rand_new_with_seed (42);
+  ShellAppOrder *order = shell_app_order_new ();
+  int step;
+
+  memset (apps, 0, sizeof (apps));
+  user_time_base = base;
+
+  for (step = 0; step < N_CHURN_STEPS; step++)
+    {
+      TestApp *app = &apps[g_rand_int_range (rand, 0, N_APPS)];
+      g_autofree gpointer *before = NULL;
+      gpointer *after;
+      guint serial, n_before, n_after;
+
+      before = g_memdup2 (shell_app_order_peek (order, &n_before),
+                          n_before * sizeof (gpointer));
+      serial = shell_app_order_get_serial (order);
+
+      switch (g_rand_int_range (rand, 0, 4))
+        {
+        case 0:
+          /* Starts or stops */
+          app->running = !app->running;
+          if (app->running)
+            {
+              random_key (rand, &app->key);
+              shell_app_order_update (order, app, &app->key);
+            }
+          else
+            {
+              shell_app_order_remove (order, app);
+            }
+          break;
+
+        case 1:
+          /* Gets focused */
+          if (app->running)
+            {
+              app->key.minimized = FALSE;
+              app->key.last_user_time = user_time_base + g_rand_int_range (rand, 0, MAX_USER_TIME);
+              shell_app_order_update (order, app, &app->key);
+            }
+          break;
+
+        case 2:
+          /* Gets minimized, or unminimized */
+          if (app->running)
+            {
+              app->key.minimized = !app->key.minimized;
+              shell_app_order_update (order, app, &app->key);
+            }
+          break;
+
+        default:
+          /* Changes in a way that doesn't affect its key */
+          if (app->running)
+            shell_app_order_update (order, app, &app->key);
+          break;
+        }
+
+      assert_order (order);
+
+      after = shell_app_order_peek (order, &n_after);
+      if (n_before != n_after ||
+          memcmp (before, after, n_after * sizeof (gpointer)) != 0)
+        g_assert_cmpuint (shell_app_order_get_serial (order), !=, serial);
+      else
+        g_assert_cmpuint (shell_app_order_get_serial (order), ==, serial);
+    }
+
+  shell_app_order_free (order);
+}
+
+static void
+test_churn (void)
+{
+  test_churn_from (0);
+}
+
+/* User times straddling the point where they turn negative as int */
+static void
+test_churn_sign (void)
+{
+  test_churn_from ((guint32) G_MAXINT32 - MAX_USER_TIME / 2);
+}
+
+/* User times straddling the point where they wrap around */
+static void
+test_churn_wrap (void)
+{
+  test_churn_from (G_MAXUINT32 - MAX_USER_TIME / 2);
+}
+
+static void
+test_remove_unknown (void)
+{
+  ShellAppOrder *order = shell_app_order_new ();
+  ShellAppOrderKey key = { FALSE, TRUE, 1 };
+  guint serial, n_apps;
+
+  shell_app_order_update (order, &apps[0], &key);
+  serial = shell_app_order_get_serial (order);
+
+  shell_app_order_remove (order, &apps[1]);
+  g_assert_cmpuint (shell_app_order_get_serial (order), ==, serial);
+
+  shell_app_order_peek (order, &n_apps);
+  g_assert_cmpuint (n_apps, ==, 1);
+
+  shell_app_order_free (order);
+}
+
+/* Every round, one of N_APPS running apps gets focused, and running apps
+ * are listed, like when the dash or the app switcher update */
+static void
+test_benchmark (void)
+{
+  g_autoptr (GRand) sort_rand = g_rand_new_with_seed (42);
+  g_autoptr (GRand) order_rand = g_rand_new_with_seed (42);
+  ShellAppOrder *order = shell_app_order_new ();
+  g_autoptr (GTimer) timer = g_timer_new ();
+  double sort_time, order_time;
+  guint32 user_time = N_APPS;
+  guint checksum = 0;
+  int i;
+
+  memset (apps, 0, sizeof (apps));
+  for (i = 0; i < N_APPS; i++)
+    {
+      apps[i].running = TRUE;
+      apps[i].key.has_windows = TRUE;
+      apps[i].key.last_user_time = i;
+      shell_app_order_update (order, &apps[i], &apps[i].key);
+    }
+
+  g_timer_start (timer);
+  for (i = 0; i < N_BENCHMARK_ROUNDS; i++)
+    {
+      TestApp *app = &apps[g_rand_int_range (sort_rand, 0, N_APPS)];
+      GSList *running;
+
+      app->key.last_user_time = user_time++;
+
+      running = sort_running_apps ();
+      checksum += GPOINTER_TO_UINT (running->data);
+      g_slist_free (running);
+    }
+  sort_time = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_BENCHMARK_ROUNDS; i++)
+    {
+      TestApp *app = &apps[g_rand_int_range (order_rand, 0, N_APPS)];
+      gpointer *running;
+      guint n_running;
+
+      app->key.last_user_time = user_time++;
+      shell_app_order_update (order, app, &app->key);
+
+      running = shell_app_order_peek (order, &n_running);
+      checksum -= GPOINTER_TO_UINT (running[0]);
+    }
+  order_time = g_timer_elapsed (timer, NULL);
+
+  g_test_minimized_result (sort_time * G_USEC_PER_SEC / N_BENCHMARK_ROUNDS,
+                           "Sorting %d running apps: %.2f us",
+                           N_APPS, sort_time * G_USEC_PER_SEC / N_BENCHMARK_ROUNDS);
+  g_test_minimized_result (order_time * G_USEC_PER_SEC / N_BENCHMARK_ROUNDS,
+                           "Reordering %d running apps: %.2f us",
+                           N_APPS, order_time * G_USEC_PER_SEC / N_BENCHMARK_ROUNDS);
+
+  /* Both focused the same apps, so they were listed first the same times */
+  g_assert_cmpuint (checksum, ==, 0);
+
+  shell_app_order_free (order);
+}
+
+int
+main (int argc, char **argv)
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/app-order/churn", test_churn);
+  g_test_add_func ("/app-order/churn-sign", test_churn_sign);
+  g_test_add_func ("/app-order/churn-wrap", test_churn_wrap);
+  g_test_add_func ("/app-order/remove-unknown", test_remove_unknown);
+  g_test_add_func ("/app-order/benchmark", test_benchmark);
+
+  return g_test_run ();
+}
@@ -0,0 +1,28 @@
+// Helpers for shell tests that install their own applications
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+
+/**
+ * Gets the directory test applications are installed into, creating
+ * it if necessary
+ *
+ * Only the scratch data dir set up by tests/meson.build is used, so
+ * tests never install apps for the user running them.
+ *
+ * @returns {Gio.File} the applications directory
+ */
+export function getApplicationsDir() {
+    if (!GLib.getenv('XDG_DATA_HOME'))
+        throw new Error('XDG_DATA_HOME is not set to a scratch directory');
+
+    const dir = Gio.File.new_for_path(
+        GLib.build_filenamev([GLib.get_user_data_dir(), 'applications']));
+    try {
+        dir.make_directory_with_parents(null);
+    } catch (e) {
+        if (!e.matches(Gio.IOErrorEnum, Gio.IOErrorEnum.EXISTS))
+            throw e;
+    }
+    return dir;
+}
@@ -0,0 +1,63 @@
+// Reference implementation of Util.findUrls(), using the regular
+// expression it was based on before URLs were scanned natively
+
+const JsUnit = imports.jsUnit;
+
+// http://daringfireball.net/2010/07/improved_regex_for_matching_urls
+const _balancedParens = '\\([^\\s()<>]+\\)';
+const _leadingJunk = '[\\s`(\\[{\'\\"<\u00AB\u201C\u2018]';
+const _notTrailingJunk = '[^\\s`!()\\[\\]{};:\'\\".,<>?\u00AB\u00BB\u200E\u200F\u201C\u201D\u2018\u2019\u202A\u202C]';
+
+const _urlRegexp = new RegExp(
+    `(^|${_leadingJunk})` +
+    '(' +
+        '(?:' +
+            '(?:http|https|ftp)://' +             // scheme://
+            '|' +
+            'www\\d{0,3}[.]' +                    // www.
+            '|' +
+            '[a-z0-9.\\-]+[.][a-z]{2,4}/' +       // foo.xx/
+        ')' +
+        '(?:' +                                   // one or more:
+            '[^\\s()<>]+' +                       // run of non-space non-()
+            '|' +                                 // or
+            `${_balancedParens}` +                // balanced parens
+        ')+' +
+        '(?:' +                                   // end with:
+            `${_balancedParens}` +                // balanced parens
+            '|' +                                 // or
+            `${_notTrailingJunk}` +               // last non-junk char
+        ')' +
+    ')', 'gi');
+
+/**
+ * @param {string} str string to find URLs in
+ * @returns {{url: string, pos: number}[]} the URLs in `str`
+ */
+export function findUrls(str) {
+    const res = [];
+    let match;
+
+    _urlRegexp.lastIndex = 0;
+    while ((match = _urlRegexp.exec(str)))
+        res.push({url: match[2], pos: match.index + match[1].length});
+    return res;
+}
+
+/**
+ * Asserts that two lists of URLs are the same
+ *
+ * @param {string} errorMessage an error message if the lists differ
+ * @param {{url: string, pos: number}[]} expected the expected URLs
+ * @param {{url: string, pos: number}[]} actual the URLs that were found
+ */
+export function assertUrlsEqual(errorMessage, expected, actual) {
+    JsUnit.assertEquals(`${errorMessage} match length`,
+        expected.length, actual.length);
+    for (let j = 0; j < expected.length; j++) {
+        JsUnit.assertEquals(`${errorMessage}, match ${j} url`,
+            expected[j].url, actual[j].url);
+        JsUnit.assertEquals(`${errorMessage}, match ${j} position`,
+            expected[j].pos, actual[j].pos);
+    }
+}
@@ -0,0 +1,77 @@
+'''NetworkManager D-Bus mock template with access point bursts'''
+
+# This program is free software; you can redistribute it and/or modify it under
+# the terms of the GNU Lesser General Public License as published by the Free
+# Software Foundation; either version 3 of the License, or (at your option) any
+# later version.  See http://www.gnu.org/copyleft/lgpl.html for the full text
+# of the license.
+
+__license__ = 'LGPL 3+'
+
+import random
+
+import dbus
+from dbusmock import MOCK_IFACE, mockobject
+from dbusmock.templates import networkmanager
+# Re-export the upstream template, so this one can replace it
+from dbusmock.templates.networkmanager import *  # noqa: F401,F403
+
+ACCESS_POINT_IFACE = 'org.freedesktop.NetworkManager.AccessPoint'
+
+
+def load(mock, parameters=None):
+    networkmanager.load(mock, parameters if parameters else {})
+    mock.burst_access_points = {}
+    mock.burst_random = random.Random(0)
+
+
+@dbus.service.method(MOCK_IFACE, in_signature='s', out_signature='o')
+def AddBurstWiFiDevice(self, device_name):
+    '''Add a disconnected WiFi device to add access points bursts to
+
+    Returns the new object path.
+    '''
+    path = networkmanager.AddWiFiDevice(self, device_name, device_name,
+                                        networkmanager.DeviceState.DISCONNECTED)
+    self.burst_access_points[path] = {}
+    return path
+
+
+@dbus.service.method(MOCK_IFACE, in_signature='ssuu', out_signature='ao')
+def AddAccessPointBurst(self, dev_path, prefix, n_aps, n_networks):
+    '''Add @n_aps open access points to a device in a single burst
+
+    The access points are spread over @n_networks networks, and have
+    random signal strengths.
+
+    Returns the object paths of the new access points.
+    '''
+    access_points = self.burst_access_points[dev_path]
+    paths = []
+
+    for i in range(n_aps):
+        n = len(access_points)
+        strength = self.burst_random.randint(10, 100)
+        path = networkmanager.AddAccessPoint(
+            self, dev_path, f'{prefix}{n}', f'{prefix}-network-{i % n_networks}',
+            '00:23:00:%02X:%02X:%02X' % ((n >> 16) & 0xff, (n >> 8) & 0xff, n & 0xff),
+            networkmanager.InfrastructureMode.NM_802_11_MODE_INFRA,
+            2412, 54000, strength,
+            networkmanager.NM80211ApSecurityFlags.NM_802_11_AP_SEC_NONE)
+        access_points[path] = strength
+        paths.append(path)
+
+    return paths
+
+
+@dbus.service.method(MOCK_IFACE, in_signature='sy', out_signature='')
+def JitterAccessPoints(self, dev_path, amplitude):
+    '''Change the signal strength of every access point of a device by
+    at most @amplitude from the strength it was added with
+    '''
+    rand = self.burst_random
+    for path, strength in self.burst_access_points[dev_path].items():
+        jittered = min(max(strength + rand.randint(-amplitude, amplitude), 0), 100)
+        mockobject.objects[path].UpdateProperties(ACCESS_POINT_IFACE, {
+            'Strength': dbus.Byte(jittered),
+        })
@@ -91,10 +91,11 @@ class GnomeShellDBusRunner(MutterDBusRunner):
         systemd_system = klass.start_from_template('systemd', system_bus=True)
         systemd_user = klass.start_from_template('systemd', system_bus=False)
         klass.start_from_template('upower')
-        klass.start_from_template('networkmanager')
         klass.start_from_template('polkitd')
         klass.start_from_template('power_profiles_daemon')
 
+        klass.start_from_local_template('network_manager')
+
         accounts_service = klass.start_from_local_template('accounts_service')
         empty_dict = dbus.Dictionary({}, signature='sv')
         accounts_service[1].AddUser(os.getuid(),
@@ -0,0 +1,103 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+import St from 'gi://St';
+
+// This script tests that clipboard transfers honor their maximum size,
+// using content owned by the shell itself as selection source.
+
+export var METRICS = {};
+
+Gio._promisify(St.Clipboard.prototype, 'get_content_async');
+Gio._promisify(St.Clipboard.prototype, 'get_text_async');
+Gio._promisify(St.Clipboard.prototype, 'transfer_async');
+
+const TEXT_MIMETYPE = 'text/plain;charset=utf-8';
+
+// Two bytes per character in UTF-8, so an odd limit cuts a character
+const TEXT = 'é'.repeat(4 * 1024 * 1024);
+const TEXT_SIZE = 2 * TEXT.length;
+
+let checks = 0;
+
+/**
+ * @param {boolean} condition - the condition that must hold
+ * @param {string} message - description of the check
+ */
+function check(condition, message) {
+    if (!condition)
+        throw new Error(`Check failed: ${message}`);
+    checks++;
+}
+
+/**
+ * @param {Promise} promise - the request expected to fail
+ * @param {number} code - the expected Gio.IOErrorEnum code
+ * @param {string} message - description of the check
+ */
+async function checkFails(promise, code, message) {
+    try {
+        await promise;
+    } catch (e) {
+        check(e.matches(Gio.IOErrorEnum, code), `${message}: ${e.message}`);
+        return;
+    }
+
+    check(false, `${message}: request succeeded`);
+}
+
+/** @returns {void} */
+export async function run() {
+    const clipboard = St.Clipboard.get_default();
+    const type = St.ClipboardType.CLIPBOARD;
+
+    clipboard.set_text(type, TEXT);
+
+    let text = await clipboard.get_text_async(type, -1, null);
+    check(text === TEXT, 'unlimited text is complete');
+
+    text = await clipboard.get_text_async(type, 1001, null);
+    check(text === TEXT.slice(0, 500),
+        'text is truncated to the limit, without partial characters');
+
+    text = await clipboard.get_text_async(type, TEXT_SIZE, null);
+    check(text === TEXT, 'text as large as the limit is not truncated');
+
+    let bytes = await clipboard.get_content_async(type,
+        TEXT_MIMETYPE, TEXT_SIZE, null);
+    check(bytes.get_size() === TEXT_SIZE,
+        'content as large as the limit is complete');
+
+    await checkFails(
+        clipboard.get_content_async(type, TEXT_MIMETYPE, 4096, null),
+        Gio.IOErrorEnum.MESSAGE_TOO_LARGE,
+        'content over the limit fails');
+
+    const stream = Gio.MemoryOutputStream.new_resizable();
+    const [success_, truncated] = await clipboard.transfer_async(type,
+        TEXT_MIMETYPE, 4096, St.ClipboardTransferFlags.TRUNCATE,
+        stream, null);
+    check(truncated, 'transfer over the limit is reported as truncated');
+    check(stream.get_data_size() === 4096,
+        'no more than the limit is written to the stream');
+
+    const cancellable = new Gio.Cancellable();
+    const promise = clipboard.get_content_async(type,
+        TEXT_MIMETYPE, -1, cancellable);
+    cancellable.cancel();
+    await checkFails(promise, Gio.IOErrorEnum.CANCELLED,
+        'cancelled content request fails');
+
+    clipboard.set_content(type, 'application/octet-stream',
+        new GLib.Bytes(new Uint8Array(8192)));
+    bytes = await clipboard.get_content_async(type,
+        'application/octet-stream', -1, null);
+    check(bytes.get_size() === 8192, 'binary content is complete');
+}
+
+/** @returns {void} */
+export function finish() {
+    if (checks === 0)
+        throw new Error('No clipboard checks ran');
+}
@@ -0,0 +1,150 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+import Shell from 'gi://Shell';
+
+// This script tests that the D-Bus interfaces compiled at build time
+// match their XML descriptions, and measures the time saved by not
+// parsing them.
+
+export var METRICS = {};
+
+const IFACES_PATH = '/org/gnome/shell/dbus-interfaces';
+
+const mismatches = [];
+
+function describeAnnotations(annotations) {
+    return annotations.map(a => ({
+        key: a.key,
+        value: a.value,
+        annotations: describeAnnotations(a.annotations),
+    }));
+}
+
+function describeArgs(args) {
+    return args.map(a => ({
+        name: a.name,
+        signature: a.signature,
+        annotations: describeAnnotations(a.annotations),
+    }));
+}
+
+function describeInterface(info) {
+    return {
+        name: info.name,
+        methods: info.methods.map(m => ({
+            name: m.name,
+            inArgs: describeArgs(m.in_args),
+            outArgs: describeArgs(m.out_args),
+            annotations: describeAnnotations(m.annotations),
+        })),
+        signals: info.signals.map(s => ({
+            name: s.name,
+            args: describeArgs(s.args),
+            annotations: describeAnnotations(s.annotations),
+        })),
+        properties: info.properties.map(p => ({
+            name: p.name,
+            signature: p.signature,
+            flags: p.flags,
+            annotations: describeAnnotations(p.annotations),
+        })),
+        annotations: describeAnnotations(info.annotations),
+    };
+}
+
+// Loads every interface like loadInterfaceXML() does
+function loadXmlInterfaces(resource) {
+    const decoder = new TextDecoder();
+    const interfaces = new Map();
+
+    const files = resource.enumerate_children(IFACES_PATH,
+        Gio.ResourceLookupFlags.NONE);
+    for (const file of files.filter(f => f.endsWith('.xml'))) {
+        const bytes = resource.lookup_data(`${IFACES_PATH}/${file}`,
+            Gio.ResourceLookupFlags.NONE);
+        const nodeInfo = Gio.DBusNodeInfo.new_for_xml(
+            decoder.decode(bytes.toArray()));
+
+        for (const info of nodeInfo.interfaces)
+            interfaces.set(info.name, info);
+    }
+
+    return interfaces;
+}
+
+// Builds every interface, without the infos shared by earlier lookups
+function buildCompiledInterfaces(names) {
+    const interfaces = new Map();
+    for (const name of names)
+        interfaces.set(name, Shell.util_build_dbus_interface_info(name));
+    return interfaces;
+}
+
+function measure(func) {
+    const start = GLib.get_monotonic_time();
+    const result = func();
+    return [result, GLib.get_monotonic_time() - start];
+}
+
+/**
+ * run:
+ */
+export function run() {
+    const resource = Gio.Resource.load(
+        `${global.datadir}/gnome-shell-dbus-interfaces.gresource`);
+
+    const [xmlInterfaces, xmlTime] =
+        measure(() => loadXmlInterfaces(resource));
+
+    // The shell already looked up the interfaces it uses, so they are
+    // built again, as on their first lookup
+    const [compiledInterfaces, compiledTime] =
+        measure(() => buildCompiledInterfaces(xmlInterfaces.keys()));
+
+    for (const [name, xmlInfo] of xmlInterfaces) {
+        const expected = JSON.stringify(describeInterface(xmlInfo));
+
+        for (const compiledInfo of [
+            compiledInterfaces.get(name),
+            Shell.util_lookup_dbus_interface_info(name),
+        ]) {
+            const actual = compiledInfo
+                ? JSON.stringify(describeInterface(compiledInfo)) : null;
+
+            if (actual !== expected) {
+                mismatches.push(name);
+                break;
+            }
+        }
+    }
+
+    if (Shell.util_lookup_dbus_interface_info('org.gnome.Shell.Unknown'))
+        mismatches.push('org.gnome.Shell.Unknown');
+
+    METRICS.xmlLoadTime = {
+        description: `Time to load ${xmlInterfaces.size} D-Bus interfaces from XML`,
+        units: 'us',
+        value: xmlTime,
+    };
+    METRICS.compiledLookupTime = {
+        description: `Time to build ${xmlInterfaces.size} compiled D-Bus interfaces`,
+        units: 'us',
+        value: compiledTime,
+    };
+    METRICS.startupTimeSaved = {
+        description: 'Time saved by not parsing D-Bus interface XML',
+        units: 'us',
+        value: xmlTime - compiledTime,
+    };
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (mismatches.length > 0)
+        throw new Error(`Compiled D-Bus interfaces differ from XML: ${mismatches.join(', ')}`);
+}
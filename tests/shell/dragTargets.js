@@ -0,0 +1,404 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Clutter from 'gi://Clutter';
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+import Shell from 'gi://Shell';
+import St from 'gi://St';
+
+import * as AppDisplay from 'resource:///org/gnome/shell/ui/appDisplay.js';
+import * as DND from 'resource:///org/gnome/shell/ui/dnd.js';
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+import * as TestApps from '../common/testApps.js';
+
+// This script tests that drags over the app grid find the same drop
+// targets as picking the stage would, and compares the time it takes
+// to find them. It also checks that no target is found below actors
+// that aren't registered or for rotated targets, and that moved targets
+// are found.
+
+export var METRICS = {};
+
+const N_APPS = 48;
+const APP_ID_PREFIX = 'org.gnome.Shell.TestDrag';
+
+// The scripted path goes back and forth over the current page
+const N_PATH_ROWS = 6;
+const N_PATH_STEPS_PER_ROW = 40;
+
+// Keeps the path away from the edges, where drags switch pages
+const PATH_MARGIN = 0.1;
+
+const TIMEOUT_MS = 10000;
+
+const mismatches = [];
+const failures = [];
+let nSteps = 0;
+
+function getAppIds() {
+    return Array.from({length: N_APPS}, (_, i) => `${APP_ID_PREFIX}${i}.desktop`);
+}
+
+function installApps() {
+    const appsDir = TestApps.getApplicationsDir();
+
+    getAppIds().forEach((id, i) => {
+        const contents = [
+            '[Desktop Entry]',
+            'Type=Application',
+            `Name=Drag Test ${i}`,
+            'Exec=true',
+            '',
+        ].join('\n');
+        appsDir.get_child(id).replace_contents(contents, null, false,
+            Gio.FileCreateFlags.REPLACE_DESTINATION, null);
+    });
+}
+
+function uninstallApps() {
+    const appsDir = TestApps.getApplicationsDir();
+
+    for (const id of getAppIds()) {
+        try {
+            appsDir.get_child(id).delete(null);
+        } catch (e) {
+            if (!e.matches(Gio.IOErrorEnum, Gio.IOErrorEnum.NOT_FOUND))
+                throw e;
+        }
+    }
+}
+
+async function waitFor(checkFunc, what) {
+    /* eslint-disable no-await-in-loop */
+    const start = GLib.get_monotonic_time();
+    while (!checkFunc()) {
+        if (GLib.get_monotonic_time() - start > TIMEOUT_MS * 1000)
+            throw new Error(`Timed out waiting for ${what}`);
+        await Scripting.sleep(50);
+    }
+    /* eslint-enable no-await-in-loop */
+}
+
+// The delegates a drag over @actor is offered to, in order
+function getDragHandlers(actor) {
+    const handlers = [];
+    for (; actor; actor = actor.get_parent()) {
+        const delegate = actor._delegate;
+        if (delegate?.handleDragOver && delegate !== handlers.at(-1))
+            handlers.push(delegate);
+    }
+    return handlers;
+}
+
+function describeActor(actor) {
+    return actor ? `${actor.constructor.name} ${actor.name ?? ''}`.trim() : 'null';
+}
+
+// Records the target found by every hover update of the drag, along
+// with the actor picking the stage would have found
+function trackHoverUpdates(draggable, steps) {
+    const prototype = Object.getPrototypeOf(draggable);
+    const {_pickTargetActor} = prototype;
+    let resolveUpdate = null;
+
+    prototype._pickTargetActor = function () {
+        let start = GLib.get_monotonic_time();
+        const target = _pickTargetActor.call(this);
+        const indexTime = GLib.get_monotonic_time() - start;
+
+        start = GLib.get_monotonic_time();
+        const picked = global.stage.get_actor_at_pos(
+            Clutter.PickMode.ALL, this._dragX, this._dragY);
+        const pickTime = GLib.get_monotonic_time() - start;
+
+        steps.push({x: this._dragX, y: this._dragY, target, picked, indexTime, pickTime});
+        resolveUpdate?.();
+        resolveUpdate = null;
+
+        return target;
+    };
+
+    const waitForUpdate = () => new Promise((resolve, reject) => {
+        const timeoutId = GLib.timeout_add(GLib.PRIORITY_DEFAULT, TIMEOUT_MS, () => {
+            resolveUpdate = null;
+            reject(new Error('Timed out waiting for a hover update'));
+            return GLib.SOURCE_REMOVE;
+        });
+        resolveUpdate = () => {
+            GLib.source_remove(timeoutId);
+            resolve();
+        };
+    });
+
+    return {
+        waitForUpdate,
+        untrack: () => (prototype._pickTargetActor = _pickTargetActor),
+    };
+}
+
+function createPath(appDisplay) {
+    const [x, y] = appDisplay.get_transformed_position();
+    const [width, height] = appDisplay.get_transformed_size();
+    const x1 = x + width * PATH_MARGIN, x2 = x + width * (1 - PATH_MARGIN);
+    const y1 = y + height * PATH_MARGIN, y2 = y + height * (1 - PATH_MARGIN);
+
+    const path = [];
+    for (let row = 0; row < N_PATH_ROWS; row++) {
+        const rowY = y1 + (y2 - y1) * row / (N_PATH_ROWS - 1);
+        for (let step = 0; step < N_PATH_STEPS_PER_ROW; step++) {
+            let progress = step / (N_PATH_STEPS_PER_ROW - 1);
+            if (row % 2)
+                progress = 1 - progress;
+            path.push([x1 + (x2 - x1) * progress, rowY]);
+        }
+    }
+    return path;
+}
+
+function compareSteps(steps) {
+    for (const {x, y, target, picked} of steps) {
+        const expected = getDragHandlers(picked);
+        const actual = getDragHandlers(target);
+
+        if (!target?.contains(picked) ||
+            actual.length !== expected.length ||
+            actual.some((handler, i) => handler !== expected[i])) {
+            mismatches.push(`(${Math.round(x)}, ${Math.round(y)}): ` +
+                `${describeActor(target)} instead of ${describeActor(picked)}`);
+        }
+    }
+}
+
+async function dragAlongPath(appDisplay, icon, steps) {
+    /* eslint-disable no-await-in-loop */
+    const seat = Clutter.get_default_backend().get_default_seat();
+    const pointer = seat.create_virtual_device(Clutter.InputDeviceType.POINTER_DEVICE);
+    const keyboard = seat.create_virtual_device(Clutter.InputDeviceType.KEYBOARD_DEVICE);
+    const moveTo = (x, y) =>
+        pointer.notify_absolute_motion(GLib.get_monotonic_time(), x, y);
+
+    const [iconX, iconY] = icon.get_transformed_position();
+    const [iconWidth, iconHeight] = icon.get_transformed_size();
+    const startX = iconX + iconWidth / 2, startY = iconY + iconHeight / 2;
+
+    let dragging = false;
+    const beginId = icon._draggable.connect('drag-begin', () => (dragging = true));
+    const endId = icon._draggable.connect('drag-end', () => (dragging = false));
+
+    moveTo(startX, startY);
+    await Scripting.waitLeisure();
+    pointer.notify_button(GLib.get_monotonic_time(),
+        Clutter.BUTTON_PRIMARY, Clutter.ButtonState.PRESSED);
+    moveTo(startX + 20, startY + 20);
+    await waitFor(() => dragging, 'the drag to begin');
+
+    const tracker = trackHoverUpdates(icon._draggable, steps);
+    try {
+        for (const [x, y] of createPath(appDisplay)) {
+            const update = tracker.waitForUpdate();
+            moveTo(x, y);
+            await update;
+        }
+    } finally {
+        tracker.untrack();
+
+        // Cancel rather than drop, so that the app grid layout is kept
+        keyboard.notify_keyval(GLib.get_monotonic_time(),
+            Clutter.KEY_Escape, Clutter.KeyState.PRESSED);
+        keyboard.notify_keyval(GLib.get_monotonic_time(),
+            Clutter.KEY_Escape, Clutter.KeyState.RELEASED);
+        pointer.notify_button(GLib.get_monotonic_time(),
+            Clutter.BUTTON_PRIMARY, Clutter.ButtonState.RELEASED);
+        await waitFor(() => !dragging, 'the drag to end');
+
+        icon._draggable.disconnect(beginId);
+        icon._draggable.disconnect(endId);
+    }
+    /* eslint-enable no-await-in-loop */
+}
+
+async function testOcclusion(appDisplay) {
+    const [x, y] = appDisplay.get_transformed_position();
+    const [width, height] = appDisplay.get_transformed_size();
+    const centerX = x + width / 2, centerY = y + height / 2;
+
+    const target = DND.findDropTarget(centerX, centerY);
+    if (!target) {
+        failures.push('No drop target is found over the app grid');
+        return;
+    }
+
+    // Picking finds unregistered actors painted above targets
+    const cover = new St.Widget({
+        x: centerX - 50,
+        y: centerY - 50,
+        width: 100,
+        height: 100,
+    });
+    Main.uiGroup.add_child(cover);
+    await Scripting.waitLeisure();
+
+    const covered = DND.findDropTarget(centerX, centerY);
+    if (covered)
+        failures.push(`${describeActor(covered)} is found below an unregistered actor`);
+
+    cover.destroy();
+    await Scripting.waitLeisure();
+
+    const uncovered = DND.findDropTarget(centerX, centerY);
+    if (uncovered !== target) {
+        failures.push(`${describeActor(uncovered)} is found instead of ` +
+            `${describeActor(target)} once uncovered`);
+    }
+}
+
+async function testReparent() {
+    const container = new Clutter.Actor({x: 100, y: 100, width: 400, height: 100});
+    const oldParent = new Clutter.Actor({x: 0, y: 0, width: 100, height: 100});
+    const newParent = new Clutter.Actor({
+        x: 200,
+        y: 0,
+        width: 100,
+        height: 100,
+        clip_to_allocation: true,
+    });
+    const target = new Clutter.Actor({x: 75, y: 0, width: 50, height: 50});
+
+    container.add_child(oldParent);
+    container.add_child(newParent);
+    oldParent.add_child(target);
+    Main.uiGroup.add_child(container);
+    DND.addDropTarget(target);
+
+    try {
+        await Scripting.waitLeisure();
+        if (DND.findDropTarget(210, 110) !== target)
+            failures.push('A registered target is not found');
+
+        // The target is clipped by its new parent from now on
+        oldParent.remove_child(target);
+        newParent.add_child(target);
+        await Scripting.waitLeisure();
+
+        if (DND.findDropTarget(380, 110) !== target)
+            failures.push('A reparented target is not found');
+        if (DND.findDropTarget(210, 110) === target)
+            failures.push('A reparented target is found at its old position');
+        if (DND.findDropTarget(410, 110) === target)
+            failures.push('A reparented target is found outside of its clip');
+    } finally {
+        DND.removeDropTarget(target);
+        container.destroy();
+    }
+}
+
+async function testRotation() {
+    const target = new Clutter.Actor({x: 100, y: 100, width: 100, height: 100});
+    target.set_pivot_point(0.5, 0.5);
+
+    Main.uiGroup.add_child(target);
+    DND.addDropTarget(target);
+
+    try {
+        await Scripting.waitLeisure();
+        if (DND.findDropTarget(150, 150) !== target)
+            failures.push('A registered target is not found');
+
+        // The rotated target doesn't fill its box, so picking decides
+        target.rotation_angle_z = 45;
+        await Scripting.waitLeisure();
+        if (DND.findDropTarget(150, 150) === target)
+            failures.push('A rotated target is found by its box');
+
+        target.rotation_angle_z = 0;
+        await Scripting.waitLeisure();
+        if (DND.findDropTarget(150, 150) !== target)
+            failures.push('A target is not found once no longer rotated');
+    } finally {
+        DND.removeDropTarget(target);
+        target.destroy();
+    }
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    const appSystem = Shell.AppSystem.get_default();
+    const appIds = getAppIds();
+
+    installApps();
+
+    try {
+        await waitFor(() => appIds.every(id => appSystem.lookup_app(id)),
+            'apps to be installed');
+
+        Main.overview.show();
+        await Scripting.waitLeisure();
+        Main.overview.dash.showAppsButton.checked = true;
+        await Scripting.waitLeisure();
+
+        const appDisplay = Main.overview._overview._controls._appDisplay;
+        await waitFor(() => appIds.every(id => appDisplay._items.has(id)),
+            'apps to be shown');
+        await Scripting.waitLeisure();
+
+        const icon = appDisplay._orderedItems.find(
+            item => item instanceof AppDisplay.AppIcon && item.mapped);
+        if (!icon)
+            throw new Error('No app icon is shown');
+
+        const steps = [];
+        await dragAlongPath(appDisplay, icon, steps);
+        compareSteps(steps);
+        nSteps = steps.length;
+
+        const sum = values => values.reduce((total, value) => total + value, 0);
+        const indexTime = sum(steps.map(s => s.indexTime));
+        const pickTime = sum(steps.map(s => s.pickTime));
+
+        METRICS.indexHoverTime = {
+            description: 'Mean time to find the drop target of a hover update',
+            units: 'us',
+            value: Math.round(indexTime / Math.max(nSteps, 1)),
+        };
+        METRICS.pickHoverTime = {
+            description: 'Mean time to pick the actor under a drag',
+            units: 'us',
+            value: Math.round(pickTime / Math.max(nSteps, 1)),
+        };
+        METRICS.hoverUpdates = {
+            description: 'Hover updates along the drag path',
+            units: 'updates',
+            value: nSteps,
+        };
+
+        await testOcclusion(appDisplay);
+        await testReparent();
+        await testRotation();
+
+        Main.overview.dash.showAppsButton.checked = false;
+        await Scripting.waitLeisure();
+        Main.overview.hide();
+        await Scripting.waitLeisure();
+    } finally {
+        uninstallApps();
+    }
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (nSteps === 0)
+        throw new Error('The drag did not hover anything');
+
+    if (mismatches.length > 0)
+        throw new Error(`Drop targets differ from picks:\n${mismatches.join('\n')}`);
+
+    if (failures.length > 0)
+        throw new Error(failures.join('\n'));
+}
@@ -0,0 +1,162 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Clutter from 'gi://Clutter';
+import GObject from 'gi://GObject';
+import St from 'gi://St';
+
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+// This script measures the time it takes to paint the stage with the
+// magnifier active, at increasing zoom factors. Each is compared to
+// painting a plain clone of the whole uiGroup, as the magnifier used to.
+
+export var METRICS = {};
+
+const ZOOM_FACTORS = [1.5, 2, 4, 8, 16];
+const N_FRAMES = 60;
+
+// Chrome spread over the screen, so that there is UI to skip everywhere
+const N_GRID_COLUMNS = 16;
+const N_GRID_ROWS = 16;
+
+const failures = [];
+
+/**
+ * @returns {St.Widget[]} labels covering the screen, added to uiGroup
+ */
+function addGrid() {
+    const width = global.screen_width / N_GRID_COLUMNS;
+    const height = global.screen_height / N_GRID_ROWS;
+    const labels = [];
+
+    for (let row = 0; row < N_GRID_ROWS; row++) {
+        for (let column = 0; column < N_GRID_COLUMNS; column++) {
+            const label = new St.Label({
+                text: `${column}, ${row}`,
+                style: 'background-color: rgba(255, 255, 255, 0.2);' +
+                    'border-radius: 8px; box-shadow: 0 2px 4px black;',
+                x: column * width,
+                y: row * height,
+                width: width - 4,
+                height: height - 4,
+            });
+            Main.uiGroup.add_child(label);
+            labels.push(label);
+        }
+    }
+
+    return labels;
+}
+
+/**
+ * Stands in a plain clone of uiGroup for the culling clone
+ *
+ * @param {Clutter.Actor} uiGroupClone - the magnifier's clone of uiGroup
+ * @returns {Function} that removes the plain clone again
+ */
+function addPlainClone(uiGroupClone) {
+    const plainClone = new Clutter.Clone({
+        source: Main.uiGroup,
+        clip_to_allocation: true,
+    });
+    uiGroupClone.get_parent().insert_child_above(plainClone, uiGroupClone);
+    uiGroupClone.hide();
+
+    const bindings = ['x', 'y', 'scale-x', 'scale-y'].map(prop =>
+        uiGroupClone.bind_property(prop, plainClone, prop,
+            GObject.BindingFlags.SYNC_CREATE));
+
+    return () => {
+        bindings.forEach(binding => binding.unbind());
+        plainClone.destroy();
+        uiGroupClone.show();
+    };
+}
+
+async function measureFrames(zoomRegion) {
+    /* eslint-disable no-await-in-loop */
+    const [width, height] = [global.screen_width, global.screen_height];
+    const times = [];
+    let painted = 0, culled = 0;
+
+    for (let i = 0; i < N_FRAMES; i++) {
+        // Move the region of interest around, like a moving pointer would
+        zoomRegion.scrollContentsTo(
+            (width / N_FRAMES) * i, (height / N_FRAMES) * i);
+        times.push(await Scripting.measureFrame());
+
+        painted += zoomRegion._uiGroupClone.paintedCount;
+        culled += zoomRegion._uiGroupClone.culledCount;
+    }
+
+    times.sort((a, b) => a - b);
+    return {
+        time: times[Math.floor(times.length / 2)],
+        painted: painted / N_FRAMES,
+        culled: culled / N_FRAMES,
+    };
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    /* eslint-disable no-await-in-loop */
+    const labels = addGrid();
+
+    Main.magnifier.setActive(true);
+    const [zoomRegion] = Main.magnifier.getZoomRegions();
+
+    for (const factor of ZOOM_FACTORS) {
+        zoomRegion.setMagFactor(factor, factor);
+        await Scripting.waitLeisure();
+
+        const culled = await measureFrames(zoomRegion);
+
+        const removePlainClone = addPlainClone(zoomRegion._uiGroupClone);
+        await Scripting.waitLeisure();
+        const plain = await measureFrames(zoomRegion);
+        removePlainClone();
+
+        const suffix = `${String(factor).replace('.', '_')}x`;
+        METRICS[`magnifierPaintTime${suffix}`] = {
+            description: `Median time to paint a frame at ${factor}x zoom`,
+            units: 'us',
+            value: culled.time,
+        };
+        METRICS[`magnifierPlainPaintTime${suffix}`] = {
+            description: `Median time to paint a frame at ${factor}x zoom, cloning all of uiGroup`,
+            units: 'us',
+            value: plain.time,
+        };
+        METRICS[`magnifierPaintedActors${suffix}`] = {
+            description: `Mean number of cloned actors painted at ${factor}x zoom`,
+            units: 'actors',
+            value: culled.painted,
+        };
+
+        // Expect at least half of the grid outside the region of interest
+        // to be skipped
+        const minCulled = labels.length * (1 - 1 / (factor * factor)) / 2;
+        if (culled.culled < minCulled) {
+            failures.push(`Only ${culled.culled} actors were skipped at ${factor}x, ` +
+                `${culled.painted} were painted`);
+        }
+    }
+
+    Main.magnifier.setActive(false);
+    labels.forEach(label => label.destroy());
+    await Scripting.waitLeisure();
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (failures.length > 0)
+        throw new Error(failures.join('\n'));
+}
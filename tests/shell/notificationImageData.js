@@ -0,0 +1,128 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import GLib from 'gi://GLib';
+import Shell from 'gi://Shell';
+import St from 'gi://St';
+
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+// This script tests that notification image data is downscaled to the
+// size it is shown at, at most once per resource scale, that identical
+// images share one texture and that invalid image data is rejected.
+
+export var METRICS = {};
+
+const MAX_SIZE = 48;
+
+/**
+ * @param {number} width - the width of the image
+ * @param {number} height - the height of the image
+ * @param {number} value - the value of every channel of every pixel
+ * @param {object} params - overrides for the image data fields
+ * @returns {GLib.Variant} image data as sent in an `image-data` hint
+ */
+function createImageData(width, height, value, params = {}) {
+    const {
+        rowstride = width * 4,
+        hasAlpha = true,
+        nChannels = 4,
+        length = rowstride * height,
+    } = params;
+
+    return new GLib.Variant('(iiibiiay)', [
+        width, height, rowstride, hasAlpha, 8, nChannels,
+        new Uint8Array(length).fill(value),
+    ]);
+}
+
+function assertSize(image, width, height, what) {
+    if (!(image instanceof St.ImageContent))
+        throw new Error(`No image was created for ${what}`);
+
+    const {preferredWidth, preferredHeight} = image;
+    if (preferredWidth !== width || preferredHeight !== height) {
+        throw new Error(`The image for ${what} is ${preferredWidth}x${preferredHeight}, ` +
+            `expected ${width}x${height}`);
+    }
+}
+
+function testDownscale() {
+    const image = Shell.util_get_image_from_image_data(
+        createImageData(256, 128, 0x80), MAX_SIZE);
+    assertSize(image, MAX_SIZE, MAX_SIZE / 2, 'a large image');
+
+    const small = Shell.util_get_image_from_image_data(
+        createImageData(16, 8, 0x80), MAX_SIZE);
+    assertSize(small, 16, 8, 'a small image');
+}
+
+function testSharing() {
+    const image = Shell.util_get_image_from_image_data(
+        createImageData(64, 64, 0x10), MAX_SIZE);
+    const same = Shell.util_get_image_from_image_data(
+        createImageData(64, 64, 0x10), MAX_SIZE);
+    const other = Shell.util_get_image_from_image_data(
+        createImageData(64, 64, 0x20), MAX_SIZE);
+    const larger = Shell.util_get_image_from_image_data(
+        createImageData(64, 64, 0x10), 2 * MAX_SIZE);
+
+    if (image !== same)
+        throw new Error('Identical images do not share a texture');
+    if (image === other)
+        throw new Error('Different images share a texture');
+    if (image === larger)
+        throw new Error('Images for different sizes share a texture');
+}
+
+function testInvalid() {
+    const invalid = {
+        'the wrong variant type': new GLib.Variant('(ii)', [16, 16]),
+        'truncated pixel data': createImageData(16, 16, 0, {length: 16 * 4 * 15}),
+        'a rowstride shorter than a row': createImageData(16, 16, 0, {rowstride: 16}),
+        'a channel count not matching the alpha flag':
+            createImageData(16, 16, 0, {hasAlpha: false}),
+        'an empty image': createImageData(0, 16, 0),
+    };
+
+    for (const [what, imageData] of Object.entries(invalid)) {
+        if (Shell.util_get_image_from_image_data(imageData, MAX_SIZE))
+            throw new Error(`An image was created for ${what}`);
+    }
+}
+
+function testResourceScale() {
+    const {scaleFactor} = St.ThemeContext.get_for_stage(global.stage);
+    let maxScale = scaleFactor;
+    for (let i = 0; i < global.display.get_n_monitors(); i++)
+        maxScale = Math.max(maxScale, global.display.get_monitor_scale(i));
+
+    // The daemon shows images at 48 logical pixels, which take up this
+    // many device pixels on the monitor with the largest scale
+    const size = Math.ceil(MAX_SIZE * maxScale);
+
+    const daemon = Main.notificationDaemon._fdoNotificationDaemon;
+    const image = daemon._imageForNotificationData({
+        'image-data': createImageData(1024, 1024, 0x40),
+    });
+    assertSize(image, size, size, 'a notification');
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    await Scripting.waitLeisure();
+
+    testDownscale();
+    testSharing();
+    testInvalid();
+    testResourceScale();
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+}
@@ -0,0 +1,186 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import GLib from 'gi://GLib';
+import * as System from 'system';
+
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as MessageTray from 'resource:///org/gnome/shell/ui/messageTray.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+// This script tests that a source flooding the message tray with
+// notifications is rate limited, and neither blocks the main loop,
+// delays frames nor accumulates notifications or memory.
+
+const N_NOTIFICATIONS = 10000;
+const BATCH_SIZE = 500;
+
+// Upper bounds for the time spent handling a batch and painting the
+// frame after it, for the number of notifications and banners that may
+// be alive at any time, and for the memory the storm may leave behind
+const MAX_BATCH_TIME_MS = 250;
+const MAX_FRAME_TIME_MS = 500;
+const MAX_LIVE_NOTIFICATIONS = 3;
+const MAX_SHOWN_BANNERS = 20;
+const MAX_MEMORY_GROWTH = 16 * 1024 * 1024;
+
+export var METRICS = {
+    maxBatchTime: {
+        description: `Longest time to handle ${BATCH_SIZE} notifications`,
+        units: 'us',
+    },
+    maxFrameTime: {
+        description: 'Longest time from sending a batch of notifications to the next frame',
+        units: 'us',
+    },
+    stormMemoryGrowth: {
+        description: 'Malloc memory in use after the storm, compared to before',
+        units: 'B',
+    },
+};
+
+let maxBatchTime = 0;
+let maxFrameTime = 0;
+let maxLiveNotifications = 0;
+let bannersShown = 0;
+let notificationsExpired = 0;
+let summaryShown = false;
+
+let haveMallocStats = false;
+let mallocUsedSize = 0;
+let usedBeforeStorm = 0;
+let usedAfterStorm = 0;
+
+/**
+ * @returns {Promise} that resolves once the next frame was painted
+ */
+function waitFrame() {
+    return new Promise(resolve => {
+        const {stage} = global;
+        const afterId = stage.connect('after-paint', () => {
+            stage.disconnect(afterId);
+            resolve();
+        });
+        stage.queue_redraw();
+    });
+}
+
+async function collectMemory(eventName) {
+    System.gc();
+    await Scripting.sleep(100);
+    Scripting.collectStatistics();
+    Scripting.scriptEvent(eventName);
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    /* eslint-disable no-await-in-loop */
+    Scripting.defineScriptEvent('stormStart', 'Starting to send notifications');
+    Scripting.defineScriptEvent('stormDone', 'Done with all notifications');
+
+    const source = new MessageTray.SystemNotificationSource();
+    Main.messageTray.add(source);
+
+    source.connect('notification-show', (s, notification) => {
+        bannersShown++;
+        if (notification.bannerBodyText?.includes('more notifications'))
+            summaryShown = true;
+    });
+
+    await Scripting.waitLeisure();
+    await collectMemory('stormStart');
+
+    for (let i = 0; i < N_NOTIFICATIONS; i += BATCH_SIZE) {
+        const startTime = GLib.get_monotonic_time();
+
+        for (let j = i; j < i + BATCH_SIZE; j++) {
+            const notification = new MessageTray.Notification(source,
+                `Message ${j}`, `Body of message ${j}`);
+            notification.connect('destroy', (n, reason) => {
+                if (reason === MessageTray.NotificationDestroyedReason.EXPIRED)
+                    notificationsExpired++;
+            });
+            source.showNotification(notification);
+
+            // Callers keep using notifications after showing them
+            notification.connect('activated', () => {});
+        }
+
+        const batchTime = (GLib.get_monotonic_time() - startTime) / 1000;
+        maxBatchTime = Math.max(maxBatchTime, batchTime);
+        maxLiveNotifications =
+            Math.max(maxLiveNotifications, source.notifications.length);
+
+        await waitFrame();
+        const frameTime = (GLib.get_monotonic_time() - startTime) / 1000;
+        maxFrameTime = Math.max(maxFrameTime, frameTime);
+    }
+
+    // Give the summary a chance to show up
+    await Scripting.sleep(1000);
+    await Scripting.waitLeisure();
+
+    source.destroy();
+    await Scripting.waitLeisure();
+    await collectMemory('stormDone');
+
+    METRICS.maxBatchTime.value = Math.round(maxBatchTime * 1000);
+    METRICS.maxFrameTime.value = Math.round(maxFrameTime * 1000);
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * @param {number} _time - event timestamp
+ * @returns {void}
+ */
+export function script_stormStart(_time) {
+    usedBeforeStorm = mallocUsedSize;
+}
+
+/**
+ * @param {number} _time - event timestamp
+ * @returns {void}
+ */
+export function script_stormDone(_time) {
+    usedAfterStorm = mallocUsedSize;
+    METRICS.stormMemoryGrowth.value = usedAfterStorm - usedBeforeStorm;
+}
+
+/**
+ * @param {number} time - event timestamp
+ * @param {number} bytes - event data
+ * @returns {void}
+ */
+export function malloc_usedSize(time, bytes) {
+    haveMallocStats = true;
+    mallocUsedSize = bytes;
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (maxBatchTime > MAX_BATCH_TIME_MS)
+        throw new Error(`Handling a batch took ${maxBatchTime} ms`);
+
+    if (maxFrameTime > MAX_FRAME_TIME_MS)
+        throw new Error(`A frame after a batch took ${maxFrameTime} ms`);
+
+    if (maxLiveNotifications > MAX_LIVE_NOTIFICATIONS)
+        throw new Error(`${maxLiveNotifications} notifications were kept alive`);
+
+    if (bannersShown > MAX_SHOWN_BANNERS)
+        throw new Error(`${bannersShown} banners were shown`);
+
+    if (notificationsExpired < N_NOTIFICATIONS - MAX_SHOWN_BANNERS)
+        throw new Error(`Only ${notificationsExpired} notifications were coalesced`);
+
+    if (!summaryShown)
+        throw new Error('No summary notification was shown');
+
+    // Malloc statistics are only available with glibc
+    if (haveMallocStats && usedAfterStorm - usedBeforeStorm > MAX_MEMORY_GROWTH)
+        throw new Error(`The storm left ${usedAfterStorm - usedBeforeStorm} bytes in use`);
+}
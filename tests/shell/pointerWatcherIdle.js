@@ -0,0 +1,76 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Clutter from 'gi://Clutter';
+import GLib from 'gi://GLib';
+
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as PointerWatcher from 'resource:///org/gnome/shell/ui/pointerWatcher.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+// This script tests that the pointer watcher doesn't wake up while the
+// pointer is still, and that it follows the pointer once it moves.
+
+export var METRICS = {};
+
+const WATCH_INTERVAL_MS = 100;
+const IDLE_TIME_MS = 2000;
+
+const failures = [];
+
+/**
+ * run:
+ */
+export async function run() {
+    const seat = Clutter.get_default_backend().get_default_seat();
+    const pointer = seat.create_virtual_device(Clutter.InputDeviceType.POINTER_DEVICE);
+    const moveTo = (x, y) =>
+        pointer.notify_absolute_motion(GLib.get_monotonic_time(), x, y);
+
+    Main.overview.hide();
+    moveTo(100, 100);
+    await Scripting.waitLeisure();
+
+    const watcher = PointerWatcher.getPointerWatcher();
+    const positions = [];
+    const watch = watcher.addWatch(WATCH_INTERVAL_MS,
+        (x, y) => positions.push([x, y]));
+
+    try {
+        // Idle with the watch installed
+        let wakeups = watcher.wakeups;
+        await Scripting.sleep(IDLE_TIME_MS);
+        const idleWakeups = watcher.wakeups - wakeups;
+
+        METRICS.idleWakeups = {
+            description: 'Pointer watcher wakeups while the pointer is still',
+            units: 'wakeups',
+            value: idleWakeups,
+        };
+
+        if (idleWakeups !== 0)
+            failures.push(`The watcher woke up ${idleWakeups} times while the pointer was still`);
+
+        // Moving the pointer wakes it up, so that idling is meaningful
+        wakeups = watcher.wakeups;
+        moveTo(200, 150);
+        await Scripting.sleep(WATCH_INTERVAL_MS * 5);
+
+        if (watcher.wakeups === wakeups)
+            failures.push('The watcher did not wake up when the pointer moved');
+
+        const [x, y] = positions.at(-1) ?? [];
+        if (x !== 200 || y !== 150)
+            failures.push(`The watch was last called for ${x}, ${y} instead of 200, 150`);
+    } finally {
+        watch.remove();
+    }
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (failures.length > 0)
+        throw new Error(failures.join('\n'));
+}
@@ -0,0 +1,168 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Clutter from 'gi://Clutter';
+import Gio from 'gi://Gio';
+import GObject from 'gi://GObject';
+import Shell from 'gi://Shell';
+import St from 'gi://St';
+
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+Gio._promisify(Shell.Screenshot, 'composite_to_stream');
+
+// This script checks that a scroll view with faded edges looks the same
+// whether only the faded strips are rendered offscreen, or the whole
+// scroll view is rendered offscreen and faded by the shader. The time
+// to paint a frame while scrolling is reported for both paths.
+
+export var METRICS = {};
+
+const N_ROWS = 200;
+const N_FRAMES = 120;
+const SCROLL_STEP = 16;
+
+// Per channel; the two paths round the fade ratio differently
+const MAX_PIXEL_DIFFERENCE = 8;
+
+const failures = [];
+
+// The fade effect renders the whole scroll view offscreen as soon as
+// it has other effects, so a no-op one forces the shader path
+const NoOpEffect = GObject.registerClass(
+class NoOpEffect extends Clutter.Effect {});
+
+/**
+ * @returns {St.ScrollView} a faded scroll view, larger than the screen
+ *   is tall, with enough content to scroll
+ */
+function createScrollView() {
+    const scrollView = new St.ScrollView({
+        style: '-st-vfade-offset: 68px;',
+        width: global.screen_width / 2,
+        height: global.screen_height,
+    });
+    scrollView.set_policy(St.PolicyType.NEVER, St.PolicyType.AUTOMATIC);
+
+    const box = new St.BoxLayout({vertical: true});
+    for (let i = 0; i < N_ROWS; i++) {
+        box.add_child(new St.Label({
+            text: `Row ${i}`,
+            style: 'padding: 12px; background-color: rgba(255, 255, 255, 0.1);',
+        }));
+    }
+    scrollView.add_actor(box);
+
+    return scrollView;
+}
+
+/**
+ * @param {Clutter.Actor} actor - the actor to paint
+ * @returns {Promise<Uint8Array>} the pixels of the actor, painted with
+ *   its effects
+ */
+async function paintToPixels(actor) {
+    const content = actor.paint_to_content(null);
+    const stream = Gio.MemoryOutputStream.new_resizable();
+    const pixbuf = await Shell.Screenshot.composite_to_stream(
+        content.get_texture(),
+        0, 0, -1, -1,
+        1,
+        null, 0, 0, 1,
+        stream);
+    stream.close(null);
+
+    return pixbuf.read_pixel_bytes().toArray();
+}
+
+function maxDifference(pixels, otherPixels) {
+    if (pixels.length !== otherPixels.length)
+        return Infinity;
+
+    let max = 0;
+    for (let i = 0; i < pixels.length; i++)
+        max = Math.max(max, Math.abs(pixels[i] - otherPixels[i]));
+    return max;
+}
+
+async function measureScrolling(vadjustment) {
+    /* eslint-disable no-await-in-loop */
+    vadjustment.value = SCROLL_STEP;
+    await Scripting.waitLeisure();
+
+    const times = [];
+    for (let i = 0; i < N_FRAMES; i++) {
+        // Stay away from the ends, so both edges stay faded
+        const range = vadjustment.upper - vadjustment.page_size;
+        vadjustment.value = SCROLL_STEP + (i * SCROLL_STEP) % (range - 2 * SCROLL_STEP);
+        times.push(await Scripting.measureFrame());
+    }
+
+    times.sort((a, b) => a - b);
+    return times[Math.floor(times.length / 2)];
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    /* eslint-disable no-await-in-loop */
+    const scrollView = createScrollView();
+    Main.uiGroup.add_child(scrollView);
+    await Scripting.waitLeisure();
+
+    if (!scrollView.get_effect('fade'))
+        throw new Error('Scroll view has no fade effect');
+
+    const {vadjustment} = scrollView.vscroll;
+    const range = vadjustment.upper - vadjustment.page_size;
+    const noOpEffect = new NoOpEffect();
+
+    // At the top only the bottom edge is faded, both edges further down
+    for (const value of [0, SCROLL_STEP, range / 2]) {
+        vadjustment.value = value;
+        await Scripting.waitLeisure();
+        const stripPixels = await paintToPixels(scrollView);
+
+        scrollView.add_effect(noOpEffect);
+        const shaderPixels = await paintToPixels(scrollView);
+        scrollView.remove_effect(noOpEffect);
+
+        const difference = maxDifference(stripPixels, shaderPixels);
+        if (difference > MAX_PIXEL_DIFFERENCE) {
+            failures.push(`Faded strips differ from the shader by ${difference} ` +
+                `when scrolled to ${value}`);
+        }
+    }
+
+    const stripTime = await measureScrolling(vadjustment);
+
+    scrollView.add_effect(noOpEffect);
+    const shaderTime = await measureScrolling(vadjustment);
+    scrollView.remove_effect(noOpEffect);
+
+    METRICS.scrollViewFadePaintTime = {
+        description: 'Median time to paint a frame while scrolling a faded scroll view',
+        units: 'us',
+        value: stripTime,
+    };
+    METRICS.scrollViewFadeOffscreenPaintTime = {
+        description: 'Median time to paint a frame while scrolling a faded scroll view offscreen',
+        units: 'us',
+        value: shaderTime,
+    };
+
+    scrollView.destroy();
+    await Scripting.waitLeisure();
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (failures.length > 0)
+        throw new Error(failures.join('\n'));
+}
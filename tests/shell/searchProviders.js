@@ -0,0 +1,212 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+
+import * as Main from 'resource:///org/gnome/shell/ui/main.js';
+import * as RemoteSearch from 'resource:///org/gnome/shell/ui/remoteSearch.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+import {loadInterfaceXML} from 'resource:///org/gnome/shell/misc/dbusUtils.js';
+
+// This script tests that a search provider that answers slower than the
+// search latency budget doesn't hold up the results of faster ones, and
+// is moved after them once it keeps being slow.
+
+export var METRICS = {};
+
+const SearchProvider2Iface = loadInterfaceXML('org.gnome.ShellSearchProvider2');
+
+const OBJECT_PATH_PREFIX = '/org/gnome/Shell/Test/SearchProvider';
+
+// Comfortably above and below the 250 ms budget of search.js
+const FAST_PROVIDER_DELAY = 20;
+const SLOW_PROVIDER_DELAY = 800;
+
+// Each search uses new terms, so that no results are cached
+const SEARCHES = ['alpha', 'bravo', 'charlie'];
+
+const TIMEOUT_MS = 10000;
+
+const failures = [];
+
+class MockSearchProvider {
+    constructor(name, delay) {
+        this.name = name;
+        this.delay = delay;
+        this.roundTrips = 0;
+        this.searchedTerms = [];
+        this.objectPath = `${OBJECT_PATH_PREFIX}/${name}`;
+
+        this._dbusImpl = Gio.DBusExportedObject.wrapJSObject(SearchProvider2Iface, this);
+        this._dbusImpl.export(Gio.DBus.session, this.objectPath);
+    }
+
+    destroy() {
+        this._dbusImpl.unexport();
+    }
+
+    _reply(invocation, signature, value) {
+        this.roundTrips++;
+        GLib.timeout_add(GLib.PRIORITY_DEFAULT, this.delay, () => {
+            invocation.return_value(new GLib.Variant(signature, [value]));
+            return GLib.SOURCE_REMOVE;
+        });
+    }
+
+    GetInitialResultSetAsync([terms], invocation) {
+        this.searchedTerms.push(...terms);
+        this._reply(invocation, '(as)', terms.map(t => `${this.name}-${t}`));
+    }
+
+    GetSubsearchResultSetAsync([previousResults_, terms], invocation) {
+        this.searchedTerms.push(...terms);
+        this._reply(invocation, '(as)', terms.map(t => `${this.name}-${t}`));
+    }
+
+    GetResultMetasAsync([ids], invocation) {
+        this._reply(invocation, '(aa{sv})', ids.map(id => ({
+            id: new GLib.Variant('s', id),
+            name: new GLib.Variant('s', id),
+        })));
+    }
+
+    ActivateResult() {
+    }
+
+    LaunchSearch() {
+    }
+}
+
+function createProvider(mock) {
+    const keyFile = new GLib.KeyFile();
+    keyFile.set_string('Desktop Entry', 'Type', 'Application');
+    keyFile.set_string('Desktop Entry', 'Name', mock.name);
+    keyFile.set_string('Desktop Entry', 'Exec', 'true');
+
+    const appInfo = Gio.DesktopAppInfo.new_from_keyfile(keyFile);
+    const provider = new RemoteSearch.RemoteSearchProvider2(appInfo,
+        Gio.DBus.session.get_unique_name(), mock.objectPath, false);
+
+    // Apps created from key files have no id of their own
+    provider.id = `${mock.name}.desktop`;
+    return provider;
+}
+
+function getFirstResultId(provider) {
+    return provider.display.getFirstResult()?.metaInfo.id ?? null;
+}
+
+async function waitFor(checkFunc, what) {
+    /* eslint-disable no-await-in-loop */
+    const start = GLib.get_monotonic_time();
+    while (!checkFunc()) {
+        if (GLib.get_monotonic_time() - start > TIMEOUT_MS * 1000)
+            throw new Error(`Timed out waiting for ${what}`);
+        await Scripting.sleep(10);
+    }
+    /* eslint-enable no-await-in-loop */
+}
+
+function check(condition, message) {
+    if (!condition)
+        failures.push(message);
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    /* eslint-disable no-await-in-loop */
+    const {searchController} = Main.overview;
+    const searchResults = searchController._searchResults;
+
+    const slowMock = new MockSearchProvider('Slow', SLOW_PROVIDER_DELAY);
+    const fastMock = new MockSearchProvider('Fast', FAST_PROVIDER_DELAY);
+
+    // The slow provider starts out first
+    const slow = createProvider(slowMock);
+    const fast = createProvider(fastMock);
+    searchController.addProvider(slow);
+    searchController.addProvider(fast);
+
+    try {
+        Main.overview.show();
+        await Scripting.waitLeisure();
+
+        let maxProgressTime = 0;
+        for (const [i, term] of SEARCHES.entries()) {
+            const startTime = GLib.get_monotonic_time();
+            Main.overview.searchEntry.text = term;
+
+            await waitFor(() => getFirstResultId(fast) === `Fast-${term}`,
+                `results of the fast provider for "${term}"`);
+            await waitFor(() => !searchResults.searchInProgress,
+                `the search for "${term}" to stop holding up progress`);
+            const progressTime = (GLib.get_monotonic_time() - startTime) / 1000;
+            maxProgressTime = Math.max(maxProgressTime, progressTime);
+
+            check(getFirstResultId(slow) !== `Slow-${term}`,
+                `Results of the slow provider for "${term}" arrived within the budget`);
+            check(progressTime < SLOW_PROVIDER_DELAY,
+                `Search for "${term}" was held up for ${progressTime} ms`);
+
+            await waitFor(() => slow.searchStats.searches === i + 1,
+                `the slow provider to answer "${term}"`);
+            await waitFor(() => getFirstResultId(slow) === `Slow-${term}`,
+                `late results of the slow provider for "${term}"`);
+        }
+
+        const providers = searchResults._providers;
+        check(slow.searchStats.demoted, 'The slow provider was not demoted');
+        check(!fast.searchStats.demoted, 'The fast provider was demoted');
+        check(providers.indexOf(slow) > providers.indexOf(fast),
+            'The slow provider is still listed before the fast one');
+
+        // Searches superseded before the slow provider answers don't
+        // show its stale results
+        Main.overview.searchEntry.text = 'delta';
+        await waitFor(() => slowMock.searchedTerms.includes('delta'),
+            'the slow provider to be asked for "delta"');
+        Main.overview.searchEntry.text = 'echo';
+        await waitFor(() => getFirstResultId(slow) === 'Slow-echo',
+            'results of the slow provider for "echo"');
+        await Scripting.sleep(SLOW_PROVIDER_DELAY);
+        check(getFirstResultId(slow) === 'Slow-echo',
+            'Results of a superseded search were shown');
+
+        // Repeated searches are answered from the cache
+        const roundTrips = slowMock.roundTrips;
+        Main.overview.searchEntry.text = '';
+        await Scripting.waitLeisure();
+        Main.overview.searchEntry.text = 'echo';
+        await waitFor(() => getFirstResultId(slow) === 'Slow-echo',
+            'cached results of the slow provider');
+        check(slowMock.roundTrips === roundTrips,
+            'A repeated search was sent to the provider again');
+
+        METRICS.maxProgressTime = {
+            description: 'Longest time a search was shown as in progress',
+            units: 'ms',
+            value: Math.round(maxProgressTime),
+        };
+
+        Main.overview.searchEntry.text = '';
+        Main.overview.hide();
+        await Scripting.waitLeisure();
+    } finally {
+        searchController.removeProvider(slow);
+        searchController.removeProvider(fast);
+        slowMock.destroy();
+        fastMock.destroy();
+    }
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (failures.length > 0)
+        throw new Error(failures.join('\n'));
+}
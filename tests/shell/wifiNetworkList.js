@@ -0,0 +1,180 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+import NM from 'gi://NM';
+
+import * as PopupMenu from 'resource:///org/gnome/shell/ui/popupMenu.js';
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+// This script tests that a burst of access points showing up, and
+// jitter in their signal strength, neither blocks the main loop nor
+// keeps reordering the list of Wi-Fi networks.
+
+Gio._promisify(Gio.DBusConnection.prototype, 'call');
+Gio._promisify(NM.Client, 'new_async');
+
+export var METRICS = {};
+
+const N_ACCESS_POINTS = 500;
+const N_NETWORKS = 100;
+const JITTER_AMPLITUDE = 4;
+const N_JITTER_ROUNDS = 5;
+
+// Must match the constant in status/network.js
+const MAX_VISIBLE_NETWORKS = 8;
+
+// Upper bounds for the longest main loop iteration, and for the number
+// of network items created or moved while handling the burst
+const MAX_STALL_TIME_MS = 250;
+const MAX_BURST_ITEM_CHANGES = 5 * MAX_VISIBLE_NETWORKS;
+
+const STALL_CHECK_INTERVAL_MS = 10;
+
+const MockIface = 'org.freedesktop.DBus.Mock';
+
+let itemsCreated = 0;
+let itemsMoved = 0;
+let liveItems = 0;
+let maxLiveItems = 0;
+let maxStallTime = 0;
+let burstItemChanges = 0;
+let jitterReorders = 0;
+
+function isNetworkItem(menuItem) {
+    return menuItem.has_style_class_name?.('nm-network-item');
+}
+
+function trackNetworkItems() {
+    const {prototype} = PopupMenu.PopupMenuSection;
+    const {addMenuItem, moveMenuItem} = prototype;
+
+    prototype.addMenuItem = function (menuItem, position) {
+        if (isNetworkItem(menuItem)) {
+            itemsCreated++;
+            maxLiveItems = Math.max(maxLiveItems, ++liveItems);
+            menuItem.connect('destroy', () => liveItems--);
+        }
+        return addMenuItem.call(this, menuItem, position);
+    };
+
+    prototype.moveMenuItem = function (menuItem, position) {
+        if (isNetworkItem(menuItem))
+            itemsMoved++;
+        return moveMenuItem.call(this, menuItem, position);
+    };
+
+    return () => {
+        prototype.addMenuItem = addMenuItem;
+        prototype.moveMenuItem = moveMenuItem;
+    };
+}
+
+function trackMainLoopStalls() {
+    let lastTime = GLib.get_monotonic_time();
+    const id = GLib.timeout_add(GLib.PRIORITY_HIGH, STALL_CHECK_INTERVAL_MS, () => {
+        const now = GLib.get_monotonic_time();
+        const stallTime = (now - lastTime) / 1000 - STALL_CHECK_INTERVAL_MS;
+        maxStallTime = Math.max(maxStallTime, stallTime);
+        lastTime = now;
+        return GLib.SOURCE_CONTINUE;
+    });
+
+    return () => GLib.source_remove(id);
+}
+
+async function callMock(method, params, replyType = null) {
+    const reply = await Gio.DBus.system.call(
+        'org.freedesktop.NetworkManager',
+        '/org/freedesktop/NetworkManager',
+        MockIface,
+        method,
+        params,
+        replyType ? new GLib.VariantType(replyType) : null,
+        Gio.DBusCallFlags.NONE,
+        -1,
+        null);
+    return reply?.deepUnpack();
+}
+
+async function waitForAccessPoints(client, devicePath, nAccessPoints) {
+    /* eslint-disable no-await-in-loop */
+    let device;
+    while (device?.get_access_points().length !== nAccessPoints) {
+        await Scripting.sleep(100);
+        device = client.get_device_by_path(devicePath);
+    }
+    /* eslint-enable no-await-in-loop */
+
+    // Let the shell handle pending changes
+    await Scripting.waitLeisure();
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    /* eslint-disable no-await-in-loop */
+    const client = await NM.Client.new_async(null);
+    const [devicePath] = await callMock('AddBurstWiFiDevice',
+        new GLib.Variant('(s)', ['burst0']), '(o)');
+    await waitForAccessPoints(client, devicePath, 0);
+
+    const untrackItems = trackNetworkItems();
+    const untrackStalls = trackMainLoopStalls();
+
+    await callMock('AddAccessPointBurst',
+        new GLib.Variant('(ssuu)',
+            [devicePath, 'ap', N_ACCESS_POINTS, N_NETWORKS]));
+    await waitForAccessPoints(client, devicePath, N_ACCESS_POINTS);
+
+    burstItemChanges = itemsCreated + itemsMoved;
+    const burstStallTime = maxStallTime;
+
+    for (let i = 0; i < N_JITTER_ROUNDS; i++) {
+        await callMock('JitterAccessPoints',
+            new GLib.Variant('(sy)', [devicePath, JITTER_AMPLITUDE]));
+        await Scripting.sleep(100);
+        await Scripting.waitLeisure();
+    }
+
+    jitterReorders = itemsCreated + itemsMoved - burstItemChanges;
+
+    untrackStalls();
+    untrackItems();
+
+    METRICS.burstStallTime = {
+        description: `Longest main loop iteration while adding ${N_ACCESS_POINTS} access points`,
+        units: 'us',
+        value: Math.round(burstStallTime * 1000),
+    };
+    METRICS.burstItemChanges = {
+        description: 'Network items created or moved while adding access points',
+        units: 'items',
+        value: burstItemChanges,
+    };
+    METRICS.jitterReorders = {
+        description: 'Network items created or moved by signal strength jitter',
+        units: 'items',
+        value: jitterReorders,
+    };
+    /* eslint-enable no-await-in-loop */
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (maxStallTime > MAX_STALL_TIME_MS)
+        throw new Error(`The main loop was blocked for ${maxStallTime} ms`);
+
+    if (maxLiveItems > MAX_VISIBLE_NETWORKS)
+        throw new Error(`${maxLiveItems} network items were created`);
+
+    if (burstItemChanges > MAX_BURST_ITEM_CHANGES)
+        throw new Error(`Network items changed ${burstItemChanges} times`);
+
+    if (jitterReorders > 0)
+        throw new Error(`Signal strength jitter reordered ${jitterReorders} items`);
+}
@@ -0,0 +1,280 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+/* eslint camelcase: ["error", { properties: "never", allow: ["^script_"] }] */
+
+import Gio from 'gi://Gio';
+import GLib from 'gi://GLib';
+import Shell from 'gi://Shell';
+
+import * as Scripting from 'resource:///org/gnome/shell/ui/scripting.js';
+
+import * as TestApps from '../common/testApps.js';
+
+// This script tests that applications resolved from the properties of
+// many windows match the ones found by the uncached heuristics, also
+// for a mapped window, and that resolutions are forgotten when
+// installed apps change.
+
+export var METRICS = {};
+
+const N_WINDOW_KINDS = 200;
+const N_WINDOWS = 5000;
+
+const INSTALL_TIMEOUT_MS = 10000;
+
+const FIXTURES_DIR = GLib.build_filenamev([
+    GLib.path_get_dirname(GLib.filename_from_uri(import.meta.url)[0]),
+    '..', 'data', 'applications',
+]);
+const LATE_FIXTURE = 'org.gnome.Shell.TestTracker.Late.desktop';
+// The app of the windows of gnome-shell-perf-helper
+const PERF_HELPER_FIXTURE = 'org.gnome.Shell.PerfHelper.desktop';
+
+const WM_CLASSES = [
+    null,
+    'test-tracker-startup',
+    'Test-tracker-startup',
+    'crx_testtrackerabcdefghijklmnop',
+    'Chromium',
+    'test-tracker-browser',
+    'org.gnome.Shell.TestTracker.Exact',
+    'Org.gnome.Shell.TestTracker.Exact',
+    'Test Tracker Eclipse',
+    'test-tracker-eclipse',
+    'test-tracker-vendor',
+    'Test-Tracker-Vendor',
+    'test-tracker-sandboxed',
+    'org.gnome.Shell.TestTracker.Sandboxed.Helper',
+    'test-tracker-late',
+    ...Array.from({length: 10}, (_, i) => `test-tracker-unknown-${i}`),
+];
+const GTK_APPLICATION_IDS = [
+    null,
+    null,
+    'org.gnome.Shell.TestTracker.GApplication',
+    'org.gnome.Shell.TestTracker.Unknown',
+];
+const SANDBOXED_APP_IDS = [
+    null,
+    null,
+    null,
+    'org.gnome.Shell.TestTracker.Sandboxed',
+    'org.gnome.Shell.TestTracker.Unknown',
+];
+
+const mismatches = [];
+const invalidationErrors = [];
+const windowErrors = [];
+
+let seed = 42;
+
+/**
+ * @param {number} n - upper bound
+ * @returns {number} - a pseudo-random integer in [0, n)
+ */
+function random(n) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    return seed % n;
+}
+
+function randomItem(items) {
+    return items[random(items.length)];
+}
+
+function createWindowKinds() {
+    return Array.from({length: N_WINDOW_KINDS}, () => ({
+        wmClass: randomItem(WM_CLASSES),
+        wmInstance: randomItem(WM_CLASSES),
+        gtkApplicationId: randomItem(GTK_APPLICATION_IDS),
+        sandboxedAppId: randomItem(SANDBOXED_APP_IDS),
+    }));
+}
+
+function resolveUncached(appSystem, window) {
+    return appSystem.resolve_window_app(window.wmClass, window.wmInstance,
+        window.gtkApplicationId, window.sandboxedAppId);
+}
+
+function lookupCached(tracker, window) {
+    return tracker.lookup_app(window.wmClass, window.wmInstance,
+        window.gtkApplicationId, window.sandboxedAppId);
+}
+
+function listFixtures() {
+    const dir = Gio.File.new_for_path(FIXTURES_DIR);
+    const enumerator = dir.enumerate_children('standard::name',
+        Gio.FileQueryInfoFlags.NONE, null);
+
+    const fixtures = [];
+    for (const info of enumerator) {
+        if (info.get_name().endsWith('.desktop'))
+            fixtures.push(info.get_name());
+    }
+    return fixtures;
+}
+
+// Runs @changeFunc, and waits until installed apps changed such that
+// @checkFunc returns true
+function changeInstalledApps(changeFunc, checkFunc) {
+    const appSystem = Shell.AppSystem.get_default();
+
+    return new Promise((resolve, reject) => {
+        const timeoutId = GLib.timeout_add(GLib.PRIORITY_DEFAULT, INSTALL_TIMEOUT_MS, () => {
+            appSystem.disconnect(changedId);
+            reject(new Error('Timed out waiting for installed apps to change'));
+            return GLib.SOURCE_REMOVE;
+        });
+        const changedId = appSystem.connect('installed-changed', () => {
+            if (!checkFunc())
+                return;
+
+            appSystem.disconnect(changedId);
+            GLib.source_remove(timeoutId);
+            resolve();
+        });
+
+        changeFunc();
+    });
+}
+
+function installFixtures(fixtures) {
+    const appsDir = TestApps.getApplicationsDir();
+    const appSystem = Shell.AppSystem.get_default();
+
+    return changeInstalledApps(() => {
+        for (const fixture of fixtures) {
+            Gio.File.new_for_path(GLib.build_filenamev([FIXTURES_DIR, fixture]))
+                .copy(appsDir.get_child(fixture), Gio.FileCopyFlags.OVERWRITE, null, null);
+        }
+    }, () => fixtures.every(f => appSystem.lookup_app(f)));
+}
+
+function uninstallFixtures(fixtures) {
+    const appsDir = TestApps.getApplicationsDir();
+    const appSystem = Shell.AppSystem.get_default();
+
+    return changeInstalledApps(() => {
+        for (const fixture of fixtures)
+            appsDir.get_child(fixture).delete(null);
+    }, () => !fixtures.some(f => appSystem.lookup_app(f)));
+}
+
+function measure(func) {
+    const start = GLib.get_monotonic_time();
+    func();
+    return GLib.get_monotonic_time() - start;
+}
+
+function getWindowProperties(window) {
+    return {
+        wmClass: window.get_wm_class(),
+        wmInstance: window.get_wm_class_instance(),
+        gtkApplicationId: window.get_gtk_application_id(),
+        sandboxedAppId: window.get_sandboxed_app_id(),
+    };
+}
+
+async function testMappedWindow(tracker, appSystem) {
+    await Scripting.createTestWindow({});
+    await Scripting.waitTestWindows();
+
+    try {
+        const windows = global.get_window_actors()
+            .map(actor => actor.meta_window)
+            .filter(w => resolveUncached(appSystem, getWindowProperties(w))
+                ?.get_id() === PERF_HELPER_FIXTURE);
+        if (windows.length === 0) {
+            windowErrors.push('No mapped window resolves to the perf helper app');
+            return;
+        }
+
+        for (const window of windows) {
+            const appId = tracker.get_window_app(window)?.get_id() ?? null;
+            if (appId !== PERF_HELPER_FIXTURE)
+                windowErrors.push(`Mapped window is tracked as ${appId}`);
+        }
+    } finally {
+        await Scripting.destroyTestWindows();
+    }
+}
+
+async function testInvalidation(tracker) {
+    const window = {
+        wmClass: 'test-tracker-late',
+        wmInstance: 'test-tracker-late',
+        gtkApplicationId: null,
+        sandboxedAppId: null,
+    };
+
+    if (lookupCached(tracker, window))
+        invalidationErrors.push('resolved an app before it was installed');
+
+    await installFixtures([LATE_FIXTURE]);
+    if (lookupCached(tracker, window)?.get_id() !== LATE_FIXTURE)
+        invalidationErrors.push('did not resolve an app once it was installed');
+
+    await uninstallFixtures([LATE_FIXTURE]);
+    if (lookupCached(tracker, window))
+        invalidationErrors.push('resolved an app after it was uninstalled');
+}
+
+/**
+ * run:
+ */
+export async function run() {
+    const tracker = Shell.WindowTracker.get_default();
+    const appSystem = Shell.AppSystem.get_default();
+    const fixtures = listFixtures().filter(f => f !== LATE_FIXTURE);
+
+    await installFixtures(fixtures);
+
+    try {
+        const kinds = createWindowKinds();
+        const windows = Array.from({length: N_WINDOWS}, () => randomItem(kinds));
+
+        let expected, actual;
+        const uncachedTime = measure(() => {
+            expected = windows.map(w => resolveUncached(appSystem, w));
+        });
+
+        const cachedTime = measure(() => {
+            actual = windows.map(w => lookupCached(tracker, w));
+        });
+
+        windows.forEach((w, i) => {
+            const expectedId = expected[i]?.get_id() ?? null;
+            const actualId = actual[i]?.get_id() ?? null;
+            if (expectedId !== actualId)
+                mismatches.push(`${JSON.stringify(w)}: ${actualId} instead of ${expectedId}`);
+        });
+
+        METRICS.uncachedResolutionTime = {
+            description: `Time to resolve the apps of ${N_WINDOWS} windows without a cache`,
+            units: 'us',
+            value: uncachedTime,
+        };
+        METRICS.cachedResolutionTime = {
+            description: `Time to resolve the apps of ${N_WINDOWS} windows`,
+            units: 'us',
+            value: cachedTime,
+        };
+
+        await testMappedWindow(tracker, appSystem);
+        await testInvalidation(tracker);
+    } finally {
+        await uninstallFixtures(fixtures);
+    }
+}
+
+/**
+ * finish:
+ */
+export function finish() {
+    if (mismatches.length > 0)
+        throw new Error(`Resolved apps differ from the uncached heuristics:\n${mismatches.join('\n')}`);
+
+    if (windowErrors.length > 0)
+        throw new Error(windowErrors.join('\n'));
+
+    if (invalidationErrors.length > 0)
+        throw new Error(`Resolution cache ${invalidationErrors.join(', ')}`);
+}
@@ -0,0 +1,157 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+// Test cases for remote search provider result caching
+
+const JsUnit = imports.jsUnit;
+
+import 'resource:///org/gnome/shell/ui/environment.js';
+
+import * as Assertions from '../common/assertions.js';
+
+import * as RemoteSearch from 'resource:///org/gnome/shell/ui/remoteSearch.js';
+
+const CORPUS = ['firefox', 'files', 'fonts', 'terminal', 'text-editor'];
+
+class MockProxy {
+    constructor() {
+        this.roundTrips = 0;
+        this._ownerChangedHandlers = [];
+    }
+
+    connect(signal, handler) {
+        if (signal === 'notify::g-name-owner')
+            this._ownerChangedHandlers.push(handler);
+        return this._ownerChangedHandlers.length;
+    }
+
+    restart() {
+        this._ownerChangedHandlers.forEach(handler => handler());
+    }
+
+    _match(ids, terms) {
+        return ids.filter(id => terms.every(t => id.includes(t)));
+    }
+
+    GetInitialResultSetAsync(terms) {
+        this.roundTrips++;
+        return Promise.resolve([this._match(CORPUS, terms)]);
+    }
+
+    GetSubsearchResultSetAsync(previousResults, terms) {
+        this.roundTrips++;
+        return Promise.resolve([this._match(previousResults, terms)]);
+    }
+
+    GetResultMetasAsync(ids) {
+        this.roundTrips++;
+        return Promise.resolve([ids.map(id => ({
+            id: {deepUnpack: () => id},
+            name: {deepUnpack: () => id.toUpperCase()},
+        }))]);
+    }
+}
+
+class MockSearchProvider extends RemoteSearch.RemoteSearchProvider {
+    _createProxy() {
+        return new MockProxy();
+    }
+}
+
+const appInfo = {get_id: () => 'mock.desktop'};
+
+// Result sets
+{
+    const provider = new MockSearchProvider(appInfo, 'org.gnome.Mock', '/', false);
+    const {proxy} = provider;
+
+    let results = await provider.getInitialResultSet(['fi'], null);
+    Assertions.assertArrayEquals('initial search', ['firefox', 'files'], results);
+    JsUnit.assertEquals('initial search round trips', 1, proxy.roundTrips);
+
+    results = await provider.getInitialResultSet([' fi '], null);
+    Assertions.assertArrayEquals('repeated search', ['firefox', 'files'], results);
+    JsUnit.assertEquals('repeated search is cached', 1, proxy.roundTrips);
+
+    results = await provider.getSubsearchResultSet(results, ['fil'], null);
+    Assertions.assertArrayEquals('subsearch', ['files'], results);
+    JsUnit.assertEquals('subsearch round trips', 2, proxy.roundTrips);
+
+    // Backspacing to a previous query is answered from the cache
+    results = await provider.getSubsearchResultSet(results, ['fi'], null);
+    Assertions.assertArrayEquals('backspace', ['firefox', 'files'], results);
+    JsUnit.assertEquals('backspace is cached', 2, proxy.roundTrips);
+
+    // Longer terms filter a cached superset instead of a full search
+    const initialCalls = [];
+    proxy.GetInitialResultSetAsync = terms => {
+        initialCalls.push(terms);
+        return MockProxy.prototype.GetInitialResultSetAsync.call(proxy, terms);
+    };
+    results = await provider.getInitialResultSet(['fir'], null);
+    Assertions.assertArrayEquals('superset', ['firefox'], results);
+    JsUnit.assertEquals('superset does not search from scratch', 0, initialCalls.length);
+
+    proxy.restart();
+    results = await provider.getInitialResultSet(['fi'], null);
+    Assertions.assertArrayEquals('after restart', ['firefox', 'files'], results);
+    JsUnit.assertEquals('restart invalidates the cache', 1, initialCalls.length);
+}
+
+// Result metas
+{
+    const provider = new MockSearchProvider(appInfo, 'org.gnome.Mock', '/', false);
+    const {proxy} = provider;
+
+    let metas = await provider.getResultMetas(['firefox', 'files'], null);
+    Assertions.assertArrayEquals('metas',
+        ['FIREFOX', 'FILES'], metas.map(m => m.name));
+    JsUnit.assertEquals('metas round trips', 1, proxy.roundTrips);
+
+    metas = await provider.getResultMetas(['files', 'fonts', 'firefox'], null);
+    Assertions.assertArrayEquals('partially cached metas',
+        ['FILES', 'FONTS', 'FIREFOX'], metas.map(m => m.name));
+    JsUnit.assertEquals('only missing metas are fetched', 2, proxy.roundTrips);
+
+    metas = await provider.getResultMetas(['fonts', 'files'], null);
+    JsUnit.assertEquals('cached metas', 2, metas.length);
+    JsUnit.assertEquals('cached metas round trips', 2, proxy.roundTrips);
+}
+
+// Metas that are dropped or reordered by the provider
+{
+    const provider = new MockSearchProvider(appInfo, 'org.gnome.Mock', '/', false);
+    const {proxy} = provider;
+
+    const {GetResultMetasAsync} = proxy;
+    proxy.GetResultMetasAsync = async ids => {
+        const [metas] = await GetResultMetasAsync.call(proxy, ids);
+        return [metas.filter(m => m.id.deepUnpack() !== 'files').reverse()];
+    };
+
+    let metas = await provider.getResultMetas(['firefox', 'files', 'fonts'], null);
+    Assertions.assertArrayEquals('reordered metas',
+        ['firefox', 'fonts'], metas.map(m => m.id));
+    Assertions.assertArrayEquals('reordered metas match their ids',
+        ['FIREFOX', 'FONTS'], metas.map(m => m.name));
+
+    proxy.GetResultMetasAsync = GetResultMetasAsync;
+    metas = await provider.getResultMetas(['files', 'fonts'], null);
+    Assertions.assertArrayEquals('dropped metas are fetched again',
+        ['FILES', 'FONTS'], metas.map(m => m.name));
+    JsUnit.assertEquals('dropped metas round trips', 2, proxy.roundTrips);
+}
+
+// Cache bounds
+{
+    const cache = new RemoteSearch.SearchCache(2, 60);
+    cache.insert('a', 1);
+    cache.insert('b', 2);
+    cache.lookup('a');
+    cache.insert('c', 3);
+
+    JsUnit.assertEquals('bounded size', 2, cache.size);
+    JsUnit.assertEquals('recently used entry kept', 1, cache.lookup('a'));
+    JsUnit.assertEquals('least recently used entry evicted', undefined, cache.lookup('b'));
+    JsUnit.assertEquals('hits', 2, cache.hits);
+    JsUnit.assertEquals('misses', 1, cache.misses);
+}
@@ -0,0 +1,40 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+// Test cases for search provider latency statistics
+
+const JsUnit = imports.jsUnit;
+
+import 'resource:///org/gnome/shell/ui/environment.js';
+
+import {ProviderSearchStats} from 'resource:///org/gnome/shell/misc/searchStats.js';
+
+const BUDGET = 250;
+
+const stats = new ProviderSearchStats(BUDGET);
+
+[10, 40, 90, 240].forEach(latency => stats.record(latency));
+JsUnit.assertEquals('searches', 4, stats.searches);
+JsUnit.assertEquals('within budget', 0, stats.overBudget);
+JsUnit.assertFalse('fast provider is not demoted', stats.demoted);
+
+// Isolated slow answers don't demote a provider
+stats.record(800);
+stats.record(100);
+stats.record(3000);
+JsUnit.assertEquals('over budget', 2, stats.overBudget);
+JsUnit.assertEquals('max latency', 3000, stats.maxLatency);
+JsUnit.assertFalse('jitter does not demote', stats.demoted);
+
+JsUnit.assertFalse('second overrun', stats.record(600));
+JsUnit.assertTrue('third consecutive overrun demotes', stats.record(700));
+JsUnit.assertTrue('demoted', stats.demoted);
+
+JsUnit.assertFalse('still demoted', stats.record(10));
+JsUnit.assertFalse('still demoted', stats.record(10));
+JsUnit.assertTrue('consistently fast provider is promoted', stats.record(10));
+JsUnit.assertFalse('promoted', stats.demoted);
+
+const {histogram} = stats.toJSON();
+JsUnit.assertEquals('histogram <=25ms', 4, histogram['<=25ms']);
+JsUnit.assertEquals('histogram <=1000ms', 3, histogram['<=1000ms']);
+JsUnit.assertEquals('histogram slower', 1, histogram['slower']);
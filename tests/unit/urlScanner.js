@@ -0,0 +1,79 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+// Differential tests of the native URL scanner against the regular
+// expression Util.findUrls() used before
+
+import 'resource:///org/gnome/shell/ui/environment.js';
+
+import * as UrlRegexp from '../common/urlRegexp.js';
+
+import * as Util from 'resource:///org/gnome/shell/misc/util.js';
+
+const corpus = [
+    '',
+    'http://',
+    'http://a',
+    'http://ab',
+    'http://a.',
+    'HTTPS://WWW.GNOME.ORG/',
+    'ftp://ftp.gnome.org/pub',
+    'www.gnome.org',
+    'www1.gnome.org and www123.gnome.org but not www1234.gnome.org',
+    'wwwgnome.org/ is not www.',
+    'gnome.org/ gnome.o/ gnome.info/ gnome.museum/ gnome.c0m/',
+    '.org/ -.org/ a-b.c-d.org/path',
+    'http://gnome.org/.,;:!?',
+    'http://gnome.org/?q=1&x=2#anchor.',
+    'http://gnome.org/wiki/Foo_(bar)',
+    'http://gnome.org/wiki/Foo_(bar)_(baz).',
+    'http://gnome.org/(a)(b)(c)',
+    'http://gnome.org/((a))',
+    'http://gnome.org/(a b)',
+    'http://gnome.org/(',
+    'http://gnome.org/()',
+    'http://(a)',
+    'http://(a)(b)',
+    '(http://gnome.org)',
+    '[http://gnome.org]',
+    '{http://gnome.org}',
+    '<http://gnome.org>',
+    '"http://gnome.org"',
+    "'http://gnome.org'",
+    '`http://gnome.org`',
+    '«http://gnome.org»',
+    '“http://gnome.org”',
+    '‘http://gnome.org’',
+    'x http://gnome.org‎',
+    'x http://gnome.org‪‬',
+    'nohttp://gnome.org',
+    'a,http://gnome.org',
+    'http://a http://b http://c',
+    'http://a\thttp://b\nhttp://c',
+    'http://a http://b　http://c http://d',
+    'http://gnome.org/http://gnome.org',
+    'http://gnome.org/[http://gnome.org]',
+    'http://exämple.org/über',
+    'café http://gnome.org/été à http://gnome.org',
+    '\u{1F600} http://gnome.org/\u{1F600}',
+    'http://\u{1F600}',
+    'http://\u{1F600}\u{1F600}.',
+    '日本 http://日本.jp/日本。',
+    'http://gnome.org/’s',
+    'user@gnome.org and mailto:user@gnome.org',
+    'www.',
+    'www..',
+    'www.(a)',
+    'www.(a).',
+    'foo.com/(a)',
+    'foo.com/(a).',
+    'a.b/c.de/',
+    'x.co.uk/ x.co.uk/path x.co.uk',
+    '((((((((((http://gnome.org))))))))))',
+    '))))http://gnome.org((((',
+];
+
+for (let i = 0; i < corpus.length; i++) {
+    UrlRegexp.assertUrlsEqual(`Test ${i}`,
+        UrlRegexp.findUrls(corpus[i]),
+        Util.findUrls(corpus[i]));
+}
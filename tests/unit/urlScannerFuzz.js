@@ -0,0 +1,112 @@
+// -*- mode: js; js-indent-level: 4; indent-tabs-mode: nil -*-
+
+// Fuzzes the native URL scanner: random text must give the same URLs
+// as the regular expression Util.findUrls() used before, and no input
+// may take more than a bounded time per byte
+
+const JsUnit = imports.jsUnit;
+
+import GLib from 'gi://GLib';
+
+import 'resource:///org/gnome/shell/ui/environment.js';
+
+import * as UrlRegexp from '../common/urlRegexp.js';
+
+import * as Util from 'resource:///org/gnome/shell/misc/util.js';
+
+const N_RANDOM_INPUTS = 20000;
+const MAX_RANDOM_ATOMS = 16;
+
+const LONG_INPUT_LENGTH = 256 * 1024;
+const N_TIMED_RUNS = 3;
+
+// Generous, to not fail on slow builders; backtracking takes seconds on
+// some of these inputs once they are a few dozen bytes long
+const MAX_TIME_PER_BYTE_NS = 500;
+
+// Fragments that exercise every part of the grammar
+const atoms = [
+    'http://', 'https://', 'ftp://', 'HTTP://', 'http:/',
+    'www.', 'WWW1.', 'www12.', 'www1234.', 'ww.',
+    'foo.com/', 'a.b.cd/', 'x.co.uk/', 'ab.c1/', 'a.abcde/', '.com/',
+    'a', 'Z', '0', '.', '/', '-', '_', '#', '?', '&', '=',
+    '(', ')', '<', '>', '[', ']', '{', '}',
+    '`', '!', ';', ':', "'", '"', ',',
+    ' ', '\t', '\n', ' ', ' ', '　',
+    '«', '»', '“', '”', '‘', '’',
+    '‎', '‏', '‪', '‬',
+    'é', '日', '\u{1F600}',
+];
+
+// Inputs the regular expression backtracks badly on
+const pathologicalInputs = [
+    n => `http://${'('.repeat(n)}`,
+    n => `http://a${'!'.repeat(n)}`,
+    n => `http://${'(a'.repeat(n / 2)}`,
+    n => `http://${'(a)'.repeat(n / 3)}!`,
+    n => '[http://'.repeat(n / 8),
+    n => `www.${'.'.repeat(n)}`,
+    n => `${'a'.repeat(n)}.com`,
+    n => `${'a.'.repeat(n / 2)}/`,
+    n => '(x.co/'.repeat(n / 6),
+];
+
+let seed = 42;
+
+/**
+ * @param {number} n upper bound
+ * @returns {number} a pseudo-random integer between 0 and `n` - 1
+ */
+function random(n) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    return seed % n;
+}
+
+/**
+ * @returns {string} a random string made of atoms
+ */
+function randomInput() {
+    const nAtoms = random(MAX_RANDOM_ATOMS) + 1;
+    let str = '';
+    for (let i = 0; i < nAtoms; i++)
+        str += atoms[random(atoms.length)];
+    return str;
+}
+
+/**
+ * @param {string} str string to find URLs in
+ * @returns {number} the time it takes to find URLs in `str`, in ns
+ */
+function timeFindUrls(str) {
+    let bestTime = Infinity;
+    for (let i = 0; i < N_TIMED_RUNS; i++) {
+        const startTime = GLib.get_monotonic_time();
+        Util.findUrls(str);
+        bestTime = Math.min(bestTime, GLib.get_monotonic_time() - startTime);
+    }
+    return bestTime * 1000;
+}
+
+for (let i = 0; i < N_RANDOM_INPUTS; i++) {
+    const input = randomInput();
+    UrlRegexp.assertUrlsEqual(`Random input ${JSON.stringify(input)}`,
+        UrlRegexp.findUrls(input),
+        Util.findUrls(input));
+}
+
+const longInputs = pathologicalInputs.map(f => f(LONG_INPUT_LENGTH));
+const N_LONG_RANDOM_INPUTS = 4;
+for (let i = 0; i < N_LONG_RANDOM_INPUTS; i++) {
+    let input = '';
+    while (input.length < LONG_INPUT_LENGTH)
+        input += randomInput();
+    longInputs.push(input);
+}
+
+for (let i = 0; i < longInputs.length; i++) {
+    const nBytes = new TextEncoder().encode(longInputs[i]).length;
+    const timePerByte = timeFindUrls(longInputs[i]) / nBytes;
+
+    JsUnit.assertTrue(`Input ${i} took ${timePerByte} ns per byte`,
+        timePerByte <= MAX_TIME_PER_BYTE_NS);
+}